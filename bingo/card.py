@@ -11,7 +11,7 @@ import hashlib
 import random
 from dataclasses import dataclass, field
 from datetime import datetime, timezone
-from typing import List, Optional
+from typing import Dict, List, Optional, Sequence
 
 from challenges import Challenge
 
@@ -37,18 +37,52 @@ class BingoCard:
         return sum(sq.difficulty for sq in self.squares if sq is not None)
 
 
+@dataclass
+class ChallengeBuckets:
+    """The pool split by difficulty (in pool order) and by category, once for many cards."""
+    by_difficulty: Dict[int, List[Challenge]]
+    by_category: Dict[str, List[Challenge]]
+
+    def check(self, easy_count: int, medium_count: int, hard_count: int) -> None:
+        """Raise ValueError if a card with these counts cannot be filled."""
+        for diff, name, need in ((1, "easy", easy_count), (2, "medium", medium_count), (3, "hard", hard_count)):
+            have = len(self.by_difficulty.get(diff, []))
+            if have < need:
+                raise ValueError(f"Need {need} {name} challenges, pool has {have}")
+        # Each category contributes at most _MAX_PER_CATEGORY squares.
+        reachable = sum(min(len(v), _MAX_PER_CATEGORY) for v in self.by_category.values())
+        if reachable < easy_count + medium_count + hard_count:
+            raise ValueError(
+                f"Category cap {_MAX_PER_CATEGORY} leaves {reachable} usable challenges, "
+                f"need {easy_count + medium_count + hard_count}"
+            )
+
+
+def bucket_challenges(pool: Sequence[Challenge]) -> ChallengeBuckets:
+    """Bucket *pool* by difficulty and category."""
+    by_difficulty: Dict[int, List[Challenge]] = {1: [], 2: [], 3: []}
+    by_category: Dict[str, List[Challenge]] = {}
+    for ch in pool:
+        by_difficulty.setdefault(ch.difficulty, []).append(ch)
+        by_category.setdefault(ch.category, []).append(ch)
+    return ChallengeBuckets(by_difficulty=by_difficulty, by_category=by_category)
+
+
 def generate_card(
     pool: List[Challenge],
     seed: Optional[int] = None,
     easy_count: int = 8,
     medium_count: int = 10,
     hard_count: int = 6,
+    buckets: Optional[ChallengeBuckets] = None,
 ) -> BingoCard:
     """Generate a single 5x5 bingo card from *pool*.
 
     The 24 playable squares (centre is FREE) are filled with a balanced
     mix of easy / medium / hard challenges.  Harder squares are placed
-    toward the corners, easier ones near the centre.
+    toward the corners, easier ones near the centre.  Pass *buckets*
+    (from bucket_challenges(), already checked) to skip partitioning the
+    pool for every card; the card is the same either way.
     """
     assert easy_count + medium_count + hard_count == 24
 
@@ -57,16 +91,12 @@ def generate_card(
     rng = random.Random(seed)
 
     # -- partition pool by difficulty --
-    easy = [c for c in pool if c.difficulty == 1]
-    medium = [c for c in pool if c.difficulty == 2]
-    hard = [c for c in pool if c.difficulty == 3]
-
-    if len(easy) < easy_count:
-        raise ValueError(f"Need {easy_count} easy challenges, pool has {len(easy)}")
-    if len(medium) < medium_count:
-        raise ValueError(f"Need {medium_count} medium challenges, pool has {len(medium)}")
-    if len(hard) < hard_count:
-        raise ValueError(f"Need {hard_count} hard challenges, pool has {len(hard)}")
+    if buckets is None:
+        buckets = bucket_challenges(pool)
+        buckets.check(easy_count, medium_count, hard_count)
+    easy = buckets.by_difficulty[1]
+    medium = buckets.by_difficulty[2]
+    hard = buckets.by_difficulty[3]
 
     # -- sample with category cap --
     selected = _sample_with_category_cap(
@@ -3,12 +3,40 @@ Challenge pool for the Compiler Optimization Bingo card generator.
 
 Each challenge maps to a concept demonstrated in the gallery's source files.
 Difficulty: 1=easy(★), 2=medium(★★), 3=hard(★★★).
+
+Challenges whose answer is visible in the compiled output carry claims,
+which verify.py checks against a ce_batch.py output tree.
 """
 
 from dataclasses import dataclass, field
 from typing import List
 
 
+@dataclass(frozen=True)
+class Claim:
+    """A statement about the compiled gallery that verify.py can check.
+
+    It must hold for *source* in *scenario*, on every compiler that has the
+    cell, targets *isa* ("" for any) and, if set, is of *family* (gcc,
+    clang or msvc). *function* is a glob over the listing's functions.
+
+      uses / lacks      an instruction matching glob *pattern* appears / does not
+      gains / loses     ... appears in *scenario* but not *than* / the reverse
+      text / no_text    regex *pattern* matches the listing / does not
+      vectorized        vector instructions are used (.metrics.json)
+      scalar            none are
+      smaller           fewer instructions in *scenario* than in *than*
+    """
+    kind: str
+    source: str
+    pattern: str = ""
+    scenario: str = "O2"
+    than: str = ""
+    function: str = "*"
+    family: str = ""
+    isa: str = "amd64"
+
+
 @dataclass
 class Challenge:
     id: str
@@ -20,6 +48,7 @@ class Challenge:
     answer: str           # Hidden answer revealed on flip
     hint: str = ""        # Gallery reference
     accept: List[str] = field(default_factory=list)  # Quiz-mode accepted keywords
+    claims: List[Claim] = field(default_factory=list)  # Checked by verify.py
 
 
 CHALLENGE_POOL: List[Challenge] = [
@@ -129,6 +158,7 @@ CHALLENGE_POOL: List[Challenge] = [
         answer="If-conversion (branch to conditional move)",
         hint="See: control-flow/if-conversion",
         accept=["if-conversion", "if conversion", "conditional move"],
+        claims=[Claim("gains", "control-flow/if-conversion", "cmov*", function="min", than="O0")],
     ),
     Challenge(
         id="asm_shift_for_mul",
@@ -139,6 +169,7 @@ CHALLENGE_POOL: List[Challenge] = [
         answer="Strength reduction (multiply → shift)",
         hint="See: arithmetic/strength-reduction",
         accept=["strength reduction"],
+        claims=[Claim("uses", "arithmetic/strength-reduction", "s[ah]l", function="multiply_by_15")],
     ),
     Challenge(
         id="asm_movabs_string",
@@ -149,6 +180,10 @@ CHALLENGE_POOL: List[Challenge] = [
         answer="String literal inlining (immediate stores)",
         hint="See: string-literals/static-copy-1",
         accept=["string literal inlin", "immediate store"],
+        claims=[
+            Claim("no_text", "string-literals/static-copy-1", r"call\s+\S*strcpy", function="foo"),
+            Claim("text", "string-literals/static-copy-1", r"^mov\w*\s+[^,]+,\s*(0x[0-9a-f]{8,}|-?\d{8,})$", function="foo"),
+        ],
     ),
     Challenge(
         id="asm_jump_table",
@@ -159,6 +194,7 @@ CHALLENGE_POOL: List[Challenge] = [
         answer="Jump table (O(1) dispatch instead of if-else chain)",
         hint="See: control-flow/switch-table",
         accept=["jump table"],
+        claims=[Claim("text", "control-flow/switch-table", r"^jmp\s+(r\w+|\w*\s*PTR\b)", function="apply_op")],
     ),
     Challenge(
         id="asm_jmp_self",
@@ -169,6 +205,7 @@ CHALLENGE_POOL: List[Challenge] = [
         answer="Tail call optimization",
         hint="See: control-flow/tail-call",
         accept=["tail call"],
+        claims=[Claim("loses", "control-flow/tail-call", "call*", function="factorial_tail", than="O0")],
     ),
     Challenge(
         id="asm_magic_mul",
@@ -179,6 +216,7 @@ CHALLENGE_POOL: List[Challenge] = [
         answer="Strength reduction (division by multiplicative inverse)",
         hint="See: arithmetic/strength-reduction",
         accept=["strength reduction", "multiplicative inverse"],
+        claims=[Claim("text", "arithmetic/strength-reduction", r"\b(0xaaaaaaab|2863311531|-1431655765)\b", function="divide_by_3")],
     ),
     Challenge(
         id="asm_endbr64",
@@ -189,6 +227,7 @@ CHALLENGE_POOL: List[Challenge] = [
         answer="Intel CET / -fcf-protection (Indirect Branch Tracking)",
         hint="See: hardening/cf-protection",
         accept=["cet", "cf-protection", "cf protection", "indirect branch tracking"],
+        claims=[Claim("uses", "hardening/cf-protection", "endbr64", function="apply")],
     ),
     Challenge(
         id="asm_xor_zero_regs",
@@ -199,6 +238,7 @@ CHALLENGE_POOL: List[Challenge] = [
         answer="Zero-call-used-regs (-fzero-call-used-regs)",
         hint="See: hardening/zero-call-used-regs",
         accept=["zero-call-used-regs", "zero call used regs"],
+        claims=[Claim("text", "hardening/zero-call-used-regs", r"(^xor\s+(\w+), \2\n){2,}ret$", function="compute")],
     ),
 
     # ===================================================================
@@ -213,6 +253,7 @@ CHALLENGE_POOL: List[Challenge] = [
         answer="Loop unrolling combined with dead store elimination",
         hint="See: loops/unrollme-1",
         accept=["loop unroll", "unrolling"],
+        claims=[Claim("loses", "loops/unrollme-1", "j*", function="foo", than="O0")],
     ),
     Challenge(
         id="scen_const_fold",
@@ -223,6 +264,7 @@ CHALLENGE_POOL: List[Challenge] = [
         answer="Constant folding",
         hint="See: arithmetic/constant-folding",
         accept=["constant folding"],
+        claims=[Claim("text", "arithmetic/constant-folding", r"^mov\s+eax, 4096$", function="get_buffer_size")],
     ),
     Challenge(
         id="scen_branch_elim",
@@ -233,6 +275,7 @@ CHALLENGE_POOL: List[Challenge] = [
         answer="Dead branch elimination (compile-time constant condition)",
         hint="See: control-flow/branch-elimination",
         accept=["dead branch", "branch elim"],
+        claims=[Claim("lacks", "control-flow/branch-elimination", "j*", function="get_pointer_size")],
     ),
     Challenge(
         id="scen_vectorize",
@@ -243,6 +286,10 @@ CHALLENGE_POOL: List[Challenge] = [
         answer="Auto-vectorization (SIMD)",
         hint="See: simd/auto-vectorize",
         accept=["vectori"],
+        claims=[
+            Claim("vectorized", "simd/auto-vectorize", scenario="O3", function="add_arrays", isa=""),
+            Claim("scalar", "simd/auto-vectorize", function="add_arrays", family="gcc", isa=""),
+        ],
     ),
     Challenge(
         id="scen_inline",
@@ -253,6 +300,7 @@ CHALLENGE_POOL: List[Challenge] = [
         answer="Function inlining",
         hint="See: control-flow/inline-expansion",
         accept=["inlining", "inline"],
+        claims=[Claim("loses", "control-flow/inline-expansion", "call*", function="compute", than="O0")],
     ),
     Challenge(
         id="scen_licm",
@@ -263,6 +311,7 @@ CHALLENGE_POOL: List[Challenge] = [
         answer="Loop-Invariant Code Motion (LICM)",
         hint="See: loops/loop-invariant-motion",
         accept=["loop-invariant", "loop invariant", "licm"],
+        claims=[Claim("text", "loops/loop-invariant-motion", r"\A(?:(?!\.L\d+:).*\n)*imul", function="fill_scaled")],
     ),
     Challenge(
         id="scen_ofast_nan",
@@ -273,6 +322,10 @@ CHALLENGE_POOL: List[Challenge] = [
         answer="-ffast-math assumes no NaN values exist",
         hint="See: arithmetic/fast-math",
         accept=["fast-math", "fast math", "no nan"],
+        claims=[
+            Claim("text", "arithmetic/fast-math", r"\Axor\s+eax, eax\nret$", scenario="Ofast", function="is_nan"),
+            Claim("no_text", "arithmetic/fast-math", r"\Axor\s+eax, eax\nret$", scenario="O3", function="is_nan"),
+        ],
     ),
     Challenge(
         id="scen_os_vs_o3",
@@ -296,6 +349,10 @@ CHALLENGE_POOL: List[Challenge] = [
         answer="__security_cookie (a global, XORed with RSP)",
         hint="See: hardening/msvc-gs-canary",
         accept=["__security_cookie", "security_cookie"],
+        claims=[
+            Claim("text", "hardening/msvc-gs-canary", r"__security_cookie", family="msvc"),
+            Claim("text", "hardening/stack-protector", r"fs:(40|0x28)\b", family="gcc"),
+        ],
     ),
     Challenge(
         id="comp_fortify",
@@ -306,6 +363,7 @@ CHALLENGE_POOL: List[Challenge] = [
         answer="__strcpy_chk",
         hint="See: hardening/fortify-source",
         accept=["__strcpy_chk", "strcpy_chk"],
+        claims=[Claim("text", "hardening/fortify-source", r"__strcpy_chk", function="greet", family="gcc")],
     ),
     Challenge(
         id="comp_restrict",
@@ -316,6 +374,7 @@ CHALLENGE_POOL: List[Challenge] = [
         answer="Vectorization and load/store optimization",
         hint="See: simd/restrict-pointer",
         accept=["vectori", "load/store", "load store"],
+        claims=[Claim("vectorized", "simd/restrict-pointer", scenario="O3", isa="")],
     ),
     Challenge(
         id="comp_cfg_vs_cet",
@@ -326,6 +385,7 @@ CHALLENGE_POOL: List[Challenge] = [
         answer="Control Flow Guard (/guard:cf) with __guard_dispatch_icall_fptr",
         hint="See: hardening/msvc-guard-cf",
         accept=["control flow guard", "/guard:cf", "guard:cf"],
+        claims=[Claim("text", "hardening/msvc-guard-cf", r"__guard_dispatch_icall_fptr", family="msvc")],
     ),
     Challenge(
         id="comp_spectre",
@@ -336,6 +396,7 @@ CHALLENGE_POOL: List[Challenge] = [
         answer="Speculative Load Hardening (-mspeculative-load-hardening)",
         hint="See: hardening/msvc-qspectre",
         accept=["speculative load hardening", "mspeculative"],
+        claims=[Claim("uses", "hardening/msvc-qspectre", "lfence", family="msvc")],
     ),
     Challenge(
         id="comp_loop_interchange",
@@ -360,6 +421,10 @@ CHALLENGE_POOL: List[Challenge] = [
         answer="Dead store (buffer not read afterward)",
         hint="See: security/memset-removed",
         accept=["dead store"],
+        claims=[
+            Claim("text", "security/memset-removed", r"call\s+\S*memset", scenario="O0", function="process_password"),
+            Claim("no_text", "security/memset-removed", r"call\s+\S*memset", function="process_password"),
+        ],
     ),
     Challenge(
         id="sec_stack_canary_purpose",
@@ -641,6 +706,7 @@ CHALLENGE_POOL: List[Challenge] = [
         answer="Integer promotion: ~byte promotes to int, so the result is never 0",
         hint="See: arithmetic/integer-promotion",
         accept=["integer promotion", "int promotion"],
+        claims=[Claim("text", "arithmetic/integer-promotion", r"\Axor\s+eax, eax\nret$", function="promotion_surprise")],
     ),
 
     # ===================================================================
@@ -689,6 +755,7 @@ CHALLENGE_POOL: List[Challenge] = [
         answer="Doubled code size for the loop body (suppressed at -Os)",
         hint="See: loops/loop-unswitching",
         accept=["code size", "doubled", "duplicate"],
+        claims=[Claim("smaller", "loops/loop-unswitching", than="O3", isa="")],
     ),
 
     # ===================================================================
@@ -809,6 +876,7 @@ CHALLENGE_POOL: List[Challenge] = [
         answer="Integer truncation vulnerability (narrowing conversion before bounds check)",
         hint="See: security/type-width-truncation",
         accept=["truncat", "narrowing"],
+        claims=[Claim("text", "security/type-width-truncation", r"^cmpw?\s+(WORD PTR|[abcd]x|[sd]i|r\d+w)\b", function="copy_data_bad")],
     ),
 
     # ===================================================================
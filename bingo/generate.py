@@ -13,17 +13,26 @@ Generates interactive HTML bingo cards with compiler-optimization challenges.
 
 Usage:
     python bingo/generate.py [--output DIR] [--count N] [--seed INT]
-                             [--difficulty easy|mixed|hard]
+                             [--difficulty easy|mixed|hard] [--jobs N]
+                             [--printable [--answer-key]]
 
-Each card is a self-contained HTML file with embedded CSS and JS.
+Each card is a self-contained HTML file with embedded CSS and JS. With
+--printable all cards go into one paginated file for printing instead,
+one card per page.
+
+The pool is bucketed and the templates are compiled once per worker
+process; cards are generated and rendered in parallel.
 """
 
 from __future__ import annotations
 
 import argparse
+import os
 import random
 import sys
+from concurrent.futures import ProcessPoolExecutor
 from pathlib import Path
+from typing import Any, Dict, List, Tuple
 
 try:
     from jinja2 import Environment, FileSystemLoader
@@ -31,7 +40,7 @@ except ImportError as e:
     raise SystemExit("Missing dependency: jinja2. Install with: pip install jinja2") from e
 
 from challenges import CHALLENGE_POOL
-from card import generate_card
+from card import bucket_challenges, generate_card
 
 _DIFFICULTY_PRESETS = {
     "easy":  {"easy_count": 12, "medium_count": 8, "hard_count": 4},
@@ -39,6 +48,35 @@ _DIFFICULTY_PRESETS = {
     "hard":  {"easy_count": 4, "medium_count": 8, "hard_count": 12},
 }
 
+PRINT_NAME = "bingo-cards-print.html"
+
+# Per-process state: the compiled templates and the bucketed pool.
+_worker: Dict[str, Any] = {}
+
+
+def _environment() -> Environment:
+    # Resolve template directory relative to this script
+    template_dir = Path(__file__).resolve().parent
+    return Environment(
+        loader=FileSystemLoader(str(template_dir)),
+        autoescape=False,
+    )
+
+
+def init_worker(preset: Dict[str, int], printable: bool, answer_key: bool) -> None:
+    """Compile the card template and bucket the challenge pool once per process."""
+    _worker["template"] = _environment().get_template("print_card.html.j2" if printable else "template.html.j2")
+    _worker["answer_key"] = answer_key
+    _worker["preset"] = preset
+    _worker["buckets"] = bucket_challenges(CHALLENGE_POOL)
+
+
+def render_card(seed: int) -> Tuple[str, int, str]:
+    """(card id, seed, HTML) of the card for *seed*: a whole page, or a print page with --printable."""
+    card = generate_card(CHALLENGE_POOL, seed=seed, buckets=_worker["buckets"], **_worker["preset"])
+    html = _worker["template"].render(card=card, answer_key=_worker["answer_key"])
+    return card.id, card.seed, html
+
 
 def main() -> None:
     parser = argparse.ArgumentParser(
@@ -68,17 +106,29 @@ def main() -> None:
         default="mixed",
         help="Difficulty preset (default: mixed)",
     )
-    args = parser.parse_args()
-
-    # Resolve template directory relative to this script
-    template_dir = Path(__file__).resolve().parent
-    env = Environment(
-        loader=FileSystemLoader(str(template_dir)),
-        autoescape=False,
+    parser.add_argument(
+        "--jobs", "-j",
+        type=int,
+        default=os.cpu_count() or 1,
+        help="Worker processes for generating cards (default: CPU count)",
     )
-    template = env.get_template("template.html.j2")
+    parser.add_argument(
+        "--printable", "-p",
+        action="store_true",
+        help=f"Write all cards to one paginated printable file ({PRINT_NAME}) instead of one file each",
+    )
+    parser.add_argument(
+        "--answer-key",
+        action="store_true",
+        help="With --printable, follow each card with its answer key",
+    )
+    args = parser.parse_args()
 
     preset = _DIFFICULTY_PRESETS[args.difficulty]
+    try:
+        bucket_challenges(CHALLENGE_POOL).check(**preset)
+    except ValueError as e:
+        raise SystemExit(f"Cannot build a {args.difficulty} card: {e}") from e
 
     # Determine seeds
     if args.seed is not None:
@@ -89,18 +139,35 @@ def main() -> None:
 
     args.output.mkdir(parents=True, exist_ok=True)
 
-    pool = list(CHALLENGE_POOL)
-    generated = []
-
-    for seed in seeds:
-        card = generate_card(pool, seed=seed, **preset)
-        html = template.render(card=card)
-        out_path = args.output / f"bingo-{card.id}.html"
+    initargs = (preset, args.printable, args.answer_key)
+    jobs = max(1, min(args.jobs, len(seeds)))
+    rendered: List[Tuple[str, int, str]]
+    if jobs > 1:
+        with ProcessPoolExecutor(max_workers=jobs, initializer=init_worker, initargs=initargs) as pool:
+            rendered = list(pool.map(render_card, seeds, chunksize=max(1, len(seeds) // (jobs * 4))))
+    else:
+        init_worker(*initargs)
+        rendered = [render_card(seed) for seed in seeds]
+
+    if args.printable:
+        out_path = args.output / PRINT_NAME
+        out_path.write_text(
+            _environment().get_template("print.html.j2").render(
+                pages=[html for _, _, html in rendered],
+                cards=[(card_id, seed) for card_id, seed, _ in rendered],
+                answer_key=args.answer_key,
+            ),
+            encoding="utf-8",
+        )
+        print(f"\nGenerated {len(rendered)} card(s) in {out_path}")
+        return
+
+    for card_id, seed, html in rendered:
+        out_path = args.output / f"bingo-{card_id}.html"
         out_path.write_text(html, encoding="utf-8")
-        generated.append((card.id, out_path))
-        print(f"  Card {card.id}  (seed {card.seed})  →  {out_path}")
+        print(f"  Card {card_id}  (seed {seed})  →  {out_path}")
 
-    print(f"\nGenerated {len(generated)} card(s) in {args.output}/")
+    print(f"\nGenerated {len(rendered)} card(s) in {args.output}/")
 
 
 if __name__ == "__main__":
@@ -0,0 +1,257 @@
+#!/usr/bin/env python3
+# Copyright (c) 2026 Larry H <l.gr [at] dartmouth [dot] edu>
+# SPDX-License-Identifier: AGPL-3.0-or-later
+#
+# Compiler Optimization Gallery
+# Developed for COSC-69.16: Basics of Reverse Engineering
+# Dartmouth College, Winter 2026
+
+"""
+verify.py
+
+Checks the claims of the challenge pool (see Claim in challenges.py)
+against a ce_batch.py output tree, and reports the challenges whose answer
+the compiled gallery no longer shows, for example after the compiler
+versions in docs/config.yaml were bumped.
+
+Usage:
+    python bingo/verify.py [--out DIR] [--only ID ...] [--verbose] [--json]
+
+Instruction claims are answered from the assembly index of ce_search.py,
+built from the tree's manifest and cached in ``<out>/.search-cache.json``,
+so only listings that changed since the last check are read. Text claims
+read the listings of the claimed source, vector and size claims its
+``.metrics.json``. A claim is checked on every compiler of its instruction
+set (and family) that has the cell. Exits with status 1 if any challenge is
+stale.
+"""
+
+from __future__ import annotations
+
+import argparse
+import fnmatch
+import json
+import re
+import sys
+from pathlib import Path
+from typing import Any, Dict, List, Optional, Tuple
+
+sys.path.insert(1, str(Path(__file__).resolve().parent.parent))
+
+from ce_metrics import split_functions  # noqa: E402
+from ce_remarks import compiler_family  # noqa: E402
+from ce_search import index_output_tree  # noqa: E402
+from ce_store import open_outputs_for_reading  # noqa: E402
+
+from challenges import CHALLENGE_POOL, Challenge, Claim  # noqa: E402
+
+INDEX_KINDS = ("uses", "lacks", "gains", "loses")
+TEXT_KINDS = ("text", "no_text")
+METRIC_KINDS = ("vectorized", "scalar", "smaller")
+
+
+def describe(claim: Claim) -> str:
+    where = f" in {claim.function}" if claim.function != "*" else ""
+    than = f" vs {claim.than}" if claim.than else ""
+    pattern = f" {claim.pattern!r}" if claim.pattern else ""
+    return f"{claim.source} {claim.scenario}{than}: {claim.kind}{pattern}{where}"
+
+
+class Verifier:
+    """Claims checked against one output tree; indexes and cell files are read once."""
+
+    def __init__(self, out: Path) -> None:
+        self.index = index_output_tree(out, cache=out / ".search-cache.json")
+        self.outputs = open_outputs_for_reading(out)
+        self._pages: Dict[Tuple[str, str, str], int] = {}
+        for i, (_, source, compiler_id, scenario) in enumerate(self.index["pages"]):
+            self._pages[(source, scenario, compiler_id)] = i
+        self._page_functions: Dict[int, List[str]] = {}
+        for name, pages in self.index["functions"].items():
+            for page in pages:
+                self._page_functions.setdefault(page, []).append(name)
+        self._uses: Dict[str, Dict[int, Dict[str, int]]] = {}
+        self._metrics: Dict[str, Optional[Dict[str, Any]]] = {}
+
+    def close(self) -> None:
+        self.outputs.close()
+
+    def _metrics_of(self, cell_key: str) -> Optional[Dict[str, Any]]:
+        if cell_key not in self._metrics:
+            text = self.outputs.read_text(f"{cell_key}.metrics.json")
+            self._metrics[cell_key] = json.loads(text) if text else None
+        return self._metrics[cell_key]
+
+    def _uses_of(self, pattern: str) -> Dict[int, Dict[str, int]]:
+        """Per page and function, the uses of instructions matching *pattern*."""
+        if pattern not in self._uses:
+            found: Dict[int, Dict[str, int]] = {}
+            for mnem, postings in self.index["mnemonics"].items():
+                if fnmatch.fnmatchcase(mnem, pattern.lower()):
+                    for page, _, users in postings:
+                        by_function = found.setdefault(page, {})
+                        for name, count in users:
+                            by_function[name] = by_function.get(name, 0) + count
+            self._uses[pattern] = found
+        return self._uses[pattern]
+
+    def _count(self, claim: Claim, page: int) -> Optional[int]:
+        """Uses of the claim's instructions on *page*, or None if it has no matching function."""
+        functions = [f for f in self._page_functions.get(page, []) if fnmatch.fnmatchcase(f, claim.function)]
+        if claim.function != "*" and not functions:
+            return None
+        by_function = self._uses_of(claim.pattern).get(page, {})
+        return sum(n for f, n in by_function.items() if fnmatch.fnmatchcase(f, claim.function))
+
+    def _listing(self, claim: Claim, cell_key: str) -> Optional[str]:
+        text = self.outputs.read_text(f"{cell_key}.asm")
+        if text is None:
+            return None
+        if claim.function == "*":
+            return "\n".join(line.strip() for line in text.splitlines())
+        bodies = [body for name, body in split_functions(text.splitlines()).items() if fnmatch.fnmatchcase(name, claim.function)]
+        return "\n".join("\n".join(body) for body in bodies) if bodies else None
+
+    def _holds(self, claim: Claim, compiler_id: str) -> Tuple[bool, str]:
+        """Whether *claim* holds on *compiler_id*, and why not."""
+        page = self._pages[(claim.source, claim.scenario, compiler_id)]
+        cell_key = f"{compiler_id}/{claim.scenario}/{claim.source}"
+        base_key = f"{compiler_id}/{claim.than}/{claim.source}"
+        missing = f"no function {claim.function}"
+        if claim.kind in INDEX_KINDS:
+            n = self._count(claim, page)
+            if n is None:
+                return False, missing
+            if claim.kind == "uses":
+                return n > 0, "not used"
+            if claim.kind == "lacks":
+                return n == 0, f"used {n} times"
+            base = self._count(claim, self._pages[(claim.source, claim.than, compiler_id)])
+            if claim.kind == "gains":
+                return n > 0 and not base, f"{base or 0} uses in {claim.than}, {n} in {claim.scenario}"
+            return n == 0 and bool(base), f"{base or 0} uses in {claim.than}, {n} in {claim.scenario}"
+        if claim.kind in TEXT_KINDS:
+            listing = self._listing(claim, cell_key)
+            if listing is None:
+                return False, missing
+            found = re.search(claim.pattern, listing, re.IGNORECASE | re.MULTILINE)
+            if claim.kind == "text":
+                return found is not None, "no match"
+            return found is None, f"matches {found.group(0).strip()!r}" if found else ""
+        if claim.kind in METRIC_KINDS:
+            metrics = self._metrics_of(cell_key)
+            if metrics is None:
+                return False, "no .metrics.json"
+            if claim.kind == "smaller":
+                base = self._metrics_of(base_key)
+                if base is None:
+                    return False, f"no .metrics.json in {claim.than}"
+                n, m = metrics["total"]["instructions"], base["total"]["instructions"]
+                return n < m, f"{n} instructions vs {m} in {claim.than}"
+            if claim.function == "*":
+                simd = [metrics["total"].get("simd")]
+            else:
+                simd = [f.get("simd") for f in metrics.get("functions", []) if fnmatch.fnmatchcase(f["name"], claim.function)]
+                if not simd:
+                    return False, missing
+            if claim.kind == "vectorized":
+                return any(simd), "no vector instructions"
+            return not any(simd), f"uses {', '.join(sorted(set(filter(None, simd))))}"
+        raise ValueError(f"unknown claim kind {claim.kind!r}")
+
+    def check(self, claim: Claim) -> Dict[str, Any]:
+        """{"claim", "holds": [compiler], "fails": {compiler: reason}} over the compilers the claim covers."""
+        holds: List[str] = []
+        fails: Dict[str, str] = {}
+        for (source, scenario, compiler_id) in sorted(self._pages):
+            if source != claim.source or scenario != claim.scenario:
+                continue
+            if claim.than and (source, claim.than, compiler_id) not in self._pages:
+                continue
+            if claim.family and compiler_family(compiler_id) != claim.family:
+                continue
+            if claim.isa:
+                metrics = self._metrics_of(f"{compiler_id}/{scenario}/{source}")
+                if metrics is None or metrics.get("instruction_set") != claim.isa:
+                    continue
+            ok, reason = self._holds(claim, compiler_id)
+            if ok:
+                holds.append(compiler_id)
+            else:
+                fails[compiler_id] = reason
+        return {"claim": describe(claim), "holds": holds, "fails": fails}
+
+    def verify(self, challenge: Challenge) -> Dict[str, Any]:
+        """A challenge's status: ok, stale, unchecked (no covered outputs) or manual (no claims)."""
+        results = [self.check(c) for c in challenge.claims]
+        if not results:
+            status = "manual"
+        elif any(r["fails"] for r in results):
+            status = "stale"
+        elif all(r["holds"] for r in results):
+            status = "ok"
+        else:
+            status = "unchecked"
+        return {"id": challenge.id, "status": status, "claims": results}
+
+
+def main() -> int:
+    parser = argparse.ArgumentParser(
+        description="Check the challenge pool's claims against compiled gallery output.",
+    )
+    parser.add_argument(
+        "--out",
+        type=Path,
+        default=Path("output"),
+        help="Output directory of ce_batch.py (default: output/)",
+    )
+    parser.add_argument(
+        "--only",
+        action="append",
+        default=[],
+        metavar="ID",
+        help="Only check this challenge (repeatable)",
+    )
+    parser.add_argument(
+        "--verbose", "-v",
+        action="store_true",
+        help="Also list challenges that check out",
+    )
+    parser.add_argument(
+        "--json",
+        action="store_true",
+        help="Print the results as JSON",
+    )
+    args = parser.parse_args()
+
+    pool = [c for c in CHALLENGE_POOL if not args.only or c.id in args.only]
+    verifier = Verifier(args.out)
+    try:
+        results = [verifier.verify(c) for c in pool]
+    finally:
+        verifier.close()
+
+    if args.json:
+        print(json.dumps(results, indent=2))
+    else:
+        for r in results:
+            if r["status"] == "manual" or (r["status"] == "ok" and not args.verbose):
+                continue
+            print(f"{r['status'].upper():<10} {r['id']}")
+            for c in r["claims"]:
+                if args.verbose or c["fails"] or not c["holds"]:
+                    holds = ", ".join(c["holds"]) or "-"
+                    print(f"    {c['claim']}")
+                    print(f"        holds on: {holds}")
+                    for compiler_id, reason in c["fails"].items():
+                        print(f"        fails on {compiler_id}: {reason}")
+        counts = {s: sum(1 for r in results if r["status"] == s) for s in ("ok", "stale", "unchecked", "manual")}
+        print(
+            f"\n{counts['ok']} verified, {counts['stale']} stale, {counts['unchecked']} without outputs, "
+            f"{counts['manual']} without claims ({len(results)} challenges)"
+        )
+    return 1 if any(r["status"] == "stale" for r in results) else 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -26,12 +26,19 @@ import argparse
 import re
 from dataclasses import dataclass, field
 from pathlib import Path
-from typing import Any, Dict, List, Optional, Set
+from typing import Any, Dict, Iterator, List, Optional, Set, Tuple
+from concurrent.futures import Future, ProcessPoolExecutor
+from contextlib import contextmanager
+import dataclasses
+import filecmp
 import json
+import math
+import os
 import shutil
+import time
 
 try:
-    from jinja2 import Environment, FileSystemLoader, select_autoescape
+    from jinja2 import Environment, FileSystemBytecodeCache, FileSystemLoader, select_autoescape
 except ImportError as e:
     raise SystemExit("Missing dependency: jinja2. Install with: pip install jinja2") from e
 
@@ -40,6 +47,21 @@ try:
 except ImportError as e:
     raise SystemExit("Missing dependency: pyyaml. Install with: pip install pyyaml") from e
 
+from ce_asmdiff import DiffCache, normalize_listing, unified_hunks
+from ce_baseline import compare as compare_baseline, load_baseline, load_thresholds, snapshot as snapshot_outputs
+from ce_compiletime import COMPILETIME_SUFFIX
+from ce_consttime import CONSTTIME_SUFFIX, DUDECT_SUFFIX, T_THRESHOLD, summarize
+from ce_incremental import SourceChanges, changed_sources_since, source_category
+from ce_manifest import read_manifest
+from ce_mca import MCA_SUFFIX
+from ce_metrics import detect_instruction_set
+from ce_overhead import OVERHEAD_SUFFIX, percent, timing_rows
+from ce_pgo import PGO_SUFFIX
+from ce_remarks import REMARKS_SUFFIX, group_by_line
+from ce_search import SEARCH_INDEX_NAME, TermCache, build_index
+from ce_store import open_outputs_for_reading
+from ce_sweep import SWEEP_SUFFIX, Sweep, SweepError, expand_sweeps
+
 
 # -----------------------------------------------------------------------------
 # Data classes
@@ -52,6 +74,7 @@ class ScenarioConfig:
     flags: str
     title: str
     description: str
+    sweep: Optional[str] = None  # name of the flag sweep this point belongs to
 
 
 @dataclass
@@ -63,13 +86,18 @@ class CompilerInfo:
 
 @dataclass
 class SourceOutput:
-    """Output data for a single source/compiler/scenario combination."""
+    """
+    One source/compiler/scenario cell. Only metadata is kept in memory; the
+    source, assembly and explanation are read when its page is rendered.
+    """
     compiler_id: str
     scenario: str
-    source_code: str
-    assembly: str
-    explanation: str
     source_lang: str
+    cell_key: str             # store key without suffix, e.g. "cg152/O2/loops/unrollme-1"
+    source_ext: str = ".c"
+    mtime: float = 0.0        # newest of the cell's asm/explain files (and its variants' metrics)
+    variants: List[str] = field(default_factory=list)  # cell keys of its sweep-defines variants, "...@N=1024"
+    source_digest: Optional[str] = None  # sha256 of the source copy, from the manifest; same across cells
 
 
 @dataclass
@@ -86,6 +114,39 @@ class SourceFile:
 # Helper functions
 # -----------------------------------------------------------------------------
 
+def write_if_changed(path: Path, text: str) -> bool:
+    """Write *text* unless the file already holds exactly that. Returns True if written."""
+    try:
+        if path.read_text(encoding="utf-8") == text:
+            return False
+    except FileNotFoundError:
+        pass
+    path.write_text(text, encoding="utf-8")
+    return True
+
+
+class PhaseTimer:
+    """Accumulates wall-clock seconds per build phase for the closing summary."""
+
+    def __init__(self) -> None:
+        self.phases: Dict[str, float] = {}
+
+    def add(self, name: str, seconds: float) -> None:
+        self.phases[name] = self.phases.get(name, 0.0) + seconds
+
+    @contextmanager
+    def phase(self, name: str) -> Iterator[None]:
+        start = time.perf_counter()
+        try:
+            yield
+        finally:
+            self.add(name, time.perf_counter() - start)
+
+    def report(self) -> str:
+        width = max((len(n) for n in self.phases), default=0)
+        return "\n".join(f"  {name:<{width}}  {secs:8.3f}s" for name, secs in self.phases.items())
+
+
 def slugify(text: str) -> str:
     """Convert text to URL-friendly slug."""
     return re.sub(r'[^a-z0-9]+', '-', text.lower()).strip('-')
@@ -96,6 +157,11 @@ def title_case(text: str) -> str:
     return ' '.join(word.capitalize() for word in text.replace('-', ' ').replace('_', ' ').split())
 
 
+def md_inline(text: str) -> str:
+    """Escape compiler output for a Markdown table cell: 'data-refs *_4 | x' stays literal."""
+    return re.sub(r"([\\`*_\[\]|])", r"\\\1", str(text)).replace("<", "&lt;")
+
+
 def detect_language(extension: str) -> str:
     """Map file extension to syntax highlighting language."""
     mapping = {
@@ -216,21 +282,26 @@ DEFAULT_SCENARIO_DESCRIPTIONS = {
     "Ofast": "Maximum speed optimization. Enables O3 plus fast-math and other aggressive options.",
 }
 
+# Extensions a cell's ".src<ext>" copy may have, in lookup order.
+SOURCE_EXTENSIONS = (".c", ".cc", ".cpp", ".cxx", ".C", ".h", ".hpp")
+
 
 # -----------------------------------------------------------------------------
 # Config loading
 # -----------------------------------------------------------------------------
 
-def load_config(config_path: Optional[Path]) -> tuple[Dict[str, ScenarioConfig], Dict[str, str]]:
+def load_config(config_path: Optional[Path]) -> tuple[Dict[str, ScenarioConfig], Dict[str, str], List[Sweep]]:
     """
     Load configuration from YAML file.
 
     Returns:
-        - Dict of scenario configs keyed by scenario name
+        - Dict of scenario configs keyed by scenario name (sweep points included)
         - Dict of section display names keyed by directory name
+        - Flag sweeps (see ce_sweep.py)
     """
     scenarios: Dict[str, ScenarioConfig] = {}
     sections: Dict[str, str] = {}
+    sweeps: List[Sweep] = []
 
     if config_path and config_path.exists():
         obj = yaml.safe_load(config_path.read_text(encoding="utf-8"))
@@ -250,6 +321,21 @@ def load_config(config_path: Optional[Path]) -> tuple[Dict[str, ScenarioConfig],
                             description=desc.strip(),
                         )
 
+            # Expand flag sweeps into one scenario per point
+            try:
+                sweeps = expand_sweeps(obj.get("sweeps"))
+            except SweepError as e:
+                raise SystemExit(f"Invalid sweeps in {config_path}: {e}") from e
+            for sweep in sweeps:
+                for point in sweep.points:
+                    scenarios[point.name] = ScenarioConfig(
+                        name=point.name,
+                        flags=point.flags,
+                        title=f"{sweep.title}: {' '.join(v for v in point.values if v) or 'base'}",
+                        description=sweep.description or f"Point of the {sweep.name} flag sweep.",
+                        sweep=sweep.name,
+                    )
+
             # Load section display names
             sections_raw = obj.get("sections", {})
             if isinstance(sections_raw, dict):
@@ -257,16 +343,70 @@ def load_config(config_path: Optional[Path]) -> tuple[Dict[str, ScenarioConfig],
                     if isinstance(display_name, str):
                         sections[key] = display_name
 
-    return scenarios, sections
+    return scenarios, sections, sweeps
 
 
 # -----------------------------------------------------------------------------
 # Output collection
 # -----------------------------------------------------------------------------
 
-def collect_outputs(input_root: Path) -> tuple[Dict[str, SourceFile], Dict[str, CompilerInfo], Set[str]]:
+def _add_output(
+    sources: Dict[str, SourceFile],
+    compilers: Dict[str, CompilerInfo],
+    scenarios_found: Set[str],
+    base: str,
+    source_ext: str,
+    mtime: float,
+    variants: List[str],
+    source_digest: Optional[str] = None,
+) -> None:
+    """Register the cell with store key *base* (``<compiler>/<scenario>/<rel_path>/<stem>``)."""
+    parts = base.split("/")
+    compiler_id, scenario_name = parts[0], parts[1]
+    if compiler_id not in compilers:
+        compilers[compiler_id] = CompilerInfo(id=compiler_id)
+    scenarios_found.add(scenario_name)
+    compilers[compiler_id].scenarios.add(scenario_name)
+
+    stem = parts[-1]
+    parent_rel = "/".join(parts[2:-1])
+
+    # Build the source key
+    source_key = f"{parent_rel}/{stem}" if parent_rel else stem
+    category = source_category(source_key)
+
+    # Create or update SourceFile
+    if source_key not in sources:
+        sources[source_key] = SourceFile(
+            rel_path=source_key,
+            category=category,
+            name=stem,
+            extension=source_ext,
+        )
+
+    sources[source_key].outputs.append(SourceOutput(
+        compiler_id=compiler_id,
+        scenario=scenario_name,
+        source_lang=detect_language(source_ext),
+        cell_key=base,
+        source_ext=source_ext,
+        mtime=mtime,
+        variants=variants,
+        source_digest=source_digest,
+    ))
+
+
+def collect_outputs(
+    input_root: Path, use_manifest: bool = True,
+) -> tuple[Dict[str, SourceFile], Dict[str, CompilerInfo], Set[str]]:
     """
-    Walk the input directory and collect all outputs.
+    Collect all outputs under the input directory.
+
+    Reads the packed store (<input>/gallery.sqlite) if there is one, otherwise
+    the per-cell file tree; see ce_store.py. The cells come from the
+    manifest ce_batch.py keeps (ce_manifest.py) when there is one and
+    *use_manifest* is set, so the tree is not walked; otherwise every
+    explanation is listed and its source copy found by extension.
 
     Returns:
         - Dict of source files keyed by relative path
@@ -280,83 +420,831 @@ def collect_outputs(input_root: Path) -> tuple[Dict[str, SourceFile], Dict[str,
     if not input_root.exists():
         raise SystemExit(f"Input directory does not exist: {input_root}")
 
-    # Structure: input_root/<compiler>/<scenario>/<rel_path>/<stem>.*
-    for compiler_dir in sorted(input_root.iterdir()):
-        if not compiler_dir.is_dir() or compiler_dir.name.startswith("."):
+    outputs = open_outputs_for_reading(input_root)
+    try:
+        manifest = read_manifest(outputs) if use_manifest else None
+        if manifest is not None:
+            _collect_from_manifest(manifest, sources, compilers, scenarios_found)
+            return sources, compilers, scenarios_found
+
+        # sweep-defines variants (<stem>@N=1024.*) have no explanation and no
+        # page of their own: they are listed on their base cell's page.
+        variants: Dict[str, List[str]] = {}
+        for metrics_key in outputs.iter_files(".metrics.json"):
+            cell_key = metrics_key[: -len(".metrics.json")]
+            head, sep, _ = cell_key.rpartition("@")
+            if sep and "/" not in cell_key[len(head):]:
+                variants.setdefault(head, []).append(cell_key)
+
+        # Structure: <compiler>/<scenario>/<rel_path>/<stem>.*
+        for explain_key in outputs.iter_files(".explain.md"):
+            if explain_key.count("/") < 2:
+                continue
+            base = explain_key[: -len(".explain.md")]
+
+            # Find the source copy (contents are loaded at render time)
+            source_ext = ".c"
+            for ext in SOURCE_EXTENSIONS:
+                if outputs.size(f"{base}.src{ext}") is not None:
+                    source_ext = ext
+                    break
+            mtime = max(
+                outputs.mtime(explain_key), outputs.mtime(f"{base}.asm"),
+                *(outputs.mtime(f"{v}.metrics.json") for v in variants.get(base, ())),
+            )
+            _add_output(sources, compilers, scenarios_found, base, source_ext, mtime, variants.get(base, []))
+    finally:
+        outputs.close()
+
+    return sources, compilers, scenarios_found
+
+
+def _collect_from_manifest(
+    manifest: Dict[str, Dict[str, Any]],
+    sources: Dict[str, SourceFile],
+    compilers: Dict[str, CompilerInfo],
+    scenarios_found: Set[str],
+) -> None:
+    """collect_outputs() from the manifest's cell list: no walk and no per-cell lookups."""
+    variants: Dict[str, List[str]] = {}
+    for cell_key in manifest:
+        head, sep, _ = cell_key.rpartition("@")
+        if sep and "/" not in cell_key[len(head):]:
+            variants.setdefault(head, []).append(cell_key)
+    for base, entry in sorted(manifest.items()):
+        files = entry.get("files") or []
+        if ".explain.md" not in files or base.count("/") < 2:
             continue
+        source_ext = next((sfx[len(".src"):] for sfx in files if sfx.startswith(".src.")), ".c")
+        cell_variants = sorted(variants.get(base, []))
+        mtime = max([float(entry.get("mtime") or 0.0)] + [float(manifest[v].get("mtime") or 0.0) for v in cell_variants])
+        _add_output(
+            sources, compilers, scenarios_found, base, source_ext, mtime, cell_variants, entry.get("source"),
+        )
 
-        compiler_id = compiler_dir.name
-        if compiler_id not in compilers:
-            compilers[compiler_id] = CompilerInfo(id=compiler_id)
 
-        for scenario_dir in sorted(compiler_dir.iterdir()):
-            if not scenario_dir.is_dir():
+def collect_sweep_records(input_root: Path) -> Dict[str, Dict[str, List[Dict[str, Any]]]]:
+    """
+    Sweep records written by ce_batch.py, as {sweep: {compiler: [record]}}
+    with records sorted by source. Each point gets the relative links of its
+    own page (kept points) or of the page it matches (pruned points).
+    """
+    records: Dict[str, Dict[str, List[Dict[str, Any]]]] = {}
+    outputs = open_outputs_for_reading(input_root)
+    try:
+        for key in outputs.iter_files(SWEEP_SUFFIX):
+            record = _load_json(outputs.read_text(key))
+            if not isinstance(record, dict) or not isinstance(record.get("points"), list):
                 continue
+            compiler_id, rel = record.get("compiler", ""), record.get("source", "")
+            category = source_category(rel)
+            for point in record["points"]:
+                target = point.get("same_as") or point.get("scenario")
+                point["page"] = f"../{target}/{compiler_id}/{category}/{Path(rel).name}.md"
+            records.setdefault(record.get("sweep", ""), {}).setdefault(compiler_id, []).append(record)
+    finally:
+        outputs.close()
+    for by_compiler in records.values():
+        for recs in by_compiler.values():
+            recs.sort(key=lambda r: r.get("source", ""))
+    return records
+
+
+def collect_compile_times(
+    input_root: Path, scenario_order: Sequence[str], top: int = 25, use_manifest: bool = True,
+) -> Optional[Dict[str, Any]]:
+    """
+    The Compile Time page's data from the ``.compiletime.json`` records
+    (ce_compiletime.py): the *top* slowest cells, and per compiler one row
+    per scenario with its total and mean compile time, code size and the
+    geometric mean ns/op of the benchmarks every benchmarked scenario of
+    that compiler ran. None if there are no records. Sweep-defines variants
+    have no page and are left out.
+    """
+    outputs = open_outputs_for_reading(input_root)
+    cells: List[Dict[str, Any]] = []
+    bench_runs: Dict[Tuple[str, str], Dict[Tuple[str, str, Any], float]] = {}
+    try:
+        manifest = read_manifest(outputs) if use_manifest else None
+        keys = (
+            [k + COMPILETIME_SUFFIX for k, e in sorted(manifest.items()) if COMPILETIME_SUFFIX in (e.get("files") or [])]
+            if manifest is not None else outputs.iter_files(COMPILETIME_SUFFIX)
+        )
+        for key in keys:
+            cell_key = key[:-len(COMPILETIME_SUFFIX)]
+            record = _load_json(outputs.read_text(key))
+            if not isinstance(record, dict) or cell_key.count("/") < 2 or "@" in cell_key.rpartition("/")[2]:
+                continue
+            compiler_id, scenario_name, rel = cell_key.split("/", 2)
+            category = source_category(rel)
+            metrics = _load_json(outputs.read_text(f"{cell_key}.metrics.json")) or {}
+            report = record.get("time_report") or {}
+            cells.append({
+                "source": rel,
+                "compiler": compiler_id,
+                "scenario": scenario_name,
+                "flags": record.get("flags", ""),
+                "wall_ms": record.get("wall_ms"),
+                "cached": bool(record.get("cached")),
+                "bytes": (metrics.get("total") or {}).get("bytes"),
+                "slowest_pass": next((p["name"] for p in report.get("passes") or [] if p.get("group") != "phase"), None),
+                "page": f"{scenario_name}/{compiler_id}/{category}/{Path(rel).name}.md",
+            })
+            bench = _load_json(outputs.read_text(f"{cell_key}.bench.json")) or {}
+            runs = {
+                (rel, r.get("function"), r.get("n")): float(r["ns_per_op"])
+                for r in bench.get("results", []) if isinstance(r.get("ns_per_op"), (int, float)) and r["ns_per_op"] > 0
+            }
+            if runs:
+                bench_runs.setdefault((compiler_id, scenario_name), {}).update(runs)
+    finally:
+        outputs.close()
+    if not cells:
+        return None
+    order = {name: i for i, name in enumerate(scenario_order)}
+    by_compiler: Dict[str, List[Dict[str, Any]]] = {}
+    for compiler_id in sorted({c["compiler"] for c in cells}):
+        scenarios = sorted(
+            {c["scenario"] for c in cells if c["compiler"] == compiler_id}, key=lambda n: (order.get(n, len(order)), n)
+        )
+        # Only benchmarks every benchmarked scenario ran are comparable.
+        benched = [bench_runs[(compiler_id, n)] for n in scenarios if (compiler_id, n) in bench_runs]
+        common = set.intersection(*(set(r) for r in benched)) if benched else set()
+        rows = []
+        for name in scenarios:
+            times = [c["wall_ms"] for c in cells if c["compiler"] == compiler_id and c["scenario"] == name and c["wall_ms"] is not None]
+            sizes = [c["bytes"] for c in cells if c["compiler"] == compiler_id and c["scenario"] == name and c["bytes"]]
+            runs = bench_runs.get((compiler_id, name), {})
+            geomean = (
+                math.exp(sum(math.log(runs[k]) for k in common) / len(common)) if common and (compiler_id, name) in bench_runs else None
+            )
+            rows.append({
+                "scenario": name,
+                "cells": sum(1 for c in cells if c["compiler"] == compiler_id and c["scenario"] == name),
+                "total_ms": sum(times),
+                "mean_ms": sum(times) / len(times) if times else None,
+                "max_ms": max(times) if times else None,
+                "bytes": sum(sizes) if sizes else None,
+                "bench_ns": geomean,
+            })
+        by_compiler[compiler_id] = rows
+    cells.sort(key=lambda c: -(c["wall_ms"] or 0))
+    return {"slowest": cells[:top], "by_compiler": by_compiler, "benchmarks": any(r["bench_ns"] for rows in by_compiler.values() for r in rows)}
 
-            scenario_name = scenario_dir.name
-            scenarios_found.add(scenario_name)
-            compilers[compiler_id].scenarios.add(scenario_name)
-
-            # Find all .explain.md files recursively
-            for explain_file in scenario_dir.rglob("*.explain.md"):
-                stem = explain_file.name.replace(".explain.md", "")
-                parent_rel = explain_file.parent.relative_to(scenario_dir)
-
-                # Build the source key
-                if str(parent_rel) == ".":
-                    source_key = stem
-                    category = "general"
-                else:
-                    source_key = str(parent_rel / stem)
-                    category = str(parent_rel).split("/")[0]
-
-                # Find corresponding files
-                base_dir = explain_file.parent
-
-                # Find the source file
-                source_code = ""
-                source_ext = ".c"
-                for ext in [".c", ".cc", ".cpp", ".cxx", ".C", ".h", ".hpp"]:
-                    src_file = base_dir / f"{stem}.src{ext}"
-                    if src_file.exists():
-                        source_code = src_file.read_text(encoding="utf-8", errors="replace")
-                        source_ext = ext
-                        break
-
-                # Read assembly
-                asm_file = base_dir / f"{stem}.asm"
-                assembly = asm_file.read_text(encoding="utf-8", errors="replace") if asm_file.exists() else ""
-
-                # Read explanation
-                explanation = explain_file.read_text(encoding="utf-8", errors="replace")
-
-                # Create or update SourceFile
-                if source_key not in sources:
-                    sources[source_key] = SourceFile(
-                        rel_path=source_key,
-                        category=category,
-                        name=stem,
-                        extension=source_ext,
-                    )
 
-                sources[source_key].outputs.append(SourceOutput(
-                    compiler_id=compiler_id,
-                    scenario=scenario_name,
-                    source_code=source_code,
-                    assembly=assembly,
-                    explanation=explanation,
-                    source_lang=detect_language(source_ext),
-                ))
+def index_outputs(sources: Dict[str, SourceFile]) -> Dict[Tuple[str, str], List[Tuple[SourceFile, SourceOutput]]]:
+    """
+    Group cells by (compiler, scenario) in one pass over all outputs, so each
+    compiler/scenario page set is built from its own list rather than by
+    scanning every source. Sources keep their collection order.
+    """
+    index: Dict[Tuple[str, str], List[Tuple[SourceFile, SourceOutput]]] = {}
+    for source in sources.values():
+        for output in source.outputs:
+            index.setdefault((output.compiler_id, output.scenario), []).append((source, output))
+    return index
 
-    return sources, compilers, scenarios_found
+
+# -----------------------------------------------------------------------------
+# Page rendering
+# -----------------------------------------------------------------------------
+
+@dataclass(frozen=True)
+class PageJob:
+    """Everything a render worker needs for one source page."""
+    page: Path
+    source: SourceFile        # without its outputs list, to keep jobs small
+    output: SourceOutput
+    scenario: ScenarioConfig
+    compiler: CompilerInfo
+    # (scenario name, cell_key) of every scenario of this source and compiler,
+    # for the code metrics table and the scenario diffs.
+    siblings: Tuple[Tuple[str, str], ...] = ()
+    # (compiler id, cell_key) of the other compilers with the same instruction
+    # set in this scenario, for the compiler diffs.
+    peers: Tuple[Tuple[str, str], ...] = ()
+    # cell_key of every cell of this source, to link shared explanations.
+    cell_keys: Tuple[str, ...] = ()
+
+
+# Per-process render state, set up by init_render_worker().
+_render_state: Dict[str, Any] = {}
+
+
+def make_environment(templates_dir: Path, bytecode_dir: Optional[Path] = None) -> Environment:
+    """
+    Jinja2 environment with the gallery's filters registered.
+
+    With *bytecode_dir*, compiled templates are kept there between runs (and
+    shared by the render workers), so each template is only parsed again
+    after it changes.
+    """
+    bytecode_cache = None
+    if bytecode_dir is not None:
+        bytecode_dir.mkdir(parents=True, exist_ok=True)
+        bytecode_cache = FileSystemBytecodeCache(str(bytecode_dir))
+    env = Environment(
+        loader=FileSystemLoader(templates_dir),
+        autoescape=select_autoescape(["html", "xml"]),
+        trim_blocks=True,
+        lstrip_blocks=True,
+        bytecode_cache=bytecode_cache,
+    )
+    env.filters["detect_arch"] = detect_arch
+    env.filters["describe_flags"] = describe_flags
+    env.filters["title_case"] = title_case
+    env.filters["normalize_headings"] = normalize_heading_levels
+    env.filters["md_inline"] = md_inline
+    return env
+
+
+def init_render_worker(
+    templates_dir: Path,
+    input_dir: Path,
+    bytecode_dir: Optional[Path] = None,
+    diff_dir: Optional[Path] = None,
+) -> None:
+    """Open the templates, the output reader and the diff cache once per render process."""
+    env = make_environment(templates_dir, bytecode_dir)
+    _render_state["template"] = env.get_template("source_page.md.j2")
+    _render_state["diff_template"] = env.get_template("diff_page.md.j2")
+    _render_state["outputs"] = open_outputs_for_reading(input_dir)
+    _render_state["diffs"] = DiffCache(diff_dir)
+    _render_state["sources"] = {}  # source texts by manifest digest, read once per process
+
+
+def _load_json(text: Optional[str]) -> Optional[Dict[str, Any]]:
+    if not text:
+        return None
+    try:
+        return json.loads(text)
+    except ValueError:
+        return None
+
+
+# Listings longer than this are written next to their page as <stem>.asm.txt
+# and fetched when the reader asks for them (gallery.js); the page keeps the
+# first ASM_PREVIEW_LINES.
+ASM_INLINE_LINES = 800
+ASM_PREVIEW_LINES = 40
+
+
+def asm_fragment_path(page: Path) -> Path:
+    return page.with_name(page.stem + ".asm.txt")
+
+
+def diff_page_path(page: Path) -> Path:
+    return page.with_name(f"{page.stem}.diff.md")
+
+
+def _function_bytes(metrics: Optional[Dict[str, Any]]) -> Dict[str, int]:
+    """Bytes per function of a ``.metrics.json`` record, when they are exact (else empty)."""
+    if not isinstance(metrics, dict) or not metrics.get("bytes_exact"):
+        return {}
+    return {f["name"]: f.get("bytes", 0) for f in metrics.get("functions", []) if isinstance(f, dict) and "name" in f}
+
+
+def _cell_diffs(
+    outputs: Any, assembly: str, isa: str, others: List[Tuple[str, str]], metrics: Optional[Dict[str, Any]] = None
+) -> List[Dict[str, Any]]:
+    """
+    Diffs from each (label, cell_key) in *others* to this cell's *assembly*.
+    Where both cells have exact byte sizes (binary output, see ce_metrics.py)
+    a changed function also carries its ``bytes`` on each side.
+    """
+    cache: DiffCache = _render_state["diffs"]
+    current = normalize_listing(assembly, isa)
+    current_bytes = _function_bytes(metrics)
+    diffs = []
+    for label, cell_key in others:
+        other_asm = outputs.read_text(f"{cell_key}.asm")
+        if other_asm is None:
+            continue
+        result = cache.diff(normalize_listing(other_asm, isa), current)
+        other_bytes = _function_bytes(_load_json(outputs.read_text(f"{cell_key}.metrics.json"))) if current_bytes else {}
+        functions = [
+            {
+                **{k: v for k, v in f.items() if k != "ops"},
+                "hunks": unified_hunks(f["ops"]),
+                "bytes": (other_bytes.get(f["name"], 0), current_bytes.get(f["name"], 0)) if other_bytes else None,
+            }
+            for f in result["functions"]
+            if f["status"] != "same"
+        ]
+        diffs.append({
+            "label": label,
+            "identical": result["identical"],
+            "unchanged": sum(1 for f in result["functions"] if f["status"] == "same"),
+            "functions": functions,
+        })
+    return diffs
+
+
+def _source_remarks(record: Optional[Dict[str, Any]], source_code: str) -> Optional[Dict[str, Any]]:
+    """A ``.remarks.json`` record shaped for the page: findings and notes per source line."""
+    if not isinstance(record, dict) or not isinstance(record.get("remarks"), list):
+        return None
+    lines = []
+    for group in group_by_line(record["remarks"], source_code):
+        lines.append({
+            "line": group["line"],
+            "code": group["code"],
+            "findings": [r for r in group["remarks"] if r["kind"] != "analysis"],
+            "notes": [r for r in group["remarks"] if r["kind"] == "analysis"],
+        })
+    return {
+        **record,
+        "lines": [g for g in lines if g["findings"]],
+        "notes": [g for g in lines if g["notes"]],
+        "hl_lines": " ".join(str(g["line"]) for g in lines if g["findings"]),
+    }
+
+
+def _constant_time(outputs: Any, cell_key: str, siblings: Sequence[Tuple[str, str]]) -> Optional[Dict[str, Any]]:
+    """The static check and timing test of a cell's ``constant-time`` functions, and verdicts per scenario."""
+    static = _load_json(outputs.read_text(f"{cell_key}{CONSTTIME_SUFFIX}"))
+    if not isinstance(static, dict) or not isinstance(static.get("functions"), list):
+        return None
+    timing = _load_json(outputs.read_text(f"{cell_key}{DUDECT_SUFFIX}"))
+    timed = {r["function"]: r for r in (timing or {}).get("results", [])}
+    rows = []
+    for f in static["functions"]:
+        t = timed.get(f["function"], {})
+        rows.append({
+            "function": f["function"],
+            "static": f.get("verdict"),
+            "findings": [
+                {**x, "instruction": " ".join(str(x.get("instruction", "")).split())} for x in f.get("findings", [])
+            ],
+            "t": t.get("t"),
+            "timing": t.get("verdict"),
+        })
+    by_scenario = []
+    for scenario_name, key in siblings:
+        records = [_load_json(outputs.read_text(f"{key}{suffix}")) for suffix in (CONSTTIME_SUFFIX, DUDECT_SUFFIX)]
+        if records[0]:
+            by_scenario.append({"scenario": scenario_name, "current": key == cell_key, "verdicts": summarize(records)})
+    return {
+        "rows": rows,
+        "functions": [r["function"] for r in rows],
+        "by_scenario": by_scenario,
+        "unsupported": static.get("supported") is False,
+        "instruction_set": static.get("instruction_set"),
+        "timing": timing if isinstance(timing, dict) else None,
+        "threshold": T_THRESHOLD,
+    }
+
+
+def _hardening_overhead(outputs: Any, cell_key: str, siblings: Sequence[Tuple[str, str]]) -> Optional[Dict[str, Any]]:
+    """Code size and time per call with and without a cell's hardening flags, in each scenario."""
+    record = _load_json(outputs.read_text(f"{cell_key}{OVERHEAD_SUFFIX}"))
+    if not isinstance(record, dict) or not isinstance(record.get("functions"), list):
+        return None
+    functions = [
+        {
+            **f,
+            "instructions_delta": f["instructions"] - f["baseline_instructions"],
+            "bytes_delta": f["bytes"] - f["baseline_bytes"],
+        }
+        for f in record["functions"]
+    ]
+    by_scenario = []
+    for scenario_name, key in siblings:
+        rec = record if key == cell_key else _load_json(outputs.read_text(f"{key}{OVERHEAD_SUFFIX}"))
+        if not isinstance(rec, dict) or not isinstance(rec.get("total"), dict):
+            continue
+        total = rec["total"]
+        bench = _load_json(outputs.read_text(f"{key}.bench.json"))
+        by_scenario.append({
+            "scenario": scenario_name,
+            "current": key == cell_key,
+            "flags": rec.get("flags"),
+            "baseline_flags": rec.get("baseline_flags"),
+            "instructions": total["instructions"],
+            "baseline_instructions": total["baseline_instructions"],
+            "instructions_delta": total["instructions"] - total["baseline_instructions"],
+            "instructions_pct": percent(total["instructions"], total["baseline_instructions"]),
+            "bytes": total["bytes"],
+            "baseline_bytes": total["baseline_bytes"],
+            "bytes_delta": total["bytes"] - total["baseline_bytes"],
+            "bytes_pct": percent(total["bytes"], total["baseline_bytes"]),
+            "timing": timing_rows(bench),
+        })
+    bench = _load_json(outputs.read_text(f"{cell_key}.bench.json"))
+    baseline_run = bench.get("overhead") if isinstance(bench, dict) else None
+    return {
+        "flags": record.get("flags"),
+        "baseline_flags": record.get("baseline_flags"),
+        "bytes_exact": record.get("bytes_exact"),
+        "functions": functions,
+        "by_scenario": by_scenario,
+        "timed": any(s["timing"] for s in by_scenario),
+        "benchmarked": isinstance(bench, dict),
+        "error": (bench.get("error") or (baseline_run or {}).get("error")) if isinstance(bench, dict) else None,
+    }
+
+
+def _throughput(outputs: Any, cell_key: str, siblings: Sequence[Tuple[str, str]]) -> Optional[Dict[str, Any]]:
+    """A cell's llvm-mca estimates, one row per (function, CPU), and cycles per iteration in each scenario."""
+    record = _load_json(outputs.read_text(f"{cell_key}{MCA_SUFFIX}"))
+    if not isinstance(record, dict) or not isinstance(record.get("functions"), list):
+        return None
+    rows = []
+    for f in record["functions"]:
+        base = {"function": f["function"], "scope": f.get("scope"), "instructions": f.get("instructions")}
+        rows.extend({**base, **e} for e in f.get("estimates") or [{}])
+    by_scenario = []
+    for scenario_name, key in siblings:
+        rec = record if key == cell_key else _load_json(outputs.read_text(f"{key}{MCA_SUFFIX}"))
+        if not isinstance(rec, dict):
+            continue
+        cycles = {}
+        for f in rec.get("functions", []):
+            values = [e.get("cycles_per_iteration") for e in f.get("estimates") or []]
+            if values and any(v is not None for v in values):
+                cycles[f["function"]] = " / ".join("-" if v is None else f"{v:.2f}" for v in values)
+        if cycles:
+            by_scenario.append({"scenario": scenario_name, "current": key == cell_key, "cycles": cycles})
+    return {
+        "tool": record.get("tool"),
+        "iterations": record.get("iterations"),
+        "cpus": record.get("cpus") or [],
+        "instruction_set": record.get("instruction_set"),
+        "rows": rows,
+        "functions": [f["function"] for f in record["functions"]],
+        "by_scenario": by_scenario,
+        "unsupported": record.get("supported") is False,
+        "error": record.get("error"),
+    }
+
+
+def _companion_files(outputs: Any, cell_key: str) -> List[Dict[str, str]]:
+    """The other translation units a multi-file example was linked with (``<stem>.files.json``)."""
+    record = _load_json(outputs.read_text(f"{cell_key}.files.json"))
+    if not isinstance(record, dict):
+        return []
+    return [
+        {"filename": f["filename"], "contents": f.get("contents", "")}
+        for f in record.get("files", []) if isinstance(f, dict) and isinstance(f.get("filename"), str)
+    ]
+
+
+def _profile_guided(outputs: Any, cell_key: str, siblings: Sequence[Tuple[str, str]]) -> Optional[Dict[str, Any]]:
+    """A PGO cell's training run, and its code size and times against the scenario with the same flags and no profile."""
+    record = _load_json(outputs.read_text(f"{cell_key}{PGO_SUFFIX}"))
+    if not isinstance(record, dict):
+        return None
+    base_key = next((key for name, key in siblings if name == record.get("baseline")), None)
+    functions: List[Dict[str, Any]] = []
+    timing: List[Dict[str, Any]] = []
+    if base_key is not None:
+        metrics = _load_json(outputs.read_text(f"{cell_key}.metrics.json")) or {}
+        base_metrics = _load_json(outputs.read_text(f"{base_key}.metrics.json")) or {}
+        pgo_fns = {f["name"]: f for f in metrics.get("functions", []) if isinstance(f, dict) and "name" in f}
+        base_fns = {f["name"]: f for f in base_metrics.get("functions", []) if isinstance(f, dict) and "name" in f}
+        for name in list(pgo_fns) + [n for n in base_fns if n not in pgo_fns]:
+            f, b = pgo_fns.get(name, {}), base_fns.get(name, {})
+            functions.append({
+                "function": name,
+                **{k: f.get(k, 0) for k in ("instructions", "bytes", "branches", "calls")},
+                **{f"baseline_{k}": b.get(k, 0) for k in ("instructions", "bytes", "branches", "calls")},
+            })
+        bench = _load_json(outputs.read_text(f"{cell_key}.bench.json")) or {}
+        base_bench = _load_json(outputs.read_text(f"{base_key}.bench.json")) or {}
+        base_runs = {(r.get("function"), r.get("n")): r for r in base_bench.get("results", [])}
+        for r in bench.get("results", []):
+            b = base_runs.get((r.get("function"), r.get("n")))
+            if b is None or r.get("ns_per_op") is None or b.get("ns_per_op") is None:
+                continue
+            timing.append({
+                "function": r["function"],
+                "n": r["n"],
+                "ns": r["ns_per_op"],
+                "baseline_ns": b["ns_per_op"],
+                "change_pct": percent(r["ns_per_op"], b["ns_per_op"]),
+            })
+    return {**record, "functions": functions, "timing": timing, "seconds": record.get("seconds")}
+
+
+_CHART_COLORS = ("#00693e", "#c90016", "#267aba", "#ffa00f", "#8a6996", "#643c20")
+
+
+def _svg_line_chart(series: List[Tuple[str, List[Tuple[int, float]]]], y_label: str, x_label: str = "n") -> str:
+    """
+    A small inline SVG line chart: *x_label* on a log2 x axis, one line per series.
+    Kept on one line so Markdown passes it through as raw HTML.
+    """
+    width, height, left, right, top, bottom = 560, 220, 64, 150, 12, 36
+    xs = sorted({n for _, points in series for n, _ in points})
+    y_max = max(v for _, points in series for _, v in points) or 1.0
+    lo = math.log2(max(1, xs[0]))
+    hi = max(math.log2(max(1, xs[-1])), lo + 1)
+
+    def px(n: int) -> float:
+        return left + (math.log2(max(1, n)) - lo) / (hi - lo) * (width - left - right)
+
+    def py(v: float) -> float:
+        return top + (1 - v / y_max) * (height - top - bottom)
+
+    parts = [
+        f'<svg class="bench-chart" viewBox="0 0 {width} {height}" width="{width}" height="{height}" '
+        f'role="img" aria-label="{y_label} by {x_label}" font-size="11" fill="currentColor">',
+        f'<line x1="{left}" y1="{py(0):.1f}" x2="{width - right}" y2="{py(0):.1f}" stroke="currentColor" stroke-opacity="0.5"/>',
+        f'<line x1="{left}" y1="{top}" x2="{left}" y2="{py(0):.1f}" stroke="currentColor" stroke-opacity="0.5"/>',
+    ]
+    for frac in (0.0, 0.5, 1.0):
+        v = y_max * frac
+        parts.append(f'<text x="{left - 6}" y="{py(v) + 4:.1f}" text-anchor="end">{v:.3g}</text>')
+    for n in xs:
+        label = f"{n / 1048576:.3g}M" if n >= 1048576 else f"{n / 1024:.3g}K" if n >= 1024 else str(n)
+        parts.append(f'<text x="{px(n):.1f}" y="{height - bottom + 16}" text-anchor="middle">{label}</text>')
+    parts.append(f'<text x="{(left + width - right) / 2:.0f}" y="{height - 4}" text-anchor="middle">{x_label}</text>')
+    parts.append(f'<text x="12" y="{(top + height - bottom) / 2:.0f}" text-anchor="middle" transform="rotate(-90 12 {(top + height - bottom) / 2:.0f})">{y_label}</text>')
+    for i, (name, points) in enumerate(series):
+        color = _CHART_COLORS[i % len(_CHART_COLORS)]
+        coords = " ".join(f"{px(n):.1f},{py(v):.1f}" for n, v in points)
+        parts.append(f'<polyline points="{coords}" fill="none" stroke="{color}" stroke-width="2"/>')
+        parts.extend(f'<circle cx="{px(n):.1f}" cy="{py(v):.1f}" r="3" fill="{color}"><title>{name} n={n}: {v:.4g}</title></circle>' for n, v in points)
+        legend_y = top + 14 * i + 8
+        parts.append(f'<rect x="{width - right + 12}" y="{legend_y - 8}" width="10" height="10" fill="{color}"/>')
+        parts.append(f'<text x="{width - right + 26}" y="{legend_y + 1}">{name.replace("&", "&amp;").replace("<", "&lt;")}</text>')
+    parts.append("</svg>")
+    return "".join(parts)
+
+
+def _bench_charts(bench: Optional[Dict[str, Any]]) -> List[Dict[str, str]]:
+    """Per-element cost against n, for benchmarks run at two sizes or more."""
+    if not isinstance(bench, dict) or not bench.get("results"):
+        return []
+    metrics = [("ns/element", lambda r: r.get("ns_per_element"))]
+    for key, label in (("l1d_misses", "L1D misses/element"), ("llc_misses", "LLC misses/element")):
+        metrics.append((label, lambda r, key=key: (r.get("counters_per_element") or {}).get(key)))
+    charts = []
+    for label, value in metrics:
+        by_function: Dict[str, List[Tuple[int, float]]] = {}
+        for r in bench["results"]:
+            v = value(r)
+            if isinstance(v, (int, float)):
+                by_function.setdefault(r["function"], []).append((int(r["n"]), float(v)))
+        series = [(name, sorted(points)) for name, points in by_function.items() if len(points) > 1]
+        if series:
+            charts.append({"title": label, "svg": _svg_line_chart(series, label)})
+    return charts
+
+
+def _bench_comparison(outputs: Any, cell_key: str, bench: Optional[Dict[str, Any]]) -> Optional[Dict[str, Any]]:
+    """
+    A cell's benchmarks against its ``bench-baseline`` source's, on the same
+    compiler and scenario: ``sum_array_simd`` here against ``sum_array`` there.
+    """
+    baseline = bench.get("baseline") if isinstance(bench, dict) else None
+    if not isinstance(baseline, str) or not bench.get("results"):
+        return None
+    compiler_id, scenario_name = cell_key.split("/")[:2]
+    other = _load_json(outputs.read_text(f"{compiler_id}/{scenario_name}/{baseline}.bench.json")) or {}
+    category = source_category(baseline)
+    rows = []
+    for r in bench["results"]:
+        matches = [
+            b for b in other.get("results", [])
+            if b["n"] == r["n"] and r["function"].startswith(b["function"] + "_")
+        ]
+        if not matches or not r["ns_per_op"]:
+            continue
+        b = max(matches, key=lambda m: len(m["function"]))
+        rows.append({
+            "function": r["function"], "baseline": b["function"], "n": r["n"],
+            "ns_per_op": r["ns_per_op"], "baseline_ns_per_op": b["ns_per_op"],
+            "speedup": b["ns_per_op"] / r["ns_per_op"],
+        })
+    return {"source": baseline, "link": f"../{category}/{Path(baseline).name}.md", "rows": rows}
+
+
+def _bench_inputs(outputs: Any, cell_key: str, siblings: Sequence[Tuple[str, str]]) -> Optional[Dict[str, Any]]:
+    """
+    Benchmarks run on several input patterns (stream arguments, see
+    ce_bench.py), side by side: ns and branch misses per call, per scenario.
+    """
+    patterns: List[str] = []
+    rows = []
+    for scenario_name, key in siblings:
+        bench = _load_json(outputs.read_text(f"{key}.bench.json"))
+        by_function: Dict[Tuple[str, int], Dict[str, Any]] = {}
+        for r in (bench or {}).get("results", []):
+            pattern = r.get("input")
+            if not pattern or not r["function"].endswith("/" + pattern):
+                continue
+            if pattern not in patterns:
+                patterns.append(pattern)
+            row = by_function.setdefault((r["function"][: -len(pattern) - 1], r["n"]), {
+                "scenario": scenario_name, "current": key == cell_key,
+                "function": r["function"][: -len(pattern) - 1], "n": r["n"], "inputs": {},
+            })
+            row["inputs"][pattern] = {
+                "ns": r.get("ns_per_element"),
+                "branch_misses": (r.get("counters_per_element") or {}).get("branch_misses"),
+            }
+        rows.extend(by_function.values())
+    if not rows:
+        return None
+    return {
+        "patterns": patterns,
+        "rows": rows,
+        "misses": any(v["branch_misses"] is not None for r in rows for v in r["inputs"].values()),
+    }
+
+
+def _size_value(text: str) -> float:
+    return float(text) if text.isdigit() else float("inf")
+
+
+def _scaling(outputs: Any, variant_keys: List[str]) -> Optional[Dict[str, Any]]:
+    """A cell's sweep-defines variants: metrics and timings per variant, and charts against size."""
+    rows = []
+    for key in variant_keys:
+        m = _load_json(outputs.read_text(f"{key}.metrics.json"))
+        if not m or not isinstance(m.get("defines"), dict):
+            continue
+        bench = _load_json(outputs.read_text(f"{key}.bench.json"))
+        rows.append({
+            "name": key.rpartition("@")[2],
+            "defines": m["defines"],
+            "working_set": m.get("working_set_bytes"),
+            "total": m.get("total", {}),
+            "results": bench.get("results", []) if bench and bench.get("ok") else [],
+        })
+    if not rows:
+        return None
+    rows.sort(key=lambda r: ([_size_value(v) for v in r["defines"].values()], r["name"]))
+    by_working_set = all(isinstance(r["working_set"], int) and r["working_set"] > 0 for r in rows)
+    first_define = next(iter(rows[0]["defines"]))
+    charts = []
+    for label, value in (
+        ("ns/element", lambda res: res.get("ns_per_element")),
+        ("L1D misses/element", lambda res: (res.get("counters_per_element") or {}).get("l1d_misses")),
+        ("LLC misses/element", lambda res: (res.get("counters_per_element") or {}).get("llc_misses")),
+    ):
+        by_function: Dict[str, List[Tuple[int, float]]] = {}
+        for row in rows:
+            x = row["working_set"] if by_working_set else row["defines"].get(first_define, "")
+            if not isinstance(x, int) and not str(x).isdigit():
+                continue
+            # A variant benchmarked at several sizes gets one line per (function, n).
+            several_n = len(row["results"]) > len({res["function"] for res in row["results"]})
+            for res in row["results"]:
+                v = value(res)
+                if isinstance(v, (int, float)):
+                    name = f'{res["function"]} n={res["n"]}' if several_n else res["function"]
+                    by_function.setdefault(name, []).append((int(x), float(v)))
+        series = [(name, sorted(points)) for name, points in by_function.items() if len(points) > 1]
+        if series:
+            x_label = "working set (bytes)" if by_working_set else first_define
+            charts.append({"title": f"{label} by {x_label}", "svg": _svg_line_chart(series, label, x_label)})
+    return {"rows": rows, "charts": charts, "by_working_set": by_working_set}
+
+
+def _source_text(outputs: Any, out: SourceOutput) -> str:
+    """A cell's source copy; cells with the same manifest digest share one read."""
+    texts: Dict[str, str] = _render_state["sources"]
+    if out.source_digest is not None and out.source_digest in texts:
+        return texts[out.source_digest]
+    text = outputs.read_text(f"{out.cell_key}.src{out.source_ext}") or ""
+    if out.source_digest is not None:
+        texts[out.source_digest] = text
+    return text
+
+
+def render_source_page(job: PageJob) -> Tuple[float, float, float]:
+    """
+    Load one cell's texts, render its page (and its diff page, if it has
+    siblings or peers to compare with) and write them. Returns (load,
+    render, write) seconds.
+    """
+    outputs = _render_state["outputs"]
+    out = job.output
+    t0 = time.perf_counter()
+    source_code = _source_text(outputs, out)
+    assembly = outputs.read_text(f"{out.cell_key}.asm") or ""
+    explanation = outputs.read_text(f"{out.cell_key}.explain.md") or ""
+    bench = _load_json(outputs.read_text(f"{out.cell_key}.bench.json"))
+    metrics_by_scenario = []
+    for scenario_name, cell_key in job.siblings:
+        m = _load_json(outputs.read_text(f"{cell_key}.metrics.json"))
+        if m:
+            metrics_by_scenario.append({"scenario": scenario_name, "current": cell_key == out.cell_key, **m})
+    metrics = next((m for m in metrics_by_scenario if m["current"]), None)
+    remarks = _source_remarks(_load_json(outputs.read_text(f"{out.cell_key}{REMARKS_SUFFIX}")), source_code)
+    isa = detect_instruction_set(out.compiler_id)
+    scenario_diffs = _cell_diffs(
+        outputs, assembly, isa, [(name, key) for name, key in job.siblings if key != out.cell_key], metrics
+    )
+    compiler_diffs = _cell_diffs(outputs, assembly, isa, list(job.peers), metrics)
+    diff_page = diff_page_path(job.page)
+    reused_from = None
+    explain_response = _load_json(outputs.read_text(f"{out.cell_key}.explain.response.json"))
+    leader = explain_response.get("reusedFrom") if isinstance(explain_response, dict) else None
+    if isinstance(leader, str) and leader.count("/") >= 2:
+        compiler_id, scenario_name, rel = leader.split("/", 2)
+        category = source_category(rel)
+        reused_from = {
+            "compiler": compiler_id,
+            "scenario": scenario_name,
+            "link": (
+                f"../../../{scenario_name}/{compiler_id}/{category}/{Path(rel).name}.md"
+                if leader in job.cell_keys else None
+            ),
+        }
+    # Long listings are fetched on demand instead of being part of the page.
+    asm_lines = assembly.splitlines()
+    fragment_text, assembly_fragment = None, None
+    if len(asm_lines) > ASM_INLINE_LINES:
+        fragment_text = assembly if assembly.endswith("\n") else assembly + "\n"
+        assembly_fragment = {
+            "href": asm_fragment_path(job.page).name,
+            "lines": len(asm_lines),
+            "preview": ASM_PREVIEW_LINES,
+            "kib": max(1, round(len(fragment_text.encode("utf-8")) / 1024)),
+        }
+        assembly = "\n".join(asm_lines[:ASM_PREVIEW_LINES])
+    t1 = time.perf_counter()
+    content = _render_state["template"].render(
+        source=job.source,
+        source_code=source_code,
+        source_lang=out.source_lang,
+        companion_files=_companion_files(outputs, out.cell_key),
+        assembly=assembly,
+        assembly_fragment=assembly_fragment,
+        explanation=explanation,
+        bench=bench,
+        bench_charts=_bench_charts(bench),
+        bench_comparison=_bench_comparison(outputs, out.cell_key, bench),
+        bench_inputs=_bench_inputs(outputs, out.cell_key, job.siblings),
+        scaling=_scaling(outputs, out.variants),
+        constant_time=_constant_time(outputs, out.cell_key, job.siblings),
+        overhead=_hardening_overhead(outputs, out.cell_key, job.siblings),
+        throughput=_throughput(outputs, out.cell_key, job.siblings),
+        pgo=_profile_guided(outputs, out.cell_key, job.siblings),
+        metrics=metrics,
+        metrics_by_scenario=metrics_by_scenario,
+        remarks=remarks,
+        diff_page=diff_page.name if scenario_diffs or compiler_diffs else None,
+        reused_from=reused_from,
+        x86=isa in ("amd64", "x86"),
+        scenario=job.scenario,
+        compiler=job.compiler,
+    )
+    diff_content = None
+    fragment = asm_fragment_path(job.page)
+    if fragment_text is not None:
+        fragment.parent.mkdir(parents=True, exist_ok=True)
+        write_if_changed(fragment, fragment_text)
+    elif fragment.exists():
+        fragment.unlink()
+    if scenario_diffs or compiler_diffs:
+        diff_content = _render_state["diff_template"].render(
+            source=job.source,
+            scenario=job.scenario,
+            compiler=job.compiler,
+            scenario_diffs=scenario_diffs,
+            compiler_diffs=compiler_diffs,
+        )
+    t2 = time.perf_counter()
+    job.page.parent.mkdir(parents=True, exist_ok=True)
+    job.page.write_text(content, encoding="utf-8")
+    if diff_content is not None:
+        diff_page.write_text(diff_content, encoding="utf-8")
+    elif diff_page.exists():
+        diff_page.unlink()
+    return t1 - t0, t2 - t1, time.perf_counter() - t2
 
 
 # -----------------------------------------------------------------------------
 # Template management
 # -----------------------------------------------------------------------------
 
+DEFAULT_TEMPLATE_NAMES = (
+    "index.md.j2",
+    "compilers.md.j2",
+    "scenario_index.md.j2",
+    "compiler_index.md.j2",
+    "source_page.md.j2",
+    "diff_page.md.j2",
+    "sweep_page.md.j2",
+    "compile_time.md.j2",
+    "regressions.md.j2",
+)
+
+
 def ensure_templates(templates_dir: Path) -> None:
     """Create default templates if they don't exist."""
+    # One directory listing answers the common case: everything is there and
+    # nothing needs to be written.
+    try:
+        present = {entry.name for entry in os.scandir(templates_dir)}
+    except FileNotFoundError:
+        present = set()
+    if present.issuperset(DEFAULT_TEMPLATE_NAMES):
+        return
     templates_dir.mkdir(parents=True, exist_ok=True)
 
     # Main index template
@@ -447,22 +1335,516 @@ This documentation is auto-generated from Compiler Explorer outputs with AI-powe
 
 ## Source Code
 
-```{{ source_lang }} title="{{ source.name }}{{ source.extension }}"
+```{{ source_lang }} title="{{ source.name }}{{ source.extension }}"{% if remarks %} linenums="1"{% if remarks.hl_lines %} hl_lines="{{ remarks.hl_lines }}"{% endif %}{% endif %}
+
 {{ source_code }}
 ```
+{% if companion_files %}
+
+Linked with {% for f in companion_files %}`{{ f.filename }}`{% if not loop.last %}, {% endif %}{% endfor %}; the assembly below is the `.text` of the linked program.
+{% for f in companion_files %}
+
+```{{ source_lang }} title="{{ f.filename }}"
+
+{{ f.contents }}
+```
+{% endfor %}
+{% endif %}
+{% if remarks %}
+
+## Optimization Remarks
+
+{% if remarks.lines %}
+What the {{ remarks.family }} vectorizer and loop optimizer reported for this source (highlighted lines above).
+
+| Line | Code | Remarks |
+|------|------|---------|
+{% for g in remarks.lines %}
+| {{ g.line }} | `{{ g.code }}` | {% for r in g.findings %}**{{ r.kind }}**: {{ r.message | md_inline }}{{ "<br>" if not loop.last }}{% endfor %} |
+{% endfor %}
+{% else %}
+The {{ remarks.family }} vectorizer and loop optimizer reported nothing for this source.
+{% endif %}
+{% if remarks.notes %}
+
+??? note "Analysis notes"
+{% for g in remarks.notes %}
+    - Line {{ g.line }}: {% for r in g.notes %}{{ r.message | md_inline }}{{ "; " if not loop.last }}{% endfor %}
+
+{% endfor %}
+{% endif %}
+
+Captured with `{{ remarks.flags }}`.
+{% endif %}
 
 ## Assembly Output
 
 ```asm title="{{ source.name }}.asm" linenums="1"
 {{ assembly }}
 ```
+{% if assembly_fragment %}
+
+The first {{ assembly_fragment.preview }} of {{ assembly_fragment.lines }} lines. [Show all {{ assembly_fragment.lines }} lines ({{ assembly_fragment.kib }} KiB)]({{ assembly_fragment.href }}){ .asm-fragment }
+{% endif %}
+{% if diff_page %}
+
+[Compare with other scenarios and compilers]({{ diff_page }})
+{% endif %}
+{% if metrics and metrics.functions %}
+
+## Code Metrics
+
+{% if metrics_by_scenario | length > 1 %}
+| Scenario | Instructions | Bytes | Branches | Memory ops | Calls | SIMD |
+|----------|--------------|-------|----------|------------|-------|------|
+{% for m in metrics_by_scenario %}
+| {{ "**%s**" | format(m.scenario) if m.current else m.scenario }} | {{ m.total.instructions }} | {{ "" if m.bytes_exact else "~" }}{{ m.total.bytes }} | {{ m.total.branches }} | {{ m.total.memory_ops }} | {{ m.total.calls }} | {{ m.total.simd or "-" }} |
+{% endfor %}
+
+{% endif %}
+| Function | Instructions | Bytes | Branches | Memory ops | Calls | SIMD |
+|----------|--------------|-------|----------|------------|-------|------|
+{% for f in metrics.functions %}
+| `{{ f.name }}` | {{ f.instructions }} | {{ "" if metrics.bytes_exact else "~" }}{{ f.bytes }}{{ " (+%d padding)" | format(f.padding) if f.padding else "" }} | {{ f.branches }} | {{ f.memory_ops }} | {{ f.calls }} | {{ f.simd or "-" }} |
+{% endfor %}
+
+{% if not metrics.bytes_exact %}
+Byte sizes marked ~ are estimated from the assembly text.
+{% elif metrics.total.padding %}
+Sizes are from the disassembled object; padding is the alignment nops after each function's code.
+{% endif %}
+{% endif %}
+{% if throughput %}
+
+## Throughput Estimates
+
+Static estimates from {{ throughput.tool or "llvm-mca" }}, without running anything: the innermost loop of each function (the whole function if it has no loop) is simulated for {{ throughput.iterations }} iterations on each CPU model. Cycles per iteration are the steady state; the reciprocal throughput is the bound from execution port pressure alone, so more cycles than that means a dependency chain sets the pace.
+
+| Function | Region | CPU | Cycles/iter | RThroughput | IPC | Bottleneck |
+|----------|--------|-----|-------------|-------------|-----|------------|
+{% for r in throughput.rows %}
+| `{{ r.function }}` | {{ r.scope }}{% if r.instructions %} ({{ r.instructions }} insns){% endif %} | {{ r.cpu or "-" }} | {% if r.error %}{{ r.error | truncate(80) | md_inline }}{% else %}{{ "%.2f" | format(r.cycles_per_iteration) if r.cycles_per_iteration is not none else "-" }}{% endif %} | {{ "%.2f" | format(r.block_rthroughput) if r.block_rthroughput is not none else "-" }} | {{ "%.2f" | format(r.ipc) if r.ipc is not none else "-" }} | {{ r.bottleneck or "-" }} |
+{% endfor %}
+{% if throughput.by_scenario | length > 1 %}
+
+Cycles per iteration in every scenario of this compiler ({{ throughput.cpus | join(" / ") }}):
+
+| Scenario |{% for f in throughput.functions %} `{{ f }}` |{% endfor %}
+
+|----------|{% for f in throughput.functions %}------|{% endfor %}
+
+{% for s in throughput.by_scenario %}
+| {{ "**%s**" | format(s.scenario) if s.current else s.scenario }} |{% for f in throughput.functions %} {{ s.cycles.get(f, "-") }} |{% endfor %}
+
+{% endfor %}
+{% endif %}
+{% if throughput.unsupported %}
+
+!!! note "Throughput estimates"
+    LLVM has no scheduling model for {{ throughput.instruction_set }}, so there are no estimates for this compiler.
+{% elif throughput.error %}
+
+!!! note "Throughput estimates"
+    No estimates: {{ throughput.error | md_inline }}. Install LLVM where `ce_batch.py` runs to add them.
+{% endif %}
+{% endif %}
+{% if pgo %}
+
+## Profile-Guided Optimization
+{% if not pgo.error %}
+
+This cell is built with `{{ pgo.use_flags }}`: the benchmark driver was first built with `{{ pgo.training_flags }}` and run {% if pgo.workload.sizes %}at n = {{ pgo.workload.sizes | join(", ") }}{% else %}at the default sizes{% endif %}{% if pgo.workload.inputs %} on {{ pgo.workload.inputs | join(", ") }} inputs{% endif %}, and the compiler read back the profile it wrote{% if pgo.profile %} ({{ pgo.profile.bytes }} bytes{% if pgo.seconds is not none %}, {{ "%.1f" | format(pgo.seconds) }} s of training{% endif %}){% endif %}. With a profile the compiler knows which branches are taken and how often loops run: hot paths become the fall-through, cold code moves out of line, and inlining and unrolling go where the time is spent.
+{% if pgo.baseline and pgo.functions %}
+
+Compared with {{ pgo.baseline }}, the same flags without a profile (baseline → profile-guided):
+
+| Function | Instructions | Bytes | Branches | Calls |
+|----------|--------------|-------|----------|-------|
+{% for f in pgo.functions %}
+| `{{ f.function }}` | {{ f.baseline_instructions }} → {{ f.instructions }} | {{ f.baseline_bytes }} → {{ f.bytes }} | {{ f.baseline_branches }} → {{ f.branches }} | {{ f.baseline_calls }} → {{ f.calls }} |
+{% endfor %}
+{% if pgo.timing %}
+
+| Function | n | ns/op | Change |
+|----------|---|-------|--------|
+{% for t in pgo.timing %}
+| `{{ t.function }}` | {{ t.n }} | {{ "%.2f" | format(t.baseline_ns) }} → {{ "%.2f" | format(t.ns) }} | {{ "%+.1f%%" | format(t.change_pct) if t.change_pct is not none else "-" }} |
+{% endfor %}
+{% endif %}
+{% endif %}
+{% else %}
+
+!!! warning "No profile"
+    Training failed, so this assembly is built without a profile: {{ pgo.error | replace("\\n", " ") | truncate(300) | md_inline }}
+{% endif %}
+{% endif %}
+{% if bench and bench.results %}
+
+## Benchmark
+
+Median of {{ bench.results[0].samples }} samples, built with `{{ bench.flags }}` and run {{ "locally" if bench.runner == "local" else "on Compiler Explorer" }}.
+{{ "Other cells were compiling on the same machine during the run" if bench.runner == "local" else "Compiler Explorer runs it on shared machines" }}, so treat differences within the CV as noise.
+{% if x86 %}
+Cycles are x86 TSC ticks, which track core cycles at base clock.
+{% endif %}
+
+| Function | n | ns/op | ns/element | cycles/element | CV |
+|----------|---|-------|------------|----------------|----|
+{% for r in bench.results %}
+| `{{ r.function }}` | {{ r.n }} | {{ "%.1f" | format(r.ns_per_op) }} | {{ "%.3f" | format(r.ns_per_element) }} | {{ "%.2f" | format(r.cycles_per_element) if r.cycles_per_element else "-" }} | {{ "%.1f%%" | format(r.cv * 100) }} |
+{% endfor %}
+{% if bench.counters %}
+{% if bench.counters.opened %}
+
+Hardware counters, median per call:
+
+| Function | n | cycles | instructions | IPC | L1D misses | LLC misses | branch misses |
+|----------|---|--------|--------------|-----|------------|------------|---------------|
+{% for r in bench.results if r.counters %}
+| `{{ r.function }}` | {{ r.n }} | {% for key in ["cycles", "instructions", "ipc", "l1d_misses", "llc_misses", "branch_misses"] %}{{ ("%.2f" if key == "ipc" else "%.0f") | format(r.counters[key]) if r.counters[key] is not none else "-" }} |{% if not loop.last %} {% endif %}{% endfor %}
+
+{% endfor %}
+{% endif %}
+{% if bench.counters.error %}
+
+!!! note "Hardware counters"
+    {{ bench.counters.opened }} of {{ bench.counters.of }} counters were available: {{ bench.counters.error }}.
+{% endif %}
+{% endif %}
+{% if bench_comparison and bench_comparison.rows %}
+
+Against the compiler's own code in [{{ bench_comparison.source }}]({{ bench_comparison.link }}), built with the same compiler and flags (a speedup above 1 means this version is faster):
+
+| Function | Baseline | n | ns/op | baseline ns/op | speedup |
+|----------|----------|---|-------|----------------|---------|
+{% for row in bench_comparison.rows %}
+| `{{ row.function }}` | `{{ row.baseline }}` | {{ row.n }} | {{ "%.1f" | format(row.ns_per_op) }} | {{ "%.1f" | format(row.baseline_ns_per_op) }} | {{ "%.2fx" | format(row.speedup) }} |
+{% endfor %}
+{% endif %}
+{% if bench_inputs %}
+
+Time per call on each input pattern, in every scenario of this compiler{{ ", with branch misses per call" if bench_inputs.misses }}. A branch costs little on sorted input, where it is predicted, and a misprediction per call on random input; branchless code (cmov, a lookup table) costs the same on all of them.
+
+| Scenario | Function | n |{% for p in bench_inputs.patterns %} {{ p }} |{% endfor %}
+
+|----------|----------|---|{% for p in bench_inputs.patterns %}------|{% endfor %}
+
+{% for row in bench_inputs.rows %}
+| {{ "**%s**" | format(row.scenario) if row.current else row.scenario }} | `{{ row.function }}` | {{ row.n }} |{% for p in bench_inputs.patterns %}{% set v = row.inputs.get(p) %} {% if v and v.ns is not none %}{{ "%.2f ns" | format(v.ns) }}{% if v.branch_misses is not none %}, {{ "%.2f" | format(v.branch_misses) }} misses{% endif %}{% else %}-{% endif %} |{% endfor %}
+
+{% endfor %}
+{% endif %}
+{% for chart in bench_charts %}
+
+**{{ chart.title }}**
+
+<div class="bench-chart">{{ chart.svg }}</div>
+{% endfor %}
+{% endif %}
+{% if constant_time %}
+
+## Constant-Time Check
+
+The functions this source marks as constant time. The static check follows the secret data (the array arguments) through the assembly and flags branches, early exits, memory indexing and divisions that depend on it, and calls to functions that return early. {% if constant_time.timing and constant_time.timing.ok %}The timing test calls each function with a fixed or a random secret ({{ constant_time.timing.results[0].measurements }} calls, n = {{ constant_time.timing.size }}, {{ "TSC" if constant_time.timing.timer == "tsc" else "clock" }} timer). A Welch t of {{ constant_time.threshold }} or more (either sign) means the running time depends on the secret.{% else %}Run `ce_batch.py --bench` to add the timing test.{% endif %}
+
+| Function | Static check | Findings | Welch t | Timing test |
+|----------|--------------|----------|---------|-------------|
+{% for row in constant_time.rows %}
+| `{{ row.function }}` | {{ row.static }} | {% for f in row.findings %}{{ f.kind }}: `{{ f.instruction }}`{{ "<br>" if not loop.last }}{% else %}-{% endfor %} | {{ "%.1f" | format(row.t) if row.t is not none else "-" }} | {{ row.timing or "-" }} |
+{% endfor %}
+{% if constant_time.by_scenario | length > 1 %}
+
+Verdicts in every scenario of this compiler (fail: the static check or the timing test failed):
+
+| Scenario |{% for f in constant_time.functions %} `{{ f }}` |{% endfor %}
+
+|----------|{% for f in constant_time.functions %}------|{% endfor %}
+
+{% for s in constant_time.by_scenario %}
+| {{ "**%s**" | format(s.scenario) if s.current else s.scenario }} |{% for f in constant_time.functions %} {{ s.verdicts.get(f, "-") }} |{% endfor %}
+
+{% endfor %}
+{% endif %}
+{% if constant_time.unsupported %}
+
+!!! note "Static check"
+    The static check does not model {{ constant_time.instruction_set }} assembly; only x86-64, AArch64 and ARM32 are checked.
+{% endif %}
+{% if constant_time.timing and not constant_time.timing.ok %}
+
+!!! warning "Timing test"
+    The timing test did not run: {{ constant_time.timing.error | replace("\\n", " ") | truncate(300) | md_inline }}
+{% endif %}
+{% endif %}
+{% if overhead %}
+
+## Hardening Overhead
+
+What the hardening flags cost: this cell is built with `{{ overhead.flags }}` and compared with the same source built with `{{ overhead.baseline_flags }}`. {% if overhead.timed %}Times are per call, the median of the benchmark samples{% if x86 %}; ticks are x86 TSC ticks, close to cycles at base clock{% endif %}.{% elif not overhead.benchmarked %}Run `ce_batch.py --bench` to time the functions with and without the flags.{% endif %}
+
+| Function | Instructions | Change | Bytes | Change |
+|----------|--------------|--------|-------|--------|
+{% for f in overhead.functions %}
+| `{{ f.function }}` | {{ f.baseline_instructions }} → {{ f.instructions }} | {{ "%+d" | format(f.instructions_delta) }} | {{ "" if overhead.bytes_exact else "~" }}{{ f.baseline_bytes }} → {{ f.bytes }} | {{ "%+d" | format(f.bytes_delta) }} |
+{% endfor %}
+{% if overhead.by_scenario | length > 1 %}
+
+All functions, in every scenario of this compiler:
+
+| Scenario | Instructions | Change | Bytes | Change |
+|----------|--------------|--------|-------|--------|
+{% for s in overhead.by_scenario %}
+| {{ "**%s**" | format(s.scenario) if s.current else s.scenario }} | {{ s.baseline_instructions }} → {{ s.instructions }} | {{ "%+d" | format(s.instructions_delta) }}{% if s.instructions_pct is not none %} ({{ "%+.1f%%" | format(s.instructions_pct) }}){% endif %} | {{ s.baseline_bytes }} → {{ s.bytes }} | {{ "%+d" | format(s.bytes_delta) }}{% if s.bytes_pct is not none %} ({{ "%+.1f%%" | format(s.bytes_pct) }}){% endif %} |
+{% endfor %}
+{% endif %}
+{% if overhead.timed %}
+
+| Scenario | Function | n | ns/call | Ticks/call | Overhead |
+|----------|----------|---|---------|------------|----------|
+{% for s in overhead.by_scenario %}
+{% for t in s.timing %}
+| {{ "**%s**" | format(s.scenario) if s.current else s.scenario }} | `{{ t.function }}` | {{ t.n }} | {{ "%.2f" | format(t.baseline_ns) }} → {{ "%.2f" | format(t.ns) }} | {% if t.cycles and t.baseline_cycles %}{{ "%.1f" | format(t.baseline_cycles) }} → {{ "%.1f" | format(t.cycles) }}{% else %}-{% endif %} | {{ "%+.1f%%" | format(t.overhead_pct) if t.overhead_pct is not none else "-" }} |
+{% endfor %}
+{% endfor %}
+{% endif %}
+{% if overhead.error %}
+
+!!! warning "Benchmark"
+    The benchmarks did not run in both builds: {{ overhead.error | replace("\\n", " ") | truncate(300) | md_inline }}
+{% endif %}
+{% endif %}
+
+{% if scaling %}
+
+## Scaling
+
+The same source rebuilt with each of its `sweep-defines` values (`-D` flags after the scenario's). Variants are compiled, measured and benchmarked, not explained.
+
+{% if scaling.by_working_set %}
+| Variant | Working set | Instructions | Bytes | SIMD | ns/element |
+|---------|-------------|--------------|-------|------|------------|
+{% else %}
+| Variant | Instructions | Bytes | SIMD | ns/element |
+|---------|--------------|-------|------|------------|
+{% endif %}
+{% for row in scaling.rows %}
+| `{{ row.name }}` | {% if scaling.by_working_set %}{{ row.working_set | filesizeformat(true) }} | {% endif %}{{ row.total.instructions }} | {{ row.total.bytes }} | {{ row.total.simd or "-" }} | {% for res in row.results %}`{{ res.function }}` {{ "%.3f" | format(res.ns_per_element) }}{% if not loop.last %}, {% endif %}{% else %}-{% endfor %} |
+{% endfor %}
+{% for chart in scaling.charts %}
+
+**{{ chart.title }}**
+
+<div class="bench-chart">{{ chart.svg }}</div>
+{% endfor %}
+{% endif %}
 
 ## Explanation
 
+{% if reused_from %}
+!!! note "Shared explanation"
+    This build's assembly is identical to {% if reused_from.link %}[{{ reused_from.compiler }}, {{ reused_from.scenario }}]({{ reused_from.link }}){% else %}{{ reused_from.compiler }}, {{ reused_from.scenario }}{% endif %}, so it reuses that explanation. Where it names a compiler or flags, they are that build's.
+
+{% endif %}
 {{ explanation }}
 """, encoding="utf-8")
 
 
+    # Assembly diff page template
+    diff_template = templates_dir / "diff_page.md.j2"
+    if not diff_template.exists():
+        diff_template.write_text("""\
+# {{ source.name }}: Assembly Diffs
+
+!!! info "Details"
+    **Source:** `{{ source.rel_path }}{{ source.extension }}`
+    **Compiler:** {{ compiler.id }} ({{ compiler.id | detect_arch }})
+    **Scenario:** {{ scenario.title }} (`{{ scenario.flags }}`)
+
+Per-function diffs of this page's assembly against other builds of the same
+source. Local labels and registers are renumbered in order of first use, so
+only instruction changes show: `-` lines are the other build, `+` lines this one.
+
+{% macro diff_section(d, title, link) %}
+### {{ title }}
+
+[View that page]({{ link }}).
+{% if d.identical %}
+Identical after normalization.
+{% else %}
+{% if d.unchanged %}
+{{ d.unchanged }} function(s) unchanged.
+{% endif %}
+
+{% for f in d.functions %}
+#### `{{ f.name }}` ({{ f.status }}, +{{ f.added }} -{{ f.removed }}{{ ", %d → %d bytes" | format(f.bytes[0], f.bytes[1]) if f.bytes else "" }})
+
+```diff
+{{ f.hunks }}
+```
+
+{% endfor %}
+{% endif %}
+{% endmacro %}
+{% if scenario_diffs %}
+## Other Scenarios ({{ compiler.id }})
+
+{% for d in scenario_diffs %}
+{{ diff_section(d, d.label ~ " → " ~ scenario.name, "../../../" ~ d.label ~ "/" ~ compiler.id ~ "/" ~ source.category ~ "/" ~ source.name ~ ".md") }}
+{% endfor %}
+{% endif %}
+{% if compiler_diffs %}
+## Other Compilers ({{ scenario.name }})
+
+{% for d in compiler_diffs %}
+{{ diff_section(d, d.label ~ " → " ~ compiler.id, "../../" ~ d.label ~ "/" ~ source.category ~ "/" ~ source.name ~ ".md") }}
+{% endfor %}
+{% endif %}
+
+---
+
+[← Back to {{ source.name }}]({{ source.name }}.md)
+""", encoding="utf-8")
+
+    # Flag sweep overview template
+    sweep_template = templates_dir / "sweep_page.md.j2"
+    if not sweep_template.exists():
+        sweep_template.write_text("""\
+# {{ sweep.title }}
+
+{% if sweep.description %}
+{{ sweep.description }}
+
+{% endif %}
+!!! info "Sweep"
+    **Base flags:** `{{ sweep.base or "(none)" }}`
+{% for axis in sweep.axes %}
+    **Axis {{ loop.index }}:** {% for v in axis %}`{{ v or "(none)" }}`{{ ", " if not loop.last }}{% endfor %}
+
+{% endfor %}
+
+Every combination of one value per axis is a scenario. A point whose assembly
+is identical to a neighbouring point's (one axis changed) is pruned: it has no
+page of its own and its row links to the point it matches. Compare the SIMD and
+instruction columns to see which flag changed the code.
+
+{% for compiler_id, records in compilers | dictsort %}
+## {{ compiler_id }}
+
+{% for r in records %}
+### {{ r.source }}
+
+|{% for axis in sweep.axes %} Axis {{ loop.index }} |{% endfor %} Instructions | Bytes | SIMD | Assembly |
+|{% for axis in sweep.axes %}---|{% endfor %}---|---|---|---|
+{% for p in r.points %}
+|{% for v in p["values"] %} `{{ v or "-" }}` |{% endfor %} {{ p.instructions }} | {{ p.bytes }} | {{ p.simd or "-" }} | {% if p.same_as %}same as [{{ p.same_as }}]({{ p.page }}){% else %}[view]({{ p.page }}){% endif %} |
+{% endfor %}
+
+{% endfor %}
+{% endfor %}
+""", encoding="utf-8")
+
+    # Compile time ranking template
+    compile_time_template = templates_dir / "compile_time.md.j2"
+    if not compile_time_template.exists():
+        compile_time_template.write_text("""\
+# Compile Time
+
+What each cell cost to compile, as measured by Compiler Explorer (`execTime`)
+or the local backend. Times of cached responses are those of the compile that
+produced them. Compare the scenarios of a compiler to see what higher
+optimization levels cost at build time, and what they buy in code size and
+run time.
+
+{% for compiler_id, rows in compile_times.by_compiler | dictsort %}
+## {{ compiler_id }}
+
+| Scenario | Cells | Total | Mean | Slowest | Code bytes |{% if compile_times.benchmarks %} Benchmarks (geomean ns/op) |{% endif %}
+
+|----------|-------|-------|------|---------|------------|{% if compile_times.benchmarks %}----------------------------|{% endif %}
+
+{% for r in rows %}
+| [{{ r.scenario }}]({{ r.scenario }}/{{ compiler_id }}/index.md) | {{ r.cells }} | {{ "%.2f" | format(r.total_ms / 1000) }} s | {{ "%.0f ms" | format(r.mean_ms) if r.mean_ms is not none else "-" }} | {{ "%d ms" | format(r.max_ms) if r.max_ms is not none else "-" }} | {{ r.bytes if r.bytes else "-" }} |{% if compile_times.benchmarks %} {{ "%.2f" | format(r.bench_ns) if r.bench_ns else "-" }} |{% endif %}
+
+{% endfor %}
+
+{% endfor %}
+## Most Expensive Cells
+
+| Source | Compiler | Scenario | Flags | Wall time | Slowest pass |
+|--------|----------|----------|-------|-----------|--------------|
+{% for c in compile_times.slowest %}
+| [{{ c.source }}]({{ c.page }}) | {{ c.compiler }} | {{ c.scenario }} | `{{ c.flags }}` | {{ "%d ms" | format(c.wall_ms) if c.wall_ms is not none else "-" }}{{ " (cached)" if c.cached }} | {{ c.slowest_pass or "-" }} |
+{% endfor %}
+{% if not compile_times.slowest[0].slowest_pass %}
+
+Run `ce_batch.py --time-report` to also record each compile's slowest passes
+(`-ftime-report`, `/Bt+` for MSVC).
+{% endif %}
+""", encoding="utf-8")
+
+    # Codegen regressions against a baseline (ce_baseline.py)
+    regressions_template = templates_dir / "regressions.md.j2"
+    if not regressions_template.exists():
+        regressions_template.write_text("""\
+# Regressions
+
+Codegen of this build compared with the baseline of {{ report.baseline_created or "an earlier build" }}
+(`ce_baseline.py snapshot`). A cell regresses when its instruction count or
+code size grows by more than the threshold, a benchmark gets slower by more
+than the threshold, or a function that used vector instructions no longer
+does. Compare the pages of a row to see what the compiler does differently.
+
+{% if report.compilers %}
+| Baseline compiler | Compared with |
+|-------------------|---------------|
+{% for old, new in report.compilers | dictsort %}
+| {{ old }} | {{ new }}{{ " (same)" if old == new }} |
+{% endfor %}
+
+{% endif %}
+Thresholds: instructions +{{ report.thresholds.limits.instructions }}%, code size +{{ report.thresholds.limits.bytes }}%,
+benchmarks +{{ report.thresholds.limits.bench_ns }}%{{ ", vectorization loss" if report.thresholds.vectorization }}.
+{% for glob, limits in report.thresholds.overrides %}
+Sources matching `{{ glob }}`: {% for metric, value in limits | dictsort %}{{ metric }} +{{ value }}%{{ ", " if not loop.last }}{% endfor %}.
+{% endfor %}
+{{ report.compared }} cells compared, {{ report.missing | length }} missing from this build, {{ report.new | length }} new.
+
+## Regressed ({{ report.regressions | length }})
+
+{% if report.regressions %}
+| Source | Compiler | Scenario | Metric | Function | Baseline | Now | Change |
+|--------|----------|----------|--------|----------|----------|-----|--------|
+{% for r in report.regressions %}
+| [{{ r.source }}]({{ r.page }}) | {{ r.compiler }}{{ " (was " ~ r.baseline_compiler ~ ")" if r.compiler != r.baseline_compiler }} | {{ r.scenario }} | {{ r.metric }} | {{ r.function or "-" }} | {{ r.baseline }} | {{ r.current }} | {{ "%+.1f%%" | format(r.change_pct) if r.change_pct is not none else "-" }} |
+{% endfor %}
+{% else %}
+Nothing regressed.
+{% endif %}
+
+## Improved ({{ report.improvements | length }})
+
+{% if report.improvements %}
+| Source | Compiler | Scenario | Metric | Function | Baseline | Now | Change |
+|--------|----------|----------|--------|----------|----------|-----|--------|
+{% for r in report.improvements %}
+| [{{ r.source }}]({{ r.page }}) | {{ r.compiler }}{{ " (was " ~ r.baseline_compiler ~ ")" if r.compiler != r.baseline_compiler }} | {{ r.scenario }} | {{ r.metric }} | {{ r.function or "-" }} | {{ r.baseline }} | {{ r.current }} | {{ "%+.1f%%" | format(r.change_pct) if r.change_pct is not none else "-" }} |
+{% endfor %}
+{% else %}
+Nothing improved beyond the thresholds.
+{% endif %}
+{% if report.missing %}
+
+## Missing
+
+Cells of the baseline this build does not have (a removed source, or a
+compiler without a counterpart; see `ce_baseline.py compare --map`):
+
+{% for key in report.missing %}
+- `{{ key }}`
+{% endfor %}
+{% endif %}
+""", encoding="utf-8")
+
 # -----------------------------------------------------------------------------
 # MkDocs config generation
 # -----------------------------------------------------------------------------
@@ -474,8 +1856,18 @@ def generate_mkdocs_config(
     compilers: List[CompilerInfo],
     sources: Dict[str, SourceFile],
     section_names: Dict[str, str],
+    sweeps: Optional[List[Sweep]] = None,
+    compile_time_page: bool = False,
+    search_page: bool = False,
+    regressions_page: bool = False,
 ) -> None:
-    """Generate mkdocs.yml configuration file."""
+    """
+    Generate mkdocs.yml configuration file. Points of the given *sweeps*
+    are listed under their sweep's overview page rather than as top-level
+    scenarios. *compile_time_page* adds the Compile Time page after
+    Compilers, *search_page* the Assembly Search page, *regressions_page*
+    the Regressions page.
+    """
 
     # Build a simplified navigation structure
     # Top level: Home, Compilers, then each Scenario
@@ -486,8 +1878,16 @@ def generate_mkdocs_config(
         {"Home": "index.md"},
         {"Compilers": "compilers.md"},
     ]
+    if compile_time_page:
+        nav.append({"Compile Time": "compile-time.md"})
+    if search_page:
+        nav.append({"Assembly Search": "asm-search.md"})
+    if regressions_page:
+        nav.append({"Regressions": "regressions.md"})
 
     for scenario in scenarios:
+        if scenario.sweep is not None and any(sw.name == scenario.sweep for sw in sweeps or []):
+            continue
         # Each scenario just lists its compilers, no deeper expansion
         scenario_compilers = [c for c in compilers if scenario.name in c.scenarios]
         scenario_nav: List[Any] = [
@@ -501,6 +1901,18 @@ def generate_mkdocs_config(
 
         nav.append({scenario.title: scenario_nav})
 
+    sweeps_nav: List[Any] = []
+    for sweep in sweeps or []:
+        sweep_nav: List[Any] = [{"Overview": f"sweeps/{sweep.name}.md"}]
+        present = {sc.name: sc for sc in scenarios}
+        for point in sweep.points:  # matrix order rather than by name
+            if point.name in present:
+                label = present[point.name].title.split(": ", 1)[-1]
+                sweep_nav.append({label: f"{point.name}/index.md"})
+        sweeps_nav.append({sweep.title: sweep_nav})
+    if sweeps_nav:
+        nav.append({"Sweeps": sweeps_nav})
+
     config = {
         "site_name": title,
         "theme": {
@@ -538,20 +1950,22 @@ def generate_mkdocs_config(
             "pymdownx.snippets",
             "tables",
             "admonition",
+            "attr_list",
             {"pymdownx.details": None},
             {"toc": {"permalink": True, "toc_depth": 4}},
         ],
         "extra_css": ["custom.css"],
+        "extra_javascript": ["gallery.js"],
         "nav": nav,
     }
 
     config_path = output_dir / "mkdocs.yml"
-    config_path.write_text(yaml.dump(config, default_flow_style=False, sort_keys=False), encoding="utf-8")
+    write_if_changed(config_path, yaml.dump(config, default_flow_style=False, sort_keys=False))
 
     # Generate custom CSS with Dartmouth colors
     docs_dir = output_dir / "docs"
     docs_dir.mkdir(parents=True, exist_ok=True)
-    (docs_dir / "custom.css").write_text("""\
+    write_if_changed(docs_dir / "custom.css", """\
 /* Dartmouth Green (#00693e) for header backgrounds with white text */
 :root,
 [data-md-color-scheme="default"] {
@@ -574,17 +1988,176 @@ def generate_mkdocs_config(
   --md-default-bg-color: #0D1E1C;
   --md-default-bg-color--light: #132926;
 }
-""", encoding="utf-8")
+
+/* Benchmark charts: inline SVG drawn in the text color */
+.bench-chart svg {
+  max-width: 100%;
+  height: auto;
+}
+
+/* Assembly search results */
+#asm-search input {
+  width: 100%;
+  padding: 0.4em;
+}
+""")
+
+    # Long listings on demand, and the Assembly Search page (see ce_search.py)
+    write_if_changed(docs_dir / "gallery.js", GALLERY_JS)
 
     # Copy Dartmouth D-Pine logo assets into book
     assets_src = Path(__file__).resolve().parent / "docs" / "assets"
     assets_dst = docs_dir / "assets"
     if assets_src.exists():
         if assets_dst.exists():
+            if _trees_equal(assets_src, assets_dst):
+                return
             shutil.rmtree(assets_dst)
         shutil.copytree(assets_src, assets_dst)
 
 
+GALLERY_JS = """\
+/* Compiler Optimization Gallery: long assembly listings fetched on demand,
+   and the Assembly Search page over search/asm-index.json. */
+(function () {
+  "use strict";
+
+  var script = document.currentScript;
+  var root = new URL(".", script ? script.src : location.href);
+  var index = null;
+
+  function loadListing(event) {
+    var link = event.currentTarget;
+    var para = link.closest("p");
+    event.preventDefault();
+    link.textContent = "Loading...";
+    fetch(link.href).then(function (r) {
+      if (!r.ok) throw new Error(r.status + " " + r.statusText);
+      return r.text();
+    }).then(function (text) {
+      var pre = document.createElement("pre");
+      var code = document.createElement("code");
+      code.className = "language-asm";
+      code.textContent = text;
+      pre.appendChild(code);
+      var preview = para.previousElementSibling;
+      if (preview && preview.querySelector("pre")) preview.replaceWith(pre); else para.before(pre);
+      para.remove();
+    }).catch(function (e) {
+      // A second click opens the text file itself.
+      link.removeEventListener("click", loadListing);
+      link.textContent = "Could not load the listing (" + e.message + "); open it as text";
+    });
+  }
+
+  function pageUrl(path) {
+    return new URL(path.replace(/(^|\\/)index\\.md$/, "$1").replace(/\\.md$/, "/"), root).href;
+  }
+
+  // The query and the index's names go into innerHTML, so escape them.
+  function esc(text) {
+    return String(text).replace(/[&<>"']/g, function (c) {
+      return {"&": "&amp;", "<": "&lt;", ">": "&gt;", "\\"": "&quot;", "'": "&#39;"}[c];
+    });
+  }
+
+  function row(page, detail) {
+    var p = index.pages[page];
+    return "<tr><td><a href=\\"" + esc(pageUrl(p[0])) + "\\">" + esc(p[1]) + "</a></td><td>" + esc(p[2]) +
+      "</td><td>" + esc(p[3]) + "</td><td>" + detail + "</td></tr>";
+  }
+
+  function glob(q) {
+    var re = q.replace(/[.+^${}()|[\\]\\\\]/g, "\\\\$&").replace(/\\*/g, ".*").replace(/\\?/g, ".");
+    return new RegExp("^" + re + "$");
+  }
+
+  function search(query, out) {
+    var q = query.trim().toLowerCase().replace(/\\s+/g, " ");
+    if (!q) { out.innerHTML = ""; return; }
+    var html = [];
+    var re = glob(q);
+    var terms = Object.keys(index.mnemonics).filter(function (m) { return re.test(m); });
+    if (terms.length) {
+      var uses = [];
+      terms.forEach(function (m) {
+        index.mnemonics[m].forEach(function (u) { uses.push([m].concat(u)); });
+      });
+      uses.sort(function (a, b) { return b[2] - a[2]; });
+      html.push("<h2>Instruction <code>" + esc(q) + "</code>: " + uses.length + " uses on pages</h2>",
+        "<table><tr><th>Source</th><th>Compiler</th><th>Scenario</th><th>Uses</th></tr>");
+      uses.slice(0, 200).forEach(function (u) {
+        var fns = u[3].slice(0, 4).map(function (f) { return "<code>" + esc(f[0]) + "</code> " + esc(f[1]); }).join(", ");
+        html.push(row(u[1], (terms.length > 1 ? "<code>" + esc(u[0]) + "</code> " : "") + esc(u[2]) + " (" + fns + ")"));
+      });
+      html.push("</table>");
+    }
+    var names = Object.keys(index.functions).filter(function (n) {
+      return q.indexOf("*") >= 0 ? re.test(n.toLowerCase()) : n.toLowerCase().indexOf(q) >= 0;
+    });
+    if (names.length) {
+      html.push("<h2>Functions matching <code>" + esc(q) + "</code>: " + names.length + "</h2>",
+        "<table><tr><th>Source</th><th>Compiler</th><th>Scenario</th><th>Function</th></tr>");
+      names.slice(0, 50).forEach(function (n) {
+        index.functions[n].forEach(function (page) { html.push(row(page, "<code>" + esc(n) + "</code>")); });
+      });
+      html.push("</table>");
+    }
+    out.innerHTML = html.length ? html.join("") : "<p>No function or instruction matches.</p>";
+  }
+
+  function setupSearch(box) {
+    var input = box.querySelector("input");
+    var out = box.querySelector(".results");
+    var pending = null;
+    function run() {
+      if (index) { search(input.value, out); return; }
+      pending = pending || fetch(new URL("search/asm-index.json", root)).then(function (r) { return r.json(); });
+      pending.then(function (data) { index = data; search(input.value, out); });
+    }
+    input.addEventListener("input", run);
+    if (input.value) run();
+  }
+
+  function init() {
+    document.querySelectorAll("a.asm-fragment").forEach(function (a) {
+      if (!a.dataset.bound) { a.dataset.bound = "1"; a.addEventListener("click", loadListing); }
+    });
+    var box = document.getElementById("asm-search");
+    if (box && !box.dataset.bound) { box.dataset.bound = "1"; setupSearch(box); }
+  }
+
+  if (window.document$) window.document$.subscribe(init); else document.addEventListener("DOMContentLoaded", init);
+})();
+"""
+
+ASM_SEARCH_PAGE = """\
+# Assembly Search
+
+Find the pages that define a function, or the functions that use an
+instruction: type a function name (or part of one) or a mnemonic such as
+`vpaddd`, `rep movsb` or `endbr64`. `*` matches anything, so `cmov*`
+finds every conditional move. Instruction matches list the pages that use
+it most first. The index covers every compiler and scenario in the book;
+`ce_search.py` runs the same queries from the command line.
+
+<div id="asm-search">
+<input type="search" placeholder="Function name or instruction" autofocus>
+<div class="results"></div>
+</div>
+"""
+
+
+def _trees_equal(a: Path, b: Path) -> bool:
+    cmp = filecmp.dircmp(a, b)
+    if cmp.left_only or cmp.right_only or cmp.funny_files:
+        return False
+    _, mismatch, errors = filecmp.cmpfiles(a, b, cmp.common_files, shallow=False)
+    if mismatch or errors:
+        return False
+    return all(_trees_equal(a / d, b / d) for d in cmp.common_dirs)
+
+
 # -----------------------------------------------------------------------------
 # Main build function
 # -----------------------------------------------------------------------------
@@ -597,30 +2170,51 @@ def build_book(
     sources_section: str,
     title: str,
     description: str,
+    changes: Optional[SourceChanges] = None,
+    only_stale: bool = False,
+    jobs: int = 1,
+    bytecode_dir: Optional[Path] = None,
+    diff_dir: Optional[Path] = None,
+    use_manifest: bool = True,
+    baseline_path: Optional[Path] = None,
 ) -> None:
-    """Main function to build the MkDocs book."""
+    """
+    Main function to build the MkDocs book.
+
+    By default every page is rewritten. With *changes* (source keys from
+    ``--changed-since``) only the source pages of those sources, and the
+    compiler/scenario indexes that list them, are regenerated; with
+    *only_stale* a page is regenerated when it is missing or older than the
+    cell outputs it is built from. Top-level pages and mkdocs.yml are cheap
+    and always rewritten.
+
+    Source pages are rendered by *jobs* worker processes, each reading its
+    cells' texts on demand, so memory does not grow with the matrix size.
+    Templates are compiled through the bytecode cache in *bytecode_dir*, if
+    given. Assembly diffs between a page's scenarios and compilers are kept
+    in *diff_dir* (see ce_asmdiff.py), if given, so unchanged pairs are not
+    diffed again. Cells are found through ce_batch.py's manifest unless
+    *use_manifest* is off. With *baseline_path* (see ce_baseline.py) a
+    Regressions page compares the outputs with that baseline. A per-phase
+    timing summary is printed at the end.
+    """
+    incremental = changes is not None or only_stale
+    timer = PhaseTimer()
 
-    # Load config
-    scenario_configs, section_names = load_config(config_path)
+    with timer.phase("setup"):
+        # Load config
+        scenario_configs, section_names, sweeps = load_config(config_path)
 
-    # Ensure templates exist
-    ensure_templates(templates_dir)
+        # Ensure templates exist
+        ensure_templates(templates_dir)
 
-    # Set up Jinja2 environment
-    env = Environment(
-        loader=FileSystemLoader(templates_dir),
-        autoescape=select_autoescape(["html", "xml"]),
-        trim_blocks=True,
-        lstrip_blocks=True,
-    )
-    env.filters["detect_arch"] = detect_arch
-    env.filters["describe_flags"] = describe_flags
-    env.filters["title_case"] = title_case
-    env.filters["normalize_headings"] = normalize_heading_levels
+        # Set up Jinja2 environment
+        env = make_environment(templates_dir, bytecode_dir)
 
     # Collect all outputs
     print(f"Collecting outputs from {input_dir}...")
-    sources, compilers, scenarios_found = collect_outputs(input_dir)
+    with timer.phase("collect outputs"):
+        sources, compilers, scenarios_found = collect_outputs(input_dir, use_manifest)
 
     if not sources:
         raise SystemExit("No source outputs found in input directory")
@@ -648,58 +2242,124 @@ def build_book(
     docs_dir = output_dir / "docs"
     docs_dir.mkdir(parents=True, exist_ok=True)
 
-    # Generate main index
-    print("Generating index.md...")
-    index_template = env.get_template("index.md.j2")
-    index_content = index_template.render(
-        title=title,
-        description=description,
-        scenarios=scenarios_list,
-        compilers=list(compilers.values()),
-    )
-    (docs_dir / "index.md").write_text(index_content, encoding="utf-8")
-
-    # Generate compilers page
-    print("Generating compilers.md...")
-    compilers_template = env.get_template("compilers.md.j2")
-    compilers_list = sorted(compilers.values(), key=lambda c: c.id)
-    compilers_content = compilers_template.render(
-        compilers=[{"id": c.id, "scenarios": sorted(c.scenarios)} for c in compilers_list],
-    )
-    (docs_dir / "compilers.md").write_text(compilers_content, encoding="utf-8")
+    with timer.phase("top-level pages"):
+        # Generate main index
+        print("Generating index.md...")
+        index_template = env.get_template("index.md.j2")
+        index_content = index_template.render(
+            title=title,
+            description=description,
+            scenarios=scenarios_list,
+            compilers=list(compilers.values()),
+        )
+        (docs_dir / "index.md").write_text(index_content, encoding="utf-8")
+
+        # Generate compilers page
+        print("Generating compilers.md...")
+        compilers_template = env.get_template("compilers.md.j2")
+        compilers_list = sorted(compilers.values(), key=lambda c: c.id)
+        compilers_content = compilers_template.render(
+            compilers=[{"id": c.id, "scenarios": sorted(c.scenarios)} for c in compilers_list],
+        )
+        (docs_dir / "compilers.md").write_text(compilers_content, encoding="utf-8")
 
     # Generate scenario/compiler/source pages
     print("Generating source pages...")
     scenario_index_template = env.get_template("scenario_index.md.j2")
     compiler_index_template = env.get_template("compiler_index.md.j2")
-    source_template = env.get_template("source_page.md.j2")
+    cells = index_outputs(sources)
+
+    # Source pages go to a process pool as they are planned; with one job
+    # they are rendered inline.
+    pages_start = time.perf_counter()
+    pool: Optional[ProcessPoolExecutor] = None
+    futures: List[Future] = []
+    if jobs > 1:
+        pool = ProcessPoolExecutor(
+            max_workers=jobs,
+            initializer=init_render_worker,
+            initargs=(templates_dir, input_dir, bytecode_dir, diff_dir),
+        )
+    else:
+        init_render_worker(templates_dir, input_dir, bytecode_dir, diff_dir)
 
-    for scenario in scenarios_list:
-        scenario_dir = docs_dir / scenario.name
-        scenario_dir.mkdir(parents=True, exist_ok=True)
+    page_times = [0.0, 0.0, 0.0]  # load, render, write; summed over workers
 
-        # Get compilers for this scenario
-        scenario_compilers = [c for c in compilers_list if scenario.name in c.scenarios]
+    def add_page_times(times: Tuple[float, float, float]) -> None:
+        for i, t in enumerate(times):
+            page_times[i] += t
 
-        # Scenario index
-        scenario_index_content = scenario_index_template.render(
-            scenario=scenario,
-            compilers=scenario_compilers,
+    def submit(job: PageJob) -> None:
+        if pool is None:
+            add_page_times(render_source_page(job))
+        else:
+            futures.append(pool.submit(render_source_page, job))
+
+    def related_outputs(source: SourceFile, output: SourceOutput) -> Tuple[List[SourceOutput], List[SourceOutput]]:
+        """A cell's other scenarios (same compiler) and peers (same scenario and instruction set)."""
+        isa = detect_instruction_set(output.compiler_id)
+        siblings = sorted(
+            (o for o in source.outputs if o.compiler_id == output.compiler_id),
+            key=lambda o: scenario_order.get(o.scenario, len(scenario_order)),
         )
-        (scenario_dir / "index.md").write_text(scenario_index_content, encoding="utf-8")
-
-        for compiler in scenario_compilers:
-            compiler_dir = scenario_dir / compiler.id
-            compiler_dir.mkdir(parents=True, exist_ok=True)
-
-            # Group sources by category for this compiler/scenario
-            sections: Dict[str, Dict[str, Any]] = {}
-            for source in sources.values():
-                output = next(
-                    (o for o in source.outputs if o.compiler_id == compiler.id and o.scenario == scenario.name),
-                    None
-                )
-                if output:
+        peers = sorted(
+            (
+                o for o in source.outputs
+                if o.scenario == output.scenario and o.compiler_id != output.compiler_id
+                and detect_instruction_set(o.compiler_id) == isa
+            ),
+            key=lambda o: o.compiler_id,
+        )
+        return siblings, peers
+
+    def page_is_affected(source: SourceFile, output: SourceOutput, page: Path, related: List[SourceOutput]) -> bool:
+        if not incremental:
+            return True
+        if changes is not None and source.rel_path in changes.changed:
+            return True
+        if only_stale:
+            try:
+                # Related cells feed the code metrics table and the diff page.
+                newest = max([output.mtime] + [o.mtime for o in related])
+                return page.stat().st_mtime < newest
+            except FileNotFoundError:
+                return True
+        return not page.exists()
+
+    pages_total = 0
+    pages_rendered = 0
+    scenario_order = {s.name: i for i, s in enumerate(scenarios_list)}
+
+    try:
+        for scenario in scenarios_list:
+            scenario_dir = docs_dir / scenario.name
+            scenario_dir.mkdir(parents=True, exist_ok=True)
+            scenario_affected = False
+
+            # Get compilers for this scenario
+            scenario_compilers = [c for c in compilers_list if scenario.name in c.scenarios]
+
+            for compiler in scenario_compilers:
+                compiler_dir = scenario_dir / compiler.id
+                compiler_dir.mkdir(parents=True, exist_ok=True)
+                compiler_affected = False
+                compiler_cells = cells.get((compiler.id, scenario.name), [])
+
+                # Pages of sources removed since the given revision.
+                if changes is not None:
+                    for key in changes.deleted:
+                        category = source_category(key)
+                        stale_page = compiler_dir / category / f"{Path(key).name}.md"
+                        if stale_page.exists():
+                            stale_page.unlink()
+                            compiler_affected = True
+                        for stale in (diff_page_path(stale_page), asm_fragment_path(stale_page)):
+                            if stale.exists():
+                                stale.unlink()
+
+                # Group sources by category for this compiler/scenario
+                sections: Dict[str, Dict[str, Any]] = {}
+                for source, _ in compiler_cells:
                     cat = source.category
                     if cat not in sections:
                         sections[cat] = {
@@ -708,45 +2368,157 @@ def build_book(
                         }
                     sections[cat]["sources"].append(source)
 
-            # Sort sources within each section
-            for sec in sections.values():
-                sec["sources"].sort(key=lambda s: s.name)
-
-            # Compiler index
-            compiler_index_content = compiler_index_template.render(
-                scenario=scenario,
-                compiler=compiler,
-                sections=dict(sorted(sections.items())),
-                sources_section=sources_section,
+                # Sort sources within each section
+                for sec in sections.values():
+                    sec["sources"].sort(key=lambda s: s.name)
+
+                # Source pages
+                for source, output in compiler_cells:
+                    page = compiler_dir / source.category / f"{source.name}.md"
+                    pages_total += 1
+                    siblings, peers = related_outputs(source, output)
+                    if not page_is_affected(source, output, page, siblings + peers):
+                        continue
+                    compiler_affected = True
+                    pages_rendered += 1
+                    submit(PageJob(
+                        page=page,
+                        source=dataclasses.replace(source, outputs=[]),
+                        output=output,
+                        scenario=scenario,
+                        compiler=compiler,
+                        siblings=tuple((o.scenario, o.cell_key) for o in siblings),
+                        peers=tuple((o.compiler_id, o.cell_key) for o in peers),
+                        cell_keys=tuple(o.cell_key for o in source.outputs),
+                    ))
+
+                # Compiler index
+                compiler_index = compiler_dir / "index.md"
+                if compiler_affected or not incremental or not compiler_index.exists():
+                    with timer.phase("index pages"):
+                        compiler_index_content = compiler_index_template.render(
+                            scenario=scenario,
+                            compiler=compiler,
+                            sections=dict(sorted(sections.items())),
+                            sources_section=sources_section,
+                        )
+                        compiler_index.write_text(compiler_index_content, encoding="utf-8")
+                    scenario_affected = True
+
+            # Scenario index
+            scenario_index = scenario_dir / "index.md"
+            if scenario_affected or not incremental or not scenario_index.exists():
+                with timer.phase("index pages"):
+                    scenario_index_content = scenario_index_template.render(
+                        scenario=scenario,
+                        compilers=scenario_compilers,
+                    )
+                    scenario_index.write_text(scenario_index_content, encoding="utf-8")
+
+        # Surface the first render error, if any.
+        for fut in futures:
+            add_page_times(fut.result())
+    finally:
+        if pool is not None:
+            pool.shutdown(cancel_futures=True)
+        if "outputs" in _render_state:
+            _render_state.pop("outputs").close()
+
+    timer.add(f"source pages ({jobs} jobs)", time.perf_counter() - pages_start - timer.phases.get("index pages", 0.0))
+
+    if incremental:
+        print(f"Regenerated {pages_rendered} of {pages_total} source pages")
+
+    # Sweep overview pages: cheap, always rewritten
+    sweeps_rendered: List[Sweep] = []
+    with timer.phase("sweep pages"):
+        sweep_records = collect_sweep_records(input_dir) if sweeps else {}
+        sweep_template = env.get_template("sweep_page.md.j2")
+        for sweep in sweeps:
+            if sweep.name not in sweep_records:
+                continue
+            (docs_dir / "sweeps").mkdir(exist_ok=True)
+            (docs_dir / "sweeps" / f"{sweep.name}.md").write_text(
+                sweep_template.render(sweep=sweep, compilers=sweep_records[sweep.name]),
+                encoding="utf-8",
+            )
+            sweeps_rendered.append(sweep)
+
+    # Compile time ranking: cheap, always rewritten
+    with timer.phase("compile time page"):
+        compile_times = collect_compile_times(input_dir, [s.name for s in scenarios_list], use_manifest=use_manifest)
+        if compile_times is not None:
+            (docs_dir / "compile-time.md").write_text(
+                env.get_template("compile_time.md.j2").render(compile_times=compile_times), encoding="utf-8"
             )
-            (compiler_dir / "index.md").write_text(compiler_index_content, encoding="utf-8")
 
-            # Source pages
-            for source in sources.values():
-                output = next(
-                    (o for o in source.outputs if o.compiler_id == compiler.id and o.scenario == scenario.name),
-                    None
-                )
-                if not output:
-                    continue
-
-                source_dir = compiler_dir / source.category
-                source_dir.mkdir(parents=True, exist_ok=True)
-
-                source_content = source_template.render(
-                    source=source,
-                    source_code=output.source_code,
-                    source_lang=output.source_lang,
-                    assembly=output.assembly,
-                    explanation=output.explanation,
-                    scenario=scenario,
-                    compiler=compiler,
+    # Assembly search index: terms are cached per cell, so only changed
+    # listings are read again
+    with timer.phase("search index"):
+        term_cache = TermCache(output_dir / ".search-cache.json")
+        search_pages = []
+        search_outputs = open_outputs_for_reading(input_dir)
+        try:
+            for (compiler_id, scenario_name), compiler_cells in sorted(cells.items(), key=lambda kv: (kv[0][1], kv[0][0])):
+                for source, output in sorted(compiler_cells, key=lambda c: c[0].rel_path):
+                    terms = term_cache.get(
+                        output.cell_key, output.mtime,
+                        lambda key=output.cell_key: search_outputs.read_text(f"{key}.asm"),
+                    )
+                    page = f"{scenario_name}/{compiler_id}/{source.category}/{source.name}.md"
+                    search_pages.append((page, source.rel_path, compiler_id, scenario_name, terms))
+        finally:
+            search_outputs.close()
+        search_page = bool(search_pages)
+        if search_page:
+            (docs_dir / SEARCH_INDEX_NAME).parent.mkdir(exist_ok=True)
+            write_if_changed(
+                docs_dir / SEARCH_INDEX_NAME,
+                json.dumps(build_index(search_pages), separators=(",", ":")),
+            )
+            write_if_changed(docs_dir / "asm-search.md", ASM_SEARCH_PAGE)
+        term_cache.save([o.cell_key for compiler_cells in cells.values() for _, o in compiler_cells])
+        print(f"Search index: {len(search_pages)} pages ({term_cache.misses} listings read, {term_cache.hits} cached)")
+
+    # Codegen regressions against a baseline: cheap, always rewritten
+    regressions_page = False
+    if baseline_path is not None:
+        with timer.phase("regressions page"):
+            raw_config = yaml.safe_load(config_path.read_text(encoding="utf-8")) if config_path and config_path.exists() else None
+            try:
+                report = compare_baseline(
+                    load_baseline(baseline_path),
+                    snapshot_outputs(input_dir, use_manifest=use_manifest),
+                    load_thresholds(raw_config if isinstance(raw_config, dict) else {}),
                 )
-                (source_dir / f"{source.name}.md").write_text(source_content, encoding="utf-8")
+            except (OSError, ValueError) as e:
+                raise SystemExit(f"Cannot compare with baseline: {e}") from e
+            (docs_dir / "regressions.md").write_text(
+                env.get_template("regressions.md.j2").render(report=report), encoding="utf-8"
+            )
+            regressions_page = True
+            print(
+                f"Regressions: {len(report['regressions'])} against {baseline_path} "
+                f"({report['compared']} cells compared, {len(report['improvements'])} improvements)"
+            )
 
     # Generate mkdocs.yml
     print("Generating mkdocs.yml...")
-    generate_mkdocs_config(output_dir, title, scenarios_list, compilers_list, sources, section_names)
+    with timer.phase("mkdocs.yml and assets"):
+        generate_mkdocs_config(
+            output_dir, title, scenarios_list, compilers_list, sources, section_names, sweeps_rendered,
+            compile_time_page=compile_times is not None,
+            search_page=search_page,
+            regressions_page=regressions_page,
+        )
+
+    print("\nTimings:")
+    print(timer.report())
+    if pages_rendered:
+        print(
+            f"  per page, summed over workers: load {page_times[0]:.3f}s, "
+            f"render {page_times[1]:.3f}s, write {page_times[2]:.3f}s"
+        )
 
     print(f"\nBook generated successfully at {output_dir}/")
     print(f"To preview: cd {output_dir} && mkdocs serve")
@@ -792,9 +2564,62 @@ def main() -> int:
         default="A collection of compiler optimization examples with assembly output and explanations.",
         help="Book description",
     )
+    ap.add_argument(
+        "--changed-since",
+        metavar="REV",
+        default=None,
+        help="Only regenerate pages for sources that differ from git revision REV",
+    )
+    ap.add_argument(
+        "--src",
+        default="src",
+        help="Source tree used to resolve --changed-since (default: src)",
+    )
+    ap.add_argument(
+        "--only-stale",
+        action="store_true",
+        help="Only regenerate pages that are missing or older than their outputs",
+    )
+    ap.add_argument(
+        "--template-cache",
+        default=None,
+        help="Directory for compiled template bytecode (default: <output>/.jinja-cache)",
+    )
+    ap.add_argument(
+        "--no-template-cache",
+        action="store_true",
+        help="Compile templates from scratch on every run",
+    )
+    ap.add_argument(
+        "--diff-cache",
+        default=None,
+        help="Directory for computed assembly diffs (default: <output>/.diff-cache)",
+    )
+    ap.add_argument(
+        "--no-manifest",
+        action="store_true",
+        help="Find cells by walking the input tree instead of reading its manifest.json",
+    )
+    ap.add_argument(
+        "--baseline",
+        default=None,
+        metavar="FILE",
+        help="Add a Regressions page comparing the input with this ce_baseline.py snapshot",
+    )
+    ap.add_argument(
+        "--jobs", "-j",
+        type=int,
+        default=os.cpu_count() or 1,
+        help="Worker processes for rendering source pages (default: CPU count)",
+    )
 
     args = ap.parse_args()
 
+    changes = None
+    if args.changed_since is not None:
+        changes = changed_sources_since(args.changed_since, Path(args.src), SOURCE_EXTENSIONS)
+        print(f"Changed since {args.changed_since}: {len(changes.changed)} sources, {len(changes.deleted)} deleted")
+
     build_book(
         input_dir=Path(args.input),
         output_dir=Path(args.output),
@@ -803,6 +2628,15 @@ def main() -> int:
         sources_section=args.sources_section,
         title=args.title,
         description=args.description,
+        changes=changes,
+        only_stale=args.only_stale,
+        jobs=args.jobs,
+        bytecode_dir=None if args.no_template_cache else (
+            Path(args.template_cache) if args.template_cache else Path(args.output) / ".jinja-cache"
+        ),
+        diff_dir=Path(args.diff_cache) if args.diff_cache else Path(args.output) / ".diff-cache",
+        use_manifest=not args.no_manifest,
+        baseline_path=Path(args.baseline) if args.baseline else None,
     )
 
     return 0
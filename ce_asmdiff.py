@@ -0,0 +1,361 @@
+# Copyright (c) 2026 Larry H <l.gr [at] dartmouth [dot] edu>
+# SPDX-License-Identifier: AGPL-3.0-or-later
+#
+# Compiler Optimization Gallery
+# Developed for COSC-69.16: Basics of Reverse Engineering
+# Dartmouth College, Winter 2026
+
+"""
+ce_asmdiff.py
+
+Normalized per-function assembly diffs, for the book's "compare" pages.
+
+Two listings are split into functions (ce_metrics.split_functions) and
+each function is normalized before diffing:
+
+- whitespace collapsed, x86 comments dropped
+- local labels (.L3, .LBB0_2, $LN4@f) renumbered .L1, .L2, ... in order of
+  first use; so are the branch targets of a disassembled object
+  (``4f <h+0x1f>``), whose addresses move with every size change, and a
+  relocated ``<sym>`` reads as ``sym``
+- general purpose registers renumbered by first use per register family,
+  keeping the operand width (x86: rax/eax/ax/al of the first family seen
+  become r1/r1d/r1w/r1b; vector registers become xmm1/ymm1/...; AArch64
+  x/w, ARM r, RISC-V and MIPS registers likewise). Stack, frame and
+  instruction pointers keep their names.
+
+so a diff shows changed instructions rather than a different register
+allocation or label numbering. Functions are paired by name and diffed with
+Myers' O(ND) algorithm.
+
+DiffCache stores each changed function's diff under a hash of its two
+normalized bodies; a pair is computed once per content and its reverse
+direction is derived by swapping sides. Editing one function of a source
+then costs one function diff per compared cell, not a diff of the whole
+listing. Only depends on the standard library (like build_book.py).
+"""
+
+from __future__ import annotations
+
+import hashlib
+import json
+import os
+import re
+import tempfile
+from pathlib import Path
+from typing import Any, Dict, List, Optional, Sequence, Tuple
+
+from ce_metrics import split_functions
+
+DiffOp = Tuple[str, str]  # (" " | "-" | "+", line)
+
+_LOCAL_LABEL_TOKEN_RE = re.compile(r"(?<![\w.$])(\.L[\w.$]+|\$LN\w+(@\w+)?|\$L\w+|\.\$\w+)")
+_X86_COMMENT_RE = re.compile(r"\s+[#;].*$")
+_OBJDUMP_TARGET_RE = re.compile(r"(?<![\w.$])(?:[0-9a-fA-F]+ )?<([^<>+]+)(\+0x[0-9a-fA-F]+)?>")
+
+# x86: family -> names by width (64, 32, 16, 8)
+_X86_GPR = {
+    "a": ("rax", "eax", "ax", "al"), "b": ("rbx", "ebx", "bx", "bl"),
+    "c": ("rcx", "ecx", "cx", "cl"), "d": ("rdx", "edx", "dx", "dl"),
+    "si": ("rsi", "esi", "si", "sil"), "di": ("rdi", "edi", "di", "dil"),
+}
+_X86_SUFFIXES = ("", "d", "w", "b")
+_X86_REG_NAMES: Dict[str, Tuple[str, int]] = {}
+for _family_name, _names in _X86_GPR.items():
+    for _width, _name in enumerate(_names):
+        _X86_REG_NAMES[_name] = (_family_name, _width)
+for _n in range(8, 16):
+    for _width, _suffix in enumerate(_X86_SUFFIXES):
+        _X86_REG_NAMES[f"r{_n}{_suffix}"] = (f"r{_n}", _width)
+_X86_REG_NAMES.update({"ah": ("a", 3), "bh": ("b", 3), "ch": ("c", 3), "dh": ("d", 3)})
+
+_X86_REG_RE = re.compile(
+    r"(?<![\w.$])(%?)(" + "|".join(sorted(_X86_REG_NAMES, key=len, reverse=True)) + r"|([xyz]mm)(\d+))(?![\w$])"
+)
+_RISC_REG_RE = {
+    "aarch64": re.compile(r"(?<![\w.$])([xwqdsvbh])([12]?\d|30)(?![\w$])"),
+    "arm32": re.compile(r"(?<![\w.$])(r)(\d|1[0-2])(?![\w$])"),
+    "riscv": re.compile(r"(?<![\w.$])([ast])(\d|1[01])(?![\w$])"),
+    "mips": re.compile(r"(?<![\w.$])(\$)([avt]\d|s[0-7]|[2-9]|1\d|2[0-5])(?![\w$])"),
+}
+
+
+def _isa_family(isa: str) -> str:
+    for fam in ("riscv", "mips", "aarch64", "arm32"):
+        if isa.startswith(fam):
+            return fam
+    return "x86" if isa in ("amd64", "x86") else isa
+
+
+class _Renamer:
+    """Numbers keys 1, 2, ... in order of first use."""
+
+    def __init__(self) -> None:
+        self.names: Dict[str, int] = {}
+
+    def __call__(self, key: str) -> int:
+        if key not in self.names:
+            self.names[key] = len(self.names) + 1
+        return self.names[key]
+
+
+def normalize_function(lines: Sequence[str], instruction_set: str) -> List[str]:
+    """Canonical form of one function's lines (see the module docstring)."""
+    fam = _isa_family(instruction_set or "amd64")
+    labels, gprs, vecs = _Renamer(), _Renamer(), _Renamer()
+    out = []
+
+    def x86_reg(m: "re.Match[str]") -> str:
+        pct, name = m.group(1), m.group(2)
+        if m.group(3):
+            return f"{pct}{m.group(3)}{vecs(m.group(4))}"
+        family, width = _X86_REG_NAMES[name]
+        return f"{pct}r{gprs(family)}{_X86_SUFFIXES[width]}"
+
+    def risc_reg(m: "re.Match[str]") -> str:
+        kind, num = m.group(1), m.group(2)
+        if fam == "aarch64":
+            # x/w share a file, as do the SIMD views q/d/s/h/b/v.
+            if kind in "xw" and num in ("29", "30"):
+                return m.group(0)  # frame pointer and link register
+            if kind in "xw":
+                return f"{kind}{gprs(num)}"
+            return f"{kind}{vecs(num)}"
+        if fam == "mips":
+            return f"$r{gprs(num)}"
+        if fam == "riscv":
+            return f"{kind}{gprs(kind + num)}"
+        return f"{kind}{gprs(num)}"
+
+    reg_re = _RISC_REG_RE.get(fam)
+    for line in lines:
+        text = line.strip()
+        if fam == "x86":
+            text = _X86_COMMENT_RE.sub("", text)
+        text = re.sub(r"\s+", " ", text)
+        text = re.sub(r"\s*,\s*", ", ", text)
+        text = _LOCAL_LABEL_TOKEN_RE.sub(lambda m: f".L{labels(m.group(1))}", text)
+        text = _OBJDUMP_TARGET_RE.sub(lambda m: f".L{labels(m.group(0))}" if m.group(2) else m.group(1), text)
+        if fam == "x86":
+            text = _X86_REG_RE.sub(x86_reg, text)
+        elif reg_re is not None:
+            text = reg_re.sub(risc_reg, text)
+        out.append(text)
+    return out
+
+
+def normalize_listing(asm_text: str, instruction_set: str) -> Dict[str, List[str]]:
+    """Normalized lines of every function of a listing, keyed by name."""
+    return {
+        name: normalize_function(body, instruction_set)
+        for name, body in split_functions(asm_text.splitlines()).items()
+    }
+
+
+def myers_diff(a: Sequence[str], b: Sequence[str]) -> List[DiffOp]:
+    """Shortest edit script from *a* to *b* (Myers 1986, greedy forward search)."""
+    n, m = len(a), len(b)
+    maxd = n + m
+    v = {1: 0}
+    trace: List[Dict[int, int]] = []
+    for d in range(maxd + 1):
+        trace.append(dict(v))
+        for k in range(-d, d + 1, 2):
+            if k == -d or (k != d and v[k - 1] < v[k + 1]):
+                x = v[k + 1]
+            else:
+                x = v[k - 1] + 1
+            y = x - k
+            while x < n and y < m and a[x] == b[y]:
+                x, y = x + 1, y + 1
+            v[k] = x
+            if x >= n and y >= m:
+                return _backtrack(a, b, trace, x, y)
+    return []  # unreachable: d == n + m always reaches the end
+
+
+def _backtrack(a: Sequence[str], b: Sequence[str], trace: List[Dict[int, int]], x: int, y: int) -> List[DiffOp]:
+    ops: List[DiffOp] = []
+    for d in range(len(trace) - 1, -1, -1):
+        v = trace[d]
+        k = x - y
+        if k == -d or (k != d and v.get(k - 1, -1) < v.get(k + 1, -1)):
+            prev_k = k + 1
+        else:
+            prev_k = k - 1
+        prev_x = v.get(prev_k, 0)
+        prev_y = prev_x - prev_k
+        while x > prev_x and y > prev_y:
+            x, y = x - 1, y - 1
+            ops.append((" ", a[x]))
+        if d > 0:
+            if x == prev_x:
+                y -= 1
+                ops.append(("+", b[y]))
+            else:
+                x -= 1
+                ops.append(("-", a[x]))
+    ops.reverse()
+    return ops
+
+
+def diff_function(name: str, old: Optional[List[str]], new: Optional[List[str]]) -> Dict[str, Any]:
+    """Diff of one normalized function; None for a side it is missing from."""
+    if old is None:
+        status = "added"
+    elif new is None:
+        status = "removed"
+    else:
+        status = "same" if old == new else "changed"
+    ops = [(" ", line) for line in new or ()] if status == "same" else myers_diff(old or [], new or [])
+    return {
+        "name": name,
+        "status": status,
+        "added": sum(1 for op, _ in ops if op == "+"),
+        "removed": sum(1 for op, _ in ops if op == "-"),
+        "ops": [op + line for op, line in ops] if status != "same" else [],
+    }
+
+
+def _function_order(a: Dict[str, List[str]], b: Dict[str, List[str]]) -> List[str]:
+    return list(b) + [n for n in a if n not in b]
+
+
+def diff_listings(a: Dict[str, List[str]], b: Dict[str, List[str]]) -> Dict[str, Any]:
+    """
+    Per-function diff of two normalized listings. Functions keep *b*'s
+    order, followed by those only in *a*.
+    """
+    functions = [diff_function(name, a.get(name), b.get(name)) for name in _function_order(a, b)]
+    return {
+        "identical": all(f["status"] == "same" for f in functions),
+        "functions": functions,
+    }
+
+
+def _reverse_function(f: Dict[str, Any]) -> Dict[str, Any]:
+    swap = {"+": "-", "-": "+", " ": " "}
+    status = {"added": "removed", "removed": "added"}
+    return {
+        "name": f["name"],
+        "status": status.get(f["status"], f["status"]),
+        "added": f["removed"],
+        "removed": f["added"],
+        "ops": [swap[op[0]] + op[1:] for op in f["ops"]],
+    }
+
+
+def reverse_diff(result: Dict[str, Any]) -> Dict[str, Any]:
+    """The same diff read from the other side (b -> a)."""
+    return {
+        "identical": result["identical"],
+        "functions": [_reverse_function(f) for f in result["functions"]],
+    }
+
+
+def unified_hunks(ops: Sequence[str], context: int = 3) -> str:
+    """Render diff ops (as stored in a diff) as unified diff hunks."""
+    changes = [i for i, op in enumerate(ops) if op[0] != " "]
+    if not changes:
+        return ""
+    # Merge change runs whose context windows touch.
+    groups: List[List[int]] = [[max(0, changes[0] - context), changes[0] + context + 1]]
+    for i in changes[1:]:
+        if i - context <= groups[-1][1]:
+            groups[-1][1] = i + context + 1
+        else:
+            groups.append([i - context, i + context + 1])
+
+    # Line numbers on each side before every op.
+    old_no, new_no = [], []
+    o = n = 1
+    for op in ops:
+        old_no.append(o)
+        new_no.append(n)
+        if op[0] != "+":
+            o += 1
+        if op[0] != "-":
+            n += 1
+
+    out = []
+    for start, end in groups:
+        end = min(end, len(ops))
+        chunk = ops[start:end]
+        old_len = sum(1 for op in chunk if op[0] != "+")
+        new_len = sum(1 for op in chunk if op[0] != "-")
+        # An empty side is numbered by the line before it, as diff -u does.
+        old_start = old_no[start] - (0 if old_len else 1)
+        new_start = new_no[start] - (0 if new_len else 1)
+        out.append(f"@@ -{old_start},{old_len} +{new_start},{new_len} @@")
+        out.extend(chunk)
+    return "\n".join(out)
+
+
+class DiffCache:
+    """
+    Function diffs stored as ``<dir>/<sha256>.json``, keyed by the
+    normalized bodies of both sides, so a function is diffed once per
+    content pair whichever cells it appears in. Safe to share between
+    processes: entries are written to a temporary file and renamed into
+    place.
+    """
+
+    def __init__(self, directory: Optional[Path]) -> None:
+        self.directory = directory
+        if directory is not None:
+            directory.mkdir(parents=True, exist_ok=True)
+
+    @staticmethod
+    def _digest(body: List[str]) -> str:
+        return hashlib.sha256(json.dumps(body).encode("utf-8")).hexdigest()
+
+    def diff(self, a: Dict[str, List[str]], b: Dict[str, List[str]]) -> Dict[str, Any]:
+        """diff_listings(a, b), with each changed function's diff looked up in or added to the cache."""
+        functions = []
+        for name in _function_order(a, b):
+            old, new = a.get(name), b.get(name)
+            if old is None or new is None or old == new:
+                functions.append(diff_function(name, old, new))  # nothing to search for
+                continue
+            da, db = self._digest(old), self._digest(new)
+            # One entry per unordered pair; the other direction is derived.
+            flipped = db < da
+            key = hashlib.sha256(f"{min(da, db)}:{max(da, db)}".encode("ascii")).hexdigest()
+            result = self._load(key)
+            if result is None:
+                result = diff_function(name, new, old) if flipped else diff_function(name, old, new)
+                self._store(key, result)
+            result = _reverse_function(result) if flipped else result
+            functions.append({**result, "name": name})
+        return {
+            "identical": all(f["status"] == "same" for f in functions),
+            "functions": functions,
+        }
+
+    def _load(self, key: str) -> Optional[Dict[str, Any]]:
+        if self.directory is None:
+            return None
+        try:
+            return json.loads((self.directory / f"{key}.json").read_text(encoding="utf-8"))
+        except (OSError, ValueError):
+            return None
+
+    def _store(self, key: str, result: Dict[str, Any]) -> None:
+        if self.directory is None:
+            return
+        fd, tmp = tempfile.mkstemp(dir=self.directory, suffix=".tmp")
+        with os.fdopen(fd, "w", encoding="utf-8") as f:
+            json.dump(result, f, separators=(",", ":"))
+        os.replace(tmp, self.directory / f"{key}.json")
+
+
+__all__ = [
+    "DiffCache",
+    "diff_function",
+    "diff_listings",
+    "myers_diff",
+    "normalize_function",
+    "normalize_listing",
+    "reverse_diff",
+    "unified_hunks",
+]
@@ -0,0 +1,419 @@
+# Copyright (c) 2026 Larry H <l.gr [at] dartmouth [dot] edu>
+# SPDX-License-Identifier: AGPL-3.0-or-later
+#
+# Compiler Optimization Gallery
+# Developed for COSC-69.16: Basics of Reverse Engineering
+# Dartmouth College, Winter 2026
+
+"""
+ce_baseline.py
+
+Codegen regression tracking across compiler bumps. A baseline is a
+snapshot of every cell's ``.metrics.json`` and ``.bench.json`` (sweep-defines
+variants left out), kept in the repository next to config.yaml:
+
+    {"version": 1,
+     "compilers": {"cg152": {"family": "gcc", "instruction_set": "amd64"}},
+     "cells": {"cg152/O2/loops/unrollme-1": {
+         "instructions": 42, "bytes": 128, "bytes_exact": false, "simd": "sse",
+         "functions": {"sum_array": {"instructions": 11, "simd": "sse"}},
+         "bench": {"sum_array/1024": 212.4}}}}
+
+Comparing a later output tree against it reports, per cell, the growth of
+its instruction count and code size, the benchmarks that got slower, and
+the functions that used vector instructions and no longer do. Thresholds
+come from an optional ``regressions`` mapping in config.yaml:
+
+    regressions:
+      instructions: 10          # percent growth of a cell's instructions
+      bytes: 10                 # ... of its code size
+      bench_ns: 15              # ... of a benchmark's ns/op
+      vectorization: true       # vectorized function went scalar
+      overrides:                # globs over source keys; first match wins
+        "simd/*": {instructions: 5}
+
+A baseline compiler missing from the new tree is compared with the new
+compiler of the same family and instruction set, if there is exactly one
+(``cg152`` with the ``cg160`` it was bumped to); ``--map OLD=NEW`` says so
+explicitly. From the command line:
+
+    python3 ce_baseline.py snapshot --out output             # writes docs/baseline.json
+    python3 ce_baseline.py compare --out output --config docs/config.yaml
+
+compare exits with status 1 if anything regressed, so it can gate CI;
+build_book.py ``--baseline`` renders the same comparison as the book's
+Regressions page. Only depends on the standard library (and PyYAML for
+``--config``).
+"""
+
+from __future__ import annotations
+
+import argparse
+import fnmatch
+import json
+import time
+from dataclasses import dataclass, field
+from pathlib import Path
+from typing import Any, Dict, List, Optional, Sequence, Tuple
+
+from ce_manifest import read_manifest, scan_cells
+from ce_remarks import compiler_family
+from ce_search import page_path
+from ce_store import open_outputs_for_reading
+
+BASELINE_VERSION = 1
+
+DEFAULT_BASELINE = Path("docs/baseline.json")
+
+METRICS = ("instructions", "bytes", "bench_ns")
+
+DEFAULT_LIMITS = {"instructions": 10.0, "bytes": 10.0, "bench_ns": 15.0}
+
+# Smallest absolute changes reported, so a three-instruction cell growing by
+# one is not a 33% regression.
+MIN_CHANGE = {"instructions": 2, "bytes": 8, "bench_ns": 0.5}
+
+
+class RegressionError(ValueError):
+    pass
+
+
+@dataclass(frozen=True)
+class Thresholds:
+    limits: Dict[str, float] = field(default_factory=lambda: dict(DEFAULT_LIMITS))
+    vectorization: bool = True
+    overrides: Tuple[Tuple[str, Dict[str, float]], ...] = ()
+
+    def limits_for(self, source: str) -> Dict[str, float]:
+        for glob, limits in self.overrides:
+            if fnmatch.fnmatchcase(source, glob):
+                return {**self.limits, **limits}
+        return self.limits
+
+
+def _parse_limits(raw: Any, where: str) -> Dict[str, float]:
+    if not isinstance(raw, dict):
+        raise RegressionError(f"{where} must be a mapping of metric to percent")
+    limits = {}
+    for metric, value in raw.items():
+        if metric not in METRICS:
+            raise RegressionError(f"{where}: unknown metric {metric!r} (expected one of {', '.join(METRICS)})")
+        if isinstance(value, bool) or not isinstance(value, (int, float)) or value <= 0:
+            raise RegressionError(f"{where}: '{metric}' must be a positive percentage")
+        limits[metric] = float(value)
+    return limits
+
+
+def load_thresholds(config: Dict[str, Any]) -> Thresholds:
+    """Parse the config's ``regressions`` mapping (missing: the defaults)."""
+    raw = config.get("regressions")
+    if raw is None:
+        return Thresholds()
+    if not isinstance(raw, dict):
+        raise RegressionError("'regressions' must be a mapping")
+    raw = dict(raw)
+    overrides_raw = raw.pop("overrides", None) or {}
+    if not isinstance(overrides_raw, dict):
+        raise RegressionError("'regressions.overrides' must be a mapping of source glob to thresholds")
+    vectorization = raw.pop("vectorization", True)
+    if not isinstance(vectorization, bool):
+        raise RegressionError("'regressions.vectorization' must be true or false")
+    overrides = tuple(
+        (str(glob), _parse_limits(limits, f"regressions.overrides[{glob!r}]"))
+        for glob, limits in overrides_raw.items()
+    )
+    return Thresholds(
+        limits={**DEFAULT_LIMITS, **_parse_limits(raw, "regressions")},
+        vectorization=vectorization,
+        overrides=overrides,
+    )
+
+
+def _load_json(text: Optional[str]) -> Any:
+    try:
+        return json.loads(text) if text else None
+    except ValueError:
+        return None
+
+
+def snapshot(root: Path, use_manifest: bool = True) -> Dict[str, Any]:
+    """The baseline of an output tree: the metrics and benchmarks of its cells."""
+    outputs = open_outputs_for_reading(root)
+    compilers: Dict[str, Dict[str, Any]] = {}
+    cells: Dict[str, Dict[str, Any]] = {}
+    try:
+        entries = read_manifest(outputs) if use_manifest else None
+        if entries is None:
+            entries = scan_cells(outputs)
+        for cell_key, entry in sorted(entries.items()):
+            if ".metrics.json" not in entry.get("files", ()) or "@" in cell_key.rpartition("/")[2]:
+                continue
+            if cell_key.count("/") < 2:
+                continue
+            metrics = _load_json(outputs.read_text(f"{cell_key}.metrics.json"))
+            if not isinstance(metrics, dict) or not isinstance(metrics.get("total"), dict):
+                continue
+            total = metrics["total"]
+            cell: Dict[str, Any] = {
+                "instructions": total.get("instructions"),
+                "bytes": total.get("bytes"),
+                "bytes_exact": bool(metrics.get("bytes_exact")),
+                "simd": total.get("simd"),
+                "functions": {
+                    f["name"]: {"instructions": f.get("instructions"), "simd": f.get("simd")}
+                    for f in metrics.get("functions", []) if f.get("name")
+                },
+            }
+            bench = _load_json(outputs.read_text(f"{cell_key}.bench.json")) if ".bench.json" in entry.get("files", ()) else None
+            runs = {
+                f"{r.get('function')}/{r.get('n')}": float(r["ns_per_op"])
+                for r in (bench or {}).get("results", [])
+                if isinstance(r.get("ns_per_op"), (int, float)) and r["ns_per_op"] > 0
+            }
+            if runs:
+                cell["bench"] = dict(sorted(runs.items()))
+            cells[cell_key] = cell
+            compiler_id = cell_key.split("/", 1)[0]
+            compilers.setdefault(compiler_id, {
+                "family": compiler_family(compiler_id),
+                "instruction_set": metrics.get("instruction_set"),
+            })
+    finally:
+        outputs.close()
+    return {
+        "version": BASELINE_VERSION,
+        "created": time.strftime("%Y-%m-%dT%H:%M:%SZ", time.gmtime()),
+        "compilers": dict(sorted(compilers.items())),
+        "cells": cells,
+    }
+
+
+def load_baseline(path: Path) -> Dict[str, Any]:
+    """A written baseline; raises ValueError for one of another version."""
+    data = json.loads(Path(path).read_text(encoding="utf-8"))
+    if not isinstance(data, dict) or data.get("version") != BASELINE_VERSION or not isinstance(data.get("cells"), dict):
+        raise ValueError(f"{path}: not a version {BASELINE_VERSION} baseline, take a new snapshot")
+    return data
+
+
+def write_baseline(path: Path, data: Dict[str, Any]) -> None:
+    path = Path(path)
+    path.parent.mkdir(parents=True, exist_ok=True)
+    path.write_text(json.dumps(data, indent=1, sort_keys=True) + "\n", encoding="utf-8")
+
+
+def map_compilers(
+    baseline: Dict[str, Any], current: Dict[str, Any], explicit: Optional[Dict[str, str]] = None,
+) -> Dict[str, str]:
+    """
+    The current compiler each baseline compiler is compared with: the one
+    given in *explicit*, else itself, else the only new compiler of the same
+    family and instruction set. Compilers without one are left out.
+    """
+    old, new = baseline.get("compilers", {}), current.get("compilers", {})
+    mapping: Dict[str, str] = {}
+    for compiler_id in old:
+        if explicit and compiler_id in explicit:
+            mapping[compiler_id] = explicit[compiler_id]
+        elif compiler_id in new:
+            mapping[compiler_id] = compiler_id
+    added = [c for c in new if c not in old and c not in mapping.values()]
+    for compiler_id, info in old.items():
+        if compiler_id in mapping:
+            continue
+        candidates = [
+            c for c in added
+            if new[c].get("family") == info.get("family") and new[c].get("instruction_set") == info.get("instruction_set")
+        ]
+        if len(candidates) == 1:
+            mapping[compiler_id] = candidates[0]
+            added.remove(candidates[0])
+    return dict(sorted(mapping.items()))
+
+
+def _change(before: float, after: float) -> Optional[float]:
+    return (after - before) / before * 100.0 if before else None
+
+
+def compare(
+    baseline: Dict[str, Any],
+    current: Dict[str, Any],
+    thresholds: Optional[Thresholds] = None,
+    explicit: Optional[Dict[str, str]] = None,
+) -> Dict[str, Any]:
+    """
+    The regressions and improvements of *current* against *baseline*, one
+    row per cell and metric: {"cell", "page", "source", "scenario",
+    "compiler", "baseline_compiler", "metric", "function", "baseline",
+    "current", "change_pct"}, worst first. ``missing`` and ``new`` list the
+    cells only one side has, after mapping the compilers.
+    """
+    thresholds = thresholds or Thresholds()
+    mapping = map_compilers(baseline, current, explicit)
+    regressions: List[Dict[str, Any]] = []
+    improvements: List[Dict[str, Any]] = []
+    missing: List[str] = []
+    compared: set = set()
+
+    for old_key, before in sorted(baseline["cells"].items()):
+        old_compiler, rest = old_key.split("/", 1)
+        if old_compiler not in mapping:
+            missing.append(old_key)
+            continue
+        cell_key = f"{mapping[old_compiler]}/{rest}"
+        after = current["cells"].get(cell_key)
+        if after is None:
+            missing.append(old_key)
+            continue
+        compared.add(cell_key)
+        page, source, compiler_id, scenario = page_path(cell_key)
+        limits = thresholds.limits_for(source)
+
+        def row(metric: str, function: str, b: Any, a: Any, pct: Optional[float]) -> Dict[str, Any]:
+            return {
+                "cell": cell_key, "page": page, "source": source, "scenario": scenario,
+                "compiler": compiler_id, "baseline_compiler": old_compiler, "metric": metric,
+                "function": function, "baseline": b, "current": a,
+                "change_pct": round(pct, 1) if pct is not None else None,
+            }
+
+        def measure(metric: str, function: str, b: Any, a: Any) -> None:
+            if not isinstance(b, (int, float)) or not isinstance(a, (int, float)):
+                return
+            pct = _change(b, a)
+            if pct is None or abs(a - b) < MIN_CHANGE[metric] or abs(pct) <= limits[metric]:
+                return
+            (regressions if a > b else improvements).append(row(metric, function, b, a, pct))
+
+        measure("instructions", "", before.get("instructions"), after.get("instructions"))
+        # Estimated sizes are only comparable with estimates.
+        if before.get("bytes_exact") == after.get("bytes_exact"):
+            measure("bytes", "", before.get("bytes"), after.get("bytes"))
+        after_bench = after.get("bench", {})
+        for run, ns in sorted(before.get("bench", {}).items()):
+            if run in after_bench:
+                measure("bench_ns", run, ns, after_bench[run])
+        if thresholds.vectorization:
+            after_functions = after.get("functions", {})
+            for name, f in sorted(before.get("functions", {}).items()):
+                g = after_functions.get(name)
+                if g is None:
+                    continue
+                if f.get("simd") and not g.get("simd"):
+                    regressions.append(row("vectorization", name, f["simd"], "scalar", None))
+                elif g.get("simd") and not f.get("simd"):
+                    improvements.append(row("vectorization", name, "scalar", g["simd"], None))
+
+    def severity(r: Dict[str, Any]) -> Tuple:
+        return (r["metric"] != "vectorization", -abs(r["change_pct"] or 0), r["scenario"], r["source"], r["function"])
+
+    regressions.sort(key=severity)
+    improvements.sort(key=severity)
+    mapped = set(mapping.values())
+    return {
+        "baseline_created": baseline.get("created"),
+        "compilers": mapping,
+        "compared": len(compared),
+        "missing": missing,
+        "new": sorted(k for k in current["cells"] if k not in compared and k.split("/", 1)[0] in mapped),
+        "thresholds": {
+            "limits": thresholds.limits, "vectorization": thresholds.vectorization,
+            "overrides": [[glob, limits] for glob, limits in thresholds.overrides],
+        },
+        "regressions": regressions,
+        "improvements": improvements,
+    }
+
+
+def describe(row: Dict[str, Any]) -> str:
+    """One line for a regression or improvement row."""
+    where = f"{row['compiler']} {row['scenario']} {row['source']}"
+    if row["compiler"] != row["baseline_compiler"]:
+        where += f" (was {row['baseline_compiler']})"
+    if row["metric"] == "vectorization":
+        return f"{where}: {row['function']} {row['baseline']} -> {row['current']}"
+    what = row["metric"] + (f" {row['function']}" if row["function"] else "")
+    return f"{where}: {what} {row['baseline']:g} -> {row['current']:g} ({row['change_pct']:+.1f}%)"
+
+
+def _parse_map(items: Sequence[str]) -> Dict[str, str]:
+    mapping = {}
+    for item in items:
+        old, sep, new = item.partition("=")
+        if not sep or not old or not new:
+            raise SystemExit(f"ce_baseline: --map expects OLD=NEW, got {item!r}")
+        mapping[old] = new
+    return mapping
+
+
+def main() -> int:
+    ap = argparse.ArgumentParser(description="Snapshot the gallery's codegen metrics and report regressions against them")
+    sub = ap.add_subparsers(dest="command", required=True)
+    snap = sub.add_parser("snapshot", help="Write the baseline of an output tree")
+    cmp_ = sub.add_parser("compare", help="Compare an output tree with a baseline (exit 1 on regressions)")
+    for p in (snap, cmp_):
+        p.add_argument("--out", type=Path, default=Path("output"), help="Output directory of ce_batch.py (default: output/)")
+        p.add_argument("--baseline", type=Path, default=DEFAULT_BASELINE, help=f"Baseline file (default: {DEFAULT_BASELINE})")
+        p.add_argument("--no-manifest", action="store_true", help="Find cells by walking the tree instead of reading its manifest.json")
+    cmp_.add_argument("--config", type=Path, default=None, help="config.yaml with a 'regressions' mapping of thresholds")
+    cmp_.add_argument("--map", action="append", default=[], metavar="OLD=NEW", help="Compare baseline compiler OLD with NEW (repeatable)")
+    cmp_.add_argument("--improvements", action="store_true", help="Also list what got better")
+    cmp_.add_argument("--json", action="store_true", help="Print the comparison as JSON")
+    args = ap.parse_args()
+
+    current = snapshot(args.out, use_manifest=not args.no_manifest)
+    if args.command == "snapshot":
+        if not current["cells"]:
+            raise SystemExit(f"ce_baseline: no .metrics.json in {args.out}")
+        write_baseline(args.baseline, current)
+        print(f"Baseline of {len(current['cells'])} cells ({', '.join(current['compilers'])}) written to {args.baseline}")
+        return 0
+
+    try:
+        baseline = load_baseline(args.baseline)
+        config: Dict[str, Any] = {}
+        if args.config is not None:
+            import yaml
+            config = yaml.safe_load(args.config.read_text(encoding="utf-8")) or {}
+        thresholds = load_thresholds(config)
+    except (OSError, ValueError) as e:
+        raise SystemExit(f"ce_baseline: {e}") from e
+    result = compare(baseline, current, thresholds, _parse_map(args.map))
+
+    if args.json:
+        print(json.dumps(result, indent=2))
+        return 1 if result["regressions"] else 0
+    mapped = ", ".join(f"{old} -> {new}" for old, new in result["compilers"].items() if old != new)
+    if mapped:
+        print(f"Compilers: {mapped}")
+    for r in result["regressions"]:
+        print(f"REGRESSED  {describe(r)}")
+    if args.improvements:
+        for r in result["improvements"]:
+            print(f"IMPROVED   {describe(r)}")
+    print(
+        f"\n{len(result['regressions'])} regressions, {len(result['improvements'])} improvements in "
+        f"{result['compared']} cells ({len(result['missing'])} missing, {len(result['new'])} new)"
+    )
+    return 1 if result["regressions"] else 0
+
+
+__all__ = [
+    "BASELINE_VERSION",
+    "DEFAULT_BASELINE",
+    "DEFAULT_LIMITS",
+    "METRICS",
+    "RegressionError",
+    "Thresholds",
+    "compare",
+    "describe",
+    "load_baseline",
+    "load_thresholds",
+    "map_compilers",
+    "snapshot",
+    "write_baseline",
+]
+
+
+if __name__ == "__main__":
+    raise SystemExit(main())
@@ -38,9 +38,24 @@ Behavior:
             <stem>.compile.request.json
             <stem>.compile.response.json
             <stem>.asm
+            <stem>.metrics.json     # per-function instruction/size metrics (see ce_metrics.py)
             <stem>.explain.request.json
             <stem>.explain.response.json
             <stem>.explain.md
+            <stem>.bench.json       # with --bench, for sources declaring benchmarks (see ce_bench.py)
+            <stem>.remarks.json     # vectorization/loop remarks, with --remarks or 'remarks: yes' hints (see ce_remarks.py)
+            <stem>.consttime.json   # static constant-time check, for sources with a 'constant-time' hint (see ce_consttime.py)
+            <stem>.dudect.json      # with --bench, the timing test of those functions
+            <stem>.overhead.json    # code size without the hardening flags, for sources with an 'overhead' hint (see ce_overhead.py)
+            <stem>.mca.json         # llvm-mca throughput estimates, for sources with a 'throughput' hint (see ce_mca.py)
+            <stem>.pgo.json         # the training run of a 'pgo: true' scenario's profile (see ce_pgo.py)
+            <stem>.files.json       # the other translation units of a multi-file example ('files' hint)
+            <stem>.compiletime.json # compile wall time; passes with --time-report (see ce_compiletime.py)
+            <stem>@N=1024.*         # 'sweep-defines' variants: compile, metrics and bench outputs, no explanation
+      .cache/                       # local response cache (see ce_cache.py)
+      .journal.jsonl                # completed cells, for --resume (see ce_journal.py)
+      manifest.json                 # every cell and its files, so build_book.py needs no tree walk (see ce_manifest.py)
+      gallery.sqlite                # with --store packed|both: all cell outputs in one file (see ce_store.py)
 
 Requirements:
 - pyyaml: pip install pyyaml
@@ -50,130 +65,267 @@ Requirements:
 from __future__ import annotations
 
 import argparse
+import dataclasses
+import os
 import sys
+import threading
 import time
+from collections import deque
 from dataclasses import dataclass
 from pathlib import Path
-from typing import Any, Dict, List, Optional, Set, Tuple
+from typing import Any, Deque, Dict, List, Optional, Sequence, Set, Tuple
 
 try:
     import yaml  # type: ignore
 except Exception as e:
     raise SystemExit("Missing dependency: pyyaml. Install with: pip install pyyaml") from e
 
-from ce_client import CompilerExplorerClient, CEError, ProgressInfo, process_source_tree
+from ce_bench import BenchSpecError, bench_cell, dudect_cell, training_build, training_driver
+from ce_budget import (
+    METRICS,
+    BudgetError,
+    UsageTracker,
+    budget_warning_lines,
+    explain_tokens,
+    load_budgets,
+    payload_size,
+    report_lines,
+)
+from ce_cache import ResultCache
+from ce_catalog import CATALOG_FILE, DEFAULT_TTL_HOURS, CompilerCatalog
+from ce_equivalence import EquivalenceError, load_equivalences, uses_floating_point
+from ce_export import export_format, export_matrix
+from ce_client import (
+    CellContext,
+    CompiledCell,
+    CompilerExplorerClient,
+    CEError,
+    ExplainDeduper,
+    ProgressInfo,
+    _stable_hash,
+    _write_json,
+    cell_flags,
+    companion_owners,
+    companion_paths,
+    compile_cell_group,
+    define_variants,
+    explain_cell,
+    link_explanation,
+    list_source_files,
+    load_compiled_cell,
+    parse_gallery_hints,
+    read_companions,
+)
+from ce_incremental import (
+    cell_is_stale,
+    changed_sources_since,
+    remove_cell_outputs,
+    remove_variant_outputs,
+    source_category,
+    source_key,
+)
+from ce_journal import JobJournal
+from ce_local import LocalCompiler, RoutingCompiler, load_local_toolchains
+from ce_manifest import OutputManifest
+from ce_metrics import cell_metrics, detect_instruction_set
+from ce_pgo import TrainedProfile, pgo_supported, train_cell
+from ce_pipeline import TwoStagePipeline
+from ce_priority import PriorityError, load_priorities, source_ages
+from ce_telemetry import Telemetry
+from ce_sweep import Sweep, SweepError, SweepPoint, asm_fingerprint, expand_sweeps, prune_points, sweep_record_key
+from ce_ratelimit import RetryPolicy
+from ce_store import PACKED_NAME, open_outputs
+from ce_transport import make_transport
 
 
 @dataclass(frozen=True)
 class Scenario:
     name: str
     flags: str
+    sweep: Optional[SweepPoint] = None  # set for points of a flag sweep (see ce_sweep.py)
+    sweep_spec: Optional[Sweep] = None
+    pgo: bool = False  # compile with a profile from the benchmark driver (see ce_pgo.py)
+    multi_file: bool = False  # only for multi-file examples, e.g. -flto (see ce_local.py)
+
+    def applies_to(self, compiler_id: str, source: str) -> bool:
+        return self.sweep_spec is None or self.sweep_spec.applies_to(compiler_id, source)
+
+
+def _fmt_duration(seconds: float) -> str:
+    if seconds < 60:
+        return f"{int(seconds)}s"
+    elif seconds < 3600:
+        return f"{int(seconds // 60)}m {int(seconds % 60)}s"
+    else:
+        return f"{int(seconds // 3600)}h {int((seconds % 3600) // 60)}m"
+
+
+class StepModel:
+    """
+    Running latency estimate for one (compiler, step): separate moving
+    averages for cached and uncached steps, weighted by the hit rate so far.
+    """
+
+    ALPHA = 0.2  # weight of the newest sample
+    WINDOW = 200  # samples kept for tail latency
+
+    def __init__(self) -> None:
+        self.hit_s: Optional[float] = None
+        self.miss_s: Optional[float] = None
+        self.hits = 0
+        self.misses = 0
+        self.recent: Deque[float] = deque(maxlen=self.WINDOW)
+
+    def record(self, seconds: float, cached: bool) -> None:
+        if cached:
+            self.hits += 1
+            self.hit_s = seconds if self.hit_s is None else self.hit_s + self.ALPHA * (seconds - self.hit_s)
+        else:
+            self.misses += 1
+            self.miss_s = seconds if self.miss_s is None else self.miss_s + self.ALPHA * (seconds - self.miss_s)
+        self.recent.append(seconds)
+
+    @property
+    def samples(self) -> int:
+        return self.hits + self.misses
+
+    def expected(self) -> Optional[float]:
+        """Expected seconds for the next step, or None before the first sample."""
+        if not self.samples:
+            return None
+        hit_rate = self.hits / self.samples
+        return hit_rate * (self.hit_s or 0.0) + (1 - hit_rate) * (self.miss_s or 0.0)
+
+    def percentile(self, q: float) -> float:
+        xs = sorted(self.recent)
+        return xs[min(len(xs) - 1, int(q * len(xs)))]
 
 
 class ProgressTracker:
-    """Tracks progress and calculates ETA based on rolling average."""
+    """
+    Tracks progress and estimates the time left from per-(compiler, step)
+    latency models (see StepModel).
+
+    *planned* counts the compile and explain steps of every compiler the run
+    will do; *workers* is the pool size of each step. Work left for a step is
+    the sum over compilers of steps left times their expected latency,
+    divided by the pool size; the two stages overlap, so the ETA is the
+    larger of the two. A compiler without samples yet borrows the mean of
+    the others for that step.
+    """
+
+    STEPS = ("compile", "explain")
 
-    def __init__(self, total_operations: int):
-        self.total = total_operations
+    def __init__(self, planned: Dict[Tuple[str, str], int], workers: Dict[str, int]):
+        self.planned = dict(planned)
+        self.workers = {step: max(1, workers.get(step, 1)) for step in self.STEPS}
         self.completed = 0
         self.start_time = time.time()
-        self.step_times: List[float] = []
-        self.last_step_time = self.start_time
-        self.max_samples = 20  # Rolling average window
-
-    def record_step(self) -> None:
-        """Record completion of a step (compile or explain)."""
-        now = time.time()
-        elapsed = now - self.last_step_time
-        self.step_times.append(elapsed)
-        if len(self.step_times) > self.max_samples:
-            self.step_times.pop(0)
-        self.last_step_time = now
+        self.models: Dict[Tuple[str, str], StepModel] = {}
+        self.done: Dict[Tuple[str, str], int] = {}
+        self._lock = threading.Lock()
+
+    def record(self, compiler_id: str, step: str, seconds: float, cached: bool = False) -> None:
+        """Record one finished step of *compiler_id*."""
+        with self._lock:
+            key = (compiler_id, step)
+            model = self.models.get(key)
+            if model is None:
+                model = self.models[key] = StepModel()
+            model.record(seconds, cached)
+            self.done[key] = self.done.get(key, 0) + 1
+
+    def skip(self, compiler_id: str, step: str, count: int = 1) -> None:
+        """A planned step that will not run (e.g. a pruned sweep cell's explain)."""
+        with self._lock:
+            key = (compiler_id, step)
+            self.planned[key] = self.planned.get(key, 0) - count
+
+    def add(self, compiler_id: str, step: str, count: int = 1) -> None:
+        """A step the plan did not count that will run (e.g. an equivalent cell that did not match)."""
+        self.skip(compiler_id, step, -count)
 
     def increment(self) -> None:
         """Increment completed count (after both compile + explain for a file)."""
-        self.completed += 1
+        with self._lock:
+            self.completed += 1
+
+    def _estimate(self, compiler_id: str, step: str) -> Optional[float]:
+        model = self.models.get((compiler_id, step))
+        if model is not None and model.samples:
+            return model.expected()
+        others = [m.expected() for (_, s), m in self.models.items() if s == step and m.samples]
+        return sum(others) / len(others) if others else None  # type: ignore[arg-type]
+
+    def remaining_seconds(self) -> Optional[float]:
+        with self._lock:
+            per_step = []
+            for step in self.STEPS:
+                work = 0.0
+                for (compiler_id, s), n in self.planned.items():
+                    left = n - self.done.get((compiler_id, s), 0)
+                    if s != step or left <= 0:
+                        continue
+                    estimate = self._estimate(compiler_id, step)
+                    if estimate is None:
+                        return None
+                    work += left * estimate
+                per_step.append(work / self.workers[step])
+        return max(per_step)
 
     def get_eta_str(self) -> str:
-        """Calculate ETA based on average step time."""
-        if not self.step_times:
-            return "calculating..."
-
-        avg_step_time = sum(self.step_times) / len(self.step_times)
-        # Each file has 2 steps (compile + explain)
-        remaining_files = self.total - self.completed
-        remaining_steps = remaining_files * 2
-        remaining_seconds = avg_step_time * remaining_steps
-
-        if remaining_seconds < 60:
-            return f"{int(remaining_seconds)}s"
-        elif remaining_seconds < 3600:
-            mins = int(remaining_seconds // 60)
-            secs = int(remaining_seconds % 60)
-            return f"{mins}m {secs}s"
-        else:
-            hours = int(remaining_seconds // 3600)
-            mins = int((remaining_seconds % 3600) // 60)
-            return f"{hours}h {mins}m"
+        remaining = self.remaining_seconds()
+        return "calculating..." if remaining is None else _fmt_duration(remaining)
 
     def get_elapsed_str(self) -> str:
         """Get elapsed time string."""
+        return _fmt_duration(time.time() - self.start_time)
+
+    def cells_per_minute(self) -> float:
         elapsed = time.time() - self.start_time
-        if elapsed < 60:
-            return f"{int(elapsed)}s"
-        elif elapsed < 3600:
-            mins = int(elapsed // 60)
-            secs = int(elapsed % 60)
-            return f"{mins}m {secs}s"
-        else:
-            hours = int(elapsed // 3600)
-            mins = int((elapsed % 3600) // 60)
-            return f"{hours}h {mins}m"
-
-
-def detect_instruction_set(compiler_id: str) -> str:
-    """Detect instruction set architecture from compiler ID."""
-    cid = compiler_id.lower()
-
-    if "avr" in cid:
-        return "avr"
-    if "arm64" in cid or "aarch64" in cid or "armv8" in cid:
-        return "aarch64"
-    if "arm" in cid:
-        return "arm32"
-    if "mips64" in cid:
-        return "mips64"
-    if "mips" in cid:
-        return "mips"
-    if "sparc64" in cid:
-        return "sparc64"
-    if "sparc" in cid:
-        return "sparc"
-    if "riscv64" in cid or "rv64" in cid:
-        return "riscv64"
-    if "riscv" in cid or "rv32" in cid:
-        return "riscv32"
-    if "powerpc64" in cid or "ppc64" in cid:
-        return "powerpc64"
-    if "powerpc" in cid or "ppc" in cid:
-        return "powerpc"
-    if "x86" in cid or "i386" in cid or "i686" in cid:
-        return "x86"
-    # Default to amd64 for most x86-64 compilers (gcc, clang, msvc, mingw)
-    return "amd64"
+        with self._lock:
+            return self.completed / elapsed * 60 if elapsed > 0 else 0.0
+
+    def tail_latency(self, step: str, q: float = 0.95) -> Optional[float]:
+        """*q*-th percentile of recent *step* latencies over all compilers."""
+        with self._lock:
+            xs = sorted(x for (_, s), m in self.models.items() if s == step for x in m.recent)
+        return xs[min(len(xs) - 1, int(q * len(xs)))] if xs else None
+
+    def summary_lines(self) -> List[str]:
+        """One line per (compiler, step) model, for the end-of-run report."""
+        with self._lock:
+            items = sorted(self.models.items())
+            lines = []
+            for (compiler_id, step), m in items:
+                mean = sum(m.recent) / len(m.recent)
+                lines.append(
+                    f"  {compiler_id} {step}: n={m.samples} mean {mean:.2f}s p95 {m.percentile(0.95):.2f}s "
+                    f"max {max(m.recent):.2f}s, {m.hits / m.samples * 100:.0f}% cached"
+                )
+        return lines
 
 
 def format_progress(info: ProgressInfo, tracker: ProgressTracker) -> str:
-    """Format progress information for display."""
-    pct = (info.current / info.total * 100) if info.total > 0 else 0
+    """
+    Format progress information for display. The count is of finished
+    cells: units run in priority order and finish out of order, so a
+    cell's position in the plan says nothing about progress.
+    """
+    done = tracker.completed
+    pct = (done / info.total * 100) if info.total > 0 else 0
     eta = tracker.get_eta_str()
     elapsed = tracker.get_elapsed_str()
 
-    # [compiler][scenario][source] step (current/total) pct% | elapsed | ETA: eta
+    tails = [(step, tracker.tail_latency(step)) for step in ProgressTracker.STEPS]
+    tail = ", ".join(f"{step} {t:.1f}s" for step, t in tails if t is not None)
+
+    # [compiler][scenario][source] step (done/total) pct% | elapsed | ETA: eta | rate | p95
     return (
         f"[{info.compiler_id}][{info.scenario}][{info.source_file}] "
-        f"{info.step:7s} ({info.current}/{info.total}) {pct:5.1f}% | "
-        f"elapsed: {elapsed} | ETA: {eta}"
+        f"{info.step:7s} ({done}/{info.total}) {pct:5.1f}% | "
+        f"elapsed: {elapsed} | ETA: {eta} | {tracker.cells_per_minute():.0f} cells/min"
+        + (f" | p95 {tail}" if tail else "")
     )
 
 
@@ -185,8 +337,13 @@ def load_config_yaml(path: Path) -> Tuple[List[Scenario], List[str]]:
     scenarios_raw = obj.get("scenarios")
     compilers_raw = obj.get("compilers")
 
-    if not isinstance(scenarios_raw, dict) or not scenarios_raw:
-        raise CEError("YAML must contain non-empty 'scenarios' mapping")
+    try:
+        sweeps = expand_sweeps(obj.get("sweeps"))
+    except SweepError as e:
+        raise CEError(str(e)) from e
+
+    if not isinstance(scenarios_raw, dict) or not (scenarios_raw or sweeps):
+        raise CEError("YAML must contain non-empty 'scenarios' mapping (or 'sweeps')")
     if not isinstance(compilers_raw, list) or not compilers_raw:
         raise CEError("YAML must contain non-empty 'compilers' list")
 
@@ -199,7 +356,15 @@ def load_config_yaml(path: Path) -> Tuple[List[Scenario], List[str]]:
         flags = spec.get("flags")
         if not isinstance(flags, str):
             raise CEError(f"Scenario '{name}' must have string 'flags'")
-        scenarios.append(Scenario(name=name, flags=flags))
+        scenarios.append(Scenario(
+            name=name, flags=flags, pgo=bool(spec.get("pgo", False)), multi_file=bool(spec.get("multi_file", False)),
+        ))
+
+    for sweep in sweeps:
+        for point in sweep.points:
+            if point.name in scenarios_raw:
+                raise CEError(f"Sweep point '{point.name}' clashes with a scenario of the same name")
+            scenarios.append(Scenario(name=point.name, flags=point.flags, sweep=point, sweep_spec=sweep))
 
     compilers: List[str] = []
     for c in compilers_raw:
@@ -210,20 +375,20 @@ def load_config_yaml(path: Path) -> Tuple[List[Scenario], List[str]]:
     return scenarios, compilers
 
 
-def validate_compilers_exist(client: CompilerExplorerClient, requested: List[str]) -> Set[str]:
+def validate_compilers_exist(catalog: CompilerCatalog, requested: List[str]) -> Set[str]:
     """
-    Fetches /api/compilers and verifies requested IDs exist.
+    Verifies the requested IDs exist in the CE instance's compiler catalog
+    (see ce_catalog.py).
 
     Returns the set of valid compiler IDs (intersection). Raises if any are missing.
     """
     print("Validating compiler IDs...", end=" ", flush=True)
-    all_compilers = client.get_compilers()
-    all_ids: Set[str] = set()
-    for item in all_compilers:
-        if isinstance(item, dict) and isinstance(item.get("id"), str):
-            all_ids.add(item["id"])
-
+    all_ids = catalog.ids()
     missing = [c for c in requested if c not in all_ids]
+    if missing and catalog.source.startswith("cached"):
+        # The instance may have added them since the catalog was stored.
+        all_ids = catalog.ids(refresh=True)
+        missing = [c for c in requested if c not in all_ids]
     if missing:
         print("FAILED")
         raise CEError(
@@ -231,13 +396,17 @@ def validate_compilers_exist(client: CompilerExplorerClient, requested: List[str
             + "\n".join(f"  - {m}" for m in missing)
             + "\n\nCheck the instance's /api/compilers output or use a different --ce-base-url."
         )
-    print(f"OK ({len(requested)} compilers)")
+    print(f"OK ({len(requested)} compilers, {catalog.source})")
     return set(requested)
 
 
-def count_source_files(src_root: Path, extensions: Tuple[str, ...]) -> int:
-    """Count the total number of source files to process."""
-    return len([p for p in src_root.rglob("*") if p.is_file() and p.suffix in extensions])
+def cell_fingerprint(src_text: str, effective_flags: str, companions: Sequence[Dict[str, str]] = ()) -> str:
+    """
+    Journal fingerprint: a cell's outputs are reusable while this is unchanged.
+    *companions* are a multi-file example's other files (read_companions).
+    """
+    parts = [effective_flags, src_text] + [f"{c['filename']}\0{c['contents']}" for c in companions]
+    return _stable_hash("\0".join(parts))
 
 
 def write_top_index_readme(out_root: Path, scenarios: List[Scenario], compilers: List[str]) -> None:
@@ -286,15 +455,171 @@ def main() -> int:
     ap.add_argument("--audience", default="beginner", choices=["beginner", "experienced"])
     ap.add_argument("--explain-type", default="assembly", choices=["assembly", "haiku"])
     ap.add_argument("--sleep", type=float, default=0.0, help="Sleep between files (seconds)")
+    ap.add_argument(
+        "--no-priority",
+        action="store_true",
+        help="Work through sources in path order instead of by the config's priorities and recent changes",
+    )
+    ap.add_argument(
+        "--time-limit",
+        type=float,
+        default=None,
+        metavar="MINUTES",
+        help="Stop starting new work after MINUTES; finished cells are kept and --resume picks up the rest",
+    )
+    ap.add_argument(
+        "--backend",
+        choices=["ce", "local", "auto"],
+        default="ce",
+        help="Where to compile: Compiler Explorer, the local toolchains in the config's local_compilers, "
+        "or local where available and CE otherwise",
+    )
+    ap.add_argument(
+        "--jobs", "-j",
+        type=int,
+        default=None,
+        help="Number of concurrent compile workers (default: 1, or the CPU count with a local backend)",
+    )
+    ap.add_argument(
+        "--explain-jobs",
+        type=int,
+        default=None,
+        help="Number of concurrent explain workers (default: same as --jobs for CE, --max-per-host for local)",
+    )
+    ap.add_argument("--max-per-host", type=int, default=4, help="Maximum in-flight requests per host (CE and Explain each)")
+    ap.add_argument("--rate", type=float, default=4.0, help="Initial request rate per host (requests/second)")
+    ap.add_argument("--max-rate", type=float, default=20.0, help="Ceiling the adaptive rate may climb to (requests/second)")
+    ap.add_argument("--max-retries", type=int, default=5, help="Retries for 429/5xx responses and connection errors")
+    ap.add_argument(
+        "--transport",
+        choices=["auto", "requests", "httpx"],
+        default="auto",
+        help="HTTP transport: httpx multiplexes over HTTP/2, requests uses HTTP/1.1 keep-alive (auto: httpx if installed)",
+    )
+    ap.add_argument("--no-compress", action="store_true", help="Never gzip request bodies")
     ap.add_argument("--bypass-compile-cache", type=int, default=0, help="0/1/2 bypassCache enum for CE compile")
     ap.add_argument("--bypass-explain-cache", action="store_true", help="Bypass Explain caches")
+    ap.add_argument("--cache-dir", default=None, help="Local response cache directory (default: <out>/.cache)")
+    ap.add_argument("--no-cache", action="store_true", help="Disable the local response cache")
+    ap.add_argument(
+        "--cache-max-age",
+        type=float,
+        default=30.0,
+        metavar="DAYS",
+        help="At the end of the run, drop cache entries not read or written for DAYS days (default: 30; 0: keep all)",
+    )
+    ap.add_argument(
+        "--catalog-ttl",
+        type=float,
+        default=DEFAULT_TTL_HOURS,
+        metavar="HOURS",
+        help=f"Reuse the stored CE compiler list for this long before revalidating it (default: {DEFAULT_TTL_HOURS:g}; "
+        "0 revalidates every run)",
+    )
+    ap.add_argument(
+        "--store",
+        choices=["files", "packed", "both"],
+        default="files",
+        help=f"Where cell outputs go: the per-cell file tree, one packed <out>/{PACKED_NAME}, or both",
+    )
     ap.add_argument(
         "--extensions",
         default=".c,.cc,.cpp,.cxx,.C,.h,.hpp",
         help="Comma-separated extensions to include",
     )
+    ap.add_argument(
+        "--changed-since",
+        metavar="REV",
+        default=None,
+        help="Only recompile sources that differ from git revision REV (plus uncommitted/untracked edits)",
+    )
+    ap.add_argument(
+        "--only-stale",
+        action="store_true",
+        help="Only recompile cells whose source is newer than their existing outputs",
+    )
+    stage = ap.add_mutually_exclusive_group()
+    stage.add_argument("--compile-only", action="store_true", help="Run only the compile stage; leave explanations untouched")
+    stage.add_argument(
+        "--explain-only",
+        action="store_true",
+        help="Run only the explain stage, re-reading existing .compile.response.json files (never recompiles)",
+    )
+    ap.add_argument(
+        "--bench",
+        action="store_true",
+        help="Also build and run the benchmark drivers declared in @gallery-hints (writes <stem>.bench.json), "
+        "and the timing test of 'constant-time' functions (<stem>.dudect.json); sources with an 'overhead' hint "
+        "are also benchmarked without their hardening flags",
+    )
+    ap.add_argument(
+        "--binary-object",
+        action="store_true",
+        help="Compile every cell to an object file and disassemble it: exact byte sizes and opcodes in the metrics "
+        "and diffs (the config's 'binary_object' list selects compilers otherwise)",
+    )
+    ap.add_argument(
+        "--bench-counters",
+        action="store_true",
+        help="With --bench, read perf_event_open hardware counters for every benchmark, not only those with 'bench-counters: yes' (Linux)",
+    )
+    ap.add_argument(
+        "--remarks",
+        action="store_true",
+        help="Capture vectorization/loop remarks for every cell, not just sources with 'remarks: yes' hints",
+    )
+    ap.add_argument(
+        "--time-report",
+        action="store_true",
+        help="Also compile every cell with -ftime-report (/Bt+ for MSVC) and keep its slowest passes in .compiletime.json",
+    )
+    ap.add_argument(
+        "--no-explain-dedup",
+        action="store_true",
+        help="Explain every cell, even when another cell has identical assembly and source",
+    )
+    ap.add_argument(
+        "--explain-functions",
+        action="store_true",
+        help="Explain each function of a listing on its own and cache it by its assembly, so editing one "
+        "function of a source only explains that function again",
+    )
+    ap.add_argument(
+        "--equivalence",
+        action="store_true",
+        help="Link cells of the config's equivalences (e.g. Ofast: O3) to their representative's explanation "
+        "when their assembly matches, instead of explaining them",
+    )
+    ap.add_argument(
+        "--resume",
+        action="store_true",
+        help="Skip cells the journal (<out>/.journal.jsonl) records as done whose outputs are intact",
+    )
+    ap.add_argument(
+        "--report-top",
+        type=int,
+        default=10,
+        metavar="N",
+        help="Print the N most expensive (file, compiler) pairs at the end of the run (0: none)",
+    )
+    ap.add_argument("--report-sort", choices=METRICS, default="bytes_sent", help="Column the cost report is ranked by")
+    ap.add_argument("--report-json", default=None, metavar="PATH", help="Also write every cost report row to PATH as JSON")
+    ap.add_argument(
+        "--export",
+        default=None,
+        metavar="PATH",
+        help="Write the whole result matrix, one row per function and cell, to PATH (.ndjson, .ndjson.gz or .parquet)",
+    )
+    ap.add_argument("--trace", default=None, metavar="PATH", help="Stream run events (stages, requests, cache lookups) to PATH as JSONL")
+    ap.add_argument("--chrome-trace", default=None, metavar="PATH", help="Write the run events as a Chrome/Perfetto trace to PATH")
+    ap.add_argument("--metrics-file", default=None, metavar="PATH", help="Write run metrics to PATH as an OpenMetrics text file")
     ap.add_argument("-q", "--quiet", action="store_true", help="Suppress progress output")
     args = ap.parse_args()
+    if args.export:
+        try:
+            export_format(Path(args.export))  # fail now, not after the whole run
+        except ValueError as e:
+            ap.error(str(e))
 
     yaml_path = Path(args.yaml)
     src_root = Path(args.src)
@@ -304,84 +629,630 @@ def main() -> int:
     print(f"Loading config from {yaml_path}...")
     scenarios, compilers = load_config_yaml(yaml_path)
     print(f"  {len(scenarios)} scenarios, {len(compilers)} compilers")
+    raw_config = yaml.safe_load(yaml_path.read_text(encoding="utf-8")) or {}
+    try:
+        budgets = load_budgets(raw_config)
+    except BudgetError as e:
+        raise CEError(str(e)) from e
+    try:
+        priorities = load_priorities(raw_config)
+    except PriorityError as e:
+        raise CEError(str(e)) from e
+    try:
+        equivalences = load_equivalences(raw_config, [sc.name for sc in scenarios if sc.sweep is None]) if args.equivalence else {}
+    except EquivalenceError as e:
+        raise CEError(str(e)) from e
+    if args.equivalence and not equivalences:
+        print(f"Warning: --equivalence given, but {yaml_path} has no equivalences")
+    binary_object = set(raw_config.get("binary_object") or [])
+    unknown = binary_object - set(compilers)
+    if unknown:
+        print(f"Warning: binary_object lists compilers not in the config: {', '.join(sorted(unknown))}")
+
+    # The cache lives inside the output tree by default so it travels with the
+    # compiled-output artifact between CI runs.
+    cache = None if args.no_cache else ResultCache(Path(args.cache_dir) if args.cache_dir else out_root / ".cache")
+    telemetry = Telemetry(Path(args.trace) if args.trace else None, keep_events=args.chrome_trace is not None)
 
     client = CompilerExplorerClient(
         ce_base_url=args.ce_base_url,
         explain_base_url=args.explain_base_url,
+        max_per_host=args.max_per_host,
+        cache=cache,
+        rate=args.rate,
+        max_rate=args.max_rate,
+        retry=RetryPolicy(max_retries=args.max_retries),
+        transport=make_transport(args.transport, args.max_per_host),
+        compress_requests=not args.no_compress,
+        telemetry=telemetry,
     )
+    print(f"Transport: {client.transport.name}")
+
+    # Local toolchains take the compiler IDs they are configured (and installed) for.
+    compiler_backend: Any = client
+    remote_compilers = compilers
+    if args.backend != "ce":
+        toolchains = load_local_toolchains(yaml.safe_load(yaml_path.read_text(encoding="utf-8")) or {})
+        local = LocalCompiler(toolchains, cache=cache)
+        local_ids = [c for c in compilers if local.handles(c)]
+        remote_compilers = [c for c in compilers if c not in local_ids]
+        if args.backend == "local" and remote_compilers:
+            raise CEError(
+                "No installed local toolchain for these compiler IDs (see local_compilers in the config):\n"
+                + "\n".join(f"  - {c}" for c in remote_compilers)
+                + "\n\nInstall them, drop them from the config, or use --backend auto."
+            )
+        compiler_backend = RoutingCompiler(local, client)
+        print(f"Local toolchains: {', '.join(local_ids) or 'none'}")
+
+    # PGO scenarios need a toolchain that runs the training program here.
+    pgo_compilers: Set[str] = set()
+    if any(sc.pgo for sc in scenarios):
+        if args.backend != "ce":
+            pgo_compilers = {c for c in compilers if local.can_execute(c) and pgo_supported(c)}
+        print(f"PGO scenarios: trained for {', '.join(sorted(pgo_compilers)) or 'no compiler (needs a local gcc or clang that runs here)'}")
+    # Multi-file examples link their translation units, which needs a local toolchain.
+    link_compilers: Set[str] = set(local_ids) if args.backend != "ce" else set()
+    pgo_baselines = {
+        sc.name: next((o.name for o in scenarios if not o.pgo and o.sweep is None and o.flags == sc.flags), None)
+        for sc in scenarios if sc.pgo
+    }
 
     # Validate compiler IDs exist on this CE instance.
-    validate_compilers_exist(client, compilers)
-
-    # Count total files for progress tracking
-    num_files = count_source_files(src_root, exts)
-    total_operations = num_files * len(compilers) * len(scenarios)
-    print(f"Found {num_files} source files")
-    print(f"Total: {total_operations} file compilations ({num_files} files x {len(compilers)} compilers x {len(scenarios)} scenarios)")
+    if remote_compilers:
+        catalog = CompilerCatalog(client, None if cache is None else cache.root / CATALOG_FILE, args.catalog_ttl * 3600)
+        validate_compilers_exist(catalog, remote_compilers)
+
+    jobs = args.jobs if args.jobs is not None else ((os.cpu_count() or 1) if args.backend != "ce" else 1)
+    explain_jobs = args.explain_jobs if args.explain_jobs is not None else (jobs if args.backend == "ce" else args.max_per_host)
+
+    src_root_resolved = src_root.resolve()
+    if not src_root_resolved.is_dir():
+        raise CEError(f"src_root does not exist or is not a directory: {src_root_resolved}")
+    files = list_source_files(src_root_resolved, exts)
+    # The other files of multi-file examples are compiled with their example, not on their own.
+    owners = companion_owners(files)
+    files = [p for p in files if p not in owners]
+    num_files = len(files)
+    print(f"Found {num_files} source files" + (f" ({len(owners)} more are parts of multi-file examples)" if owners else ""))
+
+    outputs = open_outputs(out_root, args.store)
+    manifest = OutputManifest(outputs)
+
+    # Open connections to the services this run uses while the matrix is planned.
+    # A local run only reaches CE to benchmark on a toolchain that cannot execute here.
+    uses_ce = bool(remote_compilers) or (args.bench and args.backend != "ce" and not all(local.can_execute(c) for c in local_ids))
+    uses_explain = not args.compile_only
+    if uses_ce or uses_explain:
+        threading.Thread(target=client.warm_up, args=(uses_ce, uses_explain), name="warm-up", daemon=True).start()
+
+    # Incremental modes narrow the matrix before anything is scheduled.
+    incremental = args.changed_since is not None or args.only_stale
+    if args.changed_since is not None:
+        changes = changed_sources_since(args.changed_since, src_root_resolved, exts)
+        # An edited part of a multi-file example changes its example.
+        changed_owners = {o for c, o in owners.items() if source_key(c, src_root_resolved) in changes.changed}
+        files = [p for p in files if source_key(p, src_root_resolved) in changes.changed or p in changed_owners]
+        changes.deleted -= {source_key(c, src_root_resolved) for c in owners}
+        print(
+            f"Changed since {args.changed_since}: {len(files)} source files"
+            + (f", {len(changes.deleted)} deleted" if changes.deleted else "")
+        )
+        removed = 0
+        for key in sorted(changes.deleted):
+            rel = Path(key)
+            for compiler_id in compilers:
+                for sc in scenarios:
+                    removed += remove_cell_outputs(out_root / compiler_id / sc.name / rel.parent, rel.name, outputs)
+                    manifest.touch(f"{compiler_id}/{sc.name}/{key}")
+                    removed += remove_variant_outputs(out_root / compiler_id / sc.name / rel.parent, rel.name, (), outputs)
+                for sweep_name in {sc.sweep.sweep for sc in scenarios if sc.sweep is not None}:
+                    removed += outputs.delete(out_root / sweep_record_key(compiler_id, sweep_name, key))
+        if removed:
+            print(f"  Removed {removed} output files of deleted sources")
+
+    journal = JobJournal(out_root, outputs)
+    if args.resume:
+        print(f"Resuming from {journal.path} ({journal.load()} journaled stages)")
+    elif args.only_stale:
+        journal.load()  # pruned sweep points have no explanation to be newer than the source
+
+    # Plan every (compiler, scenario, file) cell up front, from the parsed
+    # hints, so totals and the ETA only count work that will be done.
+    source_texts = {p: p.read_text(encoding="utf-8", errors="replace") for p in files}
+    source_hints = {p: parse_gallery_hints(t) for p, t in source_texts.items()}
+    companion_texts: Dict[Path, List[Dict[str, str]]] = {}
+    for p, h in source_hints.items():
+        try:
+            companion_texts[p] = read_companions(p, h) if h.files else []
+        except CEError:
+            companion_texts[p] = []  # the compile reports the missing file
+
+    def fingerprint(cell: CompiledCell) -> str:
+        return cell_fingerprint(cell.src_text, cell.effective_flags, companion_texts[cell.ctx.src_path])
+
+    cells: List[Tuple[str, Scenario, Path]] = []
+    explain_from_disk: Set[Tuple[str, str, Path]] = set()  # compiled already; resume at explain
+    resumed = excluded = 0
+    for compiler_id in compilers:
+        for sc in scenarios:
+            for src_path in files:
+                if not sc.applies_to(compiler_id, source_key(src_path, src_root_resolved)):
+                    continue
+                if sc.pgo and (compiler_id not in pgo_compilers or not source_hints[src_path].bench):
+                    continue  # nothing to train with
+                if source_hints[src_path].files and compiler_id not in link_compilers:
+                    continue  # CE compiles only the example's main file
+                if sc.multi_file and not source_hints[src_path].files:
+                    continue
+                out_dir = out_root / compiler_id / sc.name / src_path.parent.relative_to(src_root_resolved)
+                hints = source_hints[src_path]
+                if not hints.should_compile(compiler_id, sc.name):
+                    # Hints may have changed to exclude this cell; drop stale outputs.
+                    excluded += 1
+                    if remove_cell_outputs(out_dir, src_path.stem, outputs) + remove_variant_outputs(out_dir, src_path.stem, (), outputs):
+                        manifest.touch(outputs.key(out_dir / src_path.stem))
+                    continue
+                key = (compiler_id, sc.name, source_key(src_path, src_root_resolved))
+                fp = cell_fingerprint(source_texts[src_path], hints.effective_flags(sc.flags), companion_texts[src_path])
+                if args.only_stale and not cell_is_stale(
+                    src_path, out_dir, src_path.stem, outputs, companion_paths(src_path, hints)
+                ):
+                    continue
+                if args.resume:
+                    state = journal.resume_state(key, fp, out_dir)
+                    if state == "explain" or (state == "compile" and args.compile_only):
+                        resumed += 1
+                        continue
+                    if state == "compile":
+                        explain_from_disk.add((compiler_id, sc.name, src_path))
+                if sc.sweep is not None and (args.resume or args.only_stale) and journal.is_pruned(key, fp):
+                    resumed += 1 if args.resume else 0
+                    continue  # pruned with this source and these flags
+                cells.append((compiler_id, sc, src_path))
+
+    if args.resume:
+        print(f"  Skipping {resumed} completed cells, {len(explain_from_disk)} resume at explain")
+
+    # Sweep points are pruned by comparing all points of a (compiler, file)
+    # pair, so plan the whole sweep whenever any of its points is planned.
+    planned = {(c, sc.name, p) for c, sc, p in cells}
+    for compiler_id, sweep_name, src_path in list(dict.fromkeys(
+        (c, sc.sweep.sweep, p) for c, sc, p in cells if sc.sweep is not None
+    )):
+        for sc in scenarios:
+            if (
+                sc.sweep is not None and sc.sweep.sweep == sweep_name
+                and (compiler_id, sc.name, src_path) not in planned
+                and source_hints[src_path].should_compile(compiler_id, sc.name)
+            ):
+                cells.append((compiler_id, sc, src_path))
+
+    # Each planned cell of a plain scenario also compiles the source's
+    # sweep-defines variants (sweep scenarios vary flags, not defines).
+    variants = {p: define_variants(h) for p, h in source_hints.items()}
+    variant_cells = sum(len(variants[p]) for c, sc, p in cells if sc.sweep is None)
+    total_operations = len(cells) + variant_cells
+
+    # Members of an equivalence whose representative is planned too. Those
+    # of sources without floating-point code are expected to match it, so
+    # their explanations are not planned.
+    planned_cells = {(c, sc.name, p) for c, sc, p in cells}
+    equivalent = {
+        (c, sc.name, p) for c, sc, p in cells
+        if sc.name in equivalences and (c, equivalences[sc.name], p) in planned_cells
+    } if not args.compile_only else set()
+    expect_linked = {cell for cell in equivalent if not uses_floating_point(source_texts[cell[2]])}
+
+    if incremental or args.resume:
+        print(f"Total: {total_operations} file compilations ({'resumed' if args.resume else 'incremental'})")
+    else:
+        plain_scenarios = [sc for sc in scenarios if sc.sweep is None]
+        sweep_cells = sum(1 for _, sc, _ in cells if sc.sweep is not None)
+        skipped = num_files * len(compilers) * len(plain_scenarios) - (len(cells) - sweep_cells)
+        print(
+            f"Total: {total_operations} file compilations "
+            f"({num_files} files x {len(compilers)} compilers x {len(plain_scenarios)} scenarios"
+            + (f", minus {skipped} cells ({excluded} excluded by hints)" if skipped else "")
+            + (f", plus {sweep_cells} sweep cells" if sweep_cells else "")
+            + (f", plus {variant_cells} define variants)" if variant_cells else ")")
+        )
+    if expect_linked:
+        print(f"Equivalence: {len(expect_linked)} of {len(equivalent)} cells expected to link to their representative's explanation")
     print()
 
     # Top-level README
     write_top_index_readme(out_root, scenarios, compilers)
 
-    # Progress tracker
-    tracker = ProgressTracker(total_operations)
+    # Progress tracker: the ETA needs the steps each compiler has left.
+    planned: Dict[Tuple[str, str], int] = {}
+    for compiler_id, sc, src_path in cells:
+        steps = []
+        if not (args.explain_only or (compiler_id, sc.name, src_path) in explain_from_disk):
+            steps.append("compile")
+            if sc.sweep is None:
+                steps.extend(["compile"] * len(variants[src_path]))
+        if not args.compile_only and (compiler_id, sc.name, src_path) not in expect_linked:
+            steps.append("explain")
+        for step in steps:
+            planned[(compiler_id, step)] = planned.get((compiler_id, step), 0) + 1
+    tracker = ProgressTracker(planned, {"compile": jobs, "explain": explain_jobs})
     last_line_len = 0
+    print_lock = threading.Lock()
 
     def progress_callback(info: ProgressInfo) -> None:
         nonlocal last_line_len
         if args.quiet:
             return
 
-        tracker.record_step()
         line = format_progress(info, tracker)
 
         # Clear previous line and print new one
-        sys.stdout.write("\r" + " " * last_line_len + "\r")
-        sys.stdout.write(line)
-        sys.stdout.flush()
-        last_line_len = len(line)
+        with print_lock:
+            sys.stdout.write("\r" + " " * last_line_len + "\r")
+            sys.stdout.write(line)
+            sys.stdout.flush()
+            last_line_len = len(line)
 
-    # Run per compiler, per scenario
-    file_index = 0
     for compiler_id in compilers:
-        compiler_out = out_root / compiler_id
-        write_compiler_readme(compiler_out, compiler_id, scenarios)
-
-        for sc in scenarios:
-            scenario_out = compiler_out / sc.name
-
-            explain_compiler_label = args.explain_compiler if args.explain_compiler != "unknown" else compiler_id
-
-            files_processed = process_source_tree(
-                src_root=src_root,
-                out_root=scenario_out,
-                client=client,
+        write_compiler_readme(out_root / compiler_id, compiler_id, scenarios)
+
+    # Every scenario of one (compiler, file) pair is a single compile unit:
+    # one source read, one hint parse, one compile_many() call.
+    groups: Dict[Tuple[str, Path], List[Tuple[str, Scenario, Path]]] = {}
+    for cell_spec in cells:
+        groups.setdefault((cell_spec[0], cell_spec[2]), []).append(cell_spec)
+
+    units: List[List[CellContext]] = []
+    for group in groups.values():
+        unit: List[CellContext] = []
+        for compiler_id, sc, src_path in group:
+            ctx = CellContext(
+                src_path=src_path,
+                src_root=src_root_resolved,
+                out_root=(out_root / compiler_id / sc.name).resolve(),
                 compiler_id=compiler_id,
                 scenario_name=sc.name,
                 ce_lang_id=args.lang,
                 ce_user_arguments=sc.flags,
                 explain_language=args.explain_language,
-                explain_compiler_human=explain_compiler_label,
+                explain_compiler_human=args.explain_compiler if args.explain_compiler != "unknown" else compiler_id,
                 instruction_set=detect_instruction_set(compiler_id),
                 explain_audience=args.audience,
                 explain_type=args.explain_type,
                 bypass_compile_cache=args.bypass_compile_cache,
                 bypass_explain_cache=args.bypass_explain_cache,
-                extensions=exts,
-                sleep_s=args.sleep,
-                progress_callback=progress_callback,
-                file_index_offset=file_index,
-                total_files_global=total_operations,
+                explain_functions=args.explain_functions,
+                capture_remarks=args.remarks,
+                time_report=args.time_report,
+                binary_object=args.binary_object or compiler_id in binary_object,
+                pgo=sc.pgo,
+                total=total_operations,
             )
+            unit.append(ctx)
+            if sc.sweep is None:
+                for defines in variants[src_path]:
+                    unit.append(dataclasses.replace(ctx, defines=defines))
+        units.append(unit)
+
+    # Important and recently changed sources first (see ce_priority.py); the
+    # explain queue uses the same scores.
+    scores: Dict[Path, float] = {}
+    if not args.no_priority:
+        parts = {p: [q.resolve() for q in (p, *companion_paths(p, source_hints[p]))] for p in files}
+        ages = source_ages([q for qs in parts.values() for q in qs], src_root_resolved)
+        for p, qs in parts.items():
+            # A multi-file example changed when any of its files did.
+            age = min((ages[q] for q in qs if ages.get(q) is not None), default=None)
+            scores[p] = priorities.score(source_category(source_key(p, src_root_resolved)), age)
+        compiler_order = {c: i for i, c in enumerate(compilers)}
+        units.sort(key=lambda u: (-scores[u[0].src_path], u[0].rel_path, compiler_order.get(u[0].compiler_id, 0)))
+        if units and not args.quiet:
+            first = list(dict.fromkeys(u[0].rel_path for u in units))[:3]
+            print(f"Order: by priority, starting with {', '.join(first)}")
+
+    # Compile and explain run as two stages joined by a queue, so compiles for
+    # later cells overlap with explain calls for earlier ones.
+    missing_compiles: List[str] = []  # list.append is atomic across workers
+    bench_failures: List[str] = []
+    dedup = None if args.no_explain_dedup else ExplainDeduper(cache)
+
+    sweep_points = {sc.name: sc.sweep for sc in scenarios if sc.sweep is not None}
+    pruned: List[str] = []
+    links_written: List[str] = []
+    usage = UsageTracker()
+
+    def journal_key(ctx: CellContext) -> Tuple[str, str, str]:
+        return (ctx.compiler_id, ctx.scenario_name, ctx.rel_path)  # the source key, plus "@N=..." for variants
+
+    def prune_sweeps(unit: List[CellContext], results: List[Optional[CompiledCell]]) -> None:
+        """Drop sweep points whose assembly matches a neighbour's and write the sweep records."""
+        by_sweep: Dict[str, List[int]] = {}
+        for i, ctx in enumerate(unit):
+            point = sweep_points.get(ctx.scenario_name)
+            if point is not None and results[i] is not None:
+                by_sweep.setdefault(point.sweep, []).append(i)
+        for sweep_name, indexes in by_sweep.items():
+            cells_by_point = {unit[i].scenario_name: results[i] for i in indexes}
+            points = [p for p in sweep_points.values() if p.sweep == sweep_name]
+            same_as = prune_points(points, {name: asm_fingerprint(c.asm_text) for name, c in cells_by_point.items() if c})
+            ctx0 = unit[indexes[0]]
+            record_points = []
+            for p in points:
+                cell = cells_by_point.get(p.name)
+                if cell is None:
+                    continue
+                total = cell_metrics(cell.response, cell.ctx.instruction_set)["total"]
+                record_points.append({
+                    "scenario": p.name, "flags": p.flags, "values": list(p.values),
+                    "same_as": same_as[p.name], **{k: total[k] for k in ("instructions", "bytes", "simd")},
+                })
+            _write_json(outputs, out_root / sweep_record_key(ctx0.compiler_id, sweep_name, ctx0.rel_path), {
+                "sweep": sweep_name, "compiler": ctx0.compiler_id, "source": ctx0.rel_path, "points": record_points,
+            })
+            for i in indexes:
+                if same_as[unit[i].scenario_name] is not None:
+                    cell = results[i]
+                    journal.record(
+                        journal_key(unit[i]), "pruned", fingerprint(cell),
+                        unit[i].out_dir, unit[i].base,
+                    )
+                    remove_cell_outputs(unit[i].out_dir, unit[i].base, outputs)
+                    manifest.touch(outputs.key(unit[i].out_dir / unit[i].base))
+                    results[i] = None
+                    pruned.append(unit[i].rel_path)
+                    if not args.compile_only:
+                        tracker.skip(unit[i].compiler_id, "explain")
+
+    def train_profile(ctx: CellContext, hints: Any) -> TrainedProfile:
+        """Run a PGO cell's training driver; a bad bench hint is recorded like a failed run."""
+        flags = cell_flags(ctx, hints)
+        workload = {"bench": hints.bench, "sizes": hints.bench_sizes, "inputs": hints.pgo_inputs or hints.bench_inputs}
+        try:
+            # A bench-define source runs at the size its macro is set to, like its benchmarks.
+            sizes, train_extra = training_build(hints, dict(ctx.defines))
+            driver = training_driver(source_texts[ctx.src_path], hints, lang=ctx.ce_lang_id, sizes=sizes)
+        except BenchSpecError as e:
+            return TrainedProfile(None, {"compiler": ctx.compiler_id, "flags": flags, "workload": workload, "ok": False, "error": str(e)})
+        if sizes is not None:
+            workload["sizes"] = sizes
+        return train_cell(
+            compiler_backend, ctx.compiler_id, driver, flags, workload,
+            lang=ctx.ce_lang_id, baseline=pgo_baselines.get(ctx.scenario_name), train_extra=train_extra,
+        )
 
-            file_index += files_processed
-            tracker.completed = file_index
+    # Equivalent cells waiting for their representative's explanation, by
+    # the representative's journal key. Filled by first_stage() before the
+    # representative is queued, emptied by its second_stage().
+    linked: Dict[Tuple[str, str, str], List[CompiledCell]] = {}
+
+    def link_equivalents(unit: List[CellContext], results: List[Optional[CompiledCell]]) -> List[Optional[CompiledCell]]:
+        """Take members of an equivalence whose assembly matches their representative's out of the explain stage."""
+        if not equivalent:
+            return results
+        by_scenario = {ctx.scenario_name: i for i, ctx in enumerate(unit) if not ctx.defines}
+        for i, ctx in enumerate(unit):
+            key = (ctx.compiler_id, ctx.scenario_name, ctx.src_path)
+            if ctx.defines or key not in equivalent:
+                continue
+            member, leader = results[i], results[by_scenario[equivalences[ctx.scenario_name]]]
+            expected = key in expect_linked
+            if member is not None and leader is not None and asm_fingerprint(member.asm_text) == asm_fingerprint(leader.asm_text):
+                linked.setdefault(journal_key(leader.ctx), []).append(member)
+                results[i] = None
+                if not expected:
+                    tracker.skip(ctx.compiler_id, "explain")
+            elif member is not None and expected:
+                tracker.add(ctx.compiler_id, "explain")  # explained after all
+        return results
+
+    def first_stage(unit: List[CellContext]) -> List[Optional[CompiledCell]]:
+        results: List[Optional[CompiledCell]] = [None] * len(unit)
+        to_compile: List[int] = []
+        for i, ctx in enumerate(unit):
+            if args.explain_only or (ctx.compiler_id, ctx.scenario_name, ctx.src_path) in explain_from_disk:
+                if ctx.defines:
+                    continue  # variants are never explained
+                results[i] = load_compiled_cell(ctx, outputs)
+                if results[i] is not None:
+                    usage.add(ctx.compiler_id, ctx.rel_path, cells=1, asm_lines=len(results[i].asm_text.splitlines()))
+                elif not args.compile_only and (ctx.compiler_id, ctx.scenario_name, ctx.src_path) not in expect_linked:
+                    tracker.skip(ctx.compiler_id, "explain")
+                if results[i] is None and ctx.scenario_name not in sweep_points:  # may have been pruned
+                    missing_compiles.append(ctx.rel_path)
+            else:
+                to_compile.append(i)
+        if not to_compile:
+            return link_equivalents(unit, results)
+
+        started = time.monotonic()
+        profiles: Dict[int, TrainedProfile] = {}
+        for j, i in enumerate(to_compile):
+            ctx = unit[i]
+            hints = source_hints[ctx.src_path]
+            if not ctx.pgo:
+                continue
+            with telemetry.span("train", "stage", compiler=ctx.compiler_id, scenario=ctx.scenario_name, source=ctx.rel_path):
+                profiles[j] = train_profile(ctx, hints)
+        with telemetry.span("compile", "stage", compiler=unit[0].compiler_id, source=unit[0].rel_path, cells=len(to_compile)):
+            compiled = compile_cell_group([unit[i] for i in to_compile], compiler_backend, progress_callback, outputs, profiles)
+        elapsed = time.monotonic() - started
+        done = [cell for cell in compiled if cell is not None]
+        per_cell_s = elapsed / max(1, len(done))
+        telemetry.observe("ce_batch_stage_seconds", elapsed, stage="compile")
+        telemetry.count("ce_batch_cells", len(done), stage="compile")
+        for i, cell in zip(to_compile, compiled):
+            results[i] = cell
+        for cell in done:
+            tracker.record(cell.ctx.compiler_id, "compile", per_cell_s, cell.cached)
+            usage.add(
+                cell.ctx.compiler_id, cell.ctx.rel_path, cells=1,
+                bytes_sent=payload_size(cell.request), bytes_received=payload_size(cell.response),
+                asm_lines=len(cell.asm_text.splitlines()), seconds=per_cell_s,
+            )
+        if sweep_points:
+            prune_sweeps(unit, results)
+        for i in to_compile:
+            cell = results[i]
+            if cell is not None:
+                ctx = cell.ctx
+                journal.record(
+                    journal_key(ctx), "compile", fingerprint(cell),
+                    ctx.out_dir, ctx.base, extra_files=[f"{ctx.base}.src{ctx.src_path.suffix}"],
+                )
+                manifest.touch(outputs.key(ctx.out_dir / ctx.base))
+                if args.bench:
+                    with telemetry.span("bench", "stage", compiler=ctx.compiler_id, scenario=ctx.scenario_name, source=ctx.rel_path):
+                        record = bench_cell(cell, compiler_backend, outputs, counters=args.bench_counters)
+                        timing = dudect_cell(cell, compiler_backend, outputs) if not ctx.defines else None
+                    if any(r is not None and not r["ok"] for r in (record, timing)):
+                        bench_failures.append(f"{ctx.compiler_id}/{ctx.scenario_name}/{ctx.rel_path}")
+                if ctx.defines:
+                    results[i] = None  # compiled, measured and benchmarked; the explanation is the base cell's
+                elif ctx.scenario_name not in sweep_points:
+                    # Variants the hints no longer list.
+                    remove_variant_outputs(
+                        ctx.out_dir, ctx.src_path.stem,
+                        [dataclasses.replace(ctx, defines=d).base for d in variants[ctx.src_path]], outputs,
+                    )
+        if args.compile_only and args.sleep > 0:
+            time.sleep(args.sleep)
+        return link_equivalents(unit, results)
+
+    def second_stage(cell: CompiledCell) -> None:
+        ctx = cell.ctx
+        started = time.monotonic()
+        with telemetry.span("explain", "stage", compiler=ctx.compiler_id, scenario=ctx.scenario_name, source=ctx.rel_path) as span:
+            exp = explain_cell(cell, client, progress_callback, outputs, dedup)
+            # A shared explanation costs nothing beyond the leader's call.
+            shared = span["shared"] = "reusedFrom" in exp.response
+        elapsed = time.monotonic() - started
+        tracker.record(ctx.compiler_id, "explain", elapsed, exp.cached)
+        telemetry.observe("ce_batch_stage_seconds", elapsed, stage="explain")
+        telemetry.count("ce_batch_cells", stage="explain")
+        usage.add(
+            ctx.compiler_id, ctx.rel_path,
+            bytes_sent=0 if shared else payload_size(exp.request),
+            bytes_received=0 if shared else payload_size(exp.response),
+            explain_tokens=0 if shared else explain_tokens(exp.response),
+            seconds=elapsed,
+        )
+        journal.record(
+            journal_key(ctx), "explain", fingerprint(cell),
+            ctx.out_dir, ctx.base,
+        )
+        manifest.touch(outputs.key(ctx.out_dir / ctx.base))
+        for member in linked.pop(journal_key(ctx), []):
+            if exp.response.get("status") == "success":
+                leader = "/".join(journal_key(ctx))
+                link_explanation(member.ctx, exp, leader, outputs)
+                links_written.append("/".join(journal_key(member.ctx)))
+            else:
+                # Failures are not shared; the member is explained on its own.
+                explain_cell(member, client, progress_callback, outputs, dedup)
+            journal.record(
+                journal_key(member.ctx), "explain", fingerprint(member),
+                member.ctx.out_dir, member.ctx.base,
+            )
+            manifest.touch(outputs.key(member.ctx.out_dir / member.ctx.base))
+            tracker.increment()
+        if args.sleep > 0:
+            time.sleep(args.sleep)
+
+    def on_dequeue(enqueued_at: float, depth: int) -> None:
+        now = telemetry.now()
+        waited = time.monotonic() - enqueued_at
+        telemetry.observe("ce_batch_stage_seconds", waited, stage="queue_wait")
+        telemetry.async_span("queued", "queue", now - waited, now)
+        telemetry.sample("explain queue", depth=depth)
+
+    pipeline: TwoStagePipeline[List[CellContext], CompiledCell] = TwoStagePipeline(
+        first=first_stage,
+        second=None if args.compile_only else second_stage,
+        first_workers=jobs,
+        second_workers=explain_jobs,
+        on_item_done=tracker.increment,
+        fan_out=True,
+        on_dequeue=on_dequeue,
+        priority=(lambda cell: -scores[cell.ctx.src_path]) if scores else None,
+    )
+    deadline = None
+    if args.time_limit is not None:
+        deadline = threading.Timer(args.time_limit * 60, pipeline.stop)
+        deadline.daemon = True
+        deadline.start()
+    try:
+        pipeline.run(units)
+    finally:
+        if deadline is not None:
+            deadline.cancel()
+        # Written even when the run fails, for the cells that did finish.
+        manifest.save()
+        outputs.close()
+        client.close()
+        # Written even when the run fails: that is when a trace helps most.
+        telemetry.gauge("ce_batch_run_seconds", telemetry.now())
+        telemetry.gauge("ce_batch_run_timestamp_seconds", telemetry.start_unix)
+        telemetry.close()
+        if args.chrome_trace:
+            telemetry.write_chrome_trace(Path(args.chrome_trace))
+        if args.metrics_file:
+            telemetry.write_openmetrics(Path(args.metrics_file))
+
+    # Superseded sources and flags leave entries no run reads again.
+    cache_pruned = cache.prune(args.cache_max_age * 86400) if cache is not None and args.cache_max_age > 0 else (0, 0)
 
     # Final newline after progress
     if not args.quiet:
         print()
         print()
-        print(f"Completed {total_operations} compilations in {tracker.get_elapsed_str()}")
+        done_cells = tracker.completed if pipeline.stopped else total_operations
+        print(f"Completed {done_cells} compilations in {tracker.get_elapsed_str()} ({tracker.cells_per_minute():.0f} cells/min)")
+        steps = tracker.summary_lines()
+        if steps:
+            print(f"Step latency ({jobs} compile, {explain_jobs} explain workers):")
+            print("\n".join(steps))
+        if cache is not None:
+            print(f"Local cache: {cache.stats_str()}")
+            if cache_pruned[0]:
+                print(f"  Dropped {cache_pruned[0]} entries unused for {args.cache_max_age:g} days ({cache_pruned[1] / 1024:.0f} KiB)")
+        if pruned:
+            print(f"Pruned {len(pruned)} sweep cells whose assembly matches a neighbouring point")
+        if dedup is not None and dedup.reused:
+            print(f"Reused {dedup.reused} explanations of cells with identical assembly")
+        if links_written:
+            print(f"Linked {len(links_written)} equivalent cells to their representative's explanation (see equivalences in {yaml_path})")
+        if client.requests_sent:
+            print(f"Sent {client.requests_sent} requests ({client.bytes_sent / 1024:.0f} KiB of request bodies)")
+        if client.retries:
+            print(f"Retried {client.retries} requests after 429/5xx or connection errors")
+        latency = client.latency.summary_lines()
+        if latency:
+            print("Request latency:")
+            print("\n".join(latency))
+        report = report_lines(usage, args.report_top, args.report_sort) if args.report_top > 0 else []
+        if report:
+            print(f"Most expensive files (by {args.report_sort.replace('_', ' ')}):")
+            print("\n".join(report))
+    if args.report_json:
+        _write_json(None, Path(args.report_json), {
+            "sort": args.report_sort, "rows": [row.as_dict() for row in usage.rows(args.report_sort)],
+        })
+    over = budget_warning_lines(usage, budgets)
+    if over:
+        print(f"Warning: {len(over)} budgets exceeded (see budgets in {yaml_path}):")
+        print("\n".join(over))
+    if bench_failures:
+        print(f"Warning: {len(bench_failures)} benchmark runs failed (see their .bench.json or .dudect.json for the error)")
+    if args.export:
+        print(f"Exported {export_matrix(out_root, Path(args.export))} result rows to {args.export}")
+    if pipeline.stopped:
+        print(
+            f"Warning: stopped at the {args.time_limit:g} minute time limit with {total_operations - tracker.completed} "
+            f"of {total_operations} cells left (run again with --resume to finish them)"
+        )
+    if missing_compiles:
+        print(f"Warning: {len(missing_compiles)} cells have no compile output to explain (run without --explain-only first)")
 
     return 0
 
@@ -0,0 +1,981 @@
+# Copyright (c) 2026 Larry H <l.gr [at] dartmouth [dot] edu>
+# SPDX-License-Identifier: AGPL-3.0-or-later
+#
+# Compiler Optimization Gallery
+# Developed for COSC-69.16: Basics of Reverse Engineering
+# Dartmouth College, Winter 2026
+
+"""
+ce_bench.py
+
+Runtime micro-benchmarks for gallery examples. A source opts in through its
+``@gallery-hints`` block:
+
+    /* @gallery-hints
+     *   bench: add_arrays(f32[], f32[], f32[], n); sum_array(f32[], n)
+     *   bench-sizes: 1024, 65536
+     *   bench-iterations: 2000     (optional; default ~1e7 elements per sample)
+     *   bench-repeats: 7           (optional; default 5 samples)
+     *   bench-counters: yes        (optional; hardware counters, see below)
+     *   bench-define: N            (optional; -DN=<size>, one build per size)
+     *   bench-stubs: process_a(i32); process_b(i32)   (optional)
+     *   bench-baseline: simd/auto-vectorize             (optional)
+     *   bench-inputs: sorted, random                    (optional)
+     */
+
+Each ``bench`` entry names a function and its arguments: ``<type>[]`` is a
+freshly allocated array of n elements (types: i8 u8 i16 u16 i32 u32 i64 u64
+f32 f64) filled with deterministic pseudo-random data, ``<type>[n*n]`` one of
+n*n elements (an n x n matrix), ``<type>[n*8]`` one of 8n (n structs of
+eight floats, say), ``str[]`` a string of n - 1 letters and its NUL, ``n``
+is the element count and a number is passed as a literal. An entry without
+``n`` or an array counts one element per call.
+
+A scalar argument written ``<type>{lo..hi}`` or ``<type>{v1,v2,...}`` is an
+input stream: n values from that range or set, one per call, so the entry is
+called n times per operation (``clamp(i32{-100..100}, -50, 50)``). Such
+entries run once per input pattern of ``bench-inputs`` (default: all):
+``sorted`` (random values in ascending order, so each branch flips once),
+``random`` (uniform draws) and ``adversarial`` (the two ends of the range,
+or the set's first and last value, in random order: a compare between them
+goes either way with even odds). Each pattern is its own result,
+``clamp/random``, and the page sets them side by side per scenario with
+branch misses per call where the counters are available. Sizes should
+exceed what a branch predictor can memorize (64K values, say). With ``bench-define``, a source whose size is a macro
+(``#ifndef N``) is rebuilt with ``-D<macro>=<size>`` for each size; a
+``sweep-defines`` variant cell that sets the macro (see ce_client.py) runs
+at just its own size.
+``bench-stubs`` defines the named extern functions (arguments given by type)
+as out-of-line calls that only bump a volatile counter, so examples calling
+undefined hooks still link. ``bench-baseline`` names another source whose
+benchmarks these are compared with on the book page: a function
+``<name>_<suffix>`` here (``sum_array_simd``) is measured against
+``<name>`` there (``sum_array``), at the same size, compiler and flags.
+With an ``overhead`` hint (see ce_overhead.py) bench_cell() runs the
+benchmarks a second time with the cell's flags minus the hardening ones.
+training_driver() is the driver a PGO scenario collects its profile with
+(one sample per size and input, see ce_pgo.py); a cell compiled with that
+profile is benchmarked with it too.
+
+generate_driver() appends a ``main()`` to the source that calls every entry
+through a volatile function pointer (so it cannot be inlined into the timing
+loop or optimized away) and prints one ``@bench`` line per sample.
+run_cell_benchmarks() builds and runs it with the cell's compiler and flags,
+through ``execute()`` on CompilerExplorerClient (CE's execute filter) or
+LocalCompiler, and summarizes the samples as ns/op, ns/element, ticks per
+element and per call (x86 TSC; close to cycles at base clock) and the
+coefficient of variation. The summary is written as ``<stem>.bench.json``
+next to the cell's assembly and shown on its book page.
+
+With ``bench-counters: yes`` (or ``ce_batch.py --bench --bench-counters``)
+the driver also opens Linux ``perf_event_open`` counters for the process --
+cycles, instructions, L1D and last-level cache read misses, branch misses --
+and prints one ``@counters`` line per sample with each count per call. The
+medians go to each result's ``counters`` (per call) and
+``counters_per_element``, with IPC. Counters the kernel or the machine does
+not provide (``perf_event_paranoid`` > 2, containers, most virtual machines,
+CE's executors) are recorded as unavailable; the timings are still taken.
+Sweeping the sizes across the cache sizes shows the cliffs where a working
+set stops fitting in L1, L2 and the LLC.
+
+Functions in a ``constant-time`` hint get a dudect-style timing test
+instead: run_cell_dudect() builds a driver that times single calls with a
+fixed or a random secret and writes ``<stem>.dudect.json`` with Welch's t
+per function (see ce_consttime.py).
+"""
+
+from __future__ import annotations
+
+import dataclasses
+import re
+import statistics
+from dataclasses import dataclass
+from typing import Any, Dict, List, Optional, Protocol, Sequence, Tuple
+
+from ce_client import CompiledCell, ExecResult, GalleryHints, _write_json, parse_gallery_hints
+from ce_consttime import DUDECT_SUFFIX, T_THRESHOLD, dudect_verdict, parse_entries, welch_t
+from ce_store import OutputStore
+
+BENCH_SUFFIX = ".bench.json"
+
+DEFAULT_SIZES = (1024, 65536)
+DEFAULT_REPEATS = 5
+# Element operations per sample when the hints give no iteration count.
+TARGET_ELEMENTS_PER_SAMPLE = 10_000_000
+
+_C_TYPES = {
+    "i8": "signed char", "u8": "unsigned char",
+    "i16": "short", "u16": "unsigned short",
+    "i32": "int", "u32": "unsigned int",
+    "i64": "long long", "u64": "unsigned long long",
+    "f32": "float", "f64": "double",
+}
+
+# Array element types: the scalar types, and strings (char arrays ending in a NUL).
+_ARRAY_TYPES = {**_C_TYPES, "str": "char"}
+
+# Input patterns for stream arguments, in page order.
+BENCH_INPUTS = ("sorted", "random", "adversarial")
+
+COUNTERS = ("cycles", "instructions", "l1d_misses", "llc_misses", "branch_misses")
+
+_ENTRY_RE = re.compile(r"^\s*([A-Za-z_]\w*)\s*\((.*)\)\s*$")
+_NUMBER_RE = re.compile(r"^-?(\d+(\.\d*)?|\.\d+)([eE][-+]?\d+)?[fFuUlL]*$")
+_ARRAY_RE = re.compile(r"^(\w+)\[(?:n\*(n|\d+))?\]$")
+_STREAM_RE = re.compile(r"^(\w+)\{\s*(-?\d+)\s*(?:\.\.\s*(-?\d+)|((?:,\s*-?\d+\s*)*))\}$")
+_BENCH_LINE_RE = re.compile(r"^@bench\s+(\S+)\s+(\d+)\s+(\d+)\s+([\d.eE+-]+)\s+([\d.eE+-]+)\s*$")
+_COUNTERS_LINE_RE = re.compile(r"^@counters\s+(\S+)\s+(\d+)((?:\s+[\d.eE+-]+){%d})\s*$" % len(COUNTERS))
+_COUNTERS_OPEN_RE = re.compile(r"^@counters-open\s+(\d+)\s+(-?\d+)\s*$")
+
+# errno from perf_event_open -> why the counters are missing.
+_COUNTER_ERRORS = {
+    -1: "hardware counters are only read on Linux",
+    1: "perf_event_open not permitted (kernel.perf_event_paranoid, or a seccomp sandbox)",
+    2: "the CPU or hypervisor exposes no such hardware counters",
+    13: "perf_event_open not permitted (kernel.perf_event_paranoid)",
+    19: "the CPU or hypervisor exposes no hardware counters",
+    38: "perf_event_open is not available (seccomp sandbox or kernel without perf events)",
+    95: "the CPU or hypervisor exposes no such hardware counters",
+}
+
+
+class BenchSpecError(ValueError):
+    pass
+
+
+@dataclass(frozen=True)
+class BenchEntry:
+    function: str
+    args: List[str]  # "f32[]", "f32[n*n]", "str[]", "n" or a numeric literal
+    label: str = ""  # name in the output; tells apart entries calling the same function
+    input: str = ""  # input pattern of the entry's stream arguments, see BENCH_INPUTS
+
+    @property
+    def name(self) -> str:
+        return self.label or self.function
+
+    def elements(self, n: int) -> int:
+        """Elements one call touches: n, n*n when it takes a matrix, 1 when it takes neither n nor an array."""
+        if any(a.endswith("[n*n]") for a in self.args):
+            return n * n
+        return n if any(a == "n" or _ARRAY_RE.match(a) or _STREAM_RE.match(a) for a in self.args) else 1
+
+
+class ExecBackend(Protocol):
+    """CompilerExplorerClient, LocalCompiler and RoutingCompiler all fit."""
+
+    def execute(self, compiler_id: str, source: str, **kwargs: Any) -> ExecResult: ...
+
+
+def _split_args(text: str) -> List[str]:
+    """Split an argument list on the commas outside ``{...}`` sets."""
+    args, depth, current = [], 0, ""
+    for ch in text:
+        depth += (ch == "{") - (ch == "}")
+        if ch == "," and depth == 0:
+            args.append(current.strip())
+            current = ""
+        else:
+            current += ch
+    args.append(current.strip())
+    return [a for a in args if a]
+
+
+def stream_domain(arg: str) -> Optional[tuple]:
+    """``(type, "range", lo, hi)`` or ``(type, "set", values)`` for a stream argument, else None."""
+    m = _STREAM_RE.match(arg)
+    if not m or m.group(1) not in _C_TYPES:
+        return None
+    if m.group(3) is not None:
+        lo, hi = int(m.group(2)), int(m.group(3))
+        return (m.group(1), "range", min(lo, hi), max(lo, hi))
+    return (m.group(1), "set", [int(m.group(2))] + [int(v) for v in re.findall(r"-?\d+", m.group(4) or "")])
+
+
+def parse_bench_entries(spec: str, inputs: Sequence[str] = BENCH_INPUTS) -> List[BenchEntry]:
+    """
+    Parse the ``bench:`` hint value (entries separated by ';'). Entries with
+    stream arguments expand to one entry per pattern in *inputs*.
+    """
+    unknown = [i for i in inputs if i not in BENCH_INPUTS]
+    if unknown:
+        raise BenchSpecError(f"unknown bench input pattern {unknown[0]!r} (known: {', '.join(BENCH_INPUTS)})")
+    entries = []
+    for part in spec.split(";"):
+        if not part.strip():
+            continue
+        m = _ENTRY_RE.match(part)
+        if not m:
+            raise BenchSpecError(f"bench entry must look like 'func(arg, ...)': {part.strip()!r}")
+        args = _split_args(m.group(2))
+        for a in args:
+            array = _ARRAY_RE.match(a)
+            if (a != "n" and not _NUMBER_RE.match(a) and not (array and array.group(1) in _ARRAY_TYPES)
+                    and stream_domain(a) is None):
+                raise BenchSpecError(f"unknown bench argument {a!r} in {m.group(1)}()")
+        entries.append(BenchEntry(function=m.group(1), args=args))
+    # The same function with different literal arguments: label as "f(1)", "f(0)".
+    for i, e in enumerate(entries):
+        if sum(x.function == e.function for x in entries) > 1:
+            literals = ",".join(a for a in e.args if _NUMBER_RE.match(a))
+            entries[i] = BenchEntry(function=e.function, args=e.args, label=f"{e.function}({literals})")
+    expanded = []
+    for e in entries:
+        if any(stream_domain(a) for a in e.args):
+            expanded.extend(BenchEntry(e.function, e.args, label=f"{e.name}/{p}", input=p) for p in inputs)
+        else:
+            expanded.append(e)
+    return expanded
+
+
+def parse_bench_stubs(spec: str) -> List[BenchEntry]:
+    """Parse the ``bench-stubs:`` hint value: ``name(type, ...)`` entries separated by ';'."""
+    stubs = []
+    for part in spec.split(";"):
+        if not part.strip():
+            continue
+        m = _ENTRY_RE.match(part)
+        args = [a.strip() for a in m.group(2).split(",") if a.strip()] if m else []
+        if not m or not all(a in _C_TYPES for a in args):
+            raise BenchSpecError(f"bench stub must look like 'func(i32, f64, ...)': {part.strip()!r}")
+        stubs.append(BenchEntry(function=m.group(1), args=args))
+    return stubs
+
+
+def iterations_for(elements: int, hints: GalleryHints) -> int:
+    if hints.bench_iterations:
+        return hints.bench_iterations
+    return max(1, TARGET_ELEMENTS_PER_SAMPLE // max(1, elements))
+
+
+_DRIVER_PRELUDE = r"""
+/* ---- gallery benchmark driver (generated by ce_bench.py) ---- */
+/* Helpers are static inline: a driver that does not use one gets no -Wunused-function. */
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define GB_TICKS() ((double)__rdtsc())
+#else
+#define GB_TICKS() 0.0
+#endif
+
+static inline double gb_now_ns(void)
+{
+    struct timespec ts;
+#ifdef CLOCK_MONOTONIC
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+#else
+    timespec_get(&ts, TIME_UTC);
+#endif
+    return (double)ts.tv_sec * 1e9 + (double)ts.tv_nsec;
+}
+
+static unsigned long long gb_state = 0x9E3779B97F4A7C15ULL;
+
+static inline unsigned long long gb_next(void)
+{
+    gb_state = gb_state * 6364136223846793005ULL + 1442695040888963407ULL;
+    return gb_state >> 33;
+}
+
+static inline void *gb_alloc(size_t bytes)
+{
+    void *p = malloc(bytes ? bytes : 1);
+    if (!p) {
+        fprintf(stderr, "gallery bench: out of memory\n");
+        exit(2);
+    }
+    return p;
+}
+"""
+
+_COUNTERS_PRELUDE = r"""
+#define GB_NCOUNTERS 5
+#ifdef __linux__
+#include <errno.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <linux/perf_event.h>
+
+static int gb_fds[GB_NCOUNTERS] = {-1, -1, -1, -1, -1};
+
+/* cycles, instructions, L1D read misses, LLC read misses, branch misses */
+static void gb_counters_open(void)
+{
+    static const struct { unsigned type; unsigned long long config; } gb_events[GB_NCOUNTERS] = {
+        {PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES},
+        {PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS},
+        {PERF_TYPE_HW_CACHE, PERF_COUNT_HW_CACHE_L1D | (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16)},
+        {PERF_TYPE_HW_CACHE, PERF_COUNT_HW_CACHE_LL | (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16)},
+        {PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES},
+    };
+    int opened = 0, err = 0;
+    for (int i = 0; i < GB_NCOUNTERS; i++) {
+        struct perf_event_attr attr;
+        memset(&attr, 0, sizeof attr);
+        attr.size = sizeof attr;
+        attr.type = gb_events[i].type;
+        attr.config = gb_events[i].config;
+        attr.disabled = 1;
+        attr.exclude_kernel = 1;
+        attr.exclude_hv = 1;
+        /* More events than counters get multiplexed: scale by enabled/running time. */
+        attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+        gb_fds[i] = (int)syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0);
+        if (gb_fds[i] >= 0)
+            opened++;
+        else if (!err)
+            err = errno;
+    }
+    printf("@counters-open %d %d\n", opened, err);
+}
+
+static void gb_counters_start(void)
+{
+    for (int i = 0; i < GB_NCOUNTERS; i++) {
+        if (gb_fds[i] >= 0) {
+            ioctl(gb_fds[i], PERF_EVENT_IOC_RESET, 0);
+            ioctl(gb_fds[i], PERF_EVENT_IOC_ENABLE, 0);
+        }
+    }
+}
+
+static void gb_counters_stop(double gb_out[GB_NCOUNTERS])
+{
+    for (int i = 0; i < GB_NCOUNTERS; i++) {
+        unsigned long long v[3];
+        gb_out[i] = -1.0;
+        if (gb_fds[i] < 0)
+            continue;
+        ioctl(gb_fds[i], PERF_EVENT_IOC_DISABLE, 0);
+        if (read(gb_fds[i], v, sizeof v) == (ssize_t)sizeof v && v[2] > 0)
+            gb_out[i] = (double)v[0] * ((double)v[1] / (double)v[2]);
+    }
+}
+#else
+static void gb_counters_open(void) { printf("@counters-open 0 -1\n"); }
+static void gb_counters_start(void) {}
+static void gb_counters_stop(double gb_out[GB_NCOUNTERS])
+{
+    for (int i = 0; i < GB_NCOUNTERS; i++)
+        gb_out[i] = -1.0;
+}
+#endif
+"""
+
+_STUBS_PRELUDE = r"""
+#if defined(__GNUC__) && !defined(__clang__)
+#define GB_NOINLINE __attribute__((noipa))
+#elif defined(__GNUC__)
+#define GB_NOINLINE __attribute__((noinline))
+#else
+#define GB_NOINLINE
+#endif
+
+static volatile unsigned long long gb_sink;
+"""
+
+
+def _fill(var: str, ctype: str, length: str = "gb_n") -> str:
+    # Floats in [0, 1), integers in [0, 256): no overflow surprises in sums.
+    value = "(%s)(gb_next() %% 1000000) / 1000000" % ctype if ctype in ("float", "double") else "(%s)(gb_next() & 0xff)" % ctype
+    return f"    for (long gb_i = 0; gb_i < {length}; gb_i++) {var}[gb_i] = {value};\n"
+
+
+def _fill_string(var: str, length: str) -> str:
+    # Lowercase letters, then the terminating NUL: strlen() is length - 1.
+    return (
+        f"    for (long gb_i = 0; gb_i < {length} - 1; gb_i++) {var}[gb_i] = (char)('a' + gb_next() % 26);\n"
+        f"    {var}[{length} - 1] = 0;\n"
+    )
+
+
+_STREAM_PRELUDE = r"""
+static inline int gb_cmp_ll(const void *a, const void *b)
+{
+    long long x = *(const long long *)a, y = *(const long long *)b;
+    return (x > y) - (x < y);
+}
+"""
+
+
+def _fill_stream(var: str, index: int, domain: tuple, pattern: str) -> str:
+    """Fill *var* (gb_n long longs) with the stream's values in *pattern*'s order."""
+    lines = []
+    if domain[1] == "range":
+        lo, hi = domain[2], domain[3]
+        draw = f"{lo}LL + (long long)(gb_next() % {hi - lo + 1}ULL)"
+        ends = (f"{lo}LL", f"{hi}LL")
+    else:
+        values = domain[2]
+        lines.append(f"    static const long long gb_d{index}[] = {{{', '.join(f'{v}LL' for v in values)}}};\n")
+        draw = f"gb_d{index}[gb_next() % {len(values)}]"
+        ends = (f"gb_d{index}[0]", f"gb_d{index}[{len(values) - 1}]")
+    value = f"(gb_next() & 1) ? {ends[1]} : {ends[0]}" if pattern == "adversarial" else draw
+    lines.append(f"    for (long gb_i = 0; gb_i < gb_n; gb_i++) {var}[gb_i] = {value};\n")
+    if pattern == "sorted":
+        lines.append(f"    qsort({var}, (size_t)gb_n, sizeof(long long), gb_cmp_ll);\n")
+    return "".join(lines)
+
+
+def _stub(entry: BenchEntry) -> str:
+    # noipa: the compiler must not see through the stub into the benchmarked code.
+    params = ", ".join(f"{_C_TYPES[a]} gb_p{i}" for i, a in enumerate(entry.args)) or "void"
+    unused = "".join(f"    (void)gb_p{i};\n" for i in range(len(entry.args)))
+    return f"GB_NOINLINE void {entry.function}({params})\n{{\n{unused}    gb_sink++;\n}}\n"
+
+
+def _entry_runner(index: int, entry: BenchEntry, counters: bool = False, cast_arrays: bool = True) -> str:
+    lines = [f"static void gb_run_{index}(long gb_n, long gb_iters, int gb_repeats)\n{{\n"]
+    call_args = []
+    buffers = []
+    for i, a in enumerate(entry.args):
+        array = _ARRAY_RE.match(a)
+        if array:
+            ctype = _ARRAY_TYPES[array.group(1)]
+            var = f"gb_a{i}"
+            count = "(size_t)gb_n" + (f" * (size_t){'gb_n' if array.group(2) == 'n' else array.group(2)}" if array.group(2) else "")
+            lines.append(f"    long gb_len{i} = (long)({count});\n")
+            lines.append(f"    {ctype} *{var} = gb_alloc({count} * sizeof({ctype}));\n")
+            if array.group(1) == "str":
+                lines.append(_fill_string(var, f"gb_len{i}"))
+            else:
+                lines.append(_fill(var, ctype, f"gb_len{i}"))
+            # void * converts to whatever pointer the parameter is (a struct, a matrix row) in C.
+            call_args.append(f"(void *){var}" if cast_arrays else var)
+            buffers.append(var)
+        elif stream_domain(a):
+            domain = stream_domain(a)
+            var = f"gb_s{i}"
+            lines.append(f"    long long *{var} = (long long *)gb_alloc((size_t)gb_n * sizeof(long long));\n")
+            lines.append(_fill_stream(var, i, domain, entry.input or "random"))
+            call_args.append(f"({_C_TYPES[domain[0]]}){var}[gb_j]")
+            buffers.append(var)
+        elif a == "n":
+            call_args.append("gb_n")
+        else:
+            call_args.append(a)
+    call = f"gb_fn({', '.join(call_args)})"
+    if any(v.startswith("gb_s") for v in buffers):
+        # One call per stream value: an operation is a pass over all n of them.
+        call = f"for (long gb_j = 0; gb_j < gb_n; gb_j++) {call}"
+    lines.append(f"    __typeof__({entry.function}) *volatile gb_fn = {entry.function};\n")
+    lines.append(f"    {call};  /* warm-up */\n")
+    lines.append("    for (int gb_r = 0; gb_r < gb_repeats; gb_r++) {\n")
+    if counters:
+        lines.append("        double gb_v[GB_NCOUNTERS];\n")
+        lines.append("        gb_counters_start();\n")
+    lines.append("        double gb_t0 = gb_now_ns(), gb_c0 = GB_TICKS();\n")
+    lines.append(f"        for (long gb_k = 0; gb_k < gb_iters; gb_k++) {call};\n")
+    lines.append("        double gb_c1 = GB_TICKS(), gb_t1 = gb_now_ns();\n")
+    if counters:
+        lines.append("        gb_counters_stop(gb_v);\n")
+    lines.append(
+        f'        printf("@bench {entry.name} %ld %ld %.4f %.4f\\n", gb_n, gb_iters,\n'
+        "               (gb_t1 - gb_t0) / gb_iters, (gb_c1 - gb_c0) / gb_iters);\n"
+    )
+    if counters:
+        lines.append(f'        printf("@counters {entry.name} %ld", gb_n);\n')
+        lines.append("        for (int gb_c = 0; gb_c < GB_NCOUNTERS; gb_c++)\n")
+        lines.append('            printf(" %.4f", gb_v[gb_c] < 0 ? -1.0 : gb_v[gb_c] / gb_iters);\n')
+        lines.append('        printf("\\n");\n')
+    lines.append("    }\n")
+    for var in buffers:
+        lines.append(f"    free({var});\n")
+    lines.append("}\n")
+    return "".join(lines)
+
+
+def generate_driver(
+    source: str,
+    entries: Sequence[BenchEntry],
+    hints: GalleryHints,
+    sizes: Optional[Sequence[int]] = None,
+    counters: bool = False,
+    lang: Optional[str] = None,
+    stubs: Sequence[BenchEntry] = (),
+) -> str:
+    """*source* followed by a ``main()`` that times every entry at every size."""
+    sizes = sizes or hints.bench_sizes or list(DEFAULT_SIZES)
+    repeats = hints.bench_repeats or DEFAULT_REPEATS
+    parts = [source.rstrip("\n"), "\n", _DRIVER_PRELUDE]
+    if counters:
+        parts.append(_COUNTERS_PRELUDE)
+    if any(stream_domain(a) for e in entries for a in e.args):
+        parts.append(_STREAM_PRELUDE)
+    if stubs:
+        parts.append(_STUBS_PRELUDE)
+        for stub in stubs:
+            parts.append("\n" + _stub(stub))
+    cast_arrays = (lang or "c") != "c++"
+    for i, entry in enumerate(entries):
+        parts.append("\n" + _entry_runner(i, entry, counters, cast_arrays))
+    parts.append("\nint main(void)\n{\n")
+    if counters:
+        parts.append("    gb_counters_open();\n")
+    for n in sizes:
+        for i, entry in enumerate(entries):
+            parts.append(f"    gb_run_{i}({n}L, {iterations_for(entry.elements(n), hints)}L, {repeats});\n")
+    parts.append("    return 0;\n}\n")
+    return "".join(parts)
+
+
+def training_build(hints: GalleryHints, defines: Optional[Dict[str, str]] = None) -> Tuple[Optional[List[int]], str]:
+    """
+    ``(sizes, extra flags)`` of a PGO training run, as run_cell_benchmarks
+    builds: a variant that sets the ``bench-define`` macro (in *defines*,
+    already in the cell's flags) trains at that one size; otherwise a
+    ``bench-define`` source trains at its first size with the macro set to
+    it. Without ``bench-define``: every size, no extra flags. Raises
+    BenchSpecError for a variant value that is not a size.
+    """
+    if not hints.bench_define:
+        return None, ""
+    if hints.bench_define in (defines or {}):
+        value = defines[hints.bench_define]
+        if not value.isdigit():
+            raise BenchSpecError(f"bench-define {hints.bench_define}={value} is not a size")
+        return [int(value)], ""
+    n = (hints.bench_sizes or list(DEFAULT_SIZES))[0]
+    return [n], f"-D{hints.bench_define}={n}"
+
+
+def training_driver(
+    source: str, hints: GalleryHints, lang: Optional[str] = None, sizes: Optional[Sequence[int]] = None
+) -> str:
+    """
+    The driver a PGO scenario trains with: every ``bench`` entry at every
+    size (or *sizes*, see training_build), one sample each, over the
+    ``pgo-inputs`` patterns (default: the benchmarked ones). Raises
+    BenchSpecError for a bad hint.
+    """
+    entries = parse_bench_entries(hints.bench or "", hints.pgo_inputs or hints.bench_inputs or BENCH_INPUTS)
+    stubs = parse_bench_stubs(hints.bench_stubs) if hints.bench_stubs else []
+    return generate_driver(
+        source, entries, dataclasses.replace(hints, bench_repeats=1), sizes=sizes, lang=lang, stubs=stubs
+    )
+
+
+def _counter_summary(per_sample: List[List[float]], elements: int) -> Dict[str, Any]:
+    """Median of each counter over the samples (None where unavailable), per call and per element."""
+    per_op: Dict[str, Optional[float]] = {}
+    for i, name in enumerate(COUNTERS):
+        values = [sample[i] for sample in per_sample if sample[i] >= 0]
+        per_op[name] = statistics.median(values) if values else None
+    cycles, instructions = per_op["cycles"], per_op["instructions"]
+    return {
+        "counters": {**per_op, "ipc": instructions / cycles if cycles and instructions is not None else None},
+        "counters_per_element": {
+            name: (value / elements if value is not None and elements else None) for name, value in per_op.items()
+        },
+    }
+
+
+def parse_bench_output(stdout: str, entries: Sequence[BenchEntry] = ()) -> List[Dict[str, Any]]:
+    """Summarize ``@bench`` (and ``@counters``) lines: one record per (function, n)."""
+    samples: Dict[tuple, Dict[str, Any]] = {}
+    counter_samples: Dict[tuple, List[List[float]]] = {}
+    for line in stdout.splitlines():
+        line = line.strip()
+        m = _BENCH_LINE_RE.match(line)
+        if m:
+            key = (m.group(1), int(m.group(2)))
+            rec = samples.setdefault(key, {"iterations": int(m.group(3)), "ns": [], "ticks": []})
+            rec["ns"].append(float(m.group(4)))
+            rec["ticks"].append(float(m.group(5)))
+            continue
+        m = _COUNTERS_LINE_RE.match(line)
+        if m:
+            counter_samples.setdefault((m.group(1), int(m.group(2))), []).append([float(v) for v in m.group(3).split()])
+
+    by_name = {e.name: e for e in entries}
+    results = []
+    for (function, n), rec in samples.items():
+        entry = by_name.get(function)
+        elements = entry.elements(n) if entry else n
+        ns, ticks = rec["ns"], rec["ticks"]
+        median_ns = statistics.median(ns)
+        stdev_ns = statistics.stdev(ns) if len(ns) > 1 else 0.0
+        mean_ns = statistics.mean(ns)
+        median_ticks = statistics.median(ticks)
+        result = {
+            "function": function,
+            "n": n,
+            "elements": elements,
+            "iterations": rec["iterations"],
+            "samples": len(ns),
+            "ns_per_op": median_ns,
+            "ns_per_element": median_ns / elements if elements else None,
+            "cycles_per_element": (median_ticks / elements) if elements and median_ticks > 0 else None,
+            "cycles_per_op": median_ticks if median_ticks > 0 else None,
+            "stdev_ns": stdev_ns,
+            "cv": (stdev_ns / mean_ns) if mean_ns > 0 else 0.0,
+            "samples_ns": ns,
+        }
+        if entry and entry.input:
+            result["input"] = entry.input
+        if (function, n) in counter_samples:
+            result.update(_counter_summary(counter_samples[(function, n)], elements))
+        results.append(result)
+    return results
+
+
+def _counters_status(stdout: str) -> Dict[str, Any]:
+    """How many counters the driver opened, and why the others are missing."""
+    for line in stdout.splitlines():
+        m = _COUNTERS_OPEN_RE.match(line.strip())
+        if m:
+            opened, err = int(m.group(1)), int(m.group(2))
+            status: Dict[str, Any] = {"opened": opened, "of": len(COUNTERS)}
+            if opened < len(COUNTERS):
+                status["error"] = _COUNTER_ERRORS.get(err, f"perf_event_open failed (errno {err})")
+            return status
+    return {"opened": 0, "of": len(COUNTERS), "error": "the driver printed no @counters-open line"}
+
+
+def run_cell_benchmarks(
+    backend: ExecBackend,
+    compiler_id: str,
+    source: str,
+    hints: GalleryHints,
+    user_arguments: str,
+    lang: Optional[str] = None,
+    timeout_s: float = 120.0,
+    counters: bool = False,
+    defines: Optional[Dict[str, str]] = None,
+    profile: Optional[bytes] = None,
+) -> Optional[Dict[str, Any]]:
+    """
+    Build and run the benchmark driver for one cell. Returns the
+    ``.bench.json`` record, or None if the source declares no benchmarks.
+    Build and run failures are recorded in the result, not raised.
+    *counters* reads hardware counters even if the hints do not ask for them.
+    *defines* are those of a ``sweep-defines`` variant, already in
+    *user_arguments*; if they set the ``bench-define`` macro, the variant
+    runs at that one size. *profile* is a PGO cell's (local backends only).
+    """
+    if not hints.bench:
+        return None
+    counters = counters or hints.bench_counters
+    try:
+        entries = parse_bench_entries(hints.bench, hints.bench_inputs or BENCH_INPUTS)
+        stubs = parse_bench_stubs(hints.bench_stubs) if hints.bench_stubs else []
+    except BenchSpecError as e:
+        return {"compiler": compiler_id, "flags": user_arguments, "ok": False, "error": str(e), "results": []}
+
+    # One build for all sizes, or (bench-define) one per size with the macro set to it.
+    sizes = hints.bench_sizes or list(DEFAULT_SIZES)
+    builds = [(None, user_arguments)]
+    if hints.bench_define and hints.bench_define in (defines or {}):
+        value = defines[hints.bench_define]
+        if not value.isdigit():
+            return {"compiler": compiler_id, "flags": user_arguments, "ok": False, "results": [],
+                    "error": f"bench-define {hints.bench_define}={value} is not a size"}
+        builds = [([int(value)], user_arguments)]
+    elif hints.bench_define:
+        builds = [([n], f"{user_arguments} -D{hints.bench_define}={n}".strip()) for n in sizes]
+    stdout, res = "", None
+    extra = {"profile": profile} if profile is not None else {}
+    for build_sizes, flags in builds:
+        driver = generate_driver(source, entries, hints, sizes=build_sizes, counters=counters, lang=lang, stubs=stubs)
+        res = backend.execute(
+            compiler_id=compiler_id, source=driver, user_arguments=flags, lang=lang, timeout_s=timeout_s, **extra
+        )
+        if res.code != 0:
+            break
+        stdout += res.stdout
+    results = parse_bench_output(stdout, entries) if res.code == 0 else []
+    record: Dict[str, Any] = {
+        "compiler": compiler_id,
+        "flags": user_arguments,
+        "runner": res.runner,
+        "ok": res.code == 0 and bool(results),
+        "results": results,
+    }
+    if hints.bench_define:
+        record["define"] = hints.bench_define
+    if hints.bench_baseline:
+        record["baseline"] = hints.bench_baseline
+    if counters and res.code == 0:
+        record["counters"] = _counters_status(stdout)
+    if not record["ok"]:
+        detail = res.stderr or res.stdout
+        if res.code == 0 and not detail:
+            detail = "the driver printed no @bench lines"
+        record["error"] = (detail or f"exit code {res.code}")[-4000:]
+    return record
+
+
+# ---------------------------
+# Constant-time timing test
+# ---------------------------
+
+DUDECT_MEASUREMENTS = 100_000
+DUDECT_SIZE = 64  # n for constant-time entries that take it
+_DUDECT_POOL = 256  # prepared inputs, each fixed or random
+# Timings above these percentiles are dropped (100: none), as in dudect: the
+# leak often shows only once interrupts and other outliers are cut off.
+DUDECT_CROPS = (100, 99, 95, 90, 80, 50)
+
+_DUDECT_LINE_RE = re.compile(r"^@dudect\s+(\S+)\s+(\d+)((?:\s+[\d.eE+-]+){6})\s*$")
+_DUDECT_TIMER_RE = re.compile(r"^@dudect-timer\s+(\w+)\s*$")
+
+_DUDECT_PRELUDE = r"""
+#include <string.h>
+#if defined(__x86_64__) || defined(__i386__)
+#define GB_CT_NOW() ((double)__rdtsc())
+#define GB_CT_TIMER "tsc"
+#else
+#define GB_CT_NOW() gb_now_ns()
+#define GB_CT_TIMER "ns"
+#endif
+
+static int gb_cmp_double(const void *a, const void *b)
+{
+    double x = *(const double *)a, y = *(const double *)b;
+    return (x > y) - (x < y);
+}
+
+/* Welford's running mean and squared deviations per class, for timings <= limit */
+static void gb_ct_report(const char *name, int crop, const double *t, const unsigned char *cls, long m, double limit)
+{
+    long cnt[2] = {0, 0};
+    double mean[2] = {0, 0}, m2[2] = {0, 0};
+    for (long k = m / 10; k < m; k++) {  /* the first 10% warm up caches and predictors */
+        if (t[k] > limit)
+            continue;
+        int c = cls[k];
+        double d = t[k] - mean[c];
+        cnt[c]++;
+        mean[c] += d / cnt[c];
+        m2[c] += d * (t[k] - mean[c]);
+    }
+    printf("@dudect %s %d %ld %.6f %.6f %ld %.6f %.6f\n", name, crop, cnt[0], mean[0], m2[0], cnt[1], mean[1], m2[1]);
+}
+"""
+
+
+def _dudect_runner(index: int, name: str, args: List[str], measurements: int, cast_arrays: bool) -> str:
+    lines = [f"static void gb_ct_{index}(void)\n{{\n", f"    long gb_n = {DUDECT_SIZE}, gb_m = {measurements};\n"]
+    call_args, buffers, first = [], [], None
+    for i, a in enumerate(args):
+        array = _ARRAY_RE.match(a)
+        if array:
+            ctype = _C_TYPES[array.group(1)]
+            var = f"gb_a{i}"
+            count = "(size_t)gb_n" + (f" * (size_t){'gb_n' if array.group(2) == 'n' else array.group(2)}" if array.group(2) else "")
+            lines.append(f"    long gb_len{i} = (long)({count});\n")
+            lines.append(f"    {ctype} *{var} = gb_alloc({count} * sizeof({ctype}));\n")
+            # Every array gets the same fixed contents: the same seed, the same sequence.
+            lines.append("    gb_state = 0x9E3779B97F4A7C15ULL;\n")
+            lines.append(_fill(var, ctype, f"gb_len{i}"))
+            call_args.append(f"(void *){var}" if cast_arrays else var)
+            buffers.append(var)
+            if first is None:
+                first = (var, ctype, f"gb_len{i}")
+        elif a == "n":
+            call_args.append("gb_n")
+        else:
+            call_args.append(a)
+    if first is not None:
+        var, ctype, length = first
+        lines.append(f"    {ctype} *gb_pool = gb_alloc((size_t){_DUDECT_POOL} * {length} * sizeof({ctype}));\n")
+        lines.append(f"    unsigned char gb_pool_cls[{_DUDECT_POOL}];\n")
+        lines.append(f"    for (int gb_p = 0; gb_p < {_DUDECT_POOL}; gb_p++) {{\n")
+        lines.append(f"        {ctype} *gb_dst = gb_pool + (size_t)gb_p * {length};\n")
+        lines.append("        gb_pool_cls[gb_p] = (unsigned char)(gb_next() & 1);\n")
+        lines.append("        if (gb_pool_cls[gb_p] == 0)\n")
+        lines.append(f"            memcpy(gb_dst, {var}, {length} * sizeof({ctype}));\n")
+        lines.append("        else\n    ")
+        lines.append(_fill("gb_dst", ctype, length).replace("    for", "    for", 1))
+        lines.append("    }\n")
+        buffers.append("gb_pool")
+    lines.append("    double *gb_t = gb_alloc((size_t)gb_m * sizeof(double));\n")
+    lines.append("    unsigned char *gb_cls = gb_alloc((size_t)gb_m);\n")
+    lines.append(f"    __typeof__({name}) *volatile gb_fn = {name};\n")
+    lines.append("    for (long gb_k = 0; gb_k < gb_m; gb_k++) {\n")
+    if first is not None:
+        var, ctype, length = first
+        lines.append(f"        int gb_p = (int)(gb_next() % {_DUDECT_POOL});\n")
+        lines.append(f"        memcpy({var}, gb_pool + (size_t)gb_p * {length}, {length} * sizeof({ctype}));\n")
+        lines.append("        gb_cls[gb_k] = gb_pool_cls[gb_p];\n")
+    else:
+        lines.append("        gb_cls[gb_k] = (unsigned char)(gb_next() & 1);\n")
+    lines.append("        double gb_t0 = GB_CT_NOW();\n")
+    lines.append(f"        gb_fn({', '.join(call_args)});\n")
+    lines.append("        gb_t[gb_k] = GB_CT_NOW() - gb_t0;\n")
+    lines.append("    }\n")
+    lines.append("    double *gb_sorted = gb_alloc((size_t)gb_m * sizeof(double));\n")
+    lines.append("    memcpy(gb_sorted, gb_t, (size_t)gb_m * sizeof(double));\n")
+    lines.append("    qsort(gb_sorted, (size_t)gb_m, sizeof(double), gb_cmp_double);\n")
+    crops = ", ".join(str(c) for c in DUDECT_CROPS)
+    lines.append(f"    static const int gb_crops[] = {{{crops}}};\n")
+    lines.append(f"    for (int gb_q = 0; gb_q < {len(DUDECT_CROPS)}; gb_q++) {{\n")
+    lines.append("        double gb_limit = gb_crops[gb_q] >= 100 ? gb_sorted[gb_m - 1] : gb_sorted[(long)((double)gb_m * gb_crops[gb_q] / 100.0)];\n")
+    lines.append(f'        gb_ct_report("{name}", gb_crops[gb_q], gb_t, gb_cls, gb_m, gb_limit);\n')
+    lines.append("    }\n")
+    for v in buffers + ["gb_t", "gb_cls", "gb_sorted"]:
+        lines.append(f"    free({v});\n")
+    lines.append("}\n")
+    return "".join(lines)
+
+
+def generate_dudect_driver(
+    source: str, entries: Sequence[tuple], measurements: int, lang: Optional[str] = None
+) -> str:
+    """*source* followed by a ``main()`` that runs the fixed-vs-random timing test on every entry."""
+    parts = [source.rstrip("\n"), "\n", _DRIVER_PRELUDE, _DUDECT_PRELUDE]
+    cast_arrays = (lang or "c") != "c++"
+    for i, (name, args) in enumerate(entries):
+        parts.append("\n" + _dudect_runner(i, name, args, measurements, cast_arrays))
+    parts.append('\nint main(void)\n{\n')
+    parts.append('    printf("@dudect-timer %s\\n", GB_CT_TIMER);\n')
+    for i in range(len(entries)):
+        parts.append(f"    gb_ct_{i}();\n")
+    parts.append("    return 0;\n}\n")
+    return "".join(parts)
+
+
+def parse_dudect_output(stdout: str) -> List[Dict[str, Any]]:
+    """One result per function: the largest |t| over the crops, and the verdict."""
+    by_function: Dict[str, List[Dict[str, Any]]] = {}
+    for line in stdout.splitlines():
+        m = _DUDECT_LINE_RE.match(line.strip())
+        if not m:
+            continue
+        n0, mean0, m2_0, n1, mean1, m2_1 = (float(v) for v in m.group(3).split())
+        t = welch_t(int(n0), mean0, m2_0, int(n1), mean1, m2_1)
+        by_function.setdefault(m.group(1), []).append({
+            "crop": int(m.group(2)), "t": t, "n": [int(n0), int(n1)], "mean": [mean0, mean1],
+        })
+    results = []
+    for function, crops in by_function.items():
+        scored = [c for c in crops if c["t"] is not None]
+        worst = max(scored, key=lambda c: abs(c["t"]), default=None)
+        results.append({
+            "function": function,
+            "t": worst["t"] if worst else None,
+            "crop": worst["crop"] if worst else None,
+            "measurements": sum(crops[0]["n"]) if crops else 0,
+            "mean": worst["mean"] if worst else None,
+            "crops": crops,
+            "verdict": dudect_verdict(worst["t"] if worst else None),
+        })
+    return results
+
+
+def run_cell_dudect(
+    backend: ExecBackend,
+    compiler_id: str,
+    source: str,
+    hints: GalleryHints,
+    user_arguments: str,
+    lang: Optional[str] = None,
+    timeout_s: float = 120.0,
+    profile: Optional[bytes] = None,
+) -> Optional[Dict[str, Any]]:
+    """
+    Build and run the fixed-vs-random timing test for the functions in the
+    ``constant-time`` hint. Returns the ``.dudect.json`` record, or None if
+    the source marks no functions. Failures are recorded, not raised.
+    """
+    if not hints.constant_time:
+        return None
+    try:
+        entries = parse_entries(hints.constant_time)
+        for _, args in entries:
+            for a in args:
+                array = _ARRAY_RE.match(a)
+                if a != "n" and not _NUMBER_RE.match(a) and not (array and array.group(1) in _C_TYPES):
+                    raise ValueError(f"unknown constant-time argument {a!r}")
+    except ValueError as e:
+        return {"compiler": compiler_id, "flags": user_arguments, "ok": False, "error": str(e), "results": []}
+    measurements = hints.constant_time_measurements or DUDECT_MEASUREMENTS
+    driver = generate_dudect_driver(source, entries, measurements, lang=lang)
+    extra = {"profile": profile} if profile is not None else {}
+    res = backend.execute(
+        compiler_id=compiler_id, source=driver, user_arguments=user_arguments, lang=lang, timeout_s=timeout_s, **extra
+    )
+    results = parse_dudect_output(res.stdout) if res.code == 0 else []
+    timer = next((m.group(1) for m in map(_DUDECT_TIMER_RE.match, res.stdout.splitlines()) if m), None)
+    record: Dict[str, Any] = {
+        "compiler": compiler_id,
+        "flags": user_arguments,
+        "runner": res.runner,
+        "ok": res.code == 0 and bool(results),
+        "timer": timer,
+        "size": DUDECT_SIZE,
+        "threshold": T_THRESHOLD,
+        "results": results,
+    }
+    if not record["ok"]:
+        record["error"] = ((res.stderr or res.stdout) or f"exit code {res.code}")[-4000:]
+    return record
+
+
+def dudect_cell(cell: CompiledCell, backend: ExecBackend, outputs: Optional[OutputStore] = None) -> Optional[Dict[str, Any]]:
+    """Run the timing test for a freshly compiled cell and write ``<stem>.dudect.json``."""
+    ctx = cell.ctx
+    record = run_cell_dudect(
+        backend, ctx.compiler_id, cell.src_text, parse_gallery_hints(cell.src_text), cell.effective_flags, lang=ctx.ce_lang_id,
+        profile=cell.profile,
+    )
+    if record is not None:
+        record["scenario"] = ctx.scenario_name
+        _write_json(outputs, ctx.out_dir / f"{ctx.base}{DUDECT_SUFFIX}", record)
+    return record
+
+
+def bench_cell(
+    cell: CompiledCell, backend: ExecBackend, outputs: Optional[OutputStore] = None, counters: bool = False
+) -> Optional[Dict[str, Any]]:
+    """
+    Benchmark a freshly compiled cell and write ``<stem>.bench.json``.
+    With an ``overhead`` hint the benchmarks run again without the
+    hardening flags; that run goes to the record's ``overhead``. A PGO
+    cell's benchmarks build with its profile (and get no overhead run).
+    """
+    ctx = cell.ctx
+    hints = parse_gallery_hints(cell.src_text)
+    record = run_cell_benchmarks(
+        backend, ctx.compiler_id, cell.src_text, hints,
+        cell.effective_flags, lang=ctx.ce_lang_id, counters=counters, defines=dict(ctx.defines), profile=cell.profile,
+    )
+    baseline_flags = hints.overhead_flags(ctx.ce_user_arguments)
+    if record is not None and baseline_flags is not None and not ctx.pgo:
+        baseline_flags = f"{baseline_flags} {ctx.define_flags}".strip()
+        baseline = run_cell_benchmarks(
+            backend, ctx.compiler_id, cell.src_text, hints,
+            baseline_flags, lang=ctx.ce_lang_id, counters=counters, defines=dict(ctx.defines),
+        )
+        record["overhead"] = {k: baseline[k] for k in ("flags", "ok", "results", "error") if k in baseline}
+    if record is not None:
+        record["scenario"] = ctx.scenario_name
+        _write_json(outputs, ctx.out_dir / f"{ctx.base}{BENCH_SUFFIX}", record)
+    return record
+
+
+__all__ = [
+    "BENCH_INPUTS",
+    "BENCH_SUFFIX",
+    "BenchEntry",
+    "BenchSpecError",
+    "COUNTERS",
+    "bench_cell",
+    "dudect_cell",
+    "generate_driver",
+    "generate_dudect_driver",
+    "parse_bench_entries",
+    "parse_bench_output",
+    "parse_bench_stubs",
+    "parse_dudect_output",
+    "run_cell_benchmarks",
+    "run_cell_dudect",
+    "stream_domain",
+    "training_build",
+    "training_driver",
+]
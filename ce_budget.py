@@ -0,0 +1,195 @@
+# Copyright (c) 2026 Larry H <l.gr [at] dartmouth [dot] edu>
+# SPDX-License-Identifier: AGPL-3.0-or-later
+#
+# Compiler Optimization Gallery
+# Developed for COSC-69.16: Basics of Reverse Engineering
+# Dartmouth College, Winter 2026
+
+"""
+ce_budget.py
+
+Per-file cost accounting for ce_batch.py. Every compile and explain adds its
+payload sizes, assembly line count, explain token usage and wall time to the
+row of its (compiler, source file) pair, summed over scenarios. At the end of
+a run the rows are printed as a ranked table, and rows over a budget are
+reported as warnings. Budgets come from an optional ``budgets`` mapping in
+config.yaml:
+
+    budgets:
+      asm_lines: 20000          # any subset of the metrics below
+      explain_tokens: 150000
+      overrides:                # globs over source keys; first match wins
+        "security/padding-leak": {asm_lines: 40000}
+
+Metrics: ``bytes_sent`` and ``bytes_received`` (compile and explain JSON
+payloads, whether or not they came from a cache), ``asm_lines``,
+``explain_tokens`` (as the explain API reports them; zero for shared
+explanations) and ``seconds``. Only depends on the standard library.
+"""
+
+from __future__ import annotations
+
+import fnmatch
+import json
+import threading
+from dataclasses import dataclass, field
+from typing import Any, Dict, List, Tuple
+
+METRICS = ("bytes_sent", "bytes_received", "asm_lines", "explain_tokens", "seconds")
+
+
+class BudgetError(ValueError):
+    pass
+
+
+@dataclass
+class FileUsage:
+    compiler: str
+    source: str
+    cells: int = 0
+    bytes_sent: int = 0
+    bytes_received: int = 0
+    asm_lines: int = 0
+    explain_tokens: int = 0
+    seconds: float = 0.0
+
+    def as_dict(self) -> Dict[str, Any]:
+        return {
+            "compiler": self.compiler, "source": self.source, "cells": self.cells,
+            **{m: getattr(self, m) for m in METRICS},
+        }
+
+
+@dataclass(frozen=True)
+class Budgets:
+    limits: Dict[str, float] = field(default_factory=dict)
+    overrides: Tuple[Tuple[str, Dict[str, float]], ...] = ()
+
+    def limits_for(self, source: str) -> Dict[str, float]:
+        for glob, limits in self.overrides:
+            if fnmatch.fnmatchcase(source, glob):
+                return {**self.limits, **limits}
+        return self.limits
+
+
+def _parse_limits(raw: Any, where: str) -> Dict[str, float]:
+    if not isinstance(raw, dict):
+        raise BudgetError(f"{where} must be a mapping of metric to limit")
+    limits = {}
+    for metric, value in raw.items():
+        if metric not in METRICS:
+            raise BudgetError(f"{where}: unknown metric {metric!r} (expected one of {', '.join(METRICS)})")
+        if isinstance(value, bool) or not isinstance(value, (int, float)) or value <= 0:
+            raise BudgetError(f"{where}: '{metric}' must be a positive number")
+        limits[metric] = value
+    return limits
+
+
+def load_budgets(config: Dict[str, Any]) -> Budgets:
+    """Parse the config's ``budgets`` mapping (missing: no budgets)."""
+    raw = config.get("budgets")
+    if raw is None:
+        return Budgets()
+    if not isinstance(raw, dict):
+        raise BudgetError("'budgets' must be a mapping")
+    raw = dict(raw)
+    overrides_raw = raw.pop("overrides", None) or {}
+    if not isinstance(overrides_raw, dict):
+        raise BudgetError("'budgets.overrides' must be a mapping of source glob to limits")
+    overrides = tuple(
+        (str(glob), _parse_limits(limits, f"budgets.overrides[{glob!r}]"))
+        for glob, limits in overrides_raw.items()
+    )
+    return Budgets(limits=_parse_limits(raw, "budgets"), overrides=overrides)
+
+
+def payload_size(obj: Any) -> int:
+    """Size of *obj* as compact JSON, the way it goes over the wire."""
+    return len(json.dumps(obj, separators=(",", ":"), ensure_ascii=False).encode("utf-8"))
+
+
+def explain_tokens(response: Dict[str, Any]) -> int:
+    usage = response.get("usage") if isinstance(response, dict) else None
+    if not isinstance(usage, dict):
+        return 0
+    total = usage.get("totalTokens")
+    if isinstance(total, int):
+        return total
+    return sum(v for v in (usage.get("inputTokens"), usage.get("outputTokens")) if isinstance(v, int))
+
+
+class UsageTracker:
+    """Thread-safe per-(compiler, source) accumulator."""
+
+    def __init__(self) -> None:
+        self._lock = threading.Lock()
+        self._rows: Dict[Tuple[str, str], FileUsage] = {}
+
+    def add(self, compiler: str, source: str, *, cells: int = 0, **amounts: float) -> None:
+        with self._lock:
+            row = self._rows.get((compiler, source))
+            if row is None:
+                row = self._rows[(compiler, source)] = FileUsage(compiler=compiler, source=source)
+            row.cells += cells
+            for metric, amount in amounts.items():
+                setattr(row, metric, getattr(row, metric) + amount)
+
+    def rows(self, sort_by: str = "bytes_sent") -> List[FileUsage]:
+        """All rows, largest *sort_by* first."""
+        with self._lock:
+            rows = list(self._rows.values())
+        return sorted(rows, key=lambda r: (-getattr(r, sort_by), r.compiler, r.source))
+
+    def over_budget(self, budgets: Budgets) -> List[Tuple[FileUsage, str, float]]:
+        """(row, metric, limit) for every limit a row exceeds."""
+        found = []
+        for row in self.rows():
+            for metric, limit in budgets.limits_for(row.source).items():
+                if getattr(row, metric) > limit:
+                    found.append((row, metric, limit))
+        return found
+
+
+def _fmt(metric: str, value: float) -> str:
+    if metric == "seconds":
+        return f"{value:.1f}s"
+    if metric.startswith("bytes_"):
+        return f"{value / 1024:.0f} KiB" if value >= 1024 else f"{value:.0f} B"
+    return f"{value:.0f}"
+
+
+def report_lines(tracker: UsageTracker, top: int, sort_by: str = "bytes_sent") -> List[str]:
+    """The *top* rows as an aligned table, ranked by *sort_by*."""
+    rows = tracker.rows(sort_by)[:top]
+    if not rows:
+        return []
+    header = ["file", "compiler", "sent", "received", "asm lines", "tokens", "time"]
+    table = [[r.source, r.compiler, *(_fmt(m, getattr(r, m)) for m in METRICS)] for r in rows]
+    widths = [max(len(row[i]) for row in [header, *table]) for i in range(len(header))]
+    lines = []
+    for row in [header, *table]:
+        cols = [row[0].ljust(widths[0]), row[1].ljust(widths[1])] + [c.rjust(w) for c, w in zip(row[2:], widths[2:])]
+        lines.append("  " + "  ".join(cols).rstrip())
+    return lines
+
+
+def budget_warning_lines(tracker: UsageTracker, budgets: Budgets) -> List[str]:
+    return [
+        f"  {row.compiler}/{row.source}: {metric.replace('_', ' ')} {_fmt(metric, getattr(row, metric))}"
+        f" > budget {_fmt(metric, limit)}"
+        for row, metric, limit in tracker.over_budget(budgets)
+    ]
+
+
+__all__ = [
+    "METRICS",
+    "BudgetError",
+    "Budgets",
+    "FileUsage",
+    "UsageTracker",
+    "budget_warning_lines",
+    "explain_tokens",
+    "load_budgets",
+    "payload_size",
+    "report_lines",
+]
@@ -0,0 +1,115 @@
+# Copyright (c) 2026 Larry H <l.gr [at] dartmouth [dot] edu>
+# SPDX-License-Identifier: AGPL-3.0-or-later
+#
+# Compiler Optimization Gallery
+# Developed for COSC-69.16: Basics of Reverse Engineering
+# Dartmouth College, Winter 2026
+
+"""
+ce_cache.py
+
+Content-addressed local cache for Compiler Explorer compile and Claude Explain
+responses.
+
+Entries are keyed by a hash of the request payload that determines the
+response (see ``CompilerExplorerClient._cache_key``): for compiles that is the
+compiler ID, source text, effective flags, filters, tools and libraries; for
+explains it is the full explain payload (source, asm, options, instruction
+set, audience, explanation type). ``bypassCache`` is not part of the key, so a
+forced refresh overwrites the same entry.
+
+Layout:
+    <root>/
+      compile/<k[:2]>/<key>.json    # {"request": ..., "response": ...}
+      explain/<k[:2]>/<key>.json
+
+A hit refreshes the entry's modification time, so ``prune`` can drop the
+entries no run has read or written for a while: those of superseded
+sources and flags, which would otherwise stay forever.
+"""
+
+from __future__ import annotations
+
+import json
+import os
+import threading
+import time
+from pathlib import Path
+from typing import Any, Dict, Optional, Tuple
+
+
+class ResultCache:
+    """
+    On-disk response cache shared by all worker threads.
+
+    Writes go to a temporary file and are renamed into place, so a reader
+    never sees a partially written entry and an interrupted run leaves no
+    corrupt files behind.
+    """
+
+    def __init__(self, root: Path) -> None:
+        self.root = Path(root)
+        self.hits = 0
+        self.misses = 0
+        self._lock = threading.Lock()
+
+    def _path(self, kind: str, key: str) -> Path:
+        return self.root / kind / key[:2] / f"{key}.json"
+
+    def get(self, kind: str, key: str) -> Optional[Dict[str, Any]]:
+        """Return the cached ``{"request", "response"}`` entry, or None."""
+        path = self._path(kind, key)
+        try:
+            entry = json.loads(path.read_text(encoding="utf-8"))
+        except (OSError, ValueError):
+            entry = None
+        if not isinstance(entry, dict) or "response" not in entry:
+            entry = None
+        if entry is not None:
+            try:
+                os.utime(path)  # still in use; see prune
+            except OSError:
+                pass
+        with self._lock:
+            if entry is None:
+                self.misses += 1
+            else:
+                self.hits += 1
+        return entry
+
+    def put(self, kind: str, key: str, request: Dict[str, Any], response: Any) -> None:
+        path = self._path(kind, key)
+        path.parent.mkdir(parents=True, exist_ok=True)
+        tmp = path.with_name(f"{path.name}.{os.getpid()}.{threading.get_ident()}.tmp")
+        tmp.write_text(
+            json.dumps({"request": request, "response": response}, separators=(",", ":")),
+            encoding="utf-8",
+        )
+        os.replace(tmp, path)
+
+    def prune(self, max_age_s: float) -> Tuple[int, int]:
+        """
+        Delete entries (and leftover temporary files) not read or written in
+        the last *max_age_s* seconds. Returns (files removed, bytes freed).
+        """
+        cutoff = time.time() - max_age_s
+        removed = freed = 0
+        for path in self.root.glob("*/??/*"):
+            if not (path.name.endswith(".json") or path.name.endswith(".tmp")):
+                continue
+            try:
+                st = path.stat()
+                if st.st_mtime >= cutoff:
+                    continue
+                path.unlink()
+            except OSError:
+                continue
+            removed += 1
+            freed += st.st_size
+        return removed, freed
+
+    def stats_str(self) -> str:
+        with self._lock:
+            total = self.hits + self.misses
+            rate = (self.hits / total * 100) if total else 0.0
+            return f"{self.hits} hits, {self.misses} misses ({rate:.1f}% hit rate)"
@@ -0,0 +1,128 @@
+# Copyright (c) 2026 Larry H <l.gr [at] dartmouth [dot] edu>
+# SPDX-License-Identifier: AGPL-3.0-or-later
+#
+# Compiler Optimization Gallery
+# Developed for COSC-69.16: Basics of Reverse Engineering
+# Dartmouth College, Winter 2026
+
+"""
+ce_catalog.py
+
+The compiler IDs of a Compiler Explorer instance, kept on disk so that
+ce_batch.py does not download the full ``/api/compilers`` list (thousands
+of entries) before every run. Only the ``id`` field is requested, and the
+result is stored as ``compilers.json`` in the response cache directory:
+
+    {"version": 1, "url": "https://godbolt.org", "fields": ["id"],
+     "etag": "W/\"5c1d...\"", "fetched_at": 1760400000.0, "ids": ["cg152", ...]}
+
+A catalog younger than its TTL (``--catalog-ttl``, 24 hours by default) is
+used as is. An older one is revalidated with ``If-None-Match``: a ``304 Not
+Modified`` answer only renews it. If the instance cannot be reached, a
+stored catalog is used whatever its age, with a warning, so a run whose
+compilers are all in it still starts offline. A requested ID that the
+stored catalog lacks triggers one fresh download before it is reported
+missing, in case the instance added it since. With ``--backend local`` no
+compiler is remote and the catalog is never read.
+"""
+
+from __future__ import annotations
+
+import json
+import os
+import time
+from pathlib import Path
+from typing import List, Optional, Sequence, Set, Tuple
+
+from ce_client import CEError, CompilerExplorerClient
+
+CATALOG_VERSION = 1
+CATALOG_FILE = "compilers.json"
+CATALOG_FIELDS = ("id",)
+DEFAULT_TTL_HOURS = 24.0
+
+
+class CompilerCatalog:
+    """The compiler IDs of *client*'s CE instance, cached in *path* for *ttl_s* seconds (None: not cached)."""
+
+    def __init__(self, client: CompilerExplorerClient, path: Optional[Path], ttl_s: float) -> None:
+        self.client = client
+        self.path = path
+        self.ttl_s = ttl_s
+        self.source = ""  # how the last ids() call got its answer, for the log line
+
+    def _load(self) -> Optional[dict]:
+        if self.path is None:
+            return None
+        try:
+            stored = json.loads(self.path.read_text(encoding="utf-8"))
+        except (OSError, ValueError):
+            return None
+        if (
+            not isinstance(stored, dict)
+            or stored.get("version") != CATALOG_VERSION
+            or stored.get("url") != self.client.ce_base_url
+            or stored.get("fields") != list(CATALOG_FIELDS)
+            or not isinstance(stored.get("ids"), list)
+        ):
+            return None
+        return stored
+
+    def _store(self, ids: Sequence[str], etag: Optional[str]) -> None:
+        if self.path is None:
+            return
+        self.path.parent.mkdir(parents=True, exist_ok=True)
+        record = {
+            "version": CATALOG_VERSION,
+            "url": self.client.ce_base_url,
+            "fields": list(CATALOG_FIELDS),
+            "etag": etag,
+            "fetched_at": time.time(),
+            "ids": sorted(ids),
+        }
+        tmp = self.path.with_name(f"{self.path.name}.{os.getpid()}.tmp")
+        tmp.write_text(json.dumps(record, separators=(",", ":")), encoding="utf-8")
+        os.replace(tmp, self.path)
+
+    def _fetch(self, stored: Optional[dict]) -> Tuple[List[str], bool]:
+        """IDs from the instance, and whether they are the *stored* ones (304)."""
+        etag = stored.get("etag") if stored else None
+        data, new_etag = self.client.get_compilers_if_changed(fields=list(CATALOG_FIELDS), etag=etag)
+        if data is None:
+            assert stored is not None
+            ids = [str(i) for i in stored["ids"]]
+            self._store(ids, new_etag or etag)
+            return ids, True
+        ids = [item["id"] for item in data if isinstance(item, dict) and isinstance(item.get("id"), str)]
+        self._store(ids, new_etag)
+        return ids, False
+
+    def ids(self, refresh: bool = False) -> Set[str]:
+        """
+        The instance's compiler IDs; *refresh* skips the TTL (a stored
+        catalog is still revalidated rather than downloaded again).
+        """
+        stored = self._load()
+        if stored is not None and not refresh:
+            age = time.time() - float(stored.get("fetched_at") or 0)
+            if 0 <= age < self.ttl_s:
+                self.source = f"cached catalog, {age / 3600:.1f}h old"
+                return {str(i) for i in stored["ids"]}
+        try:
+            ids, unchanged = self._fetch(stored)
+        except CEError as e:
+            if stored is None:
+                raise
+            print(f"\nWarning: could not refresh the compiler catalog ({str(e).splitlines()[0]}); using the stored one")
+            self.source = "stored catalog, offline"
+            return {str(i) for i in stored["ids"]}
+        self.source = "catalog unchanged" if unchanged else f"downloaded {len(ids)} ids"
+        return set(ids)
+
+
+__all__ = [
+    "CATALOG_FIELDS",
+    "CATALOG_FILE",
+    "DEFAULT_TTL_HOURS",
+    "CompilerCatalog",
+]
@@ -7,16 +7,33 @@
 
 from __future__ import annotations
 
+import ast
+import gzip
+import itertools
 import json
 import re
+import threading
 import time
 import hashlib
+from concurrent.futures import ThreadPoolExecutor
+from contextlib import contextmanager
 from dataclasses import dataclass
 from pathlib import Path
-from typing import Any, Callable, Dict, Iterable, List, Optional, Set, Tuple
+from typing import Any, Callable, Dict, Iterable, Iterator, List, Optional, Protocol, Sequence, Set, Tuple
 import urllib.parse
 
-import requests
+from ce_cache import ResultCache
+from ce_compiletime import COMPILETIME_SUFFIX, compiletime_record, time_report_flags
+from ce_consttime import CONSTTIME_SUFFIX, consttime_record
+from ce_mca import MCA_SUFFIX, mca_record
+from ce_metrics import METRICS_SUFFIX, cell_metrics, function_hash, function_sections, split_functions
+from ce_overhead import OVERHEAD_SUFFIX, overhead_record
+from ce_pgo import PGO_SUFFIX, TrainedProfile
+from ce_remarks import REMARKS_SUFFIX, remark_flags, remarks_record
+from ce_store import PathLike, OutputStore
+from ce_ratelimit import AdaptiveTokenBucket, RetryPolicy, parse_retry_after
+from ce_telemetry import Telemetry
+from ce_transport import LatencyStats, Transport, TransportError, TransportResponse, make_transport
 
 
 class CEError(RuntimeError):
@@ -32,6 +49,25 @@ class GalleryHints:
     compiler_exclude: Optional[Set[str]] = None
     scenario_only: Optional[Set[str]] = None
     scenario_exclude: Optional[Set[str]] = None
+    bench: Optional[str] = None             # benchmark entries, see ce_bench.py
+    bench_sizes: Optional[List[int]] = None
+    bench_iterations: Optional[int] = None
+    bench_repeats: Optional[int] = None
+    bench_counters: bool = False            # read perf_event_open counters around each sample
+    bench_define: Optional[str] = None      # macro set to each size, one build per size
+    bench_stubs: Optional[str] = None       # definitions generated for extern functions
+    bench_baseline: Optional[str] = None    # source key whose benchmarks these are compared with
+    bench_inputs: Optional[List[str]] = None  # input patterns for stream arguments
+    pgo_inputs: Optional[List[str]] = None  # input patterns a PGO scenario trains on, see ce_pgo.py
+    remarks: bool = False                   # capture optimization remarks, see ce_remarks.py
+    constant_time: Optional[str] = None     # functions checked for secret-dependent timing, see ce_consttime.py
+    constant_time_measurements: Optional[int] = None
+    overhead: Optional[str] = None          # measure the hardening flags against a baseline, see ce_overhead.py
+    throughput: Optional[str] = None        # functions given llvm-mca estimates, see ce_mca.py
+    throughput_cpus: Optional[List[str]] = None
+    sweep_defines: Optional[List[Tuple[str, List[str]]]] = None  # size variants: [("N", ["128", "1024"])]
+    sweep_working_set: Optional[str] = None  # bytes a variant touches, e.g. "4*N*N"
+    files: Optional[List[str]] = None       # other translation units of a multi-file example, relative to it
 
     def should_compile(self, compiler_id: str, scenario_name: str) -> bool:
         if self.compiler_only is not None and compiler_id not in self.compiler_only:
@@ -51,11 +87,30 @@ class GalleryHints:
             return f"{base_flags} {self.extra_flags}".strip()
         return base_flags
 
+    def overhead_flags(self, base_flags: str) -> Optional[str]:
+        """
+        Flags of the baseline build an ``overhead`` hint compares the cell
+        with: the scenario's flags without ``extra-flags``, plus the hint's
+        own flags unless it is just ``yes``; under ``replace-flags`` the
+        hint's flags replace the scenario's. None without the hint.
+        """
+        if not self.overhead:
+            return None
+        own = "" if self.overhead.lower() in ("yes", "true", "on", "1") else self.overhead
+        if self.replace_flags is not None and own:
+            return own
+        return f"{base_flags} {own}".strip()
+
 
 _HINTS_BLOCK_RE = re.compile(
     r"/\*\s*@gallery-hints\b(.*?)\*/", re.DOTALL
 )
 
+_DEFINE_VALUE_RE = re.compile(r"^[\w+-]+$")
+
+# Separates a source stem from its variant's defines: "loop-interchange@N=1024".
+VARIANT_SEP = "@"
+
 _COMMA_SET_KEYS = {
     "compiler-only", "compiler-exclude", "scenario-only", "scenario-exclude",
 }
@@ -80,6 +135,50 @@ def parse_gallery_hints(source: str) -> GalleryHints:
 
         if key == "extra-flags":
             hints.extra_flags = value
+        elif key == "bench":
+            hints.bench = value
+        elif key == "bench-sizes":
+            hints.bench_sizes = [int(v) for v in re.split(r"[,\s]+", value) if v.isdigit()]
+        elif key == "bench-iterations" and value.isdigit():
+            hints.bench_iterations = int(value)
+        elif key == "bench-repeats" and value.isdigit():
+            hints.bench_repeats = int(value)
+        elif key == "bench-counters":
+            hints.bench_counters = value.lower() in ("yes", "true", "on", "1")
+        elif key == "bench-define" and re.fullmatch(r"[A-Za-z_]\w*", value):
+            hints.bench_define = value
+        elif key == "bench-stubs":
+            hints.bench_stubs = value
+        elif key == "bench-baseline":
+            hints.bench_baseline = value.strip("/")
+        elif key == "bench-inputs":
+            hints.bench_inputs = [v.strip().lower() for v in value.split(",") if v.strip()] or None
+        elif key == "pgo-inputs":
+            hints.pgo_inputs = [v.strip().lower() for v in value.split(",") if v.strip()] or None
+        elif key == "remarks":
+            hints.remarks = value.lower() in ("yes", "true", "on", "1")
+        elif key == "constant-time":
+            hints.constant_time = value
+        elif key == "constant-time-measurements" and value.isdigit():
+            hints.constant_time_measurements = int(value)
+        elif key == "overhead":
+            hints.overhead = value
+        elif key == "throughput":
+            hints.throughput = value
+        elif key == "throughput-cpus":
+            hints.throughput_cpus = [v.strip() for v in value.split(",") if v.strip()] or None
+        elif key == "sweep-defines":
+            axes = []
+            for part in value.split(";"):
+                name, eq, values = part.partition("=")
+                items = [v.strip() for v in values.split(",") if v.strip()]
+                if eq and re.fullmatch(r"[A-Za-z_]\w*", name.strip()) and items and all(_DEFINE_VALUE_RE.match(v) for v in items):
+                    axes.append((name.strip(), items))
+            hints.sweep_defines = axes or None
+        elif key == "sweep-working-set":
+            hints.sweep_working_set = value
+        elif key == "files":
+            hints.files = [v.strip() for v in value.split(",") if v.strip()] or None
         elif key == "replace-flags":
             hints.replace_flags = value
         elif key in _COMMA_SET_KEYS:
@@ -96,6 +195,48 @@ def parse_gallery_hints(source: str) -> GalleryHints:
     return hints
 
 
+Defines = Tuple[Tuple[str, str], ...]
+
+
+def define_variants(hints: GalleryHints) -> List[Defines]:
+    """Every combination of the ``sweep-defines`` values, e.g. ((("N", "128"),), (("N", "1024"),))."""
+    if not hints.sweep_defines:
+        return []
+    names = [name for name, _ in hints.sweep_defines]
+    return [tuple(zip(names, values)) for values in itertools.product(*(v for _, v in hints.sweep_defines))]
+
+
+def variant_name(defines: Defines) -> str:
+    return ",".join(f"{k}={v}" for k, v in defines)
+
+
+_SIZE_OPS = {ast.Add: lambda a, b: a + b, ast.Sub: lambda a, b: a - b, ast.Mult: lambda a, b: a * b,
+             ast.FloorDiv: lambda a, b: a // b, ast.Div: lambda a, b: a // b}
+
+
+def working_set_bytes(expr: Optional[str], defines: Defines) -> Optional[int]:
+    """Evaluate a ``sweep-working-set`` expression (integers, macros, + - * /) for one variant."""
+    if not expr:
+        return None
+    values = dict(defines)
+
+    def ev(node: ast.AST) -> int:
+        if isinstance(node, ast.Expression):
+            return ev(node.body)
+        if isinstance(node, ast.Constant) and isinstance(node.value, int):
+            return node.value
+        if isinstance(node, ast.Name) and node.id in values and values[node.id].isdigit():
+            return int(values[node.id])
+        if isinstance(node, ast.BinOp) and type(node.op) in _SIZE_OPS:
+            return _SIZE_OPS[type(node.op)](ev(node.left), ev(node.right))
+        raise ValueError(node)
+
+    try:
+        return ev(ast.parse(expr, mode="eval"))
+    except (SyntaxError, ValueError, ZeroDivisionError):
+        return None
+
+
 @dataclass(frozen=True)
 class ProgressInfo:
     """Progress information for a single file processing step."""
@@ -112,6 +253,17 @@ class CompileResult:
     request: Dict[str, Any]
     response: Dict[str, Any]
     asm_text: str
+    cached: bool = False  # served from the local cache
+
+
+@dataclass(frozen=True)
+class ExecResult:
+    request: Dict[str, Any]
+    response: Dict[str, Any]
+    code: int
+    stdout: str
+    stderr: str
+    runner: str = "ce"  # where it ran: "ce" or "local", set by the backend
 
 
 @dataclass(frozen=True)
@@ -119,6 +271,7 @@ class ExplainResult:
     request: Dict[str, Any]
     response: Dict[str, Any]
     explanation_md: str
+    cached: bool = False  # served from the local cache or shared with another cell
 
 
 class CompilerExplorerClient:
@@ -131,36 +284,206 @@ class CompilerExplorerClient:
       :contentReference[oaicite:5]{index=5}
     - Claude Explain endpoint: separate service (default https://api.compiler-explorer.com/explain).
       :contentReference[oaicite:6]{index=6}
+
+    The client is safe to share between worker threads. At most ``max_per_host``
+    requests are in flight to any single host; further callers block until a
+    slot frees up.
+
+    With a ``cache``, compile and explain responses are looked up locally
+    first and only requested over the network on a miss (or when the caller
+    asks to bypass caches).
+
+    Every request goes through one per-host adaptive token bucket (starting at
+    ``rate`` requests/s, allowed to climb to ``max_rate``). 429 and 5xx
+    responses and connection errors are retried per ``retry``, honouring
+    ``Retry-After``, before a CEError is raised.
+
+    Requests to both services share one ``transport`` (see ce_transport.py;
+    HTTP/2 when available). With ``compress_requests``, large bodies are sent
+    gzip-encoded; a host that rejects that is remembered and gets plain
+    bodies from then on. Latency per endpoint accumulates in ``latency``;
+    requests, retries and cache lookups are also recorded in ``telemetry``
+    (see ce_telemetry.py).
     """
 
+    # Bodies smaller than this are not worth compressing.
+    COMPRESS_MIN_BYTES = 1024
+    # Statuses a host answers a gzip body it cannot read with.
+    GZIP_REJECTED = (400, 415)
+
     def __init__(
         self,
         ce_base_url: str = "https://godbolt.org",
         explain_base_url: str = "https://api.compiler-explorer.com/explain",
         timeout_s: float = 60.0,
         user_agent: str = "ce-client/1.0",
+        max_per_host: int = 4,
+        cache: Optional[ResultCache] = None,
+        rate: float = 4.0,
+        max_rate: float = 20.0,
+        retry: Optional[RetryPolicy] = None,
+        transport: Optional[Transport] = None,
+        compress_requests: bool = True,
+        telemetry: Optional[Telemetry] = None,
     ) -> None:
         self.ce_base_url = ce_base_url.rstrip("/")
         self.explain_base_url = explain_base_url.rstrip("/")
         self.timeout_s = timeout_s
+        self.max_per_host = max(1, int(max_per_host))
+        self.cache = cache
+        self.rate = rate
+        self.max_rate = max(rate, max_rate)
+        self.retry = retry or RetryPolicy()
+        self.retries = 0  # total retried requests, for end-of-run reporting
+        self.requests_sent = 0  # requests on the wire, retries included
+        self.bytes_sent = 0  # request body bytes as sent (after gzip)
+        self.transport = transport or make_transport("auto", self.max_per_host)
+        self.compress_requests = compress_requests
+        self.latency = LatencyStats()
+        self.telemetry = telemetry or Telemetry()
+
+        self._host_slots: Dict[str, threading.BoundedSemaphore] = {}
+        self._host_buckets: Dict[str, AdaptiveTokenBucket] = {}
+        self._host_gzip: Dict[str, bool] = {}  # host -> accepts gzip bodies (absent: not known yet)
+        self._host_slots_lock = threading.Lock()
+
+        self._headers = {
+            "Accept": "application/json",
+            "Accept-Encoding": "gzip",
+            "Content-Type": "application/json",
+            "User-Agent": user_agent,
+        }
 
-        self._ce = requests.Session()
-        self._ce.headers.update(
-            {
-                "Accept": "application/json",
-                "Content-Type": "application/json",
-                "User-Agent": user_agent,
-            }
-        )
+    def warm_up(self, ce: bool = True, explain: bool = True) -> None:
+        """Open connections to the services a run will use before its first real request."""
+        bases = [base for base, used in ((self.ce_base_url, ce), (self.explain_base_url, explain)) if used]
+        for base in bases:
+            self.transport.warm_up(f"{base}/", self.max_per_host, timeout=min(10.0, self.timeout_s))
+
+    def close(self) -> None:
+        self.transport.close()
+
+    def _host_state(self, url: str) -> Tuple[threading.BoundedSemaphore, AdaptiveTokenBucket]:
+        host = urllib.parse.urlsplit(url).netloc
+        with self._host_slots_lock:
+            slot = self._host_slots.get(host)
+            if slot is None:
+                slot = threading.BoundedSemaphore(self.max_per_host)
+                self._host_slots[host] = slot
+                self._host_buckets[host] = AdaptiveTokenBucket(self.rate, self.max_rate)
+            return slot, self._host_buckets[host]
+
+    @contextmanager
+    def _host_slot(self, url: str) -> Iterator[None]:
+        """Hold one of the ``max_per_host`` request slots for *url*'s host."""
+        slot, _ = self._host_state(url)
+        with slot:
+            yield
+
+    def _encode_body(self, host: str, payload: Optional[Dict[str, Any]]) -> Tuple[Optional[bytes], Dict[str, str]]:
+        """JSON-encode *payload*, gzipped if the host accepts (or may accept) it."""
+        if payload is None:
+            return None, dict(self._headers)
+        body = json.dumps(payload, separators=(",", ":")).encode("utf-8")
+        headers = dict(self._headers)
+        if self.compress_requests and len(body) >= self.COMPRESS_MIN_BYTES and self._host_gzip.get(host, True):
+            body = gzip.compress(body, compresslevel=6)
+            headers["Content-Encoding"] = "gzip"
+        return body, headers
+
+    def _send(
+        self,
+        method: str,
+        url: str,
+        context: str,
+        *,
+        params: Optional[Dict[str, str]] = None,
+        payload: Optional[Dict[str, Any]] = None,
+        extra_headers: Optional[Dict[str, str]] = None,
+    ) -> TransportResponse:
+        """
+        Send one request with pacing and retries; raises CEError on failure.
 
-        self._explain = requests.Session()
-        self._explain.headers.update(
-            {
-                "Accept": "application/json",
-                "Content-Type": "application/json",
-                "User-Agent": user_agent,
-            }
-        )
+        Waiting (for a token or a backoff) happens outside the host slot so a
+        sleeping worker does not hold up other requests to the same host.
+        """
+        host = urllib.parse.urlsplit(url).netloc
+        _, bucket = self._host_state(url)
+        attempt = 0
+        while True:
+            body, headers = self._encode_body(host, payload)
+            headers.update(extra_headers or {})
+            bucket.acquire()
+            with self._host_slots_lock:
+                self.requests_sent += 1
+                self.bytes_sent += len(body or b"")
+            self.telemetry.count("ce_batch_requests", endpoint=context)
+            self.telemetry.count("ce_batch_request_bytes", len(body or b""), endpoint=context)
+            try:
+                with self._host_slot(url):
+                    with self.telemetry.span("request", "http", endpoint=context, attempt=attempt, bytes=len(body or b"")) as span:
+                        start = time.perf_counter()
+                        try:
+                            r = self.transport.request(
+                                method, url, headers=headers, params=params, content=body, timeout=self.timeout_s,
+                            )
+                        except TransportError as e:
+                            span["error"] = str(e)
+                            raise
+                        span["status"] = r.status_code
+                    elapsed = time.perf_counter() - start
+                    self.latency.record(context, elapsed)
+                    self.telemetry.observe("ce_batch_request_seconds", elapsed, endpoint=context)
+            except TransportError as e:
+                if attempt >= self.retry.max_retries:
+                    raise CEError(f"{context} failed after {attempt + 1} attempts: {e}") from e
+                bucket.on_throttle()
+                delay = self.retry.delay(attempt)
+                self._count_retry(context, delay, error=str(e))
+                time.sleep(delay)
+                attempt += 1
+                continue
+
+            if "Content-Encoding" in headers and host not in self._host_gzip:
+                # First compressed request to this host: 400 or 415 means "no
+                # gzip bodies here" and is resent plain for free. Any other
+                # error (5xx, 429, a bad compiler ID) says nothing about gzip,
+                # so it takes the normal path and the next attempt probes again.
+                if r.status_code < 400 or r.status_code in self.GZIP_REJECTED:
+                    with self._host_slots_lock:
+                        self._host_gzip[host] = r.status_code < 400
+                    if r.status_code >= 400:
+                        continue
+
+            if self.retry.is_retryable(r.status_code) and attempt < self.retry.max_retries:
+                retry_after = parse_retry_after(r.headers.get("Retry-After"))
+                if self.retry.is_throttle(r.status_code):
+                    bucket.on_throttle(retry_after)
+                delay = self.retry.delay(attempt, retry_after)
+                self._count_retry(context, delay, status=r.status_code)
+                time.sleep(delay)
+                attempt += 1
+                continue
+
+            if r.status_code < 400:
+                bucket.on_success()
+            self._raise_for_status(r, context)
+            return r
+
+    def _count_retry(self, context: str, delay: float, **detail: Any) -> None:
+        with self._host_slots_lock:
+            self.retries += 1
+        self.telemetry.count("ce_batch_retries", endpoint=context)
+        self.telemetry.instant("retry", "http", endpoint=context, delay=delay, **detail)
+
+    def _cache_get(self, kind: str, key: str) -> Optional[Dict[str, Any]]:
+        """Cache lookup, recorded in telemetry; the caller checks ``self.cache`` and bypass flags."""
+        assert self.cache is not None
+        entry = self.cache.get(kind, key)
+        result = "miss" if entry is None else "hit"
+        self.telemetry.count("ce_batch_cache_lookups", kind=kind, result=result)
+        self.telemetry.instant("cache", "cache", kind=kind, result=result)
+        return entry
 
     # ---------------------------
     # CE REST API convenience
@@ -168,8 +491,7 @@ class CompilerExplorerClient:
 
     def get_languages(self) -> List[Dict[str, Any]]:
         url = f"{self.ce_base_url}/api/languages"
-        r = self._ce.get(url, timeout=self.timeout_s)
-        self._raise_for_status(r, "GET /api/languages")
+        r = self._send("GET", url, "GET /api/languages")
         data = r.json()
         if not isinstance(data, list):
             raise CEError(f"Unexpected languages response type: {type(data)}")
@@ -185,13 +507,30 @@ class CompilerExplorerClient:
         if fields:
             params["fields"] = ",".join(fields)
 
-        r = self._ce.get(url, params=params, timeout=self.timeout_s)
-        self._raise_for_status(r, "GET /api/compilers")
+        r = self._send("GET", url, "GET /api/compilers", params=params)
         data = r.json()
         if not isinstance(data, list):
             raise CEError(f"Unexpected compilers response type: {type(data)}")
         return data
 
+    def get_compilers_if_changed(
+        self, fields: Optional[List[str]] = None, etag: Optional[str] = None
+    ) -> Tuple[Optional[List[Dict[str, Any]]], Optional[str]]:
+        """
+        GET /api/compilers, conditional on *etag* (see ce_catalog.py).
+        Returns (compilers, ETag), or (None, ETag) if the list is unchanged.
+        """
+        params = {"fields": ",".join(fields)} if fields else {}
+        headers = {"If-None-Match": etag} if etag else {}
+        r = self._send("GET", f"{self.ce_base_url}/api/compilers", "GET /api/compilers", params=params, extra_headers=headers)
+        new_etag = r.headers.get("ETag") or None
+        if r.status_code == 304:
+            return None, new_etag or etag
+        data = r.json()
+        if not isinstance(data, list):
+            raise CEError(f"Unexpected compilers response type: {type(data)}")
+        return data, new_etag
+
     def compile_to_asm(
         self,
         compiler_id: str,
@@ -209,66 +548,110 @@ class CompilerExplorerClient:
         tools: Optional[List[Dict[str, str]]] = None,
         libraries: Optional[List[Dict[str, str]]] = None,
         extra_files: Optional[List[Dict[str, str]]] = None,
+        binary_object: bool = False,
     ) -> CompileResult:
         """
         Calls POST /api/compiler/<compiler-id>/compile with JSON payload. :contentReference[oaicite:7]{index=7}
 
         bypass_cache is the enum described in docs (0,1,2). :contentReference[oaicite:8]{index=8}
+        binary_object asks for the assembled object's disassembly: every
+        instruction line then carries its ``address`` and ``opcodes``.
         """
-        url = f"{self.ce_base_url}/api/compiler/{urllib.parse.quote(compiler_id)}/compile"
+        return self.compile_many(
+            compiler_id, source, [user_arguments], lang=lang, intel_syntax=intel_syntax, demangle=demangle,
+            labels=labels, directives=directives, comment_only=comment_only, trim=trim,
+            library_code=library_code, bypass_cache=bypass_cache, tools=tools, libraries=libraries,
+            extra_files=extra_files, binary_object=binary_object,
+        )[0]
+
+    def compile_many(
+        self,
+        compiler_id: str,
+        source: str,
+        flag_sets: Sequence[str],
+        lang: Optional[str] = None,
+        intel_syntax: bool = True,
+        demangle: bool = True,
+        labels: bool = True,
+        directives: bool = True,
+        comment_only: bool = True,
+        trim: bool = False,
+        library_code: bool = False,
+        bypass_cache: int = 0,
+        tools: Optional[List[Dict[str, str]]] = None,
+        libraries: Optional[List[Dict[str, str]]] = None,
+        extra_files: Optional[List[Dict[str, str]]] = None,
+        binary_object: bool = False,
+    ) -> List[CompileResult]:
+        """
+        Compile one source under several ``userArguments``; one result per flag set.
 
-        payload: Dict[str, Any] = {
-            "source": source,
-            "options": {
-                "userArguments": user_arguments,
-                "compilerOptions": {
-                    "skipAsm": False,
-                    "executorRequest": False,
-                    "overrides": [],
-                },
-                "filters": {
-                    "binary": False,
-                    "binaryObject": False,
-                    "commentOnly": bool(comment_only),
-                    "demangle": bool(demangle),
-                    "directives": bool(directives),
-                    "execute": False,
-                    "intel": bool(intel_syntax),
-                    "labels": bool(labels),
-                    "libraryCode": bool(library_code),
-                    "trim": bool(trim),
-                    "debugCalls": False,
-                },
-                "tools": tools or [],
-                "libraries": libraries or [],
-                "executeParameters": {"args": [], "stdin": "", "runtimeTools": []},
-            },
-            "allowStoreCodeDebug": True,
-            "bypassCache": int(bypass_cache),
-        }
-        if lang:
-            payload["lang"] = lang
-        if extra_files:
-            # Multi-file support as described in docs. :contentReference[oaicite:9]{index=9}
-            payload["files"] = extra_files
+        The payload is built once and only ``userArguments`` varies. CE has no
+        multi-compile endpoint, so each distinct flag set is one request (or
+        one cache hit); repeated flag sets are compiled once.
+        """
+        url = f"{self.ce_base_url}/api/compiler/{urllib.parse.quote(compiler_id)}/compile"
+        base = self._compile_payload(
+            source, lang=lang, intel_syntax=intel_syntax, demangle=demangle, labels=labels,
+            directives=directives, comment_only=comment_only, trim=trim, library_code=library_code,
+            bypass_cache=bypass_cache, tools=tools, libraries=libraries, extra_files=extra_files,
+            binary_object=binary_object,
+        )
 
-        r = self._ce.post(url, data=json.dumps(payload), timeout=self.timeout_s)
-        self._raise_for_status(r, f"POST /api/compiler/{compiler_id}/compile")
-        resp = r.json()
-
-        asm_lines = resp.get("asm", [])
-        asm_text = ""
-        if isinstance(asm_lines, list):
-            # JSON response format has asm lines as objects with "text". :contentReference[oaicite:10]{index=10}
-            out_lines: List[str] = []
-            for item in asm_lines:
-                if isinstance(item, dict) and "text" in item:
-                    out_lines.append(str(item["text"]))
-            asm_text = "\n".join(out_lines).rstrip() + ("\n" if out_lines else "")
-        else:
-            asm_text = ""
+        results: Dict[str, CompileResult] = {}
+        for flags in flag_sets:
+            if flags in results:
+                continue
+            payload = dict(base, options=dict(base["options"], userArguments=flags))
+            cache_key = self._cache_key("compile", payload, compiler_id)
+            cached = self._cache_get("compile", cache_key) if self.cache and not bypass_cache else None
+            if cached is not None:
+                resp = cached["response"]
+            else:
+                r = self._send("POST", url, f"POST /api/compiler/{compiler_id}/compile", payload=payload)
+                resp = r.json()
+                if self.cache and isinstance(resp, dict) and resp.get("okToCache", True):
+                    self.cache.put("compile", cache_key, payload, resp)
+            results[flags] = CompileResult(
+                request=payload, response=resp, asm_text=asm_text_from_response(resp), cached=cached is not None,
+            )
+
+        return [results[flags] for flags in flag_sets]
+
+    def execute(
+        self,
+        compiler_id: str,
+        source: str,
+        user_arguments: str = "-O2",
+        lang: Optional[str] = None,
+        timeout_s: Optional[float] = None,
+    ) -> ExecResult:
+        """
+        Build and run *source* on CE's executors (the ``execute`` filter).
 
-        return CompileResult(request=payload, response=resp, asm_text=asm_text)
+        Never cached, locally or by CE (bypassCache 2), since the caller
+        wants fresh output such as benchmark timings. *timeout_s* is
+        accepted for parity with LocalCompiler and not sent.
+        """
+        url = f"{self.ce_base_url}/api/compiler/{urllib.parse.quote(compiler_id)}/compile"
+        payload = self._compile_payload(source, lang=lang, bypass_cache=2)
+        payload["options"]["userArguments"] = user_arguments
+        payload["options"]["compilerOptions"].update(executorRequest=True, skipAsm=True)
+        payload["options"]["filters"]["execute"] = True
+
+        resp = self._send("POST", url, f"POST /api/compiler/{compiler_id}/compile (execute)", payload=payload).json()
+        # Executor requests answer with the run itself; a plain compile with
+        # the execute filter nests it under execResult.
+        run = resp.get("execResult", resp) if isinstance(resp, dict) else {}
+        build = run.get("buildResult") or {}
+        code = run.get("code", -1) if run.get("didExecute", True) else build.get("code", -1)
+        return ExecResult(
+            request=payload,
+            response=resp,
+            code=int(code if code is not None else -1),
+            stdout="\n".join(x.get("text", "") for x in run.get("stdout", []) if isinstance(x, dict)),
+            stderr="\n".join(x.get("text", "") for x in (run.get("stderr") or build.get("stderr") or []) if isinstance(x, dict)),
+        )
 
     # ---------------------------
     # Claude Explain
@@ -286,9 +669,13 @@ class CompilerExplorerClient:
         audience: str = "beginner",
         explanation_type: str = "assembly",
         bypass_cache: bool = False,
+        cache_identity: Optional[Dict[str, Any]] = None,
     ) -> ExplainResult:
         """
         Calls Claude Explain POST / with payload described in ClaudeExplain.md. :contentReference[oaicite:11]{index=11}
+
+        The local cache keys the response by the payload, or by
+        *cache_identity* when given (see explain_by_function).
         """
         url = f"{self.explain_base_url}/"
 
@@ -304,9 +691,16 @@ class CompilerExplorerClient:
             "bypassCache": bool(bypass_cache),
         }
 
-        r = self._explain.post(url, data=json.dumps(payload), timeout=self.timeout_s)
-        self._raise_for_status(r, "POST explain /")
-        resp = r.json()
+        cache_key = self._cache_key("explain", payload if cache_identity is None else cache_identity)
+        cached = self._cache_get("explain", cache_key) if self.cache and not bypass_cache else None
+        if cached is not None:
+            resp = cached["response"]
+        else:
+            r = self._send("POST", url, "POST explain /", payload=payload)
+            resp = r.json()
+            # Only successful explanations are worth keeping; failures should retry next run.
+            if self.cache and isinstance(resp, dict) and resp.get("status") == "success":
+                self.cache.put("explain", cache_key, payload, resp)
 
         explanation_md = ""
         if isinstance(resp, dict) and resp.get("status") == "success":
@@ -315,19 +709,160 @@ class CompilerExplorerClient:
             # Keep an explicit failure body around; caller can inspect response JSON on disk.
             explanation_md = ""
 
-        return ExplainResult(request=payload, response=resp, explanation_md=explanation_md)
+        return ExplainResult(request=payload, response=resp, explanation_md=explanation_md, cached=cached is not None)
+
+    def explain_by_function(
+        self,
+        *,
+        language: str,
+        compiler: str,
+        code: str,
+        compilation_options: List[str],
+        instruction_set: str,
+        asm_text: str,
+        audience: str = "beginner",
+        explanation_type: str = "assembly",
+        bypass_cache: bool = False,
+    ) -> ExplainResult:
+        """
+        One explain call per function section of *asm_text*
+        (ce_metrics.function_sections), joined into one explanation with a
+        heading per function. Each call is cached under the exact section
+        lines sent, the compiler and its options rather than the whole
+        payload (which carries the full source), so after an edit to one
+        function of a source only the functions whose assembly or data
+        changed are explained again. A listing with one function is
+        explained whole. The response is the first failed call's, if any.
+        """
+        lines = asm_text.splitlines()
+        sections = function_sections(lines)
+        if len(sections) < 2:
+            return self.explain_assembly(
+                language=language, compiler=compiler, code=code, compilation_options=compilation_options,
+                instruction_set=instruction_set, asm_lines=[{"text": line} for line in lines],
+                audience=audience, explanation_type=explanation_type, bypass_cache=bypass_cache,
+            )
+        requests: List[Dict[str, Any]] = []
+        functions: List[Dict[str, Any]] = []
+        parts: List[str] = []
+        usage: Dict[str, int] = {}
+        all_cached = True
+        for name, start, end in sections:
+            section = lines[start:end]
+            digest = function_hash(split_functions(section).get(name, section))
+            section_digest = hashlib.sha256("\n".join(section).encode("utf-8")).hexdigest()
+            exp = self.explain_assembly(
+                language=language, compiler=compiler, code=code, compilation_options=compilation_options,
+                instruction_set=instruction_set, asm_lines=[{"text": line} for line in section],
+                audience=audience, explanation_type=explanation_type, bypass_cache=bypass_cache,
+                cache_identity={
+                    "function": name, "section": section_digest, "language": language, "compiler": compiler,
+                    "compilationOptions": compilation_options, "instructionSet": instruction_set,
+                    "audience": audience, "explanation": explanation_type,
+                },
+            )
+            requests.append(exp.request)
+            all_cached = all_cached and exp.cached
+            resp = exp.response if isinstance(exp.response, dict) else {}
+            if resp.get("status") != "success":
+                return ExplainResult(
+                    request={"functions": requests}, response={**resp, "function": name},
+                    explanation_md="", cached=False,
+                )
+            functions.append({"name": name, "hash": digest, "cached": exp.cached})
+            parts.append(f"### `{name}`\n\n{exp.explanation_md.strip()}")
+            for k, v in (resp.get("usage") or {}).items():
+                if isinstance(v, int):
+                    usage[k] = usage.get(k, 0) + v
+        explanation = "\n\n".join(parts) + "\n"
+        response = {"status": "success", "explanation": explanation, "functions": functions, "usage": usage}
+        return ExplainResult(
+            request={"functions": requests}, response=response, explanation_md=explanation, cached=all_cached,
+        )
 
     # ---------------------------
     # Helpers
     # ---------------------------
 
     @staticmethod
-    def _raise_for_status(r: requests.Response, context: str) -> None:
-        try:
-            r.raise_for_status()
-        except requests.HTTPError as e:
+    def _compile_payload(
+        source: str,
+        lang: Optional[str] = None,
+        intel_syntax: bool = True,
+        demangle: bool = True,
+        labels: bool = True,
+        directives: bool = True,
+        comment_only: bool = True,
+        trim: bool = False,
+        library_code: bool = False,
+        bypass_cache: int = 0,
+        tools: Optional[List[Dict[str, str]]] = None,
+        libraries: Optional[List[Dict[str, str]]] = None,
+        extra_files: Optional[List[Dict[str, str]]] = None,
+        binary_object: bool = False,
+    ) -> Dict[str, Any]:
+        """Compile request body with an empty ``userArguments``."""
+        payload: Dict[str, Any] = {
+            "source": source,
+            "options": {
+                "userArguments": "",
+                "compilerOptions": {
+                    "skipAsm": False,
+                    "executorRequest": False,
+                    "overrides": [],
+                },
+                "filters": {
+                    "binary": False,
+                    "binaryObject": bool(binary_object),
+                    "commentOnly": bool(comment_only),
+                    "demangle": bool(demangle),
+                    "directives": bool(directives),
+                    "execute": False,
+                    "intel": bool(intel_syntax),
+                    "labels": bool(labels),
+                    "libraryCode": bool(library_code),
+                    "trim": bool(trim),
+                    "debugCalls": False,
+                },
+                "tools": tools or [],
+                "libraries": libraries or [],
+                "executeParameters": {"args": [], "stdin": "", "runtimeTools": []},
+            },
+            "allowStoreCodeDebug": True,
+            "bypassCache": int(bypass_cache),
+        }
+        if lang:
+            payload["lang"] = lang
+        if extra_files:
+            # Multi-file support as described in docs. :contentReference[oaicite:9]{index=9}
+            payload["files"] = extra_files
+        return payload
+
+    @staticmethod
+    def _cache_key(kind: str, payload: Dict[str, Any], extra: str = "") -> str:
+        """Content hash of everything in *payload* that can change the response."""
+        stable = {k: v for k, v in payload.items() if k != "bypassCache"}
+        blob = json.dumps(stable, sort_keys=True, separators=(",", ":"))
+        return _stable_hash(f"{kind}\0{extra}\0{blob}")
+
+    @staticmethod
+    def _raise_for_status(r: TransportResponse, context: str) -> None:
+        if r.status_code >= 400:
             body = r.text[:4000]
-            raise CEError(f"{context} failed: HTTP {r.status_code}\n{body}") from e
+            raise CEError(f"{context} failed: HTTP {r.status_code}\n{body}")
+
+
+def asm_text_from_response(resp: Dict[str, Any]) -> str:
+    """Join the ``asm`` line objects of a compile response into listing text."""
+    asm_lines = resp.get("asm", []) if isinstance(resp, dict) else []
+    if not isinstance(asm_lines, list):
+        return ""
+    # JSON response format has asm lines as objects with "text". :contentReference[oaicite:10]{index=10}
+    out_lines: List[str] = []
+    for item in asm_lines:
+        if isinstance(item, dict) and "text" in item:
+            out_lines.append(str(item["text"]))
+    return "\n".join(out_lines).rstrip() + ("\n" if out_lines else "")
 
 
 def _json_dump(path: Path, obj: Any) -> None:
@@ -340,6 +875,29 @@ def _text_dump(path: Path, text: str) -> None:
     path.write_text(text, encoding="utf-8")
 
 
+def _write_json(outputs: Optional[OutputStore], path: Path, obj: Any) -> None:
+    if outputs is None:
+        _json_dump(path, obj)
+    else:
+        outputs.write_json(path, obj)
+
+
+def _write_text(outputs: Optional[OutputStore], path: Path, text: str) -> None:
+    if outputs is None:
+        _text_dump(path, text)
+    else:
+        outputs.write_text(path, text)
+
+
+def _read_text(outputs: Optional[OutputStore], path: PathLike) -> Optional[str]:
+    if outputs is not None:
+        return outputs.read_text(path)
+    try:
+        return Path(path).read_text(encoding="utf-8", errors="replace")
+    except FileNotFoundError:
+        return None
+
+
 def _split_flags(user_arguments: str) -> List[str]:
     """
     Conservative split: CE explain API expects an array of strings (e.g., ["-O2","-std=c++20"]). :contentReference[oaicite:12]{index=12}
@@ -352,6 +910,580 @@ def _stable_hash(s: str) -> str:
     return hashlib.sha256(s.encode("utf-8", errors="replace")).hexdigest()[:16]
 
 
+FILES_SUFFIX = ".files.json"  # a multi-file example's other translation units
+
+_DEFAULT_EXTENSIONS: Tuple[str, ...] = (".c", ".cc", ".cpp", ".cxx", ".C", ".h", ".hpp")
+
+
+def list_source_files(src_root: Path, extensions: Tuple[str, ...] = _DEFAULT_EXTENSIONS) -> List[Path]:
+    """Return every file under *src_root* with a matching extension, in sorted path order."""
+    return sorted([p for p in src_root.rglob("*") if p.is_file() and p.suffix in extensions])
+
+
+def companion_paths(src_path: Path, hints: GalleryHints) -> List[Path]:
+    """The other translation units a ``files`` hint links *src_path* with."""
+    return [src_path.parent / name for name in hints.files or []]
+
+
+def companion_owners(paths: Sequence[Path]) -> Dict[Path, Path]:
+    """
+    Files listed in another source's ``files`` hint, mapped to that source.
+    They are part of its example and not compiled on their own.
+    """
+    owners: Dict[Path, Path] = {}
+    for p in paths:
+        hints = parse_gallery_hints(p.read_text(encoding="utf-8", errors="replace"))
+        for companion in companion_paths(p, hints):
+            owners[companion.resolve()] = p
+    return {p: owners[p.resolve()] for p in paths if p.resolve() in owners}
+
+
+def read_companions(src_path: Path, hints: GalleryHints) -> List[Dict[str, str]]:
+    """A multi-file example's other files in CE's ``files`` shape; CEError if one is missing."""
+    files = []
+    for name, path in zip(hints.files or [], companion_paths(src_path, hints)):
+        try:
+            files.append({"filename": name, "contents": path.read_text(encoding="utf-8", errors="replace")})
+        except OSError as e:
+            raise CEError(f"{src_path.name}: cannot read file {name!r} from its 'files' hint: {e}") from e
+    return files
+
+
+@dataclass(frozen=True)
+class CellContext:
+    """Identity and settings of one (file, compiler, scenario) cell."""
+    src_path: Path
+    src_root: Path
+    out_root: Path            # scenario output root, e.g. out/cg152/O2
+    compiler_id: str
+    scenario_name: str = ""
+    ce_lang_id: Optional[str] = None
+    ce_user_arguments: str = "-O2"
+    explain_language: str = "c++"
+    explain_compiler_human: str = "unknown"
+    instruction_set: str = "amd64"
+    explain_audience: str = "beginner"
+    explain_type: str = "assembly"
+    bypass_compile_cache: int = 0
+    bypass_explain_cache: bool = False
+    capture_remarks: bool = False  # also write .remarks.json (see ce_remarks.py), whatever the hints say
+    time_report: bool = False      # also compile with -ftime-report into .compiletime.json (see ce_compiletime.py)
+    binary_object: bool = False    # disassemble the assembled object: real opcodes, addresses and sizes
+    pgo: bool = False              # compile with a profile from the benchmark driver (see ce_pgo.py)
+    defines: Defines = ()          # a sweep-defines variant: compiled with -D<name>=<value>, never explained
+    explain_functions: bool = False  # explain each function on its own (see explain_by_function)
+    current_index: int = 0
+    total: int = 0
+
+    @property
+    def out_dir(self) -> Path:
+        return self.out_root / self.src_path.parent.relative_to(self.src_root)
+
+    @property
+    def base(self) -> str:
+        # "unrollme-1" from "unrollme-1.c"; "loop-interchange@N=1024" for a variant
+        stem = self.src_path.stem
+        return f"{stem}{VARIANT_SEP}{variant_name(self.defines)}" if self.defines else stem
+
+    @property
+    def define_flags(self) -> str:
+        return " ".join(f"-D{k}={v}" for k, v in self.defines)
+
+    @property
+    def rel_path(self) -> str:
+        rel_dir = self.src_path.parent.relative_to(self.src_root)
+        return str(rel_dir / self.base) if str(rel_dir) != "." else self.base
+
+    def progress(self, step: str) -> ProgressInfo:
+        return ProgressInfo(
+            compiler_id=self.compiler_id,
+            scenario=self.scenario_name,
+            source_file=self.rel_path,
+            step=step,
+            current=self.current_index,
+            total=self.total,
+        )
+
+
+@dataclass(frozen=True)
+class CompiledCell:
+    """Output of the compile stage; everything the explain stage needs."""
+    ctx: CellContext
+    src_text: str
+    effective_flags: str
+    asm_text: str
+    response: Dict[str, Any]
+    request: Optional[Dict[str, Any]] = None
+    cached: bool = False  # the compile came from the local cache
+    profile: Optional[bytes] = None  # a PGO cell's profile, for its benchmark builds
+
+
+class CompileBackend(Protocol):
+    """Anything with CompilerExplorerClient's compile_many (see ce_local.py)."""
+
+    def compile_many(self, compiler_id: str, source: str, flag_sets: Sequence[str], **kwargs: Any) -> List[CompileResult]: ...
+
+
+def cell_flags(ctx: CellContext, hints: GalleryHints) -> str:
+    """The flags a cell compiles with: the scenario's after the hints, then a variant's -D flags."""
+    return f"{hints.effective_flags(ctx.ce_user_arguments)} {ctx.define_flags}".strip()
+
+
+def compile_cell(
+    ctx: CellContext,
+    client: CompileBackend,
+    progress_callback: Optional[Callable[[ProgressInfo], None]] = None,
+    outputs: Optional[OutputStore] = None,
+) -> Optional[CompiledCell]:
+    """
+    Compile stage: writes the source copy and compile outputs for one cell.
+
+    Outputs go to plain files unless an *outputs* backend (see ce_store.py)
+    is given. Returns None if the file's gallery hints exclude this
+    compiler/scenario.
+    """
+    return compile_cell_group([ctx], client, progress_callback, outputs)[0]
+
+
+def compile_cell_group(
+    ctxs: Sequence[CellContext],
+    client: CompileBackend,
+    progress_callback: Optional[Callable[[ProgressInfo], None]] = None,
+    outputs: Optional[OutputStore] = None,
+    profiles: Optional[Dict[int, TrainedProfile]] = None,
+) -> List[Optional[CompiledCell]]:
+    """
+    Compile stage for several scenarios of one (compiler, file) pair.
+
+    The source is read and its hints parsed once, and all flag sets go to the
+    backend in one compile_many() call, so scenarios whose effective flags
+    coincide (e.g. under ``replace-flags``) share a compile. Each cell gets
+    exactly the outputs compile_cell() writes. Returns one entry per context,
+    None where the gallery hints exclude the scenario.
+
+    Cells that capture optimization remarks (``remarks: yes`` in the hints,
+    or ``capture_remarks``) add a second flag set with the compiler family's
+    remark flags to the same call; only its diagnostics are kept, as
+    ``<stem>.remarks.json``. Sources with a ``constant-time`` hint also get
+    ``<stem>.consttime.json``, the static check of ce_consttime.py, those
+    with a ``throughput`` hint ``<stem>.mca.json`` (ce_mca.py), and
+    sources with an ``overhead`` hint compile once more without their
+    hardening flags for ``<stem>.overhead.json`` (see ce_overhead.py). Variant
+    cells (``defines``, from the hints' ``sweep-defines``) compile with their
+    -D flags after the scenario's and record their defines and working set
+    in ``.metrics.json``. Every cell writes its compile time to
+    ``<stem>.compiletime.json``; cells with ``time_report`` also compile
+    with the family's ``-ftime-report`` and keep its slowest passes there
+    (see ce_compiletime.py).
+
+    PGO cells (``pgo``) take their training run from *profiles*, by index
+    into *ctxs* (ce_pgo.train_cell()), and compile in a call of their own
+    with its profile; the run's record is ``<stem>.pgo.json``. A multi-file
+    example (``files`` in the hints) passes its other files to the backend
+    as ``extra_files`` and keeps a copy in ``<stem>.files.json``; the local
+    backend links them into one program (see ce_local.py).
+    """
+    if not ctxs:
+        return []
+    first = ctxs[0]
+    if any(c.src_path != first.src_path or c.compiler_id != first.compiler_id for c in ctxs):
+        raise ValueError("compile_cell_group needs cells of a single (compiler, file) pair")
+
+    src_text = first.src_path.read_text(encoding="utf-8", errors="replace")
+
+    # Parse per-file gallery hints and apply compiler/scenario filters.
+    hints = parse_gallery_hints(src_text)
+    todo = [(i, c, cell_flags(c, hints)) for i, c in enumerate(ctxs) if hints.should_compile(c.compiler_id, c.scenario_name)]
+    cells: List[Optional[CompiledCell]] = [None] * len(ctxs)
+    if not todo:
+        return cells
+
+    companions = read_companions(first.src_path, hints) if hints.files else None
+    for _, ctx, _ in todo:
+        # Always write a copy of the input source for traceability.
+        _write_text(outputs, ctx.out_dir / f"{ctx.base}.src{ctx.src_path.suffix}", src_text)
+        files_path = ctx.out_dir / f"{ctx.base}{FILES_SUFFIX}"
+        if companions:
+            _write_json(outputs, files_path, {"files": companions})
+        elif outputs is not None:
+            outputs.delete(files_path)
+        else:
+            files_path.unlink(missing_ok=True)
+        if progress_callback:
+            progress_callback(ctx.progress("compile"))
+
+    # All plain cells share one call; each PGO cell compiles with its own profile.
+    profiles = profiles or {}
+    profile_of = {i: profiles[i].data if i in profiles else None for i, ctx, _ in todo if ctx.pgo}
+    batches = [[t for t in todo if t[0] not in profile_of]] + [[t] for t in todo if t[0] in profile_of]
+    extra = remark_flags(first.compiler_id)
+    timing = time_report_flags(first.compiler_id)
+    remark_sets: Dict[int, str] = {}
+    overhead_sets: Dict[int, str] = {}
+    report_sets: Dict[int, str] = {}
+    results: Dict[int, CompileResult] = {}
+    remark_results: Dict[int, CompileResult] = {}
+    overhead_results: Dict[int, CompileResult] = {}
+    report_results: Dict[int, CompileResult] = {}
+    for batch in batches:
+        if not batch:
+            continue
+        remarks = {i: f"{flags} {extra}" for i, ctx, flags in batch if extra and (hints.remarks or ctx.capture_remarks)}
+        # The profile was trained with the hardening flags on; no overhead baseline for PGO cells.
+        overhead = {
+            i: f"{hints.overhead_flags(ctx.ce_user_arguments)} {ctx.define_flags}".strip()
+            for i, ctx, _ in batch if hints.overhead and not ctx.pgo
+        }
+        reports = {i: f"{flags} {timing}" for i, ctx, flags in batch if timing and ctx.time_report}
+        profile = profile_of.get(batch[0][0])
+        batch_results = client.compile_many(
+            compiler_id=first.compiler_id,
+            source=src_text,
+            flag_sets=[flags for _, _, flags in batch] + list(remarks.values()) + list(overhead.values()) + list(reports.values()),
+            lang=first.ce_lang_id,
+            bypass_cache=first.bypass_compile_cache,
+            binary_object=first.binary_object,
+            **({"profile": profile} if profile is not None else {}),
+            **({"extra_files": companions} if companions else {}),
+        )
+        results.update(zip([i for i, _, _ in batch], batch_results))
+        remark_results.update(zip(remarks, batch_results[len(batch):]))
+        overhead_results.update(zip(overhead, batch_results[len(batch) + len(remarks):]))
+        report_results.update(zip(reports, batch_results[len(batch) + len(remarks) + len(overhead):]))
+        remark_sets.update(remarks)
+        overhead_sets.update(overhead)
+        report_sets.update(reports)
+
+    for i, ctx, flags in todo:
+        comp = results[i]
+        out_dir, base = ctx.out_dir, ctx.base
+        _write_json(outputs, out_dir / f"{base}.compile.request.json", comp.request)
+        _write_json(outputs, out_dir / f"{base}.compile.response.json", comp.response)
+        _write_text(outputs, out_dir / f"{base}.asm", comp.asm_text)
+        metrics = cell_metrics(comp.response, ctx.instruction_set)
+        if ctx.defines:
+            metrics["defines"] = dict(ctx.defines)
+            metrics["working_set_bytes"] = working_set_bytes(hints.sweep_working_set, ctx.defines)
+        _write_json(outputs, out_dir / f"{base}{METRICS_SUFFIX}", metrics)
+        _write_json(outputs, out_dir / f"{base}{COMPILETIME_SUFFIX}", compiletime_record(
+            ctx.compiler_id, ctx.scenario_name, flags, comp.response, comp.cached,
+            report_sets.get(i), report_results[i].response if i in report_results else None,
+        ))
+        remarks_path = out_dir / f"{base}{REMARKS_SUFFIX}"
+        record = None
+        if i in remark_results:
+            record = remarks_record(ctx.compiler_id, remark_sets[i], remark_results[i].response, ctx.src_path.name)
+        if record is not None:
+            _write_json(outputs, remarks_path, record)
+        elif outputs is not None:
+            outputs.delete(remarks_path)  # remarks no longer wanted for this cell
+        else:
+            remarks_path.unlink(missing_ok=True)
+        consttime_path = out_dir / f"{base}{CONSTTIME_SUFFIX}"
+        if hints.constant_time:
+            _write_json(outputs, consttime_path, consttime_record(
+                ctx.compiler_id, comp.response.get("instructionSet") or ctx.instruction_set, comp.response, hints.constant_time,
+            ))
+        elif outputs is not None:
+            outputs.delete(consttime_path)
+        else:
+            consttime_path.unlink(missing_ok=True)
+        mca_path = out_dir / f"{base}{MCA_SUFFIX}"
+        if hints.throughput:
+            _write_json(outputs, mca_path, mca_record(
+                ctx.compiler_id, comp.response.get("instructionSet") or ctx.instruction_set, comp.response,
+                hints.throughput, hints.throughput_cpus,
+            ))
+        elif outputs is not None:
+            outputs.delete(mca_path)
+        else:
+            mca_path.unlink(missing_ok=True)
+        overhead_path = out_dir / f"{base}{OVERHEAD_SUFFIX}"
+        if i in overhead_results:
+            _write_json(outputs, overhead_path, overhead_record(
+                flags, overhead_sets[i], metrics, cell_metrics(overhead_results[i].response, ctx.instruction_set),
+            ))
+        elif outputs is not None:
+            outputs.delete(overhead_path)
+        else:
+            overhead_path.unlink(missing_ok=True)
+        pgo_path = out_dir / f"{base}{PGO_SUFFIX}"
+        if i in profiles and ctx.pgo:
+            _write_json(outputs, pgo_path, {**profiles[i].record, "scenario": ctx.scenario_name})
+        elif outputs is not None:
+            outputs.delete(pgo_path)
+        else:
+            pgo_path.unlink(missing_ok=True)
+        cells[i] = CompiledCell(
+            ctx=ctx,
+            src_text=src_text,
+            effective_flags=flags,
+            asm_text=comp.asm_text,
+            response=comp.response,
+            request=comp.request,
+            cached=comp.cached,
+            profile=profile_of.get(i),
+        )
+    return cells
+
+
+def load_compiled_cell(ctx: CellContext, outputs: Optional[OutputStore] = None) -> Optional[CompiledCell]:
+    """
+    Rebuild a CompiledCell from outputs a previous compile stage wrote.
+
+    Uses the stored source copy and request so the explanation matches the
+    stored assembly even if src/ has changed since. Returns None if the cell
+    was never compiled.
+    """
+    out_dir, base = ctx.out_dir, ctx.base
+    response_text = _read_text(outputs, out_dir / f"{base}.compile.response.json")
+    request_text = _read_text(outputs, out_dir / f"{base}.compile.request.json")
+    src_text = _read_text(outputs, out_dir / f"{base}.src{ctx.src_path.suffix}")
+    if response_text is None or request_text is None or src_text is None:
+        return None
+    try:
+        response = json.loads(response_text)
+        request = json.loads(request_text)
+    except ValueError:
+        return None
+    flags = request.get("options", {}).get("userArguments", ctx.ce_user_arguments)
+    return CompiledCell(
+        ctx=ctx,
+        src_text=src_text,
+        effective_flags=flags,
+        asm_text=asm_text_from_response(response),
+        response=response,
+        request=request,
+    )
+
+
+def explain_dedup_key(asm_text: str, source: str, instruction_set: str, audience: str, explanation_type: str) -> str:
+    """
+    Identity of an explanation's inputs, ignoring the compiler name and
+    flags: cells with the same key get the same explanation.
+    """
+    normalized = "\n".join(" ".join(line.split()) for line in asm_text.splitlines() if line.strip())
+    blob = json.dumps([normalized, source, instruction_set, audience, explanation_type], separators=(",", ":"))
+    return hashlib.sha256(blob.encode("utf-8")).hexdigest()
+
+
+class _SharedExplain:
+    def __init__(self, leader: str) -> None:
+        self.leader = leader
+        self.done = threading.Event()
+        self.result: Optional[ExplainResult] = None  # set only on success
+
+
+class ExplainDeduper:
+    """
+    Shares one explanation between cells whose assembly, source, instruction
+    set, audience and explanation type match (see explain_dedup_key), e.g.
+    O2 and O3 of a function neither level changes.
+
+    The first cell with a key (the leader) calls the explain API; cells with
+    the same key wait for it and reuse a successful result. A failed
+    explanation is not shared: the waiting cells then explain themselves.
+    With a ``cache``, successful results are also kept there (kind
+    ``explain-shared``), so later runs reuse them too. Thread safe.
+    """
+
+    def __init__(self, cache: Optional[ResultCache] = None) -> None:
+        self.cache = cache
+        self.reused = 0
+        self._lock = threading.Lock()
+        self._shared: Dict[str, _SharedExplain] = {}
+
+    def explain(
+        self, key: str, cell_key: str, bypass_cache: bool, call: Callable[[], ExplainResult]
+    ) -> Tuple[ExplainResult, Optional[str]]:
+        """Result for *cell_key*, and the leader cell it was reused from (or None)."""
+        with self._lock:
+            shared = self._shared.get(key)
+            leading = shared is None
+            if leading:
+                shared = self._shared[key] = _SharedExplain(cell_key)
+        assert shared is not None
+
+        if not leading:
+            shared.done.wait()
+            if shared.result is None:
+                return call(), None
+            if shared.leader == cell_key:
+                return shared.result, None  # a previous run's leader, served from the cache
+            with self._lock:
+                self.reused += 1
+            return shared.result, shared.leader
+
+        try:
+            if self.cache is not None and not bypass_cache:
+                entry = self.cache.get("explain-shared", key)
+                if entry is not None and entry["request"].get("leader") != cell_key:
+                    result = ExplainResult(
+                        request=entry["request"]["request"],
+                        response=entry["response"],
+                        explanation_md=str(entry["response"].get("explanation", "")),
+                    )
+                    shared.leader, shared.result = entry["request"]["leader"], result
+                    with self._lock:
+                        self.reused += 1
+                    return result, shared.leader
+            result = call()
+            if isinstance(result.response, dict) and result.response.get("status") == "success":
+                shared.result = result
+                if self.cache is not None:
+                    self.cache.put("explain-shared", key, {"leader": cell_key, "request": result.request}, result.response)
+            return result, None
+        finally:
+            shared.done.set()
+
+
+def explain_cell(
+    cell: CompiledCell,
+    client: CompilerExplorerClient,
+    progress_callback: Optional[Callable[[ProgressInfo], None]] = None,
+    outputs: Optional[OutputStore] = None,
+    dedup: Optional[ExplainDeduper] = None,
+) -> ExplainResult:
+    """
+    Explain stage: explains a compiled cell and writes the explain outputs.
+
+    With *dedup*, a cell whose explain inputs match another cell's reuses
+    that explanation; its ``.explain.response.json`` then names the other
+    cell in ``reusedFrom`` (``<compiler>/<scenario>/<rel path>``). Returns
+    the result as written.
+    """
+    ctx = cell.ctx
+    out_dir, base = ctx.out_dir, ctx.base
+
+    if progress_callback:
+        progress_callback(ctx.progress("explain"))
+
+    # Explain (feed asm lines as array of dicts with "text" key)
+    asm_lines = [{"text": line} for line in cell.asm_text.splitlines()]
+
+    # Use instruction set from compile response if available (more accurate)
+    actual_instruction_set = cell.response.get("instructionSet", ctx.instruction_set)
+
+    def call() -> ExplainResult:
+        if ctx.explain_functions:
+            return client.explain_by_function(
+                language=ctx.explain_language,
+                compiler=ctx.explain_compiler_human,
+                code=cell.src_text,
+                compilation_options=_split_flags(cell.effective_flags),
+                instruction_set=actual_instruction_set,
+                asm_text=cell.asm_text,
+                audience=ctx.explain_audience,
+                explanation_type=ctx.explain_type,
+                bypass_cache=ctx.bypass_explain_cache,
+            )
+        return client.explain_assembly(
+            language=ctx.explain_language,
+            compiler=ctx.explain_compiler_human,
+            code=cell.src_text,
+            compilation_options=_split_flags(cell.effective_flags),
+            instruction_set=actual_instruction_set,
+            asm_lines=asm_lines,
+            audience=ctx.explain_audience,
+            explanation_type=ctx.explain_type,
+            bypass_cache=ctx.bypass_explain_cache,
+        )
+
+    if dedup is None:
+        exp, reused_from = call(), None
+    else:
+        # Whole and per-function explanations of the same listing are not interchangeable.
+        explain_type = f"{ctx.explain_type}/functions" if ctx.explain_functions else ctx.explain_type
+        key = explain_dedup_key(cell.asm_text, cell.src_text, actual_instruction_set, ctx.explain_audience, explain_type)
+        cell_key = "/".join(p for p in (ctx.compiler_id, ctx.scenario_name, ctx.rel_path) if p)
+        exp, reused_from = dedup.explain(key, cell_key, ctx.bypass_explain_cache, call)
+
+    response = exp.response
+    if reused_from is not None:
+        response = {**response, "reusedFrom": reused_from}
+    _write_json(outputs, out_dir / f"{base}.explain.request.json", exp.request)
+    _write_json(outputs, out_dir / f"{base}.explain.response.json", response)
+    _write_text(outputs, out_dir / f"{base}.explain.md", exp.explanation_md)
+    return ExplainResult(
+        request=exp.request, response=response, explanation_md=exp.explanation_md,
+        cached=exp.cached or reused_from is not None,
+    )
+
+
+def link_explanation(
+    ctx: CellContext, exp: ExplainResult, leader: str, outputs: Optional[OutputStore] = None,
+) -> ExplainResult:
+    """
+    Writes *exp*, the explanation of cell *leader* (``<compiler>/<scenario>/<rel
+    path>``), as the explanation of *ctx*, a cell with the same assembly
+    (see ce_equivalence.py). Its ``.explain.response.json`` names the leader
+    in ``reusedFrom``, as for a shared explanation.
+    """
+    response = {**exp.response, "reusedFrom": leader}
+    _write_json(outputs, ctx.out_dir / f"{ctx.base}.explain.request.json", exp.request)
+    _write_json(outputs, ctx.out_dir / f"{ctx.base}.explain.response.json", response)
+    _write_text(outputs, ctx.out_dir / f"{ctx.base}.explain.md", exp.explanation_md)
+    return ExplainResult(request=exp.request, response=response, explanation_md=exp.explanation_md, cached=True)
+
+
+def process_file(
+    *,
+    src_path: Path,
+    src_root: Path,
+    out_root: Path,
+    client: CompilerExplorerClient,
+    compiler_id: str,
+    scenario_name: str = "",
+    ce_lang_id: Optional[str] = None,
+    ce_user_arguments: str = "-O2",
+    explain_language: str = "c++",
+    explain_compiler_human: str = "unknown",
+    instruction_set: str = "amd64",
+    explain_audience: str = "beginner",
+    explain_type: str = "assembly",
+    bypass_compile_cache: int = 0,
+    bypass_explain_cache: bool = False,
+    sleep_s: float = 0.0,
+    progress_callback: Optional[Callable[[ProgressInfo], None]] = None,
+    current_index: int = 0,
+    total: int = 0,
+) -> bool:
+    """
+    Compiles and explains a single source file, writing its outputs under out_root
+    at the same relative location it has under src_root.
+
+    Safe to call concurrently for different (file, compiler, scenario) cells.
+    Returns False if the file's gallery hints exclude this compiler/scenario.
+    """
+    ctx = CellContext(
+        src_path=src_path,
+        src_root=src_root,
+        out_root=out_root,
+        compiler_id=compiler_id,
+        scenario_name=scenario_name,
+        ce_lang_id=ce_lang_id,
+        ce_user_arguments=ce_user_arguments,
+        explain_language=explain_language,
+        explain_compiler_human=explain_compiler_human,
+        instruction_set=instruction_set,
+        explain_audience=explain_audience,
+        explain_type=explain_type,
+        bypass_compile_cache=bypass_compile_cache,
+        bypass_explain_cache=bypass_explain_cache,
+        current_index=current_index,
+        total=total,
+    )
+    cell = compile_cell(ctx, client, progress_callback)
+    if cell is None:
+        return False
+    explain_cell(cell, client, progress_callback)
+
+    if sleep_s > 0:
+        time.sleep(sleep_s)
+
+    return True
+
+
 def process_source_tree(
     *,
     src_root: Path,
@@ -368,11 +1500,12 @@ def process_source_tree(
     explain_type: str = "assembly",
     bypass_compile_cache: int = 0,
     bypass_explain_cache: bool = False,
-    extensions: Tuple[str, ...] = (".c", ".cc", ".cpp", ".cxx", ".C", ".h", ".hpp"),
+    extensions: Tuple[str, ...] = _DEFAULT_EXTENSIONS,
     sleep_s: float = 0.0,
     progress_callback: Optional[Callable[[ProgressInfo], None]] = None,
     file_index_offset: int = 0,
     total_files_global: int = 0,
+    jobs: int = 1,
 ) -> int:
     """
     Walks src_root recursively, processes each matching file, and writes outputs under out_root
@@ -390,6 +1523,9 @@ def process_source_tree(
       out/loops/unrollme-1.explain.response.json
       out/loops/unrollme-1.explain.md
 
+    With jobs > 1, files are processed by a pool of that many worker threads
+    (still subject to the client's per-host cap).
+
     Returns the number of files processed.
     """
     src_root = src_root.resolve()
@@ -397,84 +1533,41 @@ def process_source_tree(
     if not src_root.exists() or not src_root.is_dir():
         raise CEError(f"src_root does not exist or is not a directory: {src_root}")
 
-    files = sorted([p for p in src_root.rglob("*") if p.is_file() and p.suffix in extensions])
+    files = list_source_files(src_root, extensions)
+    owners = companion_owners(files)
+    files = [p for p in files if p not in owners]
     total = total_files_global if total_files_global > 0 else len(files)
 
-    for i, p in enumerate(files):
-        rel_dir = p.parent.relative_to(src_root)
-        out_dir = out_root / rel_dir
-        base = p.stem  # "unrollme-1" from "unrollme-1.c"
-        rel_path = str(rel_dir / base) if str(rel_dir) != "." else base
-        src_text = p.read_text(encoding="utf-8", errors="replace")
-
-        # Parse per-file gallery hints and apply compiler/scenario filters.
-        hints = parse_gallery_hints(src_text)
-        if not hints.should_compile(compiler_id, scenario_name):
-            continue
-        effective_flags = hints.effective_flags(ce_user_arguments)
-
-        current_index = file_index_offset + i + 1
-
-        # Always write a copy of the input source for traceability.
-        _text_dump(out_dir / f"{base}.src{p.suffix}", src_text)
-
-        # Progress: compile
-        if progress_callback:
-            progress_callback(ProgressInfo(
-                compiler_id=compiler_id,
-                scenario=scenario_name,
-                source_file=rel_path,
-                step="compile",
-                current=current_index,
-                total=total,
-            ))
-
-        # Compile
-        comp = client.compile_to_asm(
+    def run(i: int, p: Path) -> bool:
+        return process_file(
+            src_path=p,
+            src_root=src_root,
+            out_root=out_root,
+            client=client,
             compiler_id=compiler_id,
-            source=src_text,
-            user_arguments=effective_flags,
-            lang=ce_lang_id,
-            bypass_cache=bypass_compile_cache,
-        )
-        _json_dump(out_dir / f"{base}.compile.request.json", comp.request)
-        _json_dump(out_dir / f"{base}.compile.response.json", comp.response)
-        _text_dump(out_dir / f"{base}.asm", comp.asm_text)
-
-        # Progress: explain
-        if progress_callback:
-            progress_callback(ProgressInfo(
-                compiler_id=compiler_id,
-                scenario=scenario_name,
-                source_file=rel_path,
-                step="explain",
-                current=current_index,
-                total=total,
-            ))
-
-        # Explain (feed asm lines as array of dicts with "text" key)
-        asm_lines = [{"text": line} for line in comp.asm_text.splitlines()]
-
-        # Use instruction set from compile response if available (more accurate)
-        actual_instruction_set = comp.response.get("instructionSet", instruction_set)
-
-        exp = client.explain_assembly(
-            language=explain_language,
-            compiler=explain_compiler_human,
-            code=src_text,
-            compilation_options=_split_flags(effective_flags),
-            instruction_set=actual_instruction_set,
-            asm_lines=asm_lines,
-            audience=explain_audience,
-            explanation_type=explain_type,
-            bypass_cache=bypass_explain_cache,
+            scenario_name=scenario_name,
+            ce_lang_id=ce_lang_id,
+            ce_user_arguments=ce_user_arguments,
+            explain_language=explain_language,
+            explain_compiler_human=explain_compiler_human,
+            instruction_set=instruction_set,
+            explain_audience=explain_audience,
+            explain_type=explain_type,
+            bypass_compile_cache=bypass_compile_cache,
+            bypass_explain_cache=bypass_explain_cache,
+            sleep_s=sleep_s,
+            progress_callback=progress_callback,
+            current_index=file_index_offset + i + 1,
+            total=total,
         )
-        _json_dump(out_dir / f"{base}.explain.request.json", exp.request)
-        _json_dump(out_dir / f"{base}.explain.response.json", exp.response)
-        _text_dump(out_dir / f"{base}.explain.md", exp.explanation_md)
 
-        if sleep_s > 0:
-            time.sleep(sleep_s)
+    if jobs <= 1:
+        for i, p in enumerate(files):
+            run(i, p)
+    else:
+        with ThreadPoolExecutor(max_workers=jobs) as pool:
+            # list() re-raises the first worker exception, if any.
+            list(pool.map(run, range(len(files)), files))
 
     return len(files)
 
@@ -507,11 +1600,16 @@ if __name__ == "__main__":
     ap.add_argument("--sleep", type=float, default=0.0, help="Sleep between files (seconds)")
     ap.add_argument("--bypass-compile-cache", type=int, default=0, help="0/1/2 bypassCache enum for CE compile")
     ap.add_argument("--bypass-explain-cache", action="store_true", help="Bypass Explain caches")
+    ap.add_argument("--jobs", "-j", type=int, default=1, help="Number of files processed concurrently")
+    ap.add_argument("--max-per-host", type=int, default=4, help="Maximum in-flight requests per host")
+    ap.add_argument("--cache-dir", default=None, help="Optional local response cache directory")
     args = ap.parse_args()
 
     client = CompilerExplorerClient(
         ce_base_url=args.ce_base_url,
         explain_base_url=args.explain_base_url,
+        max_per_host=args.max_per_host,
+        cache=ResultCache(Path(args.cache_dir)) if args.cache_dir else None,
     )
 
     process_source_tree(
@@ -529,4 +1627,5 @@ if __name__ == "__main__":
         bypass_compile_cache=args.bypass_compile_cache,
         bypass_explain_cache=args.bypass_explain_cache,
         sleep_s=args.sleep,
+        jobs=args.jobs,
     )
@@ -0,0 +1,173 @@
+# Copyright (c) 2026 Larry H <l.gr [at] dartmouth [dot] edu>
+# SPDX-License-Identifier: AGPL-3.0-or-later
+#
+# Compiler Optimization Gallery
+# Developed for COSC-69.16: Basics of Reverse Engineering
+# Dartmouth College, Winter 2026
+
+"""
+ce_compiletime.py
+
+What a cell costs to compile. Every compiled cell writes
+``<stem>.compiletime.json`` with the compile's wall time: CE's
+``execTime`` for the request, or the local backend's own measurement of
+the compiler process. A response served from the result cache keeps the
+time of the compile that produced it, and the record says it was cached.
+
+With ``ce_batch.py --time-report`` each cell is compiled once more with the
+family's per-pass timing flag, in the same compile_many() call:
+
+    gcc    -ftime-report   phases and passes (usr/sys/wall/GGC table)
+    clang  -ftime-report   pass execution and code generation reports
+    msvc   /Bt+            front end (c1) and back end (c2) times
+
+parse_time_report() reads that output from the compiler's stderr into the
+passes that took the most wall time. clang's ``-ftime-trace`` writes a
+Chrome trace file next to the object instead of to stderr, so it is not
+collected.
+
+build_book.py ranks the records on a Compile Time page: the most
+expensive cells, and per compiler and scenario the total compile time next
+to code size and benchmark time, so the cost of -O3 and heavy inlining
+sits next to what it buys. Only depends on the standard library.
+"""
+
+from __future__ import annotations
+
+import re
+from typing import Any, Dict, List, Optional
+
+from ce_remarks import compiler_family
+
+COMPILETIME_SUFFIX = ".compiletime.json"
+
+TIME_REPORT_FLAGS = {"gcc": "-ftime-report", "clang": "-ftime-report", "msvc": "/Bt+"}
+
+# Passes kept per report, by wall time.
+TOP_PASSES = 12
+
+# GCC timers that contain the passes listed after them, reported as phases.
+_GCC_AGGREGATES = {"callgraph functions expansion", "callgraph optimization", "callgraph construction"}
+
+# " phase opt and generate   :   0.01 (100%)   0.00 (  0%)   0.02 (100%)   247k ( 14%)"
+_GCC_ROW_RE = re.compile(
+    r"^\s*(?P<name>\S.*?)\s*:\s*[\d.]+\s*\(\s*\d+%\)\s*[\d.]+\s*\(\s*\d+%\)\s*(?P<wall>[\d.]+)\s*\(\s*\d+%\)"
+)
+_GCC_TOTAL_RE = re.compile(r"^\s*TOTAL\s*:\s*[\d.]+\s+[\d.]+\s+(?P<wall>[\d.]+)")
+# "   0.0030 ( 25.0%)   0.0000 (  0.0%)   0.0030 ( 24.4%)   0.0031 ( 24.8%)  X86 DAG->DAG Instruction Selection"
+_CLANG_ROW_RE = re.compile(r"^\s*(?P<cols>(?:[\d.]+\s*\(\s*[\d.]+%\)\s*)+)(?P<name>\S.*?)\s*$")
+_CLANG_TOTAL_RE = re.compile(r"Total Execution Time:\s*[\d.]+ seconds \((?P<wall>[\d.]+) wall clock\)")
+# "time(C:\...\c1.dll)=0.031s < 105665857611 - 105665933360 > BB [<source>]"
+_MSVC_RE = re.compile(r"time\((?P<path>[^)]+)\)=(?P<wall>[\d.]+)s")
+
+
+def time_report_flags(compiler_id: str) -> Optional[str]:
+    family = compiler_family(compiler_id)
+    return TIME_REPORT_FLAGS.get(family) if family else None
+
+
+def compile_ms(response: Dict[str, Any]) -> Optional[int]:
+    """Wall time of a compile response in milliseconds (CE sends ``execTime`` as a string), or None."""
+    try:
+        return int(float(response.get("execTime")))
+    except (TypeError, ValueError):
+        return None
+
+
+def _stderr_lines(response: Dict[str, Any]) -> List[str]:
+    return [x.get("text", "") for x in response.get("stderr") or [] if isinstance(x, dict)]
+
+
+def parse_time_report(lines: List[str], family: str) -> Optional[Dict[str, Any]]:
+    """
+    The passes of a ``-ftime-report`` (``/Bt+``) in compiler output *lines*
+    with the most wall time, as {"wall_s", "passes": [{"name", "group",
+    "wall_s", "percent"}]}; None if the output has no report.
+    """
+    passes: List[Dict[str, Any]] = []
+    total: Optional[float] = None
+    if family == "gcc":
+        for raw in lines:
+            m = _GCC_TOTAL_RE.match(raw)
+            if m:
+                total = float(m.group("wall"))
+                continue
+            m = _GCC_ROW_RE.match(raw)
+            if m:
+                name = m.group("name")
+                group = "phase" if name.startswith("phase ") or name in _GCC_AGGREGATES else "pass"
+                passes.append({"name": name, "group": group, "wall_s": float(m.group("wall"))})
+    elif family == "clang":
+        group, totals = "", 0.0
+        for i, raw in enumerate(lines):
+            m = _CLANG_TOTAL_RE.search(raw)
+            if m:
+                totals += float(m.group("wall"))
+                total = totals
+                continue
+            # Report titles sit between two ===---=== rules.
+            if raw.strip().startswith("===") and i + 2 < len(lines) and lines[i + 2].strip().startswith("==="):
+                group = lines[i + 1].strip().strip(".").strip()
+                continue
+            m = _CLANG_ROW_RE.match(raw)
+            if m and m.group("name") != "Total":
+                wall = re.findall(r"([\d.]+)\s*\(", m.group("cols"))[-1]
+                passes.append({"name": m.group("name"), "group": group, "wall_s": float(wall)})
+    elif family == "msvc":
+        for raw in lines:
+            m = _MSVC_RE.search(raw)
+            if m:
+                name = re.split(r"[\\/]", m.group("path"))[-1]
+                passes.append({"name": name, "group": "driver", "wall_s": float(m.group("wall"))})
+        if passes:
+            total = round(sum(p["wall_s"] for p in passes), 4)
+    if not passes:
+        return None
+    if total is None:
+        total = max(p["wall_s"] for p in passes)
+    passes.sort(key=lambda p: -p["wall_s"])
+    for p in passes:
+        p["percent"] = round(p["wall_s"] / total * 100.0, 1) if total else None
+    return {"wall_s": total, "passes": passes[:TOP_PASSES]}
+
+
+def compiletime_record(
+    compiler_id: str,
+    scenario: str,
+    flags: str,
+    response: Dict[str, Any],
+    cached: bool,
+    report_flags: Optional[str] = None,
+    report_response: Optional[Dict[str, Any]] = None,
+) -> Dict[str, Any]:
+    """
+    The ``.compiletime.json`` record of a cell compiled with *flags*, and of
+    its ``-ftime-report`` compile (*report_flags*, *report_response*) if any.
+    """
+    record: Dict[str, Any] = {
+        "compiler": compiler_id,
+        "scenario": scenario,
+        "flags": flags,
+        "wall_ms": compile_ms(response),
+        "cached": bool(cached),
+        "ok": response.get("code", 0) == 0,
+    }
+    if report_response is not None:
+        family = compiler_family(compiler_id) or ""
+        report = parse_time_report(_stderr_lines(report_response), family)
+        record["time_report"] = {
+            "flags": report_flags,
+            "wall_ms": compile_ms(report_response),
+            **(report or {"error": "no timing report in the compiler output"}),
+        }
+    return record
+
+
+__all__ = [
+    "COMPILETIME_SUFFIX",
+    "TIME_REPORT_FLAGS",
+    "compile_ms",
+    "compiletime_record",
+    "parse_time_report",
+    "time_report_flags",
+]
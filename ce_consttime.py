@@ -0,0 +1,723 @@
+# Copyright (c) 2026 Larry H <l.gr [at] dartmouth [dot] edu>
+# SPDX-License-Identifier: AGPL-3.0-or-later
+#
+# Compiler Optimization Gallery
+# Developed for COSC-69.16: Basics of Reverse Engineering
+# Dartmouth College, Winter 2026
+
+"""
+ce_consttime.py
+
+Constant-time checks for functions a source marks in its ``@gallery-hints``
+block, with the argument syntax of ``bench`` entries (see ce_bench.py):
+
+    /* @gallery-hints
+     *   constant-time: verify_token_safe(u8[], u8[], 64); verify_token_bad(u8[], u8[], 64)
+     *   constant-time-measurements: 200000     (optional; dudect sample count)
+     */
+
+Array arguments point at secret data; ``n`` and literals are public. Two
+checks use that:
+
+- A static pass over the cell's assembly (``<stem>.consttime.json``, written
+  at compile time). Taint flows from the secret buffers through registers,
+  flags and stack slots, fixed-point over the function's control flow
+  graph. Findings are conditional branches on secret flags or registers
+  (``early-exit`` when they leave a loop), memory accesses whose address
+  depends on a secret, divisions of secrets (variable latency on most
+  cores) and calls to early-exit library functions (memcmp, strcmp, ...)
+  with secret arguments. Selects (cmov, setcc, csel) are fine. x86-64
+  (Intel syntax, SysV or Windows argument registers), AArch64 and ARM32 are
+  understood; other instruction sets are recorded as unsupported.
+- A dudect-style timing test run through the benchmark backend
+  (``<stem>.dudect.json``, with ``ce_batch.py --bench``; see
+  run_cell_dudect() in ce_bench.py). Every array starts with the same fixed
+  contents. Each measurement then randomly either keeps the first array
+  equal to that fixed value (class 0) or refills it with random bytes
+  (class 1). welch_t() compares the two timing distributions, raw and
+  cropped at several percentiles. A |t| of 4.5 or more fails: the
+  function's time depends on the secret.
+
+The static pass is a lint, not a proof: it knows only the instructions it
+models and treats everything loaded through a secret pointer as secret.
+Only depends on the standard library.
+"""
+
+from __future__ import annotations
+
+import math
+import re
+from typing import Any, Dict, Iterable, List, Optional, Sequence, Set, Tuple
+
+from ce_metrics import split_functions
+
+CONSTTIME_SUFFIX = ".consttime.json"
+DUDECT_SUFFIX = ".dudect.json"
+
+# |t| at which dudect reports "probably not constant time".
+T_THRESHOLD = 4.5
+
+# Library calls that return as soon as they find a difference.
+EARLY_EXIT_CALLS = {"memcmp", "bcmp", "strcmp", "strncmp", "strcasecmp", "strncasecmp", "memchr", "strlen", "strnlen"}
+
+# Taint lattice.
+PUBLIC, SECRET_PTR, SECRET = 0, 1, 2
+
+_ARRAY_ARG_RE = re.compile(r"^\w+\[(?:n\*(n|\d+))?\]$")
+_ENTRY_RE = re.compile(r"^\s*([A-Za-z_]\w*)\s*\((.*)\)\s*$")
+
+
+def parse_entries(spec: str) -> List[Tuple[str, List[str]]]:
+    """(function, arguments) of each entry of a ``constant-time`` hint value; ValueError if malformed."""
+    entries = []
+    for part in spec.split(";"):
+        if not part.strip():
+            continue
+        m = _ENTRY_RE.match(part)
+        if not m:
+            raise ValueError(f"constant-time entry must look like 'func(arg, ...)': {part.strip()!r}")
+        entries.append((m.group(1), [a.strip() for a in m.group(2).split(",") if a.strip()]))
+    return entries
+
+
+def secret_args(args: Sequence[str]) -> List[int]:
+    """Taint of each argument of a ``constant-time`` entry: arrays point at secrets."""
+    return [SECRET_PTR if _ARRAY_ARG_RE.match(a) else PUBLIC for a in args]
+
+
+# ---------------------------
+# Per-ISA models
+# ---------------------------
+
+_X86_GPRS = {
+    "rax": ("eax", "ax", "al", "ah"), "rbx": ("ebx", "bx", "bl", "bh"),
+    "rcx": ("ecx", "cx", "cl", "ch"), "rdx": ("edx", "dx", "dl", "dh"),
+    "rsi": ("esi", "si", "sil"), "rdi": ("edi", "di", "dil"),
+    "rbp": ("ebp", "bp", "bpl"), "rsp": ("esp", "sp", "spl"),
+}
+_X86_REG = {alias: full for full, aliases in _X86_GPRS.items() for alias in (full,) + aliases}
+_X86_REG.update({f"r{i}{s}": f"r{i}" for i in range(8, 16) for s in ("", "d", "w", "b")})
+_X86_VEC_RE = re.compile(r"^[xyz]mm(\d+)$")
+_X86_ARGS_SYSV = ("rdi", "rsi", "rdx", "rcx", "r8", "r9")
+_X86_ARGS_WIN = ("rcx", "rdx", "r8", "r9")
+_X86_ZERO_IDIOMS = {"xor", "sub", "pxor", "xorps", "xorpd", "vpxor", "vxorps", "vxorpd", "psubb", "psubd", "psubq"}
+_X86_MOVES = re.compile(r"^(mov|movzx|movsx|movsxd|movabs|movd|movq|movdq[au]|movup[sd]|movap[sd]|lddqu|vmov\w*|cvt\w+|vcvt\w+)$")
+_X86_NO_DEST = {"cmp", "test", "bt", "ucomiss", "ucomisd", "comiss", "comisd", "vucomiss", "vucomisd", "ptest", "vptest"}
+_X86_NO_EFFECT = {"nop", "endbr64", "endbr32", "leave", "cdqe", "cqo", "cdq", "cwde", "ud2", "int3", "pause", "lfence",
+                  "mfence", "sfence", "prefetcht0", "prefetcht1", "prefetcht2", "prefetchnta"}
+
+_A64_ARGS = tuple(f"x{i}" for i in range(8))
+_ARM_CONDS = "eq|ne|cs|hs|cc|lo|mi|pl|vs|vc|hi|ls|ge|lt|gt|le"
+_ARM32_ARGS = ("r0", "r1", "r2", "r3")
+_ARM32_ALIAS = {"fp": "r11", "ip": "r12", "sp": "r13", "lr": "r14", "pc": "r15", "sb": "r9", "sl": "r10"}
+_ARM32_FLAG_ALU = re.compile(
+    rf"^(add|adc|sub|sbc|rsb|rsc|and|orr|eor|bic|mov|mvn|mul|mla|lsl|lsr|asr|ror)s({_ARM_CONDS})?(\.w|\.n)?$"
+)
+
+
+def _split_operands(ops: str) -> List[str]:
+    """Operands separated by top-level commas (not those inside [] or {})."""
+    parts, depth, cur = [], 0, []
+    for ch in ops:
+        if ch in "[{":
+            depth += 1
+        elif ch in "]}":
+            depth -= 1
+        if ch == "," and depth == 0:
+            parts.append("".join(cur).strip())
+            cur = []
+        else:
+            cur.append(ch)
+    if "".join(cur).strip():
+        parts.append("".join(cur).strip())
+    return parts
+
+
+def _strip_comment(text: str) -> str:
+    return re.split(r"\s(#|//|;|@)\s", " " + text + " ", maxsplit=1)[0].strip()
+
+
+class _State:
+    """Taint of registers, flags and stack slots at one program point."""
+
+    __slots__ = ("regs", "slots", "flags")
+
+    def __init__(self) -> None:
+        self.regs: Dict[str, int] = {}
+        self.slots: Dict[str, int] = {}
+        self.flags = PUBLIC
+
+    def copy(self) -> "_State":
+        s = _State()
+        s.regs, s.slots, s.flags = dict(self.regs), dict(self.slots), self.flags
+        return s
+
+    def join(self, other: "_State") -> bool:
+        """Merge *other* into this state; True if anything got more tainted."""
+        changed = False
+        for table, theirs in ((self.regs, other.regs), (self.slots, other.slots)):
+            for k, v in theirs.items():
+                if v > table.get(k, PUBLIC):
+                    table[k] = v
+                    changed = True
+        if other.flags > self.flags:
+            self.flags, changed = other.flags, True
+        return changed
+
+
+class _Model:
+    """What one instruction does to the taint state, for one ISA family."""
+
+    args: Tuple[str, ...] = ()
+
+    def reg(self, name: str) -> Optional[str]:
+        raise NotImplementedError
+
+    def step(self, st: _State, mnem: str, ops: List[str], findings: List[Tuple[str, str]]) -> None:
+        raise NotImplementedError
+
+    def branch(self, mnem: str, ops: List[str]) -> Tuple[Optional[str], bool, bool]:
+        """(local target label, is conditional, ends the function's path: return or tail call)."""
+        raise NotImplementedError
+
+    def call_target(self, mnem: str, ops: List[str]) -> Optional[str]:
+        raise NotImplementedError
+
+    # Shared helpers
+
+    def value(self, st: _State, operand: str, findings: List[Tuple[str, str]]) -> int:
+        if self.is_memory(operand):
+            return self.load(st, operand, findings)
+        r = self.reg(operand)
+        return st.regs.get(r, PUBLIC) if r else PUBLIC
+
+    def is_memory(self, operand: str) -> bool:
+        return "[" in operand
+
+    def address_regs(self, operand: str) -> List[str]:
+        inner = operand[operand.find("[") + 1: operand.rfind("]")] if "[" in operand else operand
+        return [r for r in (self.reg(tok) for tok in re.findall(r"[A-Za-z]\w*", inner)) if r]
+
+    def slot_key(self, operand: str) -> Optional[str]:
+        return None
+
+    def address(self, st: _State, operand: str, findings: List[Tuple[str, str]], store: bool) -> int:
+        taint = max((st.regs.get(r, PUBLIC) for r in self.address_regs(operand)), default=PUBLIC)
+        if taint == SECRET:
+            findings.append(("memory-index", "store address depends on a secret" if store else "load address depends on a secret"))
+        return taint
+
+    def load(self, st: _State, operand: str, findings: List[Tuple[str, str]]) -> int:
+        taint = self.address(st, operand, findings, store=False)
+        if taint != PUBLIC:
+            return SECRET
+        key = self.slot_key(operand)
+        return st.slots.get(key, PUBLIC) if key else PUBLIC
+
+    def store(self, st: _State, operand: str, value: int, findings: List[Tuple[str, str]]) -> None:
+        self.address(st, operand, findings, store=True)
+        key = self.slot_key(operand)
+        if key:
+            st.slots[key] = value
+
+    def set_reg(self, st: _State, operand: str, value: int) -> None:
+        r = self.reg(operand)
+        if r:
+            st.regs[r] = value
+
+    def after_call(self, st: _State, target: Optional[str], findings: List[Tuple[str, str]], ret_reg: str) -> None:
+        tainted = max((st.regs.get(r, PUBLIC) for r in self.args), default=PUBLIC)
+        if target and target in EARLY_EXIT_CALLS and tainted != PUBLIC:
+            findings.append(("call", f"{target} returns early on the first difference"))
+        # Unknown callees: the result is as secret as what went in.
+        st.regs[ret_reg] = SECRET if tainted != PUBLIC else PUBLIC
+        st.flags = PUBLIC
+
+
+class _X86Model(_Model):
+    def __init__(self, windows: bool) -> None:
+        self.args = _X86_ARGS_WIN if windows else _X86_ARGS_SYSV
+
+    def reg(self, name: str) -> Optional[str]:
+        name = name.strip().lower()
+        if name in _X86_REG:
+            return _X86_REG[name]
+        m = _X86_VEC_RE.match(name)
+        return f"v{m.group(1)}" if m else None
+
+    def slot_key(self, operand: str) -> Optional[str]:
+        # [rbp-24], GNU's -24[rbp] and MSVC's diff$[rsp] all name a stack slot.
+        m = re.search(r"([\w$.+-]*)\[\s*(rsp|rbp|esp|ebp)\s*([+-]\s*\w+)?\s*\]", operand.lower())
+        return f"{_X86_REG[m.group(2)]}{m.group(1)}{(m.group(3) or '').replace(' ', '')}" if m else None
+
+    def branch(self, mnem: str, ops: List[str]) -> Tuple[Optional[str], bool, bool]:
+        if mnem.startswith("ret"):
+            return None, False, True
+        if not mnem.startswith("j"):
+            return None, False, False
+        target = ops[0].split()[-1] if ops else ""
+        local = bool(re.match(r"^(\.L|L\d|\$L|\$LN)", target))
+        if mnem == "jmp":
+            return (target, False, False) if local else (None, False, True)
+        return (target if local else None), True, False
+
+    def call_target(self, mnem: str, ops: List[str]) -> Optional[str]:
+        if not ops:
+            return None
+        if mnem.startswith("call") or (mnem == "jmp" and not re.match(r"^(\.L|L\d|\$L|\$LN)", ops[0].split()[-1])):
+            name = re.sub(r"@PLT$|^_+", "", ops[0].split()[-1])
+            return name
+        return None
+
+    def step(self, st: _State, mnem: str, ops: List[str], findings: List[Tuple[str, str]]) -> None:
+        if mnem in _X86_NO_EFFECT or not ops and not mnem.startswith(("call", "ret")):
+            return
+        if mnem.startswith("j"):
+            if mnem != "jmp" and st.flags == SECRET:
+                findings.append(("branch", "conditional jump on secret flags"))
+            if mnem == "jmp" and self.call_target(mnem, ops):
+                self.after_call(st, self.call_target(mnem, ops), findings, "rax")
+            return
+        if mnem.startswith("call"):
+            self.after_call(st, self.call_target(mnem, ops), findings, "rax")
+            return
+        if mnem.startswith("ret"):
+            return
+        if mnem == "push":
+            self.value(st, ops[0], findings)
+            return
+        if mnem == "pop":
+            self.set_reg(st, ops[0], PUBLIC)
+            return
+        if mnem == "lea":
+            regs = self.address_regs(ops[1]) if len(ops) > 1 else []
+            self.set_reg(st, ops[0], max((st.regs.get(r, PUBLIC) for r in regs), default=PUBLIC))
+            return
+        if mnem in ("div", "idiv", "mul", "imul") and len(ops) == 1:
+            v = max(self.value(st, ops[0], findings), st.regs.get("rax", PUBLIC), st.regs.get("rdx", PUBLIC))
+            if mnem in ("div", "idiv") and v == SECRET:
+                findings.append(("division", "division time depends on a secret operand"))
+            st.regs["rax"] = st.regs["rdx"] = SECRET if v == SECRET else PUBLIC
+            st.flags = st.regs["rax"]
+            return
+        if mnem.startswith("set"):
+            self.set_reg(st, ops[0], st.flags) if not self.is_memory(ops[0]) else self.store(st, ops[0], st.flags, findings)
+            return
+        if mnem.startswith("cmov"):
+            v = max(self.value(st, ops[0], findings), self.value(st, ops[1], findings), st.flags)
+            self.set_reg(st, ops[0], SECRET if v == SECRET else v)
+            return
+        srcs = ops[1:] if len(ops) > 1 else ops
+        if mnem in _X86_NO_DEST:
+            v = max(self.value(st, o, findings) for o in ops)
+            st.flags = SECRET if v == SECRET else PUBLIC
+            return
+        if mnem in _X86_ZERO_IDIOMS and len(ops) >= 2 and len({o.lower() for o in ops}) == 1:
+            self.set_reg(st, ops[0], PUBLIC)
+            st.flags = PUBLIC
+            return
+        if _X86_MOVES.match(mnem):
+            v = max(self.value(st, o, findings) for o in srcs)
+        else:
+            # Read-modify-write arithmetic; three-operand AVX forms name the destination first.
+            operands = ops if len(ops) == 2 else srcs
+            v = max(self.value(st, o, findings) for o in operands)
+            st.flags = SECRET if v == SECRET else PUBLIC
+        if self.is_memory(ops[0]):
+            self.store(st, ops[0], v, findings)
+        else:
+            self.set_reg(st, ops[0], v)
+
+
+class _A64Model(_Model):
+    args = _A64_ARGS
+
+    def reg(self, name: str) -> Optional[str]:
+        name = name.strip().lower().lstrip("#")
+        name = re.sub(r"\.\w+$", "", name)  # v0.16b
+        if name in ("xzr", "wzr"):
+            return None
+        if name in ("sp", "wsp"):
+            return "sp"
+        m = re.fullmatch(r"[xw](\d+)", name)
+        if m:
+            return f"x{m.group(1)}"
+        if name in ("fp", "lr"):
+            return "x29" if name == "fp" else "x30"
+        m = re.fullmatch(r"[vqdsbh](\d+)", name)
+        return f"v{m.group(1)}" if m else None
+
+    def slot_key(self, operand: str) -> Optional[str]:
+        inner = operand[operand.find("[") + 1: operand.rfind("]")].replace(" ", "").lower()
+        m = re.fullmatch(r"(sp|x29|fp)(,#-?\d+)?", inner)
+        return f"sp{m.group(2) or ''}" if m and m.group(1) == "sp" else (f"x29{m.group(2) or ''}" if m else None)
+
+    def branch(self, mnem: str, ops: List[str]) -> Tuple[Optional[str], bool, bool]:
+        if mnem == "ret":
+            return None, False, True
+        local = lambda t: bool(re.match(r"^(\.L|L\d|\$L)", t))  # noqa: E731
+        if mnem == "b" and ops:
+            return (ops[0], False, False) if local(ops[0]) else (None, False, True)
+        if mnem.startswith("b.") and ops:
+            return ops[0] if local(ops[0]) else None, True, False
+        if mnem in ("cbz", "cbnz") and len(ops) >= 2:
+            return ops[1] if local(ops[1]) else None, True, False
+        if mnem in ("tbz", "tbnz") and len(ops) >= 3:
+            return ops[2] if local(ops[2]) else None, True, False
+        if mnem == "br":
+            return None, False, True
+        return None, False, False
+
+    def call_target(self, mnem: str, ops: List[str]) -> Optional[str]:
+        if mnem == "bl" and ops:
+            return ops[0].lstrip("_")
+        if mnem == "b" and ops and not re.match(r"^(\.L|L\d|\$L)", ops[0]):
+            return ops[0].lstrip("_")
+        return None
+
+    def step(self, st: _State, mnem: str, ops: List[str], findings: List[Tuple[str, str]]) -> None:
+        base = mnem.split(".")[0]
+        if mnem.startswith("b.") or base in ("cbz", "cbnz", "tbz", "tbnz"):
+            secret = st.flags == SECRET if mnem.startswith("b.") else (st.regs.get(self.reg(ops[0]) or "", PUBLIC) == SECRET)
+            if secret:
+                findings.append(("branch", "conditional branch on a secret"))
+            return
+        if base in ("bl", "blr") or (base == "b" and self.call_target(mnem, ops)):
+            self.after_call(st, self.call_target(mnem, ops), findings, "x0")
+            return
+        if base in ("b", "br", "ret", "nop", "hint", "dmb", "dsb", "isb", "prfm", "paciasp", "autiasp", "bti") or not ops:
+            return
+        if base.startswith("ld") and len(ops) >= 2:
+            mem = next((o for o in ops if self.is_memory(o)), None)
+            if mem is None:
+                return
+            v = self.load(st, mem, findings)
+            for o in ops[: ops.index(mem)]:
+                self.set_reg(st, o, v)
+            return
+        if base.startswith("st") and len(ops) >= 2:
+            mem = next((o for o in ops if self.is_memory(o)), None)
+            if mem is not None:
+                v = max(st.regs.get(self.reg(o) or "", PUBLIC) for o in ops[: ops.index(mem)])
+                self.store(st, mem, v, findings)
+            return
+        if base in ("cmp", "cmn", "tst", "fcmp", "fcmpe", "ccmp", "ccmn"):
+            v = max(self.value(st, o, findings) for o in ops[:2])
+            if base in ("ccmp", "ccmn"):
+                v = max(v, st.flags)
+            st.flags = SECRET if v == SECRET else PUBLIC
+            return
+        if base in ("udiv", "sdiv") and len(ops) >= 3:
+            v = max(self.value(st, o, findings) for o in ops[1:3])
+            if v == SECRET:
+                findings.append(("division", "division time depends on a secret operand"))
+            self.set_reg(st, ops[0], SECRET if v == SECRET else PUBLIC)
+            return
+        v = max((self.value(st, o, findings) for o in ops[1:]), default=PUBLIC)
+        if base in ("csel", "csinc", "csinv", "csneg", "cset", "csetm", "cinc", "cneg", "fcsel"):
+            v = max(v, st.flags)
+        if base in ("adrp", "adr", "movz", "movk", "movn") or (base == "mov" and ops[1:] and ops[1].startswith("#")):
+            v = PUBLIC if base != "movk" else max(v, st.regs.get(self.reg(ops[0]) or "", PUBLIC))
+        self.set_reg(st, ops[0], SECRET if v == SECRET else v)
+        if base in ("adds", "subs", "ands", "bics", "adcs", "sbcs", "negs"):
+            st.flags = SECRET if v == SECRET else PUBLIC
+
+
+class _Arm32Model(_Model):
+    args = _ARM32_ARGS
+
+    def reg(self, name: str) -> Optional[str]:
+        name = name.strip().lower().rstrip("!").lstrip("{").rstrip("}")
+        name = _ARM32_ALIAS.get(name, name)
+        if re.fullmatch(r"r\d+", name):
+            return name
+        m = re.fullmatch(r"[dsq](\d+)", name)
+        return f"v{m.group(1)}" if m else None
+
+    def slot_key(self, operand: str) -> Optional[str]:
+        inner = operand[operand.find("[") + 1: operand.rfind("]")].replace(" ", "").lower()
+        m = re.fullmatch(r"(sp|fp|r11|r7)(,#-?\d+)?", inner)
+        return f"{_ARM32_ALIAS.get(m.group(1), m.group(1))}{m.group(2) or ''}" if m else None
+
+    def _is_branch(self, mnem: str) -> Optional[str]:
+        m = re.fullmatch(rf"b({_ARM_CONDS})?(\.w|\.n)?", mnem)
+        return None if not m else (m.group(1) or "")
+
+    def branch(self, mnem: str, ops: List[str]) -> Tuple[Optional[str], bool, bool]:
+        local = lambda t: bool(re.match(r"^(\.L|L\d|\$L)", t))  # noqa: E731
+        cond = self._is_branch(mnem)
+        if cond is not None and ops:
+            if not cond:
+                return (ops[0], False, False) if local(ops[0]) else (None, False, True)
+            return ops[0] if local(ops[0]) else None, True, False
+        if mnem in ("cbz", "cbnz") and len(ops) >= 2:
+            return ops[1] if local(ops[1]) else None, True, False
+        if (mnem == "bx" and ops and ops[0].lower() == "lr") or (mnem.startswith(("pop", "ldm")) and "pc" in " ".join(ops).lower()):
+            return None, False, True
+        return None, False, False
+
+    def call_target(self, mnem: str, ops: List[str]) -> Optional[str]:
+        if mnem in ("bl", "blx") and ops:
+            return ops[0].lstrip("_")
+        if self._is_branch(mnem) == "" and ops and not re.match(r"^(\.L|L\d|\$L)", ops[0]):
+            return ops[0].lstrip("_")
+        return None
+
+    def step(self, st: _State, mnem: str, ops: List[str], findings: List[Tuple[str, str]]) -> None:
+        cond = self._is_branch(mnem)
+        if cond or mnem in ("cbz", "cbnz"):
+            secret = st.flags == SECRET if cond else st.regs.get(self.reg(ops[0]) or "", PUBLIC) == SECRET
+            if secret:
+                findings.append(("branch", "conditional branch on a secret"))
+            return
+        if mnem in ("bl", "blx") or (cond == "" and self.call_target(mnem, ops)):
+            self.after_call(st, self.call_target(mnem, ops), findings, "r0")
+            return
+        if cond == "" or mnem in ("bx", "nop", "dmb", "dsb", "isb") or not ops:
+            return
+        if mnem.startswith(("push", "stm", "vpush")):
+            return
+        if mnem.startswith(("pop", "ldm", "vpop")):
+            for o in re.findall(r"\w+", " ".join(ops[1:] if mnem.startswith("ldm") else ops)):
+                self.set_reg(st, o, PUBLIC)
+            return
+        # Predicated (conditionally executed) instructions are constant time, but
+        # their result depends on the flags.
+        predicated = st.flags if re.search(rf"({_ARM_CONDS})(\.w|\.n)?$", mnem) and not mnem.startswith(("cmp", "cmn", "tst", "teq")) else PUBLIC
+        if mnem.startswith(("ldr", "vldr", "vld")):
+            mem = next((o for o in ops if self.is_memory(o)), None)
+            v = self.load(st, mem, findings) if mem else PUBLIC
+            for o in ops[: ops.index(mem)] if mem else ops[:1]:
+                self.set_reg(st, o, max(v, predicated))
+            return
+        if mnem.startswith(("str", "vstr", "vst")):
+            mem = next((o for o in ops if self.is_memory(o)), None)
+            if mem is not None:
+                v = max(st.regs.get(self.reg(o) or "", PUBLIC) for o in ops[: ops.index(mem)])
+                self.store(st, mem, v, findings)
+            return
+        if mnem.startswith(("cmp", "cmn", "tst", "teq", "vcmp")):
+            v = max(self.value(st, o, findings) for o in ops[:2])
+            st.flags = SECRET if v == SECRET else PUBLIC
+            return
+        if mnem.startswith(("udiv", "sdiv")) and len(ops) >= 3:
+            v = max(self.value(st, o, findings) for o in ops[1:3])
+            if v == SECRET:
+                findings.append(("division", "division time depends on a secret operand"))
+        srcs = ops[1:] if len(ops) > 1 else []
+        v = max([self.value(st, o, findings) for o in srcs if not o.startswith("#")] + [predicated, PUBLIC])
+        if mnem.startswith(("movw", "movt", "adr")) or (mnem.startswith("mov") and srcs and srcs[0].startswith("#") and not predicated):
+            v = predicated
+        self.set_reg(st, ops[0], SECRET if v == SECRET else v)
+        if _ARM32_FLAG_ALU.match(mnem):
+            st.flags = SECRET if v == SECRET else PUBLIC
+
+
+def _model(instruction_set: str, compiler_id: str) -> Optional[_Model]:
+    if instruction_set == "amd64":
+        cid = compiler_id.lower()
+        return _X86Model(windows="mingw" in cid or cid.startswith("vc") or "msvc" in cid)
+    if instruction_set == "aarch64":
+        return _A64Model()
+    if instruction_set == "arm32":
+        return _Arm32Model()
+    return None
+
+
+# ---------------------------
+# Analysis
+# ---------------------------
+
+def _instructions(body: Sequence[str]) -> List[Tuple[Optional[str], str, List[str], str]]:
+    """(label or None, mnemonic, operands, text) for a split_functions() body."""
+    out = []
+    for line in body:
+        if line.endswith(":") and " " not in line:
+            out.append((line[:-1], "", [], line))
+            continue
+        text = _strip_comment(line)
+        parts = text.split(None, 1)
+        mnem = parts[0].lower()
+        ops = parts[1] if len(parts) > 1 else ""
+        while mnem in ("lock", "rep", "repe", "repz", "repne", "repnz", "notrack", "bnd") and ops:
+            parts = ops.split(None, 1)
+            mnem, ops = parts[0].lower(), parts[1] if len(parts) > 1 else ""
+        out.append((None, mnem, _split_operands(ops), text))
+    return out
+
+
+def analyze_function(body: Sequence[str], model: _Model, taints: Sequence[int]) -> List[Dict[str, Any]]:
+    """Findings for one function whose arguments have *taints* (in argument-register order)."""
+    insns = _instructions(body)
+    labels = {lab: i for i, (lab, _, _, _) in enumerate(insns) if lab}
+    # Basic-block successors, per instruction index.
+    succ: Dict[int, List[int]] = {}
+    for i, (lab, mnem, ops, _) in enumerate(insns):
+        if lab:
+            succ[i] = [i + 1]
+            continue
+        target, conditional, ends = model.branch(mnem, ops)
+        nxt = [] if ends or (target and not conditional) else [i + 1]
+        if target in labels:
+            nxt.append(labels[target])
+        succ[i] = [j for j in nxt if j < len(insns)]
+
+    start = _State()
+    for reg, taint in zip(model.args, taints):
+        if taint:
+            start.regs[reg] = taint
+    states: Dict[int, _State] = {0: start}
+    findings: Dict[int, Tuple[str, str]] = {}
+    work = [0] if insns else []
+    visits = 0
+    while work and visits < 50 * len(insns) + 100:
+        visits += 1
+        i = work.pop()
+        st = states[i].copy()
+        lab, mnem, ops, _ = insns[i]
+        found: List[Tuple[str, str]] = []
+        if not lab:
+            model.step(st, mnem, ops, found)
+        if found:
+            findings[i] = found[0]
+        for j in succ[i]:
+            if j not in states:
+                states[j] = st.copy()
+                work.append(j)
+            elif states[j].join(st):
+                work.append(j)
+
+    result = []
+    loops = _natural_loops(succ, len(insns)) if findings else []
+    for i in sorted(findings):
+        kind, detail = findings[i]
+        # A secret branch with one way out of a loop it is in is an early exit.
+        if kind == "branch" and any(i in body and any(j not in body for j in succ[i]) for body in loops):
+            kind = "early-exit"
+        result.append({"kind": kind, "index": i, "instruction": insns[i][3], "detail": detail})
+    return result
+
+
+def _natural_loops(succ: Dict[int, List[int]], count: int) -> List[Set[int]]:
+    """Bodies of the natural loops of a control flow graph whose entry is node 0."""
+    preds: Dict[int, List[int]] = {i: [] for i in range(count)}
+    for i, nxt in succ.items():
+        for j in nxt:
+            preds[j].append(i)
+    # Dominators as bit sets, iterated to a fixed point.
+    everything = (1 << count) - 1
+    dom = [everything] * count
+    dom[0] = 1
+    changed = True
+    while changed:
+        changed = False
+        for i in range(1, count):
+            ps = [dom[p] for p in preds[i]]
+            new = (1 << i) | (_and_all(ps) if ps else 0)
+            if new != dom[i]:
+                dom[i], changed = new, True
+    loops = []
+    for src, nxt in succ.items():
+        for head in nxt:
+            if dom[src] >> head & 1:  # the target dominates the source: a back edge
+                body, stack = {head, src}, [src]
+                while stack:
+                    for p in preds[stack.pop()]:
+                        if p not in body:
+                            body.add(p)
+                            stack.append(p)
+                loops.append(body)
+    return loops
+
+
+def _and_all(values: List[int]) -> int:
+    out = values[0]
+    for v in values[1:]:
+        out &= v
+    return out
+
+
+def _find_function(functions: Dict[str, List[str]], name: str) -> Optional[List[str]]:
+    for key in (name, f"_{name}", f"{name}@PLT"):
+        if key in functions:
+            return functions[key]
+    return None
+
+
+def consttime_record(
+    compiler_id: str, instruction_set: str, response: Dict[str, Any], spec: str
+) -> Dict[str, Any]:
+    """The ``.consttime.json`` record for one compile response and a ``constant-time`` hint value."""
+    record: Dict[str, Any] = {"compiler": compiler_id, "instruction_set": instruction_set, "functions": []}
+    try:
+        entries = parse_entries(spec)
+    except ValueError as e:
+        record["error"] = str(e)
+        return record
+    model = _model(instruction_set, compiler_id)
+    record["supported"] = model is not None
+    lines = [str(x.get("text", "")) if isinstance(x, dict) else str(x) for x in (response.get("asm") or [])]
+    functions = split_functions(lines)
+    for function, args in entries:
+        if function in {f["function"] for f in record["functions"]}:
+            continue
+        body = _find_function(functions, function)
+        item: Dict[str, Any] = {"function": function}
+        if body is None:
+            item["verdict"] = "missing"  # inlined everywhere, or excluded by #if
+        elif model is None:
+            item["verdict"] = "unsupported"
+        else:
+            item["findings"] = analyze_function(body, model, secret_args(args))
+            item["verdict"] = "fail" if item["findings"] else "pass"
+        record["functions"].append(item)
+    return record
+
+
+# ---------------------------
+# Timing test statistics
+# ---------------------------
+
+def welch_t(n0: int, mean0: float, m2_0: float, n1: int, mean1: float, m2_1: float) -> Optional[float]:
+    """Welch's t statistic from per-class counts, means and sums of squared deviations."""
+    if n0 < 2 or n1 < 2:
+        return None
+    var0, var1 = m2_0 / (n0 - 1), m2_1 / (n1 - 1)
+    denom = math.sqrt(var0 / n0 + var1 / n1)
+    if denom == 0:
+        return 0.0 if mean0 == mean1 else math.copysign(math.inf, mean0 - mean1)
+    return (mean0 - mean1) / denom
+
+
+def dudect_verdict(t: Optional[float]) -> str:
+    if t is None:
+        return "inconclusive"
+    return "leak" if abs(t) >= T_THRESHOLD else "pass"
+
+
+def summarize(records: Iterable[Dict[str, Any]]) -> Dict[str, str]:
+    """function -> overall verdict across a static and a dudect record (either may be missing)."""
+    out: Dict[str, str] = {}
+    for rec in records:
+        for item in (rec or {}).get("functions", []) + (rec or {}).get("results", []):
+            v = item.get("verdict")
+            if v in ("fail", "leak"):
+                out[item["function"]] = "fail"
+            elif v == "pass":
+                out.setdefault(item["function"], "pass")
+    return out
+
+
+__all__ = [
+    "CONSTTIME_SUFFIX",
+    "DUDECT_SUFFIX",
+    "EARLY_EXIT_CALLS",
+    "T_THRESHOLD",
+    "analyze_function",
+    "consttime_record",
+    "dudect_verdict",
+    "parse_entries",
+    "secret_args",
+    "summarize",
+    "welch_t",
+]
@@ -0,0 +1,87 @@
+# Copyright (c) 2026 Larry H <l.gr [at] dartmouth [dot] edu>
+# SPDX-License-Identifier: AGPL-3.0-or-later
+#
+# Compiler Optimization Gallery
+# Developed for COSC-69.16: Basics of Reverse Engineering
+# Dartmouth College, Winter 2026
+
+"""
+ce_equivalence.py
+
+Scenarios that are expected to compile a source the same as another one.
+``-Ofast`` is ``-O3`` plus options that relax floating-point semantics, so
+for a source without floating-point code the two listings are usually
+identical and explaining both is wasted work. An ``equivalences`` mapping
+in config.yaml names them, member scenario to representative:
+
+    equivalences:
+      Ofast: O3
+
+With ``ce_batch.py --equivalence``, every member cell is still compiled, in
+the same compile unit as its representative. When the two listings match
+(ignoring whitespace), the member is not explained: it gets the
+representative's explanation once that is done, with ``reusedFrom`` naming
+the representative, and the book links it there. When they differ, the
+member is explained like any other cell.
+
+Before anything is compiled, uses_floating_point() tells which members the
+plan counts as linked, so the ETA and totals do not include their
+explanations. A linked member whose listing turns out to differ is added
+back. Only depends on the standard library.
+"""
+
+from __future__ import annotations
+
+import re
+from typing import Any, Dict, Sequence
+
+
+class EquivalenceError(ValueError):
+    pass
+
+
+def load_equivalences(config: Dict[str, Any], scenarios: Sequence[str]) -> Dict[str, str]:
+    """Parse the config's ``equivalences`` mapping (missing: none) against the configured *scenarios*."""
+    raw = config.get("equivalences")
+    if raw is None:
+        return {}
+    if not isinstance(raw, dict):
+        raise EquivalenceError("'equivalences' must be a mapping of scenario to the scenario it matches")
+    known = set(scenarios)
+    found: Dict[str, str] = {}
+    for member, representative in raw.items():
+        member, representative = str(member), str(representative)
+        for name in (member, representative):
+            if name not in known:
+                raise EquivalenceError(f"equivalences: unknown scenario {name!r}")
+        if member == representative:
+            raise EquivalenceError(f"equivalences: {member!r} cannot match itself")
+        found[member] = representative
+    chained = sorted(r for r in found.values() if r in found)
+    if chained:
+        raise EquivalenceError(f"equivalences: {chained[0]!r} is both a member and a representative")
+    return found
+
+
+# Comments and string or character literals, removed before looking for
+# floating-point code.
+_NOISE_RE = re.compile(r'/\*.*?\*/|//[^\n]*|"(?:\\.|[^"\\\n])*"|\'(?:\\.|[^\'\\\n])*\'', re.DOTALL)
+
+_FLOAT_RE = re.compile(
+    r"\b(?:float|double|_Complex|complex|_Float\d+x?|__float128|__fp16|__bf16|float\d+_t)\b"
+    r"|#\s*include\s*<(?:math\.h|cmath|tgmath\.h|complex\.h|fenv\.h|cfenv)>"
+    r"|\b\d+\.\d*(?:[eE][+-]?\d+)?|(?<![\w.])\.\d+|\b\d+[eE][+-]?\d+\b"
+    r"|\b0[xX][0-9a-fA-F.]+[pP][+-]?\d+"
+)
+
+
+def uses_floating_point(source: str) -> bool:
+    """Whether C or C++ *source* has floating-point types, literals or math headers."""
+    return _FLOAT_RE.search(_NOISE_RE.sub(" ", source)) is not None
+
+
+__all__ = [
+    "EquivalenceError",
+    "load_equivalences",
+    "uses_floating_point",
+]
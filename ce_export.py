@@ -0,0 +1,254 @@
+# Copyright (c) 2026 Larry H <l.gr [at] dartmouth [dot] edu>
+# SPDX-License-Identifier: AGPL-3.0-or-later
+#
+# Compiler Optimization Gallery
+# Developed for COSC-69.16: Basics of Reverse Engineering
+# Dartmouth College, Winter 2026
+
+"""
+ce_export.py
+
+The whole result matrix as one table, one row per (source, function,
+compiler, scenario, variant), for notebooks that would otherwise walk the
+output tree and parse every cell's JSON:
+
+    {"source": "simd/auto-vectorize", "function": "sum_array", "compiler": "cg152",
+     "scenario": "O3", "variant": "", "flags": "-O3", "instruction_set": "amd64",
+     "instructions": 18, "bytes": 71, "bytes_exact": false, "branches": 2, "calls": 0,
+     "memory_ops": 3, "padding": 0, "simd": "xmm", "cell_instructions": 60,
+     "cell_bytes": 231, "asm_hash": "3f2a...", "function_hash": "9c41...",
+     "explain_hash": "e0b7...", "explain_reused_from": null, "compile_ms": 19,
+     "bench_n": 1024, "bench_ns_per_op": 212.4}
+
+``variant`` holds the defines of a sweep-defines variant (``N=1024``), empty
+for the cell itself. ``asm_hash`` is the cell's listing and
+``function_hash`` the function's body, both with whitespace differences
+removed, so identical code is one equality test away. ``explain_hash``
+identifies the explanation text. The ``bench_*`` columns are the
+function's largest benchmarked size, if it was benchmarked. Hashes are the
+first 16 hex digits of a SHA-256.
+
+The format follows the file name. ``.ndjson`` (or ``.jsonl``) is written a
+row at a time, ``.ndjson.gz`` gzip-compressed the same way; both only need
+the standard library. ``.parquet`` is columnar with zstd compression and
+needs pyarrow; it loads into pandas or DuckDB without parsing:
+
+    python3 ce_export.py --out output matrix.parquet
+    python3 ce_batch.py ... --export output/matrix.ndjson.gz
+
+Cells are found through the tree's manifest, like the book's.
+"""
+
+from __future__ import annotations
+
+import argparse
+import gzip
+import hashlib
+import io
+import json
+from pathlib import Path
+from typing import Any, Dict, Iterator, List, Optional, TextIO
+
+from ce_manifest import read_manifest, scan_cells
+from ce_metrics import function_hash, split_functions
+from ce_store import open_outputs_for_reading
+
+COLUMNS = (
+    ("source", "string"), ("function", "string"), ("compiler", "string"), ("scenario", "string"),
+    ("variant", "string"), ("flags", "string"), ("instruction_set", "string"),
+    ("instructions", "int64"), ("bytes", "int64"), ("bytes_exact", "bool"), ("branches", "int64"),
+    ("calls", "int64"), ("memory_ops", "int64"), ("padding", "int64"), ("simd", "string"),
+    ("cell_instructions", "int64"), ("cell_bytes", "int64"),
+    ("asm_hash", "string"), ("function_hash", "string"), ("explain_hash", "string"),
+    ("explain_reused_from", "string"), ("compile_ms", "int64"),
+    ("bench_n", "int64"), ("bench_ns_per_op", "double"),
+)
+
+_FUNCTION_METRICS = ("instructions", "bytes", "branches", "calls", "memory_ops", "padding", "simd")
+
+# Rows per Parquet row group.
+PARQUET_BATCH = 50_000
+
+
+def _hash(text: str) -> str:
+    return hashlib.sha256(text.encode("utf-8")).hexdigest()[:16]
+
+
+def _normalized(lines: List[str]) -> str:
+    return "\n".join(" ".join(line.split()) for line in lines if line.strip())
+
+
+def _load_json(text: Optional[str]) -> Any:
+    try:
+        return json.loads(text) if text else None
+    except ValueError:
+        return None
+
+
+def matrix_rows(root: Path, use_manifest: bool = True) -> Iterator[Dict[str, Any]]:
+    """Rows of every cell of an output tree with metrics, one cell read at a time."""
+    outputs = open_outputs_for_reading(root)
+    try:
+        cells = read_manifest(outputs) if use_manifest else None
+        if cells is None:
+            cells = scan_cells(outputs)
+        for cell_key, entry in sorted(cells.items()):
+            files = entry.get("files", ())
+            if ".metrics.json" not in files or cell_key.count("/") < 2:
+                continue
+            metrics = _load_json(outputs.read_text(f"{cell_key}.metrics.json"))
+            if not isinstance(metrics, dict):
+                continue
+            compiler_id, scenario, rest = cell_key.split("/", 2)
+            source, _, variant = rest.partition("@")
+            request = _load_json(outputs.read_text(f"{cell_key}.compile.request.json")) or {}
+            timing = _load_json(outputs.read_text(f"{cell_key}.compiletime.json")) if ".compiletime.json" in files else None
+            asm = outputs.read_text(f"{cell_key}.asm") if ".asm" in files else None
+            bodies: Optional[Dict[str, List[str]]] = None  # split only for metrics older than per-function hashes
+            explanation = outputs.read_text(f"{cell_key}.explain.md") if ".explain.md" in files else None
+            explained = _load_json(outputs.read_text(f"{cell_key}.explain.response.json")) if explanation is not None else None
+            bench = _load_json(outputs.read_text(f"{cell_key}.bench.json")) if ".bench.json" in files else None
+            largest: Dict[str, Dict[str, Any]] = {}
+            for r in (bench or {}).get("results", []):
+                if isinstance(r.get("ns_per_op"), (int, float)) and isinstance(r.get("n"), int):
+                    if r["n"] >= largest.get(r.get("function"), {}).get("n", -1):
+                        largest[r.get("function")] = r
+            total = metrics.get("total") or {}
+            cell = {
+                "compiler": compiler_id,
+                "scenario": scenario,
+                "variant": variant,
+                "flags": (request.get("options") or {}).get("userArguments", (timing or {}).get("flags")),
+                "instruction_set": metrics.get("instruction_set"),
+                "bytes_exact": bool(metrics.get("bytes_exact")),
+                "cell_instructions": total.get("instructions"),
+                "cell_bytes": total.get("bytes"),
+                "asm_hash": _hash(_normalized(asm.splitlines())) if asm is not None else None,
+                "explain_hash": _hash(explanation) if explanation is not None else None,
+                "explain_reused_from": (explained or {}).get("reusedFrom"),
+                "compile_ms": (timing or {}).get("wall_ms"),
+            }
+            for f in metrics.get("functions", []):
+                name = f.get("name")
+                run = largest.get(name, {})
+                digest = f.get("hash")
+                if digest is None and asm is not None:
+                    if bodies is None:
+                        bodies = split_functions(asm.splitlines())
+                    digest = function_hash(bodies[name]) if name in bodies else None
+                yield {
+                    "source": source,
+                    "function": name,
+                    **cell,
+                    **{m: f.get(m) for m in _FUNCTION_METRICS},
+                    "function_hash": digest,
+                    "bench_n": run.get("n"),
+                    "bench_ns_per_op": run.get("ns_per_op"),
+                }
+    finally:
+        outputs.close()
+
+
+def _ordered(row: Dict[str, Any]) -> Dict[str, Any]:
+    return {name: row.get(name) for name, _ in COLUMNS}
+
+
+def _write_ndjson(rows: Iterator[Dict[str, Any]], fh: TextIO) -> int:
+    n = 0
+    for row in rows:
+        fh.write(json.dumps(_ordered(row), separators=(",", ":")))
+        fh.write("\n")
+        n += 1
+    return n
+
+
+def export_format(path: Path) -> str:
+    """
+    Format *path*'s name asks for: "parquet", "ndjson.gz" or "ndjson".
+    Raises ValueError for any other name, or for Parquet without pyarrow,
+    so callers can check a path before a run rather than after it.
+    """
+    name = Path(path).name.lower()
+    if name.endswith(".parquet"):
+        try:
+            import pyarrow  # type: ignore  # noqa: F401
+            import pyarrow.parquet  # type: ignore  # noqa: F401
+        except ImportError as e:
+            raise ValueError("Parquet export needs pyarrow (pip install pyarrow); use .ndjson.gz otherwise") from e
+        return "parquet"
+    if name.endswith((".ndjson.gz", ".jsonl.gz")):
+        return "ndjson.gz"
+    if name.endswith((".ndjson", ".jsonl")):
+        return "ndjson"
+    raise ValueError(f"cannot tell the export format of {path} (use .ndjson, .ndjson.gz or .parquet)")
+
+
+def _write_parquet(rows: Iterator[Dict[str, Any]], path: Path) -> int:
+    import pyarrow as pa  # type: ignore
+    import pyarrow.parquet as pq  # type: ignore
+    types = {"string": pa.string(), "int64": pa.int64(), "bool": pa.bool_(), "double": pa.float64()}
+    schema = pa.schema([(name, types[kind]) for name, kind in COLUMNS])
+    n = 0
+    with pq.ParquetWriter(str(path), schema, compression="zstd") as writer:
+        batch: List[Dict[str, Any]] = []
+        for row in rows:
+            batch.append(_ordered(row))
+            if len(batch) >= PARQUET_BATCH:
+                writer.write_table(pa.Table.from_pylist(batch, schema=schema))
+                n += len(batch)
+                batch = []
+        if batch or not n:
+            writer.write_table(pa.Table.from_pylist(batch, schema=schema))
+            n += len(batch)
+    return n
+
+
+def export_matrix(root: Path, path: Path, use_manifest: bool = True) -> int:
+    """
+    Write the matrix of output tree *root* to *path*, in the format its name
+    says (see export_format, whose ValueError it raises). Returns the row count.
+    """
+    path = Path(path)
+    fmt = export_format(path)
+    path.parent.mkdir(parents=True, exist_ok=True)
+    rows = matrix_rows(root, use_manifest)
+    tmp = path.with_name(path.name + ".tmp")
+    if fmt == "parquet":
+        n = _write_parquet(rows, tmp)
+    elif fmt == "ndjson.gz":
+        # mtime=0 keeps the file identical when the matrix is.
+        with open(tmp, "wb") as raw, gzip.GzipFile(fileobj=raw, mode="wb", mtime=0) as gz, \
+                io.TextIOWrapper(gz, encoding="utf-8") as fh:
+            n = _write_ndjson(rows, fh)
+    else:
+        with open(tmp, "w", encoding="utf-8") as fh:
+            n = _write_ndjson(rows, fh)
+    tmp.replace(path)
+    return n
+
+
+def main() -> int:
+    ap = argparse.ArgumentParser(description="Export the result matrix as one NDJSON or Parquet table")
+    ap.add_argument("path", type=Path, help="File to write: .ndjson, .ndjson.gz or .parquet (needs pyarrow)")
+    ap.add_argument("--out", type=Path, default=Path("output"), help="Output directory of ce_batch.py (default: output/)")
+    ap.add_argument("--no-manifest", action="store_true", help="Find cells by walking the tree instead of reading its manifest.json")
+    args = ap.parse_args()
+    try:
+        export_format(args.path)
+    except ValueError as e:
+        ap.error(str(e))
+    n = export_matrix(args.out, args.path, use_manifest=not args.no_manifest)
+    print(f"Exported {n} rows to {args.path}")
+    return 0
+
+
+__all__ = [
+    "COLUMNS",
+    "export_format",
+    "export_matrix",
+    "matrix_rows",
+]
+
+
+if __name__ == "__main__":
+    raise SystemExit(main())
@@ -0,0 +1,198 @@
+# Copyright (c) 2026 Larry H <l.gr [at] dartmouth [dot] edu>
+# SPDX-License-Identifier: AGPL-3.0-or-later
+#
+# Compiler Optimization Gallery
+# Developed for COSC-69.16: Basics of Reverse Engineering
+# Dartmouth College, Winter 2026
+
+"""
+ce_incremental.py
+
+Change detection shared by ce_batch.py and build_book.py for incremental
+rebuilds. Only depends on the standard library (build_book.py runs without
+requests installed).
+
+Sources are identified by their "source key": the path under src/ without
+extension, e.g. ``loops/unrollme-1``. That is the same key ce_batch.py uses for
+progress output and build_book.py uses for pages.
+
+Two modes are supported:
+- git: every source that differs between a revision and the working tree
+  (committed, staged, unstaged or untracked). A ``@gallery-hints`` edit is a
+  change to the file itself, so cells whose hints changed are picked up too.
+- mtime: per cell, the source is newer than the outputs already written.
+"""
+
+from __future__ import annotations
+
+import subprocess
+from dataclasses import dataclass, field
+from pathlib import Path
+from typing import Iterable, Optional, Set, Tuple
+
+from ce_store import OutputStore
+
+# Files written per cell, relative to "<out_dir>/<stem>". The ".src<ext>"
+# copy is matched separately because its extension follows the source.
+CELL_OUTPUT_SUFFIXES: Tuple[str, ...] = (
+    ".compile.request.json",
+    ".compile.response.json",
+    ".asm",
+    ".explain.request.json",
+    ".explain.response.json",
+    ".explain.md",
+)
+
+# Written only for some cells (e.g. ``.bench.json`` with ``ce_batch.py --bench``),
+# or missing from trees compiled before they existed (``.metrics.json``).
+OPTIONAL_CELL_OUTPUT_SUFFIXES: Tuple[str, ...] = (
+    ".bench.json",
+    ".metrics.json",
+    ".remarks.json",
+    ".consttime.json",
+    ".dudect.json",
+    ".overhead.json",
+    ".mca.json",
+    ".pgo.json",
+    ".files.json",
+    ".compiletime.json",
+)
+
+
+@dataclass
+class SourceChanges:
+    """Source keys that changed (added or modified) or were deleted."""
+    changed: Set[str] = field(default_factory=set)
+    deleted: Set[str] = field(default_factory=set)
+
+    def __bool__(self) -> bool:
+        return bool(self.changed or self.deleted)
+
+
+def source_key(path: Path, src_root: Path) -> str:
+    """``src/loops/unrollme-1.c`` -> ``loops/unrollme-1``."""
+    rel = path.relative_to(src_root)
+    return rel.with_suffix("").as_posix()
+
+
+def source_category(key: str) -> str:
+    """Gallery section of a source key: ``loops/unrollme-1`` -> ``loops``; top-level sources are ``general``."""
+    return key.split("/")[0] if "/" in key else "general"
+
+
+def _git(args: Iterable[str], cwd: Path) -> str:
+    try:
+        proc = subprocess.run(
+            ["git", *args], cwd=cwd, capture_output=True, text=True, check=True,
+        )
+    except FileNotFoundError as e:
+        raise SystemExit("--changed-since requires git on PATH") from e
+    except subprocess.CalledProcessError as e:
+        raise SystemExit(f"git {' '.join(args)} failed:\n{e.stderr.strip()}") from e
+    return proc.stdout
+
+
+def changed_sources_since(rev: str, src_root: Path, extensions: Tuple[str, ...]) -> SourceChanges:
+    """
+    Return the sources under *src_root* that differ from *rev*.
+
+    Compares *rev* against the working tree, so uncommitted edits and new
+    untracked files count as changes. Renames are reported as a delete plus an
+    add.
+    """
+    src_root = src_root.resolve()
+    top = Path(_git(["rev-parse", "--show-toplevel"], src_root).strip())
+    result = SourceChanges()
+
+    def classify(rel_to_top: str, deleted: bool) -> None:
+        path = top / rel_to_top
+        if path.suffix not in extensions:
+            return
+        try:
+            key = source_key(path, src_root)
+        except ValueError:
+            return  # outside src_root
+        (result.deleted if deleted else result.changed).add(key)
+
+    diff = _git(["diff", "--name-status", "--no-renames", rev, "--", str(src_root)], top)
+    for line in diff.splitlines():
+        status, _, name = line.partition("\t")
+        if name:
+            classify(name, deleted=status.startswith("D"))
+
+    untracked = _git(["ls-files", "--others", "--exclude-standard", "--", str(src_root)], top)
+    for name in untracked.splitlines():
+        if name:
+            classify(name, deleted=False)
+
+    # A file deleted and re-added under the same key is simply changed.
+    result.deleted -= result.changed
+    return result
+
+
+def cell_is_stale(
+    src_path: Path, out_dir: Path, stem: str, outputs: Optional[OutputStore] = None, companions: Iterable[Path] = ()
+) -> bool:
+    """
+    True if the cell has no explanation yet or its source, or one of the
+    other files of a multi-file example, is newer than it.
+    """
+    marker = out_dir / f"{stem}.explain.md"
+    newest = max([src_path.stat().st_mtime] + [p.stat().st_mtime for p in companions if p.exists()])
+    if outputs is not None:
+        written = outputs.mtime(marker)
+        return written == 0.0 or written < newest
+    try:
+        return marker.stat().st_mtime < newest
+    except FileNotFoundError:
+        return True
+
+
+def _is_cell_output(name: str, stem: str) -> bool:
+    rest = name[len(stem):]
+    return name.startswith(stem) and (
+        rest in CELL_OUTPUT_SUFFIXES or rest in OPTIONAL_CELL_OUTPUT_SUFFIXES or rest.startswith(".src.")
+    )
+
+
+def remove_cell_outputs(out_dir: Path, stem: str, outputs: Optional[OutputStore] = None) -> int:
+    """Delete one cell's outputs (e.g. after its source was removed). Returns files removed."""
+    removed = 0
+    if outputs is not None:
+        prefix = outputs.key(out_dir / stem)
+        for key in list(outputs.iter_files(prefix=prefix + ".")):
+            if "/" not in key[len(prefix):] and _is_cell_output(key.rpartition("/")[2], stem):
+                removed += outputs.delete(key)
+        return removed
+    if not out_dir.is_dir():
+        return 0
+    for path in out_dir.glob(f"{stem}.*"):
+        if _is_cell_output(path.name, stem):
+            path.unlink()
+            removed += 1
+    return removed
+
+
+def remove_variant_outputs(
+    out_dir: Path, stem: str, keep: Iterable[str] = (), outputs: Optional[OutputStore] = None
+) -> int:
+    """
+    Delete the outputs of *stem*'s ``sweep-defines`` variants
+    (``<stem>@N=1024.*``) other than the variant stems in *keep*, e.g. after
+    the hints dropped a value. Returns files removed.
+    """
+    keep = set(keep)
+    prefix_name = f"{stem}@"
+    if outputs is not None:
+        names = [
+            key.rpartition("/")[2]
+            for key in outputs.iter_files(prefix=outputs.key(out_dir / prefix_name))
+            if "/" not in key[len(outputs.key(out_dir)) + 1:]
+        ]
+    elif out_dir.is_dir():
+        names = [p.name for p in out_dir.glob(f"{stem}@*")]
+    else:
+        names = []
+    # The defines never contain '.', so the variant stem ends at the first one after '@'.
+    stems = {prefix_name + name[len(prefix_name):].split(".", 1)[0] for name in names}
+    return sum(remove_cell_outputs(out_dir, s, outputs) for s in sorted(stems - keep))
@@ -0,0 +1,164 @@
+# Copyright (c) 2026 Larry H <l.gr [at] dartmouth [dot] edu>
+# SPDX-License-Identifier: AGPL-3.0-or-later
+#
+# Compiler Optimization Gallery
+# Developed for COSC-69.16: Basics of Reverse Engineering
+# Dartmouth College, Winter 2026
+
+"""
+ce_journal.py
+
+Append-only journal of completed batch cells, so an interrupted ce_batch.py
+run can be resumed with ``--resume`` instead of starting from cell zero.
+
+The journal lives next to the top-level README as ``<out>/.journal.jsonl``.
+Each line records one finished stage of one cell:
+
+    {"compiler": "cg152", "scenario": "O2", "file": "loops/unrollme-1",
+     "stage": "compile" | "explain" | "pruned", "fingerprint": "<hash of source+flags>",
+     "outputs": {"<file name>": <size in bytes>, ...}}
+
+Every record is written with a single O_APPEND write, so concurrent workers
+never interleave and a crash can at worst truncate the final line (which is
+ignored on load). Loading compacts the file to one line per (cell, stage)
+and swaps it into place atomically.
+
+A stage only counts as done if its fingerprint still matches (the source and
+effective flags are unchanged) and every output it recorded still exists
+with the recorded size. A "pruned" record marks a sweep point whose
+outputs were removed because its assembly matched a neighbour's; it counts
+as done on its fingerprint alone.
+"""
+
+from __future__ import annotations
+
+import json
+import os
+import threading
+from pathlib import Path
+from typing import Dict, Iterable, Optional, Tuple
+
+from ce_incremental import CELL_OUTPUT_SUFFIXES
+from ce_store import OutputStore
+
+JOURNAL_NAME = ".journal.jsonl"
+
+# Which per-cell outputs each stage produces (besides the ".src<ext>" copy).
+STAGE_SUFFIXES: Dict[str, Tuple[str, ...]] = {
+    "compile": CELL_OUTPUT_SUFFIXES[:3],
+    "explain": CELL_OUTPUT_SUFFIXES[3:],
+    "pruned": (),  # a sweep point whose assembly matched a neighbour's; its outputs were removed
+}
+
+CellKey = Tuple[str, str, str]  # (compiler, scenario, file)
+
+
+class JobJournal:
+    def __init__(self, out_root: Path, outputs: Optional[OutputStore] = None) -> None:
+        self.path = Path(out_root) / JOURNAL_NAME
+        # Where recorded outputs are checked; plain files unless given.
+        self.outputs = outputs
+        self._records: Dict[Tuple[CellKey, str], dict] = {}
+        self._lock = threading.Lock()
+
+    def _size(self, path: Path) -> Optional[int]:
+        if self.outputs is not None:
+            return self.outputs.size(path)
+        try:
+            return path.stat().st_size
+        except FileNotFoundError:
+            return None
+
+    # ---------------------------
+    # Loading
+    # ---------------------------
+
+    def load(self) -> int:
+        """Read and compact the journal. Returns the number of live records."""
+        records: Dict[Tuple[CellKey, str], dict] = {}
+        try:
+            lines = self.path.read_text(encoding="utf-8").splitlines()
+        except FileNotFoundError:
+            lines = []
+        for line in lines:
+            try:
+                rec = json.loads(line)
+                key = (rec["compiler"], rec["scenario"], rec["file"])
+                records[(key, rec["stage"])] = rec  # last write wins
+            except (ValueError, KeyError, TypeError):
+                continue  # torn final line from an interrupted run
+        with self._lock:
+            self._records = records
+        self._compact()
+        return len(records)
+
+    def _compact(self) -> None:
+        if not self._records:
+            return
+        self.path.parent.mkdir(parents=True, exist_ok=True)
+        tmp = self.path.with_name(self.path.name + ".tmp")
+        with tmp.open("w", encoding="utf-8") as f:
+            for rec in self._records.values():
+                f.write(json.dumps(rec, sort_keys=True) + "\n")
+            f.flush()
+            os.fsync(f.fileno())
+        os.replace(tmp, self.path)
+
+    # ---------------------------
+    # Queries
+    # ---------------------------
+
+    def is_done(self, key: CellKey, stage: str, fingerprint: str, out_dir: Path) -> bool:
+        with self._lock:
+            rec = self._records.get((key, stage))
+        if rec is None or rec.get("fingerprint") != fingerprint:
+            return False
+        for name, size in rec.get("outputs", {}).items():
+            if self._size(out_dir / name) != size:
+                return False
+        return True
+
+    def resume_state(self, key: CellKey, fingerprint: str, out_dir: Path) -> Optional[str]:
+        """The furthest stage this cell completed intact ("explain", "compile"), or None."""
+        for stage in ("explain", "compile"):
+            if self.is_done(key, stage, fingerprint, out_dir):
+                # An explanation is only reusable if its compile is intact too.
+                if stage == "explain" and not self.is_done(key, "compile", fingerprint, out_dir):
+                    continue
+                return stage
+        return None
+
+    def is_pruned(self, key: CellKey, fingerprint: str) -> bool:
+        """True if this sweep point was pruned with the same source and flags."""
+        with self._lock:
+            rec = self._records.get((key, "pruned"))
+        return rec is not None and rec.get("fingerprint") == fingerprint
+
+    # ---------------------------
+    # Recording
+    # ---------------------------
+
+    def record(self, key: CellKey, stage: str, fingerprint: str, out_dir: Path, stem: str,
+               extra_files: Iterable[str] = ()) -> None:
+        outputs: Dict[str, int] = {}
+        for name in [stem + sfx for sfx in STAGE_SUFFIXES[stage]] + list(extra_files):
+            size = self._size(out_dir / name)
+            if size is not None:
+                outputs[name] = size
+        rec = {
+            "compiler": key[0],
+            "scenario": key[1],
+            "file": key[2],
+            "stage": stage,
+            "fingerprint": fingerprint,
+            "outputs": outputs,
+        }
+        line = (json.dumps(rec, sort_keys=True) + "\n").encode("utf-8")
+        with self._lock:
+            self._records[(key, stage)] = rec
+            self.path.parent.mkdir(parents=True, exist_ok=True)
+            fd = os.open(self.path, os.O_WRONLY | os.O_CREAT | os.O_APPEND, 0o644)
+            try:
+                os.write(fd, line)
+            finally:
+                os.close(fd)
@@ -0,0 +1,741 @@
+# Copyright (c) 2026 Larry H <l.gr [at] dartmouth [dot] edu>
+# SPDX-License-Identifier: AGPL-3.0-or-later
+#
+# Compiler Optimization Gallery
+# Developed for COSC-69.16: Basics of Reverse Engineering
+# Dartmouth College, Winter 2026
+
+"""
+ce_local.py
+
+Local compile backend: runs installed gcc/clang/cross toolchains with ``-S``
+instead of calling Compiler Explorer, and returns CE-shaped compile results
+so the rest of the pipeline (outputs, explain, book) cannot tell the
+difference.
+
+Compiler IDs are mapped to toolchains in the ``local_compilers`` section of
+docs/config.yaml:
+
+    local_compilers:
+      cg152:
+        command: gcc            # executable (or list: [ccache, gcc])
+        args: ""                # extra flags before the scenario's flags
+        intel: true             # add -masm=intel when Intel syntax is asked for
+        lang: c                 # -x language when the caller gives none
+        instruction_set: amd64  # reported to the explain stage
+        run: true               # binaries run on this host (default: when
+                                # instruction_set matches the host machine)
+        objdump: objdump        # disassembler for binary_object compiles
+                                # (default: derived from command, see below)
+
+The assembly is run through filter_asm(), an approximation of CE's
+``directives``, ``labels`` and ``commentOnly`` filters, so listings look like
+the ones godbolt.org returns. Compiles are plain subprocesses, so a pool of
+worker threads keeps every core busy.
+
+With ``binary_object`` the source is compiled with ``-c`` and the object is
+disassembled with objdump (``<prefix>objdump`` for a ``<prefix>gcc``
+cross toolchain, ``llvm-objdump`` for clang). parse_objdump() turns the
+output into CE's binary listing shape: ``name:`` label lines and one entry
+per instruction with its ``address`` and ``opcodes``; relocations name
+their symbol in place of the unrelocated branch target.
+
+A compile with ``extra_files`` (the other translation units of a
+multi-file example, CE's ``files`` shape) links a program instead: the
+source as ``example.c`` and the extra files next to it, built with
+``-nostdlib -Wl,-e,main`` so no C library or start files are needed (the
+example's ``main`` is the entry point), and the ``.text`` of the result is
+disassembled like a binary object. That is what shows cross-module
+inlining under ``-flto``.
+
+LocalCompiler.execute() builds and runs a program (the benchmark drivers of
+ce_bench.py); runs are serialized so concurrent workers do not disturb each
+other's timings. train_profile() does the same with gcc's or clang's
+instrumentation and returns the profile the run wrote (merged with
+``llvm-profdata``, or ``llvm-profdata-N`` next to ``clang-N``, for clang);
+compile_to_asm() and execute() take it back as ``profile`` and build with
+``-fprofile-use`` (see ce_pgo.py). The profile's digest is part of the
+cache key.
+"""
+
+from __future__ import annotations
+
+import hashlib
+import os
+import platform
+import re
+import shlex
+import shutil
+import subprocess
+import tempfile
+import threading
+import time
+from contextlib import contextmanager
+from dataclasses import dataclass, field
+from typing import Any, Dict, Iterator, List, Optional, Sequence, Set, Tuple
+
+from ce_cache import ResultCache
+from ce_client import CompileResult, CompilerExplorerClient, ExecResult, asm_text_from_response
+from ce_pgo import TRAIN_FLAGS
+from ce_remarks import compiler_family
+
+# Linking a multi-file example: no C library or start files, main is the entry.
+LINK_FLAGS = ["-nostdlib", "-Wl,-e,main"]
+# Extra files written next to the example but not passed to the compiler.
+HEADER_SUFFIXES = (".h", ".hh", ".hpp", ".hxx", ".inc")
+
+# platform.machine() -> the instruction_set names used in local_compilers.
+_HOST_INSTRUCTION_SETS = {
+    "x86_64": "amd64", "amd64": "amd64", "AMD64": "amd64",
+    "aarch64": "aarch64", "arm64": "aarch64",
+}
+
+
+@dataclass(frozen=True)
+class LocalToolchain:
+    compiler_id: str
+    command: List[str]
+    args: str = ""
+    intel: bool = False
+    lang: str = "c"
+    instruction_set: Optional[str] = None
+    run: Optional[bool] = None
+    demangle_command: List[str] = field(default_factory=lambda: ["c++filt"])
+    objdump: Optional[List[str]] = None  # None: default_objdump(command)
+
+    @staticmethod
+    def from_config(compiler_id: str, spec: Any) -> "LocalToolchain":
+        if isinstance(spec, str):
+            spec = {"command": spec}
+        if not isinstance(spec, dict) or "command" not in spec:
+            raise ValueError(f"local_compilers.{compiler_id} needs a 'command'")
+        command = spec["command"]
+        command = shlex.split(command) if isinstance(command, str) else [str(c) for c in command]
+        objdump = spec.get("objdump")
+        if objdump is not None:
+            objdump = shlex.split(objdump) if isinstance(objdump, str) else [str(c) for c in objdump]
+        return LocalToolchain(
+            compiler_id=compiler_id,
+            command=command,
+            args=str(spec.get("args", "")),
+            intel=bool(spec.get("intel", False)),
+            lang=str(spec.get("lang", "c")),
+            instruction_set=spec.get("instruction_set"),
+            run=spec.get("run"),
+            objdump=objdump,
+        )
+
+    def objdump_command(self) -> List[str]:
+        return list(self.objdump) if self.objdump else [default_objdump(self.command)]
+
+    def available(self) -> bool:
+        return shutil.which(self.command[0]) is not None
+
+    def runnable(self) -> bool:
+        """Whether programs built by this toolchain run on this host."""
+        if self.run is not None:
+            return bool(self.run)
+        return self.instruction_set is not None and self.instruction_set == _HOST_INSTRUCTION_SETS.get(platform.machine())
+
+
+def default_objdump(command: Sequence[str]) -> str:
+    """``avr-gcc`` -> ``avr-objdump``, ``gcc-15`` -> ``objdump``, ``clang-21`` -> ``llvm-objdump-21``."""
+    name = os.path.basename(command[-1]) if command else "gcc"
+    m = re.match(r"^(.*?)clang(?:\+\+)?(-\d+)?$", name)
+    if m:
+        versioned = f"llvm-objdump{m.group(2) or ''}"
+        return versioned if shutil.which(versioned) else "llvm-objdump"
+    m = re.match(r"^(.*?)(?:gcc|g\+\+|cc|c\+\+)(?:-\d+(?:\.\d+)*)?$", name)
+    return f"{m.group(1) if m else ''}objdump"
+
+
+def default_profdata(command: Sequence[str]) -> str:
+    """``clang-21`` -> ``llvm-profdata-21`` if installed, else ``llvm-profdata``."""
+    name = os.path.basename(command[-1]) if command else "clang"
+    m = re.search(r"clang(?:\+\+)?(-\d+)$", name)
+    versioned = f"llvm-profdata{m.group(1)}" if m else None
+    return versioned if versioned and shutil.which(versioned) else "llvm-profdata"
+
+
+def example_name(lang: str) -> str:
+    """The main file of a linked example, named as Compiler Explorer names it."""
+    return "example.cpp" if lang in ("c++", "cpp") else "example.c"
+
+
+def load_local_toolchains(config: Dict[str, Any]) -> Dict[str, LocalToolchain]:
+    """Parse the ``local_compilers`` mapping of a loaded config.yaml."""
+    raw = config.get("local_compilers") or {}
+    if not isinstance(raw, dict):
+        raise ValueError("'local_compilers' must be a mapping of compiler ID -> toolchain")
+    return {str(cid): LocalToolchain.from_config(str(cid), spec) for cid, spec in raw.items()}
+
+
+# ---------------------------
+# Assembly filters
+# ---------------------------
+
+_LABEL_RE = re.compile(r"^\s*([A-Za-z_.$@][\w.$@]*):")
+_DIRECTIVE_RE = re.compile(r"^\s*\.[A-Za-z_]")
+_COMMENT_RE = re.compile(r"^\s*(#|//|;|@\s|@$|!)")
+_IDENT_RE = re.compile(r"[A-Za-z_.$@][\w.$@]*")
+_LOCAL_LABEL_RE = re.compile(r"^(\.L|L\d|\$L|\.\$)")
+
+# Directives that emit data; kept under a label that survives filtering.
+_DATA_DIRECTIVES = {
+    ".ascii", ".asciz", ".string", ".byte", ".short", ".hword", ".word", ".long",
+    ".int", ".quad", ".octa", ".value", ".zero", ".skip", ".space", ".float",
+    ".single", ".double", ".2byte", ".4byte", ".8byte", ".xword", ".dword",
+    ".uleb128", ".sleb128",
+}
+
+
+def _directive_name(line: str) -> str:
+    return line.strip().split(None, 1)[0].split("\t", 1)[0]
+
+
+def filter_asm(
+    text: str,
+    directives: bool = True,
+    labels: bool = True,
+    comment_only: bool = True,
+) -> List[str]:
+    """
+    Approximate CE's output filters on GNU-as style assembly.
+
+    - comment_only: drop lines that are nothing but a comment.
+    - directives: drop assembler directives, except data directives under a
+      label that is kept (string literals, jump tables, constants).
+    - labels: drop local labels (.L*) nothing refers to; symbol labels
+      (functions, globals) are always kept.
+    """
+    lines = [ln.rstrip().expandtabs(8) for ln in text.splitlines()]
+    lines = [ln for ln in lines if ln.strip()]
+    if comment_only:
+        lines = [ln for ln in lines if not _COMMENT_RE.match(ln)]
+    if not directives and not labels:
+        return lines
+
+    def kind(ln: str) -> str:
+        if _LABEL_RE.match(ln):
+            return "label"
+        if _DIRECTIVE_RE.match(ln):
+            return "data" if _directive_name(ln) in _DATA_DIRECTIVES else "directive"
+        return "insn"
+
+    kinds = [kind(ln) for ln in lines]
+    label_names = [(_LABEL_RE.match(ln).group(1) if k == "label" else None) for ln, k in zip(lines, kinds)]  # type: ignore[union-attr]
+
+    def refs(ln: str, k: str) -> Set[str]:
+        body = _LABEL_RE.sub("", ln, count=1) if k == "label" else ln
+        return set(_IDENT_RE.findall(body))
+
+    def label_kept(name: str, referenced: Set[str]) -> bool:
+        return not labels or not _LOCAL_LABEL_RE.match(name) or name in referenced
+
+    # Labels referenced by instructions are kept; data under kept labels may
+    # reference further labels (jump tables), so iterate to a fixed point.
+    referenced: Set[str] = set()
+    for ln, k in zip(lines, kinds):
+        if k == "insn" or (k != "label" and not directives):
+            referenced |= refs(ln, k)
+    while True:
+        grown = set(referenced)
+        current_kept = False
+        for ln, k, name in zip(lines, kinds, label_names):
+            if k == "label":
+                current_kept = label_kept(name, referenced)
+            elif k == "data" and current_kept:
+                grown |= refs(ln, k)
+        if grown == referenced:
+            break
+        referenced = grown
+
+    out: List[str] = []
+    current_kept = True
+    for ln, k, name in zip(lines, kinds, label_names):
+        if k == "label":
+            current_kept = label_kept(name, referenced)
+            if current_kept:
+                out.append(ln)
+        elif k == "directive":
+            if not directives:
+                out.append(ln)
+        elif k == "data":
+            if not directives or current_kept:
+                out.append(ln)
+        else:
+            out.append(ln)
+    return out
+
+
+# ---------------------------
+# Object disassembly
+# ---------------------------
+
+_OBJDUMP_SYMBOL_RE = re.compile(r"^([0-9a-fA-F]+) <(.+)>:\s*$")
+_OBJDUMP_INSN_RE = re.compile(r"^\s*([0-9a-fA-F]+):[ \t]+((?:[0-9a-fA-F]{2,8} )*[0-9a-fA-F]{2,8})[ \t]*(?:\t(.*))?$")
+_OBJDUMP_RELOC_RE = re.compile(r"^\s+([0-9a-fA-F]+):\s+(R_\w+)\s+(\S+)")
+_OBJDUMP_TARGET_RE = re.compile(r"(?:\b[0-9a-fA-F]+ )?<[^>]+>")
+
+
+def parse_objdump(text: str) -> List[Dict[str, Any]]:
+    """
+    CE-shaped listing of ``objdump -d -r`` output: ``{"text": "name:"}`` per
+    symbol, and ``{"text", "address", "opcodes"}`` per instruction (opcodes
+    as hex bytes; continuation lines of long instructions are merged).
+    """
+    out: List[Dict[str, Any]] = []
+    last: Optional[Dict[str, Any]] = None
+    for line in text.splitlines():
+        sym = _OBJDUMP_SYMBOL_RE.match(line)
+        if sym:
+            out.append({"text": f"{sym.group(2)}:"})
+            last = None
+            continue
+        reloc = _OBJDUMP_RELOC_RE.match(line)
+        if reloc:
+            if last is not None:
+                # "g-0x4" -> "g": the symbol the unrelocated field will point at
+                target = f"<{re.split(r'[-+]0x', reloc.group(3))[0]}>"
+                if _OBJDUMP_TARGET_RE.search(last["text"]):
+                    last["text"] = _OBJDUMP_TARGET_RE.sub(target, last["text"], count=1)
+                else:
+                    last["text"] += f" {target}"
+            continue
+        insn = _OBJDUMP_INSN_RE.match(line)
+        if not insn:
+            continue
+        # Words print as one group ("d10043ff"); bytes as pairs ("0f af").
+        groups = insn.group(2).split()
+        opcodes = [g[i:i + 2].lower() for g in groups for i in range(0, len(g), 2)]
+        if insn.group(3) is None or not insn.group(3).strip():
+            if last is not None:
+                last["opcodes"].extend(opcodes)  # continuation of a wrapped instruction
+            continue
+        last = {"text": "  " + insn.group(3).strip(), "address": int(insn.group(1), 16), "opcodes": opcodes}
+        out.append(last)
+    return out
+
+
+# ---------------------------
+# Backend
+# ---------------------------
+
+class LocalCompiler:
+    """
+    Compile backend with the same ``compile_to_asm``/``compile_many``
+    interface as CompilerExplorerClient, backed by local toolchains.
+    Thread-safe.
+    """
+
+    def __init__(
+        self,
+        toolchains: Dict[str, LocalToolchain],
+        timeout_s: float = 60.0,
+        cache: Optional[ResultCache] = None,
+    ) -> None:
+        self.toolchains = toolchains
+        self.timeout_s = timeout_s
+        self.cache = cache
+        self._versions: Dict[str, str] = {}
+        self._lock = threading.Lock()
+        self._run_lock = threading.Lock()  # one program runs at a time
+
+    def handles(self, compiler_id: str) -> bool:
+        tc = self.toolchains.get(compiler_id)
+        return tc is not None and tc.available()
+
+    def version(self, compiler_id: str) -> str:
+        """First line of ``<command> --version``; part of the cache key."""
+        with self._lock:
+            if compiler_id in self._versions:
+                return self._versions[compiler_id]
+        tc = self.toolchains[compiler_id]
+        try:
+            proc = subprocess.run(tc.command + ["--version"], capture_output=True, text=True, timeout=self.timeout_s)
+            version = (proc.stdout or proc.stderr).splitlines()[0].strip() if (proc.stdout or proc.stderr) else ""
+        except (OSError, subprocess.TimeoutExpired):
+            version = ""
+        with self._lock:
+            self._versions[compiler_id] = version
+        return version
+
+    def command_line(
+        self, tc: LocalToolchain, user_arguments: str, lang: Optional[str], intel_syntax: bool,
+        obj: Optional[str] = None, extra: Sequence[str] = (),
+    ) -> List[str]:
+        """Assembly to stdout, or with *obj* an object file at that path. *extra* follows the user's flags."""
+        cmd = list(tc.command) + shlex.split(tc.args) + shlex.split(user_arguments) + list(extra)
+        if intel_syntax and tc.intel:
+            cmd.append("-masm=intel")
+        output = ["-c", "-o", obj] if obj else ["-S", "-o", "-"]
+        return cmd + output + ["-x", lang or tc.lang, "-"]
+
+    def link_line(
+        self, tc: LocalToolchain, user_arguments: str, lang: Optional[str], inputs: Sequence[str], exe: str,
+        extra: Sequence[str] = (),
+    ) -> List[str]:
+        """A program linked from *inputs*, all compiled as *lang*."""
+        cmd = list(tc.command) + shlex.split(tc.args) + shlex.split(user_arguments) + list(extra)
+        return cmd + LINK_FLAGS + ["-o", exe, "-x", lang or tc.lang] + list(inputs)
+
+    def objdump_line(
+        self, tc: LocalToolchain, obj: str, intel_syntax: bool, demangle: bool, sections: Sequence[str] = ()
+    ) -> List[str]:
+        cmd = tc.objdump_command() + ["-d", "-r"]
+        for section in sections:
+            cmd += ["-j", section]
+        if "llvm-objdump" not in os.path.basename(cmd[0]):
+            cmd.append("--insn-width=16")  # GNU objdump wraps long x86 encodings otherwise
+        if intel_syntax and tc.intel:
+            cmd += ["-M", "intel"]
+        if demangle:
+            cmd.append("-C")
+        return cmd + [obj]
+
+    def _compile_object(
+        self, tc: LocalToolchain, source: str, user_arguments: str, lang: Optional[str], intel_syntax: bool, demangle: bool,
+        extra: Sequence[str] = (),
+    ) -> tuple:
+        """(code, listing, stderr) of a ``-c`` compile and its disassembly."""
+        with tempfile.TemporaryDirectory(prefix="gallery-obj-") as tmp:
+            obj = os.path.join(tmp, "cell.o")
+            cmd = self.command_line(tc, user_arguments, lang, intel_syntax, obj=obj, extra=extra)
+            try:
+                proc = subprocess.run(cmd, input=source, capture_output=True, text=True, timeout=self.timeout_s)
+            except subprocess.TimeoutExpired:
+                return -1, [], f"Compilation timed out after {self.timeout_s:.0f}s"
+            if proc.returncode != 0:
+                return proc.returncode, [], proc.stderr
+            dump = self.objdump_line(tc, obj, intel_syntax, demangle)
+            try:
+                dis = subprocess.run(dump, capture_output=True, text=True, timeout=self.timeout_s)
+            except (OSError, subprocess.TimeoutExpired) as e:
+                return -1, [], f"{dump[0]} failed: {e}"
+            if dis.returncode != 0:
+                return dis.returncode, [], proc.stderr + dis.stderr
+            return 0, parse_objdump(dis.stdout), proc.stderr
+
+    @contextmanager
+    def _profile_use(self, compiler_id: str, profile: Optional[bytes], link: bool) -> Iterator[List[str]]:
+        """
+        The flags that compile with *profile*, written to a scratch directory
+        for the duration (none without a profile). GCC looks for
+        ``<dumpbase>.gcda``; a link build appends ``-`` and the input's name,
+        ``-`` for stdin, to the dump base itself.
+        """
+        if profile is None:
+            yield []
+            return
+        with tempfile.TemporaryDirectory(prefix="gallery-pgo-") as tmp:
+            if compiler_family(compiler_id) == "clang":
+                path = os.path.join(tmp, "cell.profdata")
+                flags = [f"-fprofile-use={path}"]
+            else:
+                path = os.path.join(tmp, "cell--.gcda")
+                flags = ["-fprofile-use", "-dumpbase", os.path.join(tmp, "cell" if link else "cell--")]
+                if link:
+                    flags.append("-Wno-coverage-mismatch")  # the driver's own main() differs from the training driver's
+            with open(path, "wb") as f:
+                f.write(profile)
+            yield flags
+
+    def _link_program(
+        self, tc: LocalToolchain, source: str, files: Sequence[Dict[str, str]], user_arguments: str,
+        lang: Optional[str], intel_syntax: bool, demangle: bool, extra: Sequence[str] = (),
+    ) -> tuple:
+        """(code, listing, stderr) of a program linked from *source* and *files*, and its disassembly."""
+        with tempfile.TemporaryDirectory(prefix="gallery-link-") as tmp:
+            inputs = [example_name(lang or tc.lang)]
+            with open(os.path.join(tmp, inputs[0]), "w", encoding="utf-8") as f:
+                f.write(source)
+            for extra_file in files:
+                name = os.path.normpath(extra_file["filename"])
+                if os.path.isabs(name) or name.startswith(".."):
+                    return -1, [], f"extra file {extra_file['filename']!r} is outside the example"
+                os.makedirs(os.path.join(tmp, os.path.dirname(name)), exist_ok=True)
+                with open(os.path.join(tmp, name), "w", encoding="utf-8") as f:
+                    f.write(extra_file["contents"])
+                if not name.endswith(HEADER_SUFFIXES):
+                    inputs.append(name)  # headers are only there to be included
+            cmd = self.link_line(tc, user_arguments, lang, inputs, "a.out", extra)
+            try:
+                proc = subprocess.run(cmd, capture_output=True, text=True, timeout=self.timeout_s, cwd=tmp)
+            except subprocess.TimeoutExpired:
+                return -1, [], f"Link timed out after {self.timeout_s:.0f}s"
+            if proc.returncode != 0:
+                return proc.returncode, [], proc.stderr
+            dump = self.objdump_line(tc, os.path.join(tmp, "a.out"), intel_syntax, demangle, sections=[".text"])
+            try:
+                dis = subprocess.run(dump, capture_output=True, text=True, timeout=self.timeout_s)
+            except (OSError, subprocess.TimeoutExpired) as e:
+                return -1, [], f"{dump[0]} failed: {e}"
+            if dis.returncode != 0:
+                return dis.returncode, [], proc.stderr + dis.stderr
+            return 0, parse_objdump(dis.stdout), proc.stderr
+
+    def _demangle(self, tc: LocalToolchain, text: str) -> str:
+        if not shutil.which(tc.demangle_command[0]):
+            return text
+        try:
+            proc = subprocess.run(tc.demangle_command, input=text, capture_output=True, text=True, timeout=self.timeout_s)
+        except (OSError, subprocess.TimeoutExpired):
+            return text
+        return proc.stdout if proc.returncode == 0 else text
+
+    def compile_to_asm(
+        self,
+        compiler_id: str,
+        source: str,
+        user_arguments: str = "-O2",
+        lang: Optional[str] = None,
+        intel_syntax: bool = True,
+        demangle: bool = True,
+        labels: bool = True,
+        directives: bool = True,
+        comment_only: bool = True,
+        trim: bool = False,
+        library_code: bool = False,
+        bypass_cache: int = 0,
+        binary_object: bool = False,
+        profile: Optional[bytes] = None,
+        extra_files: Optional[List[Dict[str, str]]] = None,
+        **_: Any,
+    ) -> CompileResult:
+        """Compile *source* (linked with *extra_files*, if any) with the toolchain mapped to *compiler_id*; CE-shaped result."""
+        tc = self.toolchains.get(compiler_id)
+        if tc is None:
+            raise KeyError(f"No local toolchain configured for compiler '{compiler_id}'")
+        linked = bool(extra_files)
+        binary = binary_object or linked
+        # The command as recorded and cached; the one that runs names the profile's scratch copy.
+        shown = ["-fprofile-use"] if profile else []
+        if linked:
+            inputs = [example_name(lang or tc.lang)] + [f["filename"] for f in extra_files or []]
+            cmd = self.link_line(tc, user_arguments, lang, inputs, "a.out", extra=shown)
+        else:
+            cmd = self.command_line(tc, user_arguments, lang, intel_syntax, obj="cell.o" if binary_object else None, extra=shown)
+
+        payload: Dict[str, Any] = {
+            "source": source,
+            "options": {
+                "userArguments": user_arguments,
+                "filters": {
+                    "commentOnly": bool(comment_only),
+                    "demangle": bool(demangle),
+                    "directives": bool(directives),
+                    "intel": bool(intel_syntax),
+                    "labels": bool(labels),
+                    "trim": bool(trim),
+                    "binaryObject": bool(binary),
+                },
+            },
+            "local": {"command": cmd, "version": self.version(compiler_id)},
+            "bypassCache": int(bypass_cache),
+        }
+        if lang:
+            payload["lang"] = lang
+        if linked:
+            payload["files"] = extra_files
+        if binary:
+            sections = [".text"] if linked else []
+            payload["local"]["objdump"] = self.objdump_line(tc, "cell.o", intel_syntax, demangle, sections)[:-1]
+        if profile is not None:
+            payload["local"]["profile"] = hashlib.sha256(profile).hexdigest()
+
+        cache_key = CompilerExplorerClient._cache_key("compile-local", payload, compiler_id)
+        cached = self.cache.get("compile", cache_key) if self.cache and not bypass_cache else None
+        if cached is not None:
+            resp = cached["response"]
+            return CompileResult(request=payload, response=resp, asm_text=asm_text_from_response(resp), cached=True)
+
+        start = time.perf_counter()
+        with self._profile_use(compiler_id, profile, link=linked) as use:
+            if linked:
+                code, listing, stderr = self._link_program(
+                    tc, source, extra_files or [], user_arguments, lang, intel_syntax, demangle, use
+                )
+            elif binary_object:
+                code, listing, stderr = self._compile_object(tc, source, user_arguments, lang, intel_syntax, demangle, use)
+            else:
+                run_cmd = self.command_line(tc, user_arguments, lang, intel_syntax, extra=use) if profile else cmd
+                try:
+                    proc = subprocess.run(run_cmd, input=source, capture_output=True, text=True, timeout=self.timeout_s)
+                    code, stdout, stderr = proc.returncode, proc.stdout, proc.stderr
+                except subprocess.TimeoutExpired:
+                    code, stdout, stderr = -1, "", f"Compilation timed out after {self.timeout_s:.0f}s"
+        exec_ms = int((time.perf_counter() - start) * 1000)
+
+        if binary:
+            asm_lines = [] if code == 0 else ["<Compilation failed>"]
+        elif code == 0:
+            asm = stdout
+            if demangle:
+                asm = self._demangle(tc, asm)
+            asm_lines = filter_asm(asm, directives=directives, labels=labels, comment_only=comment_only)
+            if trim:
+                asm_lines = [re.sub(r"\s+", " ", ln).rstrip() for ln in asm_lines]
+        else:
+            asm_lines = ["<Compilation failed>"]
+
+        resp: Dict[str, Any] = {
+            "code": code,
+            "asm": listing if binary and code == 0 else [{"text": ln} for ln in asm_lines],
+            "stdout": [],
+            "stderr": [{"text": ln} for ln in stderr.splitlines()],
+            "execTime": exec_ms,
+            "compilationOptions": cmd[len(tc.command):],
+            "okToCache": code == 0,
+        }
+        if tc.instruction_set:
+            resp["instructionSet"] = tc.instruction_set
+        if self.cache and code == 0:
+            self.cache.put("compile", cache_key, payload, resp)
+        return CompileResult(request=payload, response=resp, asm_text=asm_text_from_response(resp))
+
+    def can_execute(self, compiler_id: str) -> bool:
+        return self.handles(compiler_id) and self.toolchains[compiler_id].runnable()
+
+    def execute(
+        self,
+        compiler_id: str,
+        source: str,
+        user_arguments: str = "-O2",
+        lang: Optional[str] = None,
+        timeout_s: Optional[float] = None,
+        profile: Optional[bytes] = None,
+    ) -> ExecResult:
+        """Build *source* into a program with the mapped toolchain and run it, with *profile* if given."""
+        with self._profile_use(compiler_id, profile, link=True) as use:
+            res = self._build_and_run(compiler_id, source, user_arguments, lang, timeout_s, extra=use)
+        if profile is not None:
+            res.request["local"]["profile"] = hashlib.sha256(profile).hexdigest()
+        return res
+
+    def train_profile(
+        self,
+        compiler_id: str,
+        source: str,
+        user_arguments: str = "-O2",
+        lang: Optional[str] = None,
+        timeout_s: Optional[float] = None,
+    ) -> Tuple[ExecResult, Optional[bytes]]:
+        """
+        Build *source* with profiling instrumentation, run it and return the
+        run and the profile it wrote (None if the build, the run or the
+        merge failed; the ExecResult says why).
+        """
+        tc = self.toolchains.get(compiler_id)
+        if tc is None:
+            raise KeyError(f"No local toolchain configured for compiler '{compiler_id}'")
+        family = compiler_family(compiler_id)
+        if family not in TRAIN_FLAGS:
+            raise KeyError(f"No profile-guided optimization support for compiler '{compiler_id}'")
+        with tempfile.TemporaryDirectory(prefix="gallery-train-") as tmp:
+            extra = shlex.split(TRAIN_FLAGS[family])
+            env = None
+            if family == "clang":
+                raw = os.path.join(tmp, "cell.profraw")
+                env = {**os.environ, "LLVM_PROFILE_FILE": raw}
+            else:
+                extra += ["-dumpbase", os.path.join(tmp, "cell")]  # the run writes cell--.gcda
+            res = self._build_and_run(compiler_id, source, user_arguments, lang, timeout_s, extra=extra, env=env)
+            if res.code != 0:
+                return res, None
+            if family == "clang":
+                merged = os.path.join(tmp, "cell.profdata")
+                merge = [default_profdata(tc.command), "merge", "-o", merged, raw]
+                try:
+                    proc = subprocess.run(merge, capture_output=True, text=True, timeout=self.timeout_s)
+                except (OSError, subprocess.TimeoutExpired) as e:
+                    return ExecResult(res.request, res.response, -1, res.stdout, f"{merge[0]} failed: {e}", runner="local"), None
+                if proc.returncode != 0:
+                    return ExecResult(res.request, res.response, proc.returncode, res.stdout, proc.stderr, runner="local"), None
+                path = merged
+            else:
+                path = os.path.join(tmp, "cell--.gcda")
+            if not os.path.exists(path):
+                return ExecResult(res.request, res.response, -1, res.stdout, "the training run wrote no profile", runner="local"), None
+            with open(path, "rb") as f:
+                return res, f.read()
+
+    def _build_and_run(
+        self,
+        compiler_id: str,
+        source: str,
+        user_arguments: str,
+        lang: Optional[str],
+        timeout_s: Optional[float],
+        extra: Sequence[str] = (),
+        env: Optional[Dict[str, str]] = None,
+    ) -> ExecResult:
+        tc = self.toolchains.get(compiler_id)
+        if tc is None:
+            raise KeyError(f"No local toolchain configured for compiler '{compiler_id}'")
+        timeout = timeout_s or self.timeout_s
+        with tempfile.TemporaryDirectory(prefix="gallery-run-") as tmp:
+            exe = os.path.join(tmp, "a.out")
+            build = list(tc.command) + shlex.split(tc.args) + shlex.split(user_arguments) + list(extra)
+            build += ["-o", exe, "-x", lang or tc.lang, "-"]
+            payload: Dict[str, Any] = {
+                "source": source,
+                "options": {"userArguments": user_arguments},
+                "local": {"command": build, "version": self.version(compiler_id)},
+            }
+            try:
+                proc = subprocess.run(build, input=source, capture_output=True, text=True, timeout=self.timeout_s)
+            except subprocess.TimeoutExpired:
+                return ExecResult(payload, {"buildResult": {"code": -1}}, -1, "", "Build timed out", runner="local")
+            if proc.returncode != 0:
+                resp = {"didExecute": False, "buildResult": {"code": proc.returncode, "stderr": proc.stderr}}
+                return ExecResult(payload, resp, proc.returncode, "", proc.stderr, runner="local")
+            with self._run_lock:
+                try:
+                    run = subprocess.run([exe], capture_output=True, text=True, timeout=timeout, env=env)
+                    code, stdout, stderr = run.returncode, run.stdout, run.stderr
+                except subprocess.TimeoutExpired:
+                    code, stdout, stderr = -1, "", f"Run timed out after {timeout:.0f}s"
+        resp = {"didExecute": True, "code": code, "stdout": stdout, "stderr": stderr}
+        return ExecResult(payload, resp, code, stdout, stderr, runner="local")
+
+    def compile_many(self, compiler_id: str, source: str, flag_sets: Sequence[str], **kwargs: Any) -> List[CompileResult]:
+        """One compile per distinct flag set, in order; repeated flag sets share a result."""
+        results: Dict[str, CompileResult] = {}
+        for flags in flag_sets:
+            if flags not in results:
+                results[flags] = self.compile_to_asm(compiler_id, source, user_arguments=flags, **kwargs)
+        return [results[flags] for flags in flag_sets]
+
+
+class RoutingCompiler:
+    """Send each compiler ID to the local backend if it handles it, else to CE."""
+
+    def __init__(self, local: LocalCompiler, remote: CompilerExplorerClient) -> None:
+        self.local = local
+        self.remote = remote
+
+    def compile_to_asm(self, compiler_id: str, source: str, **kwargs: Any) -> CompileResult:
+        backend = self.local if self.local.handles(compiler_id) else self.remote
+        return backend.compile_to_asm(compiler_id=compiler_id, source=source, **kwargs)
+
+    def compile_many(self, compiler_id: str, source: str, flag_sets: Sequence[str], **kwargs: Any) -> List[CompileResult]:
+        backend = self.local if self.local.handles(compiler_id) else self.remote
+        return backend.compile_many(compiler_id=compiler_id, source=source, flag_sets=flag_sets, **kwargs)
+
+    def execute(self, compiler_id: str, source: str, **kwargs: Any) -> ExecResult:
+        # A toolchain that cannot run here (cross compilers) runs on CE instead.
+        backend = self.local if self.local.can_execute(compiler_id) else self.remote
+        return backend.execute(compiler_id=compiler_id, source=source, **kwargs)
+
+    def train_profile(self, compiler_id: str, source: str, **kwargs: Any) -> Tuple[ExecResult, Optional[bytes]]:
+        # Only a local run leaves a profile behind to compile with.
+        return self.local.train_profile(compiler_id=compiler_id, source=source, **kwargs)
+
+
+__all__ = [
+    "LocalCompiler",
+    "LocalToolchain",
+    "RoutingCompiler",
+    "filter_asm",
+    "load_local_toolchains",
+]
@@ -0,0 +1,166 @@
+# Copyright (c) 2026 Larry H <l.gr [at] dartmouth [dot] edu>
+# SPDX-License-Identifier: AGPL-3.0-or-later
+#
+# Compiler Optimization Gallery
+# Developed for COSC-69.16: Basics of Reverse Engineering
+# Dartmouth College, Winter 2026
+
+"""
+ce_manifest.py
+
+An index of every cell in an output tree, so build_book.py can find the
+cells without walking the tree and probing each one for its source copy.
+ce_batch.py keeps it at ``<out>/manifest.json``, written through the output
+store like any other entry (so a packed store holds it too):
+
+    {"version": 1,
+     "cells": {"cg152/O2/loops/unrollme-1": {
+         "files": [".asm", ".compile.request.json", ..., ".src.c"],
+         "source": "<sha256 of the source copy>",
+         "mtime": 1767225600.0}}}
+
+``files`` are the suffixes the cell has, ``mtime`` the newest of its
+``.asm`` and ``.explain.md`` (of ``.metrics.json`` for a sweep-defines
+variant, ``<stem>@N=1024``). The source digest is the same for every
+compiler and scenario of a source, so build_book.py reads each source text
+once per render process instead of once per page.
+
+A run only re-indexes the cells it compiled, explained or removed
+(touch()). The first save into a tree without a manifest indexes every
+cell, with one walk. Only depends on the standard library.
+"""
+
+from __future__ import annotations
+
+import hashlib
+import json
+import threading
+from typing import Any, Dict, Iterable, Optional, Set
+
+from ce_incremental import CELL_OUTPUT_SUFFIXES, OPTIONAL_CELL_OUTPUT_SUFFIXES
+from ce_store import OutputStore
+
+MANIFEST_NAME = "manifest.json"
+MANIFEST_VERSION = 1
+
+_SUFFIXES = CELL_OUTPUT_SUFFIXES + OPTIONAL_CELL_OUTPUT_SUFFIXES
+
+
+def _split_key(key: str) -> Optional[tuple]:
+    """(cell key, suffix) of a store key that is a cell output, else None."""
+    dir_, _, name = key.rpartition("/")
+    if not dir_:
+        return None  # top-level files
+    for sfx in _SUFFIXES:
+        if name.endswith(sfx) and len(name) > len(sfx):
+            return f"{dir_}/{name[:-len(sfx)]}", sfx
+    stem, sep, ext = name.rpartition(".src.")
+    if sep and stem and ext:
+        return f"{dir_}/{stem}", f".src.{ext}"
+    return None
+
+
+def _entry(outputs: OutputStore, cell_key: str, files: Iterable[str]) -> Optional[Dict[str, Any]]:
+    files = sorted(set(files))
+    if not files:
+        return None
+    entry: Dict[str, Any] = {"files": files}
+    source = next((sfx for sfx in files if sfx.startswith(".src.")), None)
+    if source is not None:
+        text = outputs.read_text(cell_key + source)
+        if text is not None:
+            entry["source"] = hashlib.sha256(text.encode("utf-8")).hexdigest()
+    stamped = (".asm", ".explain.md") if ".asm" in files else (".metrics.json",)
+    entry["mtime"] = max(outputs.mtime(cell_key + sfx) for sfx in stamped)
+    return entry
+
+
+def cell_entry(outputs: OutputStore, cell_key: str) -> Optional[Dict[str, Any]]:
+    """A cell's manifest entry from what the store holds now; None if it has no outputs."""
+    files = [sfx for sfx in _SUFFIXES if outputs.size(cell_key + sfx) is not None]
+    head = cell_key.rpartition("/")[0]
+    for key in outputs.iter_files(prefix=f"{cell_key}.src."):
+        if key.rpartition("/")[0] == head:
+            files.append(key[len(cell_key):])
+    return _entry(outputs, cell_key, files)
+
+
+def scan_cells(outputs: OutputStore) -> Dict[str, Dict[str, Any]]:
+    """Entries of every cell in the store, from one walk."""
+    found: Dict[str, Set[str]] = {}
+    for key in outputs.iter_files():
+        split = _split_key(key)
+        if split is not None:
+            found.setdefault(split[0], set()).add(split[1])
+    cells = {}
+    for cell_key, files in sorted(found.items()):
+        entry = _entry(outputs, cell_key, files)
+        if entry is not None:
+            cells[cell_key] = entry
+    return cells
+
+
+def read_manifest(outputs: OutputStore) -> Optional[Dict[str, Dict[str, Any]]]:
+    """The cells of the store's manifest, or None if it has none (or one of another version)."""
+    text = outputs.read_text(MANIFEST_NAME)
+    if text is None:
+        return None
+    try:
+        data = json.loads(text)
+    except ValueError:
+        return None
+    if not isinstance(data, dict) or data.get("version") != MANIFEST_VERSION or not isinstance(data.get("cells"), dict):
+        return None
+    return data["cells"]
+
+
+class OutputManifest:
+    """The manifest of one ce_batch.py run: loaded at start, touched per cell, saved at the end."""
+
+    def __init__(self, outputs: OutputStore) -> None:
+        self.outputs = outputs
+        self._cells: Optional[Dict[str, Dict[str, Any]]] = read_manifest(outputs)
+        self._touched: Set[str] = set()
+        self._lock = threading.Lock()
+
+    def touch(self, cell_key: str) -> None:
+        """Re-index *cell_key* (and its sweep-defines variants) on save()."""
+        with self._lock:
+            self._touched.add(cell_key)
+
+    def save(self) -> int:
+        """Write the manifest. Returns the number of cells it lists."""
+        with self._lock:
+            touched, self._touched = self._touched, set()
+            if self._cells is None:
+                cells = scan_cells(self.outputs)
+            else:
+                cells = dict(self._cells)
+                variants = {k for k in cells if "@" in k.rpartition("/")[2] and k.partition("@")[0] in touched}
+                for cell_key in touched | variants:
+                    entry = cell_entry(self.outputs, cell_key)
+                    if entry is None:
+                        cells.pop(cell_key, None)
+                    else:
+                        cells[cell_key] = entry
+                # New variants of touched cells.
+                for cell_key in touched:
+                    for key in self.outputs.iter_files(".metrics.json", prefix=cell_key + "@"):
+                        variant = key[:-len(".metrics.json")]
+                        if "/" not in variant[len(cell_key):] and variant not in cells:
+                            entry = cell_entry(self.outputs, variant)
+                            if entry is not None:
+                                cells[variant] = entry
+            self._cells = cells
+            self.outputs.write_json(MANIFEST_NAME, {"version": MANIFEST_VERSION, "cells": dict(sorted(cells.items()))})
+            return len(cells)
+
+
+__all__ = [
+    "MANIFEST_NAME",
+    "MANIFEST_VERSION",
+    "OutputManifest",
+    "cell_entry",
+    "read_manifest",
+    "scan_cells",
+]
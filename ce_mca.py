@@ -0,0 +1,299 @@
+# Copyright (c) 2026 Larry H <l.gr [at] dartmouth [dot] edu>
+# SPDX-License-Identifier: AGPL-3.0-or-later
+#
+# Compiler Optimization Gallery
+# Developed for COSC-69.16: Basics of Reverse Engineering
+# Dartmouth College, Winter 2026
+
+"""
+ce_mca.py
+
+Static throughput estimates with llvm-mca. A source names its hot
+functions in its ``@gallery-hints`` block:
+
+    /* @gallery-hints
+     *   throughput: add_arrays, sum_array     (or: yes, for every function)
+     *   throughput-cpus: skylake, znver3      (optional; default per ISA)
+     */
+
+and every compiled cell gets ``<stem>.mca.json``. For each function,
+hot_region() picks the hot loop of the stored assembly: a loop is the
+span from a local label to a later instruction that refers back to it,
+and the largest loop with no other loop inside wins (the vector loop, not
+its scalar remainder). A function without a loop is analysed whole. The region goes to
+llvm-mca once per CPU, simulated for 100 iterations. parse_mca() reads
+the report:
+
+- cycles per iteration (total cycles / iterations) and IPC
+- block reciprocal throughput, the bound from resource pressure alone
+- resource pressure per iteration, per named resource (ports, pipes)
+- the bottleneck, from ``-bottleneck-analysis``: the most loaded resource
+  when resource pressure dominates, else register or memory dependencies
+
+Nothing runs on the target, so cross compilers get estimates too:
+MIPS (LLVM's generic MIPS32/MIPS64 model), RISC-V, POWER, ARM and x86.
+LLVM has no scheduling model for SPARC or AVR, and those cells are
+recorded as unsupported. Binary-object listings (objdump branch targets, see
+ce_local.py) get synthetic labels so their loops are found too.
+
+Compiler Explorer's llvm-mca tool runs on a cell's whole listing, as one
+block, so the estimates use a local llvm-mca (``llvm-mca`` or the newest
+``llvm-mca-N`` on PATH). Without one the record carries an error and the
+book page says how to add them. Only depends on the standard library.
+"""
+
+from __future__ import annotations
+
+import glob
+import os
+import re
+import shutil
+import subprocess
+from typing import Any, Dict, List, Optional, Sequence, Tuple
+
+from ce_metrics import split_functions
+
+MCA_SUFFIX = ".mca.json"
+MCA_ITERATIONS = 100
+
+# Target triple and default CPUs (with a scheduling model) per instruction set.
+_TRIPLES = {
+    "amd64": "x86_64-unknown-linux-gnu", "x86": "i686-unknown-linux-gnu",
+    "aarch64": "aarch64-linux-gnu", "arm32": "armv7a-none-eabi",
+    "mips": "mips-linux-gnu", "mips64": "mips64-linux-gnuabi64",
+    "riscv32": "riscv32-unknown-elf", "riscv64": "riscv64-unknown-linux-gnu",
+    "powerpc": "powerpc-linux-gnu", "powerpc64": "powerpc64le-linux-gnu",
+}
+DEFAULT_CPUS: Dict[str, Tuple[str, ...]] = {
+    "amd64": ("skylake", "znver3"), "x86": ("skylake",),
+    "aarch64": ("cortex-a72", "neoverse-n1"), "arm32": ("cortex-a9",),
+    "mips": ("mips32r2",), "mips64": ("mips64r2",),
+    "riscv32": ("sifive-e76",), "riscv64": ("sifive-u74",),
+    "powerpc": ("pwr9",), "powerpc64": ("pwr9",),
+}
+
+_LABEL_RE = re.compile(r"^([A-Za-z_.$@?][\w.$@?]*):$")
+_TOKEN_RE = re.compile(r"[A-Za-z_.$@?][\w.$@?]*")
+_OBJDUMP_TARGET_RE = re.compile(r"\b([0-9a-fA-F]+) <[^<>]+>")
+
+
+def find_llvm_mca() -> Optional[str]:
+    """``llvm-mca`` on PATH, else the newest versioned ``llvm-mca-N``."""
+    found = shutil.which("llvm-mca")
+    if found:
+        return found
+    versioned = []
+    for d in os.environ.get("PATH", "").split(os.pathsep):
+        for path in glob.glob(os.path.join(d, "llvm-mca-[0-9]*")):
+            m = re.search(r"-(\d+)$", path)
+            if m and os.access(path, os.X_OK):
+                versioned.append((int(m.group(1)), path))
+    return max(versioned)[1] if versioned else None
+
+
+def parse_functions(spec: str) -> Optional[List[str]]:
+    """Function names of a ``throughput`` hint; None for ``yes`` (every function)."""
+    if spec.strip().lower() in ("yes", "true", "all"):
+        return None
+    return [name.strip() for name in spec.split(",") if name.strip()]
+
+
+def listing_lines(asm: Sequence[Any]) -> List[str]:
+    """
+    Text lines of a CE ``asm`` list. Entries with an ``address`` (a
+    disassembled object) get a ``.Lmca_<addr>:`` label before every branch
+    target, and ``40 <h+0x10>`` operands become that label.
+    """
+    entries = [x if isinstance(x, dict) else {"text": str(x)} for x in asm]
+    if not any("address" in x for x in entries):
+        return [str(x.get("text", "")) for x in entries]
+    targets = {int(m.group(1), 16) for x in entries for m in _OBJDUMP_TARGET_RE.finditer(str(x.get("text", "")))}
+    lines = []
+    for x in entries:
+        text = str(x.get("text", ""))
+        if x.get("address") in targets:
+            lines.append(f".Lmca_{x['address']:x}:")
+        lines.append(_OBJDUMP_TARGET_RE.sub(lambda m: f".Lmca_{int(m.group(1), 16):x}", text))
+    return lines
+
+
+def hot_region(body: Sequence[str]) -> Tuple[str, List[str]]:
+    """
+    ("loop", lines) for the hot loop of a function body (split_functions()
+    lines), or ("function", body) when no instruction refers back to an
+    earlier label. The hot loop is the largest innermost one: a vector
+    loop rather than its scalar remainder loop.
+    """
+    labels: Dict[str, int] = {}
+    loops: List[Tuple[int, int]] = []
+    for i, line in enumerate(body):
+        label = _LABEL_RE.match(line)
+        if label:
+            labels[label.group(1)] = i
+            continue
+        parts = line.split(None, 1)
+        for token in _TOKEN_RE.findall(parts[1] if len(parts) > 1 else ""):
+            if token in labels:
+                loops.append((labels[token], i))
+    innermost = [
+        (start, end) for start, end in loops
+        if not any((s, e) != (start, end) and start <= s and e <= end for s, e in loops)
+    ]
+    if not innermost:
+        return "function", list(body)
+    start, end = max(innermost, key=lambda span: (span[1] - span[0], -span[0]))
+    return "loop", list(body[start:end + 1])
+
+
+def mca_source(lines: Sequence[str], instruction_set: str) -> str:
+    """The region as llvm-mc input: Intel-syntax x86 gets its directive, GNU ``FLAT:`` is dropped."""
+    text = "\n".join(line.strip() for line in lines)
+    if instruction_set in ("amd64", "x86") and "%" not in text:
+        text = ".intel_syntax noprefix\n" + re.sub(r"\bFLAT:", "", text)
+    return text + "\n"
+
+
+def _number(pattern: str, text: str) -> Optional[float]:
+    m = re.search(pattern + r":\s+([\d.]+)", text)
+    return float(m.group(1)) if m else None
+
+
+def parse_mca(text: str) -> Dict[str, Any]:
+    """Summary, resource pressure and bottleneck of one llvm-mca report (see the module docstring)."""
+    iterations, cycles = _number("Iterations", text), _number("Total Cycles", text)
+    result: Dict[str, Any] = {
+        "cycles_per_iteration": cycles / iterations if cycles is not None and iterations else None,
+        "block_rthroughput": _number("Block RThroughput", text),
+        "ipc": _number("IPC", text),
+        "uops_per_cycle": _number("uOps Per Cycle", text),
+        "dispatch_width": _number("Dispatch Width", text),
+    }
+
+    # "[2]   - SKLPort0" under "Resources:", then one pressure row per iteration.
+    names: Dict[str, str] = {}
+    section = re.search(r"^Resources:\n(.*?)(?:\n\s*\n|\Z)", text, re.M | re.S)
+    if section:
+        for m in re.finditer(r"^\[([\d.]+)\]\s+-\s+(\S+)", section.group(1), re.M):
+            names[m.group(1)] = m.group(2)
+    pressure: Dict[str, float] = {}
+    rows = re.search(r"^Resource pressure per iteration:\n(.*)\n(.*)$", text, re.M)
+    if rows:
+        for index, value in zip(re.findall(r"\[([\d.]+)\]", rows.group(1)), rows.group(2).split()):
+            if value != "-" and index in names:
+                pressure[names[index]] = float(value)
+    result["pressure"] = pressure
+
+    # "Resource Pressure [ 47.17% ]" / "Data Dependencies: [ 0.94% ]", each with "- name [ x% ]" items.
+    bottleneck = None
+    analysis = re.search(r"^Throughput Bottlenecks:[ \t]*\n(.*?)(?:\n\s*\n|\Z)", text, re.M | re.S)
+    if analysis:
+        groups: Dict[str, Tuple[float, List[Tuple[float, str]]]] = {}
+        current = None
+        for line in analysis.group(1).splitlines():
+            m = re.match(r"^\s*(-\s+)?(.*?):?\s+\[\s*([\d.]+)%\s*\]", line)
+            if not m:
+                continue
+            if m.group(1) and current is not None:
+                groups[current][1].append((float(m.group(3)), m.group(2).strip()))
+            elif not m.group(1):
+                current = m.group(2).strip().lower()
+                groups[current] = (float(m.group(3)), [])
+        if groups:
+            group, (share, items) = max(groups.items(), key=lambda g: g[1][0])
+            if share > 0 and items:
+                _, bottleneck = max(items)
+                if group != "resource pressure":
+                    bottleneck = bottleneck.lower()  # "register dependencies"
+    elif pressure and "No resource or data dependency bottlenecks" not in text:
+        bottleneck = max(pressure.items(), key=lambda kv: kv[1])[0]
+    result["bottleneck"] = bottleneck
+    return result
+
+
+def _run(command: Sequence[str], source: str, triple: str, cpu: str) -> Dict[str, Any]:
+    cmd = list(command) + [
+        f"-mtriple={triple}", f"-mcpu={cpu}", f"-iterations={MCA_ITERATIONS}", "-bottleneck-analysis",
+    ]
+    try:
+        proc = subprocess.run(cmd, input=source, capture_output=True, text=True, timeout=60)
+    except (OSError, subprocess.TimeoutExpired) as e:
+        return {"cpu": cpu, "error": str(e)}
+    if proc.returncode != 0:
+        lines = [ln for ln in proc.stderr.splitlines() if ln.strip()]
+        return {"cpu": cpu, "error": lines[0] if lines else f"llvm-mca exited with {proc.returncode}"}
+    return {"cpu": cpu, **parse_mca(proc.stdout)}
+
+
+def mca_version(command: Sequence[str]) -> Optional[str]:
+    try:
+        out = subprocess.run(list(command) + ["--version"], capture_output=True, text=True, timeout=10).stdout
+    except (OSError, subprocess.TimeoutExpired):
+        return None
+    m = re.search(r"LLVM version (\S+)", out)
+    return m.group(1) if m else None
+
+
+def _find_function(functions: Dict[str, List[str]], name: str) -> Optional[List[str]]:
+    for key in (name, f"_{name}"):
+        if key in functions:
+            return functions[key]
+    return None
+
+
+def mca_record(
+    compiler_id: str,
+    instruction_set: str,
+    response: Dict[str, Any],
+    spec: str,
+    cpus: Optional[Sequence[str]] = None,
+    command: Optional[Sequence[str]] = None,
+) -> Dict[str, Any]:
+    """The ``.mca.json`` record for one compile response and a ``throughput`` hint value."""
+    cpus = list(cpus or DEFAULT_CPUS.get(instruction_set, ()))
+    record: Dict[str, Any] = {
+        "compiler": compiler_id,
+        "instruction_set": instruction_set,
+        "cpus": cpus,
+        "iterations": MCA_ITERATIONS,
+        "functions": [],
+    }
+    triple = _TRIPLES.get(instruction_set)
+    record["supported"] = triple is not None and bool(cpus)
+    if command is None:
+        found = find_llvm_mca()
+        command = [found] if found else None
+    if command is None and record["supported"]:
+        record["error"] = "llvm-mca not found on PATH"
+    elif command is not None:
+        record["tool"] = f"llvm-mca {mca_version(command) or ''}".strip()
+
+    functions = split_functions(listing_lines(response.get("asm") or []))
+    functions.pop("<toplevel>", None)
+    wanted = parse_functions(spec)
+    for name in wanted if wanted is not None else list(functions):
+        body = _find_function(functions, name)
+        item: Dict[str, Any] = {"function": name}
+        if body is None:
+            item["scope"] = "missing"  # inlined everywhere, or excluded by #if
+            record["functions"].append(item)
+            continue
+        scope, region = hot_region(body)
+        item["scope"] = scope
+        item["instructions"] = sum(1 for line in region if not _LABEL_RE.match(line))
+        if record["supported"] and command is not None:
+            source = mca_source(region, instruction_set)
+            item["estimates"] = [_run(command, source, triple, cpu) for cpu in cpus]
+        record["functions"].append(item)
+    return record
+
+
+__all__ = [
+    "DEFAULT_CPUS",
+    "MCA_ITERATIONS",
+    "MCA_SUFFIX",
+    "find_llvm_mca",
+    "hot_region",
+    "listing_lines",
+    "mca_record",
+    "parse_mca",
+]
@@ -0,0 +1,748 @@
+# Copyright (c) 2026 Larry H <l.gr [at] dartmouth [dot] edu>
+# SPDX-License-Identifier: AGPL-3.0-or-later
+#
+# Compiler Optimization Gallery
+# Developed for COSC-69.16: Basics of Reverse Engineering
+# Dartmouth College, Winter 2026
+
+"""
+ce_metrics.py
+
+Static cost metrics of a cell's assembly, per function:
+
+- instructions: instruction lines
+- bytes: code size (see below)
+- branches: jumps and conditional branches (calls and returns excluded)
+- memory_ops: instructions that load or store (x86: any memory operand)
+- calls: direct and indirect calls
+- simd: widest vector register class used by vector instructions (x86
+  xmm/ymm/zmm; for xmm only packed arithmetic and shuffles count, not
+  scalar SSE or moves; NEON neon-d/neon-q, SVE sve, RISC-V V rvv), or None
+
+Byte sizes count instruction bytes only (no alignment padding). They are
+exact when the compile response carries opcodes (CE's binary filters, or
+the local backend's objdump of the object file). A disassembled object
+also shows the padding the assembler inserted as nops; those count as
+``padding`` bytes of the function they follow, not as instructions.
+Otherwise fixed-width ISAs count 4 bytes per instruction (AVR
+2, or 4 for its two-word instructions), and x86 sizes come from an operand
+based length estimate (jumps to local labels are sized by label distance,
+as the assembler relaxes them); ``bytes_exact`` says which. Assembler pseudo
+instructions (e.g. MIPS ``li`` of a wide constant) count as one.
+
+Each function record also carries the ``hash`` of its instruction lines
+(function_hash), so tools can tell which functions of a cell changed
+between two compiles without re-reading both listings.
+
+Both GNU as listings and MSVC (MASM ``PROC``/``ENDP``) listings are
+understood. Only depends on the standard library, so build_book.py can use
+it too.
+
+Run as a script to (re)compute ``<stem>.metrics.json`` for every compiled
+cell of an existing output tree:
+
+    python3 ce_metrics.py output
+"""
+
+from __future__ import annotations
+
+import hashlib
+import json
+import re
+from dataclasses import asdict, dataclass
+from typing import Any, Dict, Iterable, List, Optional, Sequence, Tuple
+
+METRICS_SUFFIX = ".metrics.json"
+
+SIMD_RANK = {None: 0, "xmm": 1, "neon-d": 1, "ymm": 2, "neon-q": 2, "rvv": 2, "zmm": 3, "sve": 3}
+
+_FIXED_WIDTH = {
+    "aarch64": 4, "arm32": 4, "mips": 4, "mips64": 4, "sparc": 4, "sparc64": 4,
+    "riscv32": 4, "riscv64": 4, "powerpc": 4, "powerpc64": 4,
+}
+
+_GNU_LABEL_RE = re.compile(r"^([A-Za-z_.$@?][\w.$@?]*):")
+_LOCAL_LABEL_RE = re.compile(r"^(\.L|L\d|\$L|\.\$|\$LN)")
+_SECTION_OPEN_RE = re.compile(r"^\.(section|rodata|data|(p2|b)?align)\b")
+_DATA_DIRECTIVE_RE = re.compile(r"^\.(string|asciz?|byte|short|value|word|long|int|quad|octa|zero|float|double|single)\b")
+_MASM_PROC_RE = re.compile(r"^\s*(\S+)\s+PROC\b", re.IGNORECASE)
+_MASM_ENDP_RE = re.compile(r"^\s*(\S+)\s+ENDP\b", re.IGNORECASE)
+_MASM_SKIP_RE = re.compile(
+    r"^\s*(PUBLIC|EXTRN|INCLUDELIB|include|ORG|ALIGN|\w+\s+(SEGMENT|ENDS)\b|\w+\$\s*=|;)", re.IGNORECASE
+)
+_MASM_DATA_RE = re.compile(r"^\s*(\S+\s+)?(DB|DW|DD|DQ|BYTE|WORD|DWORD|QWORD)\b(?!\s+PTR\b)", re.IGNORECASE)
+_COMMENT_RE = re.compile(r"^\s*(#|//|;|@\s|!)")
+
+_X86_PREFIXES = {"lock", "rep", "repe", "repz", "repne", "repnz", "notrack", "bnd", "data16", "addr32",
+                 "cs", "ds", "es", "ss"}
+
+
+@dataclass
+class FunctionMetrics:
+    name: str
+    instructions: int = 0
+    bytes: int = 0
+    branches: int = 0
+    memory_ops: int = 0
+    calls: int = 0
+    simd: Optional[str] = None
+    padding: int = 0  # alignment nop bytes (object disassembly only)
+
+    def add(self, other: "FunctionMetrics") -> None:
+        self.instructions += other.instructions
+        self.bytes += other.bytes
+        self.padding += other.padding
+        self.branches += other.branches
+        self.memory_ops += other.memory_ops
+        self.calls += other.calls
+        self.simd = widest_simd(self.simd, other.simd)
+
+
+def widest_simd(a: Optional[str], b: Optional[str]) -> Optional[str]:
+    return a if SIMD_RANK.get(a, 0) >= SIMD_RANK.get(b, 0) else b
+
+
+def detect_instruction_set(compiler_id: str) -> str:
+    """Detect instruction set architecture from compiler ID."""
+    cid = compiler_id.lower()
+
+    if "avr" in cid:
+        return "avr"
+    if "arm64" in cid or "aarch64" in cid or "armv8" in cid:
+        return "aarch64"
+    if "arm" in cid:
+        return "arm32"
+    if "mips64" in cid:
+        return "mips64"
+    if "mips" in cid:
+        return "mips"
+    if "sparc64" in cid:
+        return "sparc64"
+    if "sparc" in cid:
+        return "sparc"
+    if "riscv64" in cid or "rv64" in cid:
+        return "riscv64"
+    if "riscv" in cid or "rv32" in cid:
+        return "riscv32"
+    if "powerpc64" in cid or "ppc64" in cid:
+        return "powerpc64"
+    if "powerpc" in cid or "ppc" in cid:
+        return "powerpc"
+    if "x86" in cid or "i386" in cid or "i686" in cid:
+        return "x86"
+    # Default to amd64 for most x86-64 compilers (gcc, clang, msvc, mingw)
+    return "amd64"
+
+
+# ---------------------------
+# Per-ISA classification
+# ---------------------------
+
+def _split(line: str) -> Tuple[str, str]:
+    """(mnemonic, operands), lower-cased mnemonic with x86 prefixes removed."""
+    parts = line.strip().split(None, 1)
+    mnem = parts[0].lower()
+    ops = parts[1] if len(parts) > 1 else ""
+    while mnem in _X86_PREFIXES and ops:
+        parts = ops.split(None, 1)
+        mnem = parts[0].lower()
+        ops = parts[1] if len(parts) > 1 else ""
+    # Strip trailing comments from the operands.
+    ops = re.split(r"\s(#|//|;|@)\s", " " + ops + " ", maxsplit=1)[0].strip()
+    return mnem, ops
+
+
+def _classify_x86(mnem: str, ops: str) -> Tuple[bool, bool, bool]:
+    """(branch, call, memory) for an x86 instruction."""
+    call = mnem.startswith("call")
+    branch = not call and (mnem.startswith("j") or mnem.startswith("loop"))
+    memory = "[" in ops or bool(re.search(r"(^|[\s,])-?[\w+.$]*\(%", ops)) or "PTR" in ops.upper()
+    if mnem.startswith("lea") or mnem.startswith("nop"):
+        memory = False
+    if mnem.startswith(("push", "pop")) or (mnem.startswith(("movs", "stos", "lods", "cmps", "scas")) and not ops):
+        memory = True
+    return branch, call, memory
+
+
+_X86_SCALAR_SSE_RE = re.compile(r"^(movd|movq|cvtt?s[sd]2\w*|cvtsi2\w*|u?comis[sd]|[a-oq-z]\w*s[sd])$")
+
+
+def _simd_x86(mnem: str, ops: str) -> Optional[str]:
+    low = ops.lower()
+    if "zmm" in low:
+        return "zmm"
+    if "ymm" in low:
+        return "ymm"
+    if "xmm" in low:
+        # Scalar SSE/AVX (addss, vmulsd, cvtsi2sd, ...), register moves and
+        # zeroing idioms use xmm registers in plain scalar code too.
+        base = mnem[1:] if mnem.startswith("v") else mnem
+        if _X86_SCALAR_SSE_RE.match(base) or base.startswith("mov"):
+            return None
+        regs = [r.strip() for r in low.split(",")]
+        if base in ("pxor", "xorps", "xorpd") and len(set(regs)) == 1:
+            return None
+        return "xmm"
+    return None
+
+
+_RISC_CALLS = {
+    "aarch64": {"bl", "blr"},
+    "arm32": {"bl", "blx"},
+    "mips": {"jal", "jalr", "bal", "jalx"},
+    "sparc": {"call"},
+    "riscv": {"call", "jal", "jalr"},
+    "powerpc": {"bl", "bla", "bctrl", "blrl"},
+    "avr": {"call", "rcall", "icall", "eicall"},
+}
+_RISC_RETURNS = {
+    "aarch64": {"ret"},
+    "arm32": set(),
+    "mips": set(),
+    "sparc": {"ret", "retl", "return"},
+    "riscv": {"ret"},
+    "powerpc": {"blr"},
+    "avr": {"ret", "reti"},
+}
+_ARM_CONDS = "eq|ne|cs|hs|cc|lo|mi|pl|vs|vc|hi|ls|ge|lt|gt|le|al"
+
+
+def _family(isa: str) -> str:
+    for fam in ("aarch64", "arm", "mips", "sparc", "riscv", "powerpc", "avr"):
+        if isa.startswith(fam):
+            return "arm32" if fam == "arm" else fam
+    return isa
+
+
+def _classify_risc(fam: str, mnem: str, ops: str) -> Tuple[bool, bool, bool]:
+    calls, rets = _RISC_CALLS.get(fam, set()), _RISC_RETURNS.get(fam, set())
+    base = mnem.split(".")[0]
+    ops_low = ops.lower()
+    if fam == "riscv" and base in ("jal", "jalr"):
+        # "jal ra, f" / "jal f" are calls; "jal zero, x" and "jalr zero, ..." are jumps.
+        call = not ops_low.startswith(("zero", "x0"))
+        return not call, call, False
+    if fam == "mips" and base == "jr":
+        return "$31" not in ops and "$ra" not in ops_low, False, False
+    if fam == "arm32" and base in ("bx", "bxeq", "bxne"):
+        return "lr" not in ops_low, False, False
+    if fam == "arm32" and (base.startswith("pop") or base.startswith("ldm")) and "pc" in ops_low:
+        return False, False, True  # return
+    if base in calls:
+        return False, True, False
+    if base in rets:
+        return False, False, False
+
+    branch = False
+    if fam == "aarch64":
+        branch = base in ("b", "br", "cbz", "cbnz", "tbz", "tbnz") or mnem.startswith("b.")
+    elif fam == "arm32":
+        branch = base == "b" or bool(re.fullmatch(rf"b({_ARM_CONDS})(\.w|\.n)?", mnem))
+        branch = branch or base in ("cbz", "cbnz", "tbb", "tbh")
+    elif fam == "mips":
+        branch = base in ("b", "j") or (base.startswith("b") and base not in ("break",))
+    elif fam == "sparc":
+        branch = base.startswith(("b", "fb", "cb")) or base in ("jmp", "jmpl")
+    elif fam == "riscv":
+        branch = base in ("j", "jr", "tail") or base.startswith("b")
+    elif fam == "powerpc":
+        branch = base in ("b", "ba", "bctr") or (base.startswith("b") and not base.endswith(("l", "la", "lrl")))
+    elif fam == "avr":
+        branch = base in ("rjmp", "jmp", "ijmp", "eijmp") or base.startswith("br")
+
+    memory = False
+    if fam == "aarch64":
+        memory = base.startswith(("ld", "st", "prfm", "cas", "swp")) or base in ("ldr", "str")
+    elif fam == "arm32":
+        memory = base.startswith(("ldr", "str", "ldm", "stm", "push", "pop", "vldr", "vstr", "vld", "vst", "vpush", "vpop"))
+    elif fam == "mips":
+        memory = base in {"lb", "lbu", "lh", "lhu", "lw", "lwu", "lwl", "lwr", "ld", "ldl", "ldr", "ll", "lld",
+                          "sb", "sh", "sw", "swl", "swr", "sd", "sdl", "sdr", "sc", "scd",
+                          "lwc1", "swc1", "ldc1", "sdc1", "lwxc1", "swxc1"}
+    elif fam == "sparc":
+        memory = base.startswith(("ld", "st", "swap", "cas")) or base in ("prefetch",)
+    elif fam == "riscv":
+        memory = base in {"lb", "lbu", "lh", "lhu", "lw", "lwu", "ld", "flw", "fld", "sb", "sh", "sw", "sd", "fsw", "fsd"} \
+            or base.startswith(("lr", "sc", "amo", "vl", "vs"))
+    elif fam == "powerpc":
+        memory = bool(re.match(r"^(l[bhwd]|lf[sd]|lmw|lvx|lxv|st[bhwd]|stf[sd]|stmw|stvx|stxv)", base))
+    elif fam == "avr":
+        memory = base in {"ld", "ldd", "lds", "st", "std", "sts", "push", "pop", "lpm", "elpm", "spm"}
+    return branch, False, memory
+
+
+def _simd_risc(fam: str, mnem: str, ops: str) -> Optional[str]:
+    low = ops.lower()
+    if fam == "aarch64":
+        if re.search(r"\bz\d+\.", low) or re.search(r"\bp\d+/", low):
+            return "sve"
+        if re.search(r"\bv\d+\.(16b|8h|4s|2d)\b", low) or re.search(r"\bq\d+\b", low):
+            return "neon-q"
+        if re.search(r"\bv\d+\.(8b|4h|2s|1d)\b", low):
+            return "neon-d"
+    elif fam == "arm32":
+        if re.search(r"\bq\d+\b", low):
+            return "neon-q"
+        if re.search(r"\.(i|s|u|p)(8|16|32|64)\b", mnem) and re.search(r"\bd\d+\b", low):
+            return "neon-d"
+    elif fam == "riscv":
+        if mnem.startswith("v") and re.search(r"\bv\d+\b", low):
+            return "rvv"
+    return None
+
+
+# ---------------------------
+# x86 length estimate
+# ---------------------------
+
+_X86_REG64 = re.compile(r"\b(r(ax|bx|cx|dx|si|di|sp|bp)|r(8|9|1[0-5])[dwb]?)\b", re.IGNORECASE)
+_X86_NON_SYMBOLS = re.compile(
+    r"^((r|e)?([abcd]x|[sd]i|[sb]p|ip)|r(8|9|1[0-5])[dwb]?|[abcd][lh]|(si|di|bp|sp)l|[xyz]mm\d+|[cdefgs]s"
+    r"|(byte|word|dword|qword|tbyte|oword|xmmword|ymmword|zmmword|ptr|offset|flat))$",
+    re.IGNORECASE,
+)
+
+
+# Absolute memory operands, which have no brackets: Intel "DWORD PTR ds:1073741824"
+# or "DWORD PTR counter" (32-bit), and AT&T bare numbers (immediates take "$").
+_X86_ABS_INTEL = re.compile(
+    r"(?:\b[cdefgs]s:|\bptr\s+(?:flat:)?(?![cdefgs]s:))(-?(?:0x[0-9a-f]+|\d+)|[a-z_.$][\w.$@]*)\b(?!\s*\[)",
+    re.IGNORECASE,
+)
+_X86_ABS_ATT = re.compile(r"(?:^|,\s*)(-?(?:0x[0-9a-f]+|\d+))\s*(?=,|$)", re.IGNORECASE)
+
+
+def _x86_length(mnem: str, ops: str, is_64: bool) -> int:
+    """Rough encoded length of an x86 instruction (typically within a byte or two)."""
+    if not ops:
+        return 1 if not mnem.startswith(("syscall", "cpuid", "rdtsc", "ud2", "endbr")) else 4 if mnem.startswith("endbr") else 2
+    if mnem.startswith("j") or mnem.startswith("call"):
+        if "*" in ops or "[" in ops or "%" in ops:
+            return 3  # indirect through a register or memory
+        return 2 if mnem.startswith("j") and mnem not in ("jmp", "jmpq") else 5
+    # Intel ("QWORD PTR -8[rbp]", "[rsp+8]") or AT&T ("-8(%rbp)") memory operand.
+    mem = re.search(r"[-\w.$@+]*\[[^\]]*\]", ops) or re.search(r"[-\w.$@+]*\((%\w+)?(,%\w+)?(,\d)?\)", ops)
+    if mnem in ("push", "pop", "pushq", "popq") and not mem:
+        return 2 if re.search(r"r(8|9|1[0-5])", ops) else 1
+
+    length = 2  # opcode + ModRM
+    low = ops.lower()
+    vex = mnem.startswith("v")
+    if vex:
+        length += 3 if "zmm" in low else 2  # EVEX / VEX prefix
+    elif "xmm" in low:
+        length += 1  # mandatory prefix or 0F escape
+    # REX: a 64-bit register or operand size, or r8-r15 anywhere (a 64-bit
+    # base or index register alone needs none).
+    outside = ops.replace(mem.group(0), "") if mem else ops
+    wide = _X86_REG64.search(outside) or ("qword" in low and "xmm" not in low)
+    if is_64 and not vex and (wide or (mem and re.search(r"\br(8|9|1[0-5])", mem.group(0)))):
+        length += 1  # REX
+    if mnem.startswith(("movz", "movs", "imul", "cmov", "set", "bs", "bt")):
+        length += 1  # 0F two-byte opcode
+
+    absolute = None if mem else (_X86_ABS_INTEL.search(ops) or (("%" in ops or "$" in ops) and _X86_ABS_ATT.search(ops)))
+    if absolute:
+        length += 5 if is_64 else 4  # disp32 (and in 64-bit mode a SIB byte, as ModRM alone means RIP-relative)
+        ops = ops[:absolute.start()] + ops[absolute.end():]  # not an immediate
+    elif mem:
+        inner = re.sub(r"%\w+", "", mem.group(0).replace("[", "+").replace("]", ""))
+        if re.search(r"\b[re]sp\b|%[re]sp", mem.group(0)) or "*" in inner or re.search(r",\s*\w|,\d", mem.group(0)):
+            length += 1  # SIB
+        symbols = [t for t in re.findall(r"[A-Za-z_.$][\w.$@]*", inner) if not _X86_NON_SYMBOLS.match(t)]
+        disp = re.search(r"(?<![\w.$])[-+]?\s*(0x[0-9a-f]+|\d+)\b", inner, re.IGNORECASE)
+        if symbols or "rip" in mem.group(0).lower():
+            length += 4
+        elif disp:
+            length += 1 if abs(int(disp.group(1), 0)) < 128 else 4
+
+    imm = re.search(r"(?:^|,\s*)\$?(-?(?:0x[0-9a-f]+|\d+))\s*$", ops, re.IGNORECASE)
+    if imm:
+        value = int(imm.group(1), 0)
+        if mem or absolute:
+            if "byte" in low:
+                length += 1
+            elif mnem.startswith("mov"):
+                length += 2 if re.search(r"\bword\b", low) else 4
+            else:
+                length += 1 if -128 <= value < 128 else 4
+        elif mnem.startswith("movabs") or abs(value) > 0xFFFFFFFF:
+            length += 8
+        elif mnem.startswith("mov"):
+            length += 3  # B8+r imm32: no ModRM
+        elif -128 <= value < 128:
+            length += 1
+        else:
+            length += 4
+    return length
+
+
+def _avr_length(mnem: str) -> int:
+    return 4 if mnem in ("call", "jmp", "lds", "sts") else 2
+
+
+# ---------------------------
+# Listing walk
+# ---------------------------
+
+def _instruction_metrics(isa: str, line: str, opcodes: Optional[List[str]]) -> FunctionMetrics:
+    mnem, ops = _split(line)
+    m = FunctionMetrics(name="", instructions=1)
+    if isa in ("amd64", "x86"):
+        branch, call, memory = _classify_x86(mnem, ops)
+        m.simd = _simd_x86(mnem, ops)
+        m.bytes = len(opcodes) if opcodes else _x86_length(mnem, ops, isa == "amd64")
+    else:
+        fam = _family(isa)
+        branch, call, memory = _classify_risc(fam, mnem, ops)
+        m.simd = _simd_risc(fam, mnem, ops)
+        if opcodes:
+            m.bytes = len(opcodes)
+        elif fam == "avr":
+            m.bytes = _avr_length(mnem)
+        else:
+            m.bytes = _FIXED_WIDTH.get(isa, 4)
+    m.branches, m.calls, m.memory_ops = int(branch), int(call), int(memory)
+    return m
+
+
+def mnemonic(line: str, prefixes: bool = False) -> str:
+    """
+    The lower-cased mnemonic of an instruction line, x86 prefixes removed
+    (kept with *prefixes*: ``rep movsb``, ``lock cmpxchg``).
+    """
+    if not prefixes:
+        return _split(line)[0]
+    kept: List[str] = []
+    for word in line.strip().lower().split():
+        kept.append(word)
+        if word not in _X86_PREFIXES:
+            break
+    return " ".join(kept)
+
+
+def _is_padding(line: str) -> bool:
+    """Alignment fill as disassembled: nop of any width, or the 2-byte ``xchg ax,ax``."""
+    mnem, ops = _split(line)
+    return mnem in ("nop", "nopw", "nopl") or (mnem == "xchg" and ops.replace(" ", "").lower() == "ax,ax")
+
+
+def _is_instruction(text: str) -> bool:
+    s = text.strip()
+    if not s or _COMMENT_RE.match(s) or s.startswith("."):
+        return False
+    if _GNU_LABEL_RE.match(s) or _MASM_SKIP_RE.match(s) or _MASM_DATA_RE.match(s):
+        return False
+    if _MASM_PROC_RE.match(s) or _MASM_ENDP_RE.match(s) or s.upper() in ("END",):
+        return False
+    return True
+
+
+def split_functions(lines: Iterable[str]) -> Dict[str, List[str]]:
+    """
+    Instruction lines of an assembly listing grouped by function, in listing
+    order. Local labels followed by code are kept as ``label:`` lines;
+    directives, data and the labels of data (e.g. ``.LC0``) are dropped.
+    Code outside any function goes under ``<toplevel>``.
+    """
+    functions: Dict[str, List[str]] = {}
+    current: Optional[str] = None
+    pending: List[str] = []  # local labels not yet followed by an instruction
+    for text in lines:
+        stripped = text.strip()
+        masm_proc = _MASM_PROC_RE.match(stripped)
+        if masm_proc:
+            current, pending = masm_proc.group(1), []
+            continue
+        if _MASM_ENDP_RE.match(stripped):
+            current, pending = None, []
+            continue
+        label = _GNU_LABEL_RE.match(stripped)
+        if label:
+            name = label.group(1)
+            if _LOCAL_LABEL_RE.match(name):
+                pending.append(f"{name}:")
+            else:
+                current, pending = name, []
+            stripped = stripped[label.end():].strip()
+            if not stripped:
+                continue
+        if _is_instruction(stripped):
+            body = functions.setdefault(current or "<toplevel>", [])
+            body.extend(pending)
+            body.append(stripped)
+            pending = []
+    return functions
+
+
+def function_hash(body: Sequence[str]) -> str:
+    """Identity of a function body from split_functions, ignoring whitespace (16 hex digits)."""
+    text = "\n".join(" ".join(line.split()) for line in body if line.strip())
+    return hashlib.sha256(text.encode("utf-8")).hexdigest()[:16]
+
+
+def function_sections(lines: Sequence[str]) -> List[Tuple[str, int, int]]:
+    """
+    ``(name, start, end)`` line ranges (end exclusive) of the functions of a
+    listing, in order, as split_functions names them. A section runs from
+    the function's label (or ``PROC``) to the next section, and keeps its
+    local labels. GCC emits a function's constants (e.g. ``.LC0`` strings)
+    just before its label, so the local data labels between the previous
+    function's last instruction and the label, with the ``.section`` or
+    alignment directives that open them, start the section instead.
+    Sections without instructions (data objects) are left out.
+    """
+    starts: List[Tuple[str, int]] = []
+    for i, text in enumerate(lines):
+        stripped = text.strip()
+        masm_proc = _MASM_PROC_RE.match(stripped)
+        label = _GNU_LABEL_RE.match(stripped)
+        if masm_proc:
+            starts.append((masm_proc.group(1), i))
+        elif label and not _LOCAL_LABEL_RE.match(label.group(1)):
+            floor = starts[-1][1] + 1 if starts else 0
+            starts.append((label.group(1), _leading_data_start(lines, i, floor)))
+    if not starts or starts[0][1] > 0:
+        starts.insert(0, ("<toplevel>", 0))
+    sections = []
+    for n, (name, start) in enumerate(starts):
+        end = starts[n + 1][1] if n + 1 < len(starts) else len(lines)
+        if split_functions(lines[start:end]):
+            sections.append((name, start, end))
+    return sections
+
+
+def _leading_data_start(lines: Sequence[str], label_at: int, floor: int) -> int:
+    """
+    First line of the local data labels emitted before the function label at
+    *label_at* (see function_sections), or *label_at* when there are none.
+    Stops at an instruction or a non-local label, and not before *floor*.
+    """
+    start = label_at
+    data = False  # a data directive follows the label being looked at
+    for i in range(label_at - 1, floor - 1, -1):
+        stripped = lines[i].strip()
+        label = _GNU_LABEL_RE.match(stripped)
+        if label:
+            if not _LOCAL_LABEL_RE.match(label.group(1)) or _is_instruction(stripped[label.end():]):
+                break
+            if data or _DATA_DIRECTIVE_RE.match(stripped[label.end():].strip()):
+                start = i
+            data = False
+        elif _is_instruction(stripped) or _MASM_PROC_RE.match(stripped) or _MASM_ENDP_RE.match(stripped):
+            break
+        elif _DATA_DIRECTIVE_RE.match(stripped):
+            data = True
+    while floor < start < label_at and _SECTION_OPEN_RE.match(lines[start - 1].strip()):
+        start -= 1
+    return start
+
+
+def _relax_x86_jumps(items: List[Tuple[str, Any]]) -> None:
+    """
+    Size direct jumps to local labels like the assembler does: 2 bytes when
+    the target is within a signed byte, else 5 (jmp) or 6 (jcc). Every such
+    jump starts short and only grows, so the passes reach the fixed point
+    where all displacements fit.
+    """
+    labels = {item for kind, item in items if kind == "label"}
+    jumps = [item for kind, item in items if kind == "insn" and item[3] in labels]
+    for _, m, _, _ in jumps:
+        m.bytes = 2
+    changed = bool(jumps)
+    while changed:
+        offsets: Dict[str, int] = {}
+        pos = 0
+        for kind, item in items:
+            if kind == "label":
+                offsets[item] = pos
+            else:
+                pos += item[1].bytes
+        pos = 0
+        changed = False
+        for kind, item in items:
+            if kind == "label":
+                continue
+            _, m, mnem, target = item
+            pos += m.bytes
+            if m.bytes != 2 or target not in labels:
+                continue
+            if not -128 <= offsets[target] - pos < 128:
+                m.bytes, changed = (5 if mnem in ("jmp", "jmpq") else 6), True
+
+
+def analyze_asm(asm: Sequence[Dict[str, Any]], instruction_set: str) -> Tuple[List[FunctionMetrics], bool]:
+    """
+    Per-function metrics of a CE ``asm`` line list (dicts with "text" and,
+    with binary filters, "opcodes"). Returns (functions, bytes_exact).
+    Functions with no instructions (data objects) are left out.
+    """
+    isa = instruction_set or "amd64"
+    x86 = isa in ("amd64", "x86")
+    # ("label", name) or ("insn", (function, metrics, mnemonic, local jump target))
+    items: List[Tuple[str, Any]] = []
+    current: Optional[str] = None
+    exact = True
+
+    for entry in asm:
+        text = str(entry.get("text", "")).rstrip() if isinstance(entry, dict) else str(entry)
+        stripped = text.strip()
+        masm_proc = _MASM_PROC_RE.match(stripped)
+        if masm_proc:
+            current = masm_proc.group(1)
+            continue
+        if _MASM_ENDP_RE.match(stripped):
+            current = None
+            continue
+        label = _GNU_LABEL_RE.match(stripped)
+        if label:
+            name = label.group(1)
+            items.append(("label", name))
+            if not _LOCAL_LABEL_RE.match(name):
+                current = name
+            rest = stripped[label.end():].strip()
+            if not rest or not _is_instruction(rest):
+                continue
+            stripped = rest
+        if not _is_instruction(stripped):
+            continue
+        opcodes = entry.get("opcodes") if isinstance(entry, dict) else None
+        if opcodes and _is_padding(stripped):
+            m = FunctionMetrics(name="", padding=len(opcodes))
+            items.append(("insn", (current or "<toplevel>", m, "nop", None)))
+            continue
+        m = _instruction_metrics(isa, stripped, opcodes or None)
+        exact = exact and bool(opcodes)
+        mnem, ops = _split(stripped)
+        target = None
+        if x86 and not opcodes and mnem.startswith("j") and _LOCAL_LABEL_RE.match(ops):
+            target = ops.split()[0]
+        items.append(("insn", (current or "<toplevel>", m, mnem, target)))
+
+    if x86:
+        _relax_x86_jumps(items)
+
+    functions: Dict[str, FunctionMetrics] = {}
+    for kind, item in items:
+        if kind != "insn":
+            continue
+        name, m = item[0], item[1]
+        functions.setdefault(name, FunctionMetrics(name=name)).add(m)
+
+    any_insn = bool(functions)
+    exact = exact and any_insn
+    if not exact and any_insn and (isa in _FIXED_WIDTH or _family(isa) == "avr"):
+        # Fixed encodings are exact unless a pseudo instruction may expand.
+        exact = not any(_is_pseudo(isa, e) for e in asm)
+    return list(functions.values()), exact
+
+
+def _is_pseudo(isa: str, entry: Any) -> bool:
+    """Assembler pseudo instructions that may expand to more than one word."""
+    text = str(entry.get("text", "")) if isinstance(entry, dict) else str(entry)
+    if not _is_instruction(text.strip()) or _GNU_LABEL_RE.match(text.strip()):
+        return False
+    mnem = text.split(None, 1)[0].lower()
+    fam = _family(isa)
+    return (fam == "mips" and mnem in ("li", "la", "dla", "dli")) or (fam == "riscv" and mnem in ("li", "la", "call", "tail")) \
+        or (fam == "sparc" and mnem in ("set", "setx"))
+
+
+def cell_metrics(response: Dict[str, Any], instruction_set: str) -> Dict[str, Any]:
+    """The ``.metrics.json`` record for one compile response (its instructionSet wins)."""
+    if isinstance(response, dict) and response.get("instructionSet"):
+        instruction_set = response["instructionSet"]
+    asm = response.get("asm", []) if isinstance(response, dict) else []
+    functions, exact = analyze_asm(asm, instruction_set)
+    bodies = split_functions(str(e.get("text", "")) if isinstance(e, dict) else str(e) for e in asm)
+    total = FunctionMetrics(name="<total>")
+    for f in functions:
+        total.add(f)
+    return {
+        "instruction_set": instruction_set,
+        "bytes_exact": exact,
+        "functions": [{**asdict(f), "hash": function_hash(bodies.get(f.name, []))} for f in functions],
+        "total": {k: v for k, v in asdict(total).items() if k != "name"},
+    }
+
+
+# gcc 12 -O2 -masm=intel listing of src/memory/volatile-access.c and the
+# function sizes objdump reports for its object file (padding excluded);
+# "python3 ce_metrics.py --check" compares the x86 estimate with them.
+_X86_CHECK_LISTING = """\
+write_hardware:
+        mov     DWORD PTR ds:1073741824, edi
+        mov     DWORD PTR ds:1073741824, edi
+        ret
+read_hardware:
+        mov     eax, DWORD PTR ds:1073741824
+        mov     edx, DWORD PTR ds:1073741824
+        add     eax, edx
+        ret
+read_non_volatile:
+        mov     rax, QWORD PTR non_volatile_ptr[rip]
+        mov     eax, DWORD PTR [rax]
+        add     eax, eax
+        ret
+"""
+_X86_CHECK_BYTES = {"write_hardware": 15, "read_hardware": 17, "read_non_volatile": 12}
+
+
+def check_x86_estimate() -> List[str]:
+    """Functions of the check listing whose estimated size differs from objdump's, as messages."""
+    functions, _ = analyze_asm([{"text": line} for line in _X86_CHECK_LISTING.splitlines()], "amd64")
+    estimated = {f.name: f.bytes for f in functions}
+    return [
+        f"{name}: estimated {estimated.get(name)} bytes, objdump {size}"
+        for name, size in _X86_CHECK_BYTES.items() if estimated.get(name) != size
+    ]
+
+
+__all__ = [
+    "METRICS_SUFFIX",
+    "FunctionMetrics",
+    "analyze_asm",
+    "cell_metrics",
+    "check_x86_estimate",
+    "detect_instruction_set",
+    "function_hash",
+    "function_sections",
+    "mnemonic",
+    "split_functions",
+    "widest_simd",
+]
+
+
+if __name__ == "__main__":
+    import argparse
+    from pathlib import Path
+
+    from ce_store import PackedOutputs, open_outputs
+
+    ap = argparse.ArgumentParser(description="Compute <stem>.metrics.json for every compiled cell of an output tree")
+    ap.add_argument("out", nargs="?", help="Output directory root (as passed to ce_batch.py --out)")
+    ap.add_argument("--check", action="store_true", help="Compare the x86 size estimate with objdump sizes of a known listing")
+    args = ap.parse_args()
+    if args.check:
+        problems = check_x86_estimate()
+        print("\n".join(problems) if problems else "x86 size estimate matches objdump")
+        raise SystemExit(1 if problems else 0)
+    if not args.out:
+        ap.error("the output directory is required")
+
+    root = Path(args.out)
+    store = open_outputs(root, "packed" if PackedOutputs.exists_in(root) else "files")
+    count = 0
+    try:
+        for key in store.iter_files(".compile.response.json"):
+            text = store.read_text(key)
+            try:
+                response = json.loads(text or "")
+            except ValueError:
+                continue
+            stem = key[: -len(".compile.response.json")]
+            store.write_json(stem + METRICS_SUFFIX, cell_metrics(response, detect_instruction_set(key.split("/")[0])))
+            count += 1
+    finally:
+        store.close()
+    print(f"Wrote metrics for {count} cells")
@@ -0,0 +1,123 @@
+# Copyright (c) 2026 Larry H <l.gr [at] dartmouth [dot] edu>
+# SPDX-License-Identifier: AGPL-3.0-or-later
+#
+# Compiler Optimization Gallery
+# Developed for COSC-69.16: Basics of Reverse Engineering
+# Dartmouth College, Winter 2026
+
+"""
+ce_overhead.py
+
+What a hardening flag costs. A source whose ``extra-flags`` (or
+``replace-flags``) turn on a mitigation opts in through its
+``@gallery-hints`` block:
+
+    /* @gallery-hints
+     *   extra-flags: -fstack-protector-all
+     *   overhead: -fno-stack-protector
+     */
+
+and every cell is also built without the mitigation. The baseline is the
+scenario's flags without ``extra-flags``; the hint's value is appended to
+them (``yes`` appends nothing), which turns off a mitigation the toolchain
+enables by default. Under ``replace-flags`` the value replaces the flags
+instead, e.g. ``overhead: /O2 /GS-`` next to ``replace-flags: /O2 /GS``.
+
+The baseline is compiled in the same compile_many() call as the cell, and
+overhead_record() writes ``<stem>.overhead.json``: instructions and bytes
+per function with and without the flags (ce_metrics.py). With
+``ce_batch.py --bench`` the source's ``bench`` entries also run against
+the baseline build (ce_bench.bench_cell(), the ``overhead`` key of
+``<stem>.bench.json``), and timing_rows() pairs the two runs into time and
+TSC ticks per call. The book page shows both, for every scenario of the
+compiler.
+"""
+
+from __future__ import annotations
+
+from typing import Any, Dict, List, Optional
+
+OVERHEAD_SUFFIX = ".overhead.json"
+
+
+def percent(value: Optional[float], baseline: Optional[float]) -> Optional[float]:
+    """How much larger *value* is than *baseline*, in percent (None if unknown or no baseline)."""
+    if value is None or not baseline:
+        return None
+    return (value / baseline - 1.0) * 100.0
+
+
+def _sizes(metrics: Dict[str, Any]) -> Dict[str, Dict[str, int]]:
+    return {
+        f["name"]: {"instructions": f.get("instructions", 0), "bytes": f.get("bytes", 0)}
+        for f in metrics.get("functions", [])
+        if isinstance(f, dict) and "name" in f
+    }
+
+
+def overhead_record(
+    flags: str, baseline_flags: str, metrics: Dict[str, Any], baseline_metrics: Dict[str, Any]
+) -> Dict[str, Any]:
+    """The ``.overhead.json`` record: code size with *flags* against *baseline_flags*, per function and in total."""
+    hardened, baseline = _sizes(metrics), _sizes(baseline_metrics)
+    functions = []
+    # The cell's own functions in listing order, then any only the baseline has.
+    for name in list(hardened) + [n for n in baseline if n not in hardened]:
+        h, b = hardened.get(name), baseline.get(name)
+        functions.append({
+            "function": name,
+            "instructions": h["instructions"] if h else 0,
+            "baseline_instructions": b["instructions"] if b else 0,
+            "bytes": h["bytes"] if h else 0,
+            "baseline_bytes": b["bytes"] if b else 0,
+        })
+    total, base_total = metrics.get("total", {}), baseline_metrics.get("total", {})
+    return {
+        "flags": flags,
+        "baseline_flags": baseline_flags,
+        "instruction_set": metrics.get("instruction_set"),
+        "bytes_exact": bool(metrics.get("bytes_exact")) and bool(baseline_metrics.get("bytes_exact")),
+        "functions": functions,
+        "total": {
+            "instructions": total.get("instructions", 0),
+            "baseline_instructions": base_total.get("instructions", 0),
+            "bytes": total.get("bytes", 0),
+            "baseline_bytes": base_total.get("bytes", 0),
+        },
+    }
+
+
+def timing_rows(bench: Optional[Dict[str, Any]]) -> List[Dict[str, Any]]:
+    """
+    One row per benchmark (function, n) measured both with and without the
+    hardening flags: ns and TSC ticks per call, and the overhead in percent
+    (from ticks where both runs have them, else from ns).
+    """
+    if not isinstance(bench, dict) or not isinstance(bench.get("overhead"), dict):
+        return []
+    base = {(r.get("function"), r.get("n")): r for r in bench["overhead"].get("results", [])}
+    rows = []
+    for r in bench.get("results", []):
+        b = base.get((r.get("function"), r.get("n")))
+        if b is None:
+            continue
+        cycles, base_cycles = r.get("cycles_per_op"), b.get("cycles_per_op")
+        ns, base_ns = r.get("ns_per_op"), b.get("ns_per_op")
+        rows.append({
+            "function": r["function"],
+            "n": r["n"],
+            "ns": ns,
+            "baseline_ns": base_ns,
+            "cycles": cycles,
+            "baseline_cycles": base_cycles,
+            "overhead_pct": percent(cycles, base_cycles) if cycles and base_cycles else percent(ns, base_ns),
+        })
+    return rows
+
+
+__all__ = [
+    "OVERHEAD_SUFFIX",
+    "overhead_record",
+    "percent",
+    "timing_rows",
+]
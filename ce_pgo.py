@@ -0,0 +1,146 @@
+# Copyright (c) 2026 Larry H <l.gr [at] dartmouth [dot] edu>
+# SPDX-License-Identifier: AGPL-3.0-or-later
+#
+# Compiler Optimization Gallery
+# Developed for COSC-69.16: Basics of Reverse Engineering
+# Dartmouth College, Winter 2026
+
+"""
+ce_pgo.py
+
+Profile-guided optimization scenarios. A scenario marked ``pgo: true`` in
+docs/config.yaml:
+
+    scenarios:
+      O2-pgo:
+        flags: "-O2"
+        pgo: true
+
+builds each cell in three steps: the source's benchmark driver (its
+``bench`` hint, see ce_bench.py) is built with the scenario's flags plus
+``-fprofile-generate`` and run once per size and input pattern, which
+writes a profile; then the cell is compiled with ``-fprofile-use`` and that
+profile. The stored assembly, metrics and (with ``--bench``) timings sit
+next to those of the scenario without a profile, and the book page
+compares the two.
+
+A source can train on fewer inputs than it is benchmarked with:
+
+    /* @gallery-hints
+     *   bench: day_of_week(i32{0..7})
+     *   pgo-inputs: sorted          (optional; default: bench-inputs)
+     */
+
+train_cell() runs the training through the backend's ``train_profile()``
+(LocalCompiler, see ce_local.py) and returns the profile and the record
+written as ``<stem>.pgo.json``: the training flags and workload, the
+profile's size and digest, and the error if training failed (the cell is
+then compiled without a profile). GCC writes a ``.gcda`` file;
+clang writes a ``.profraw`` that ``llvm-profdata merge`` turns into the
+``.profdata`` it reads back.
+
+Only toolchains that run programs on this host can train, so PGO cells
+are planned for local gcc and clang compilers and sources with benchmarks;
+Compiler Explorer keeps nothing between a run and the next compile, and
+MSVC's PGO (``/GL /GENPROFILE``) needs a linker ce_local.py does not drive.
+Only depends on the standard library.
+"""
+
+from __future__ import annotations
+
+import hashlib
+import time
+from dataclasses import dataclass
+from typing import Any, Dict, Optional, Protocol, Tuple
+
+from ce_remarks import compiler_family
+
+PGO_SUFFIX = ".pgo.json"
+
+# Instrumentation flags per compiler family. -fprofile-update=single keeps
+# GCC's counters plain increments (the drivers are single-threaded).
+TRAIN_FLAGS = {
+    "gcc": "-fprofile-generate -fprofile-update=single",
+    "clang": "-fprofile-generate",
+}
+USE_FLAGS = {"gcc": "-fprofile-use", "clang": "-fprofile-use"}
+
+
+def pgo_supported(compiler_id: str) -> bool:
+    """Whether *compiler_id* is a compiler family train_cell() can drive."""
+    return compiler_family(compiler_id) in TRAIN_FLAGS
+
+
+@dataclass(frozen=True)
+class TrainedProfile:
+    """A cell's training run: the profile to compile with (None if training failed) and its record."""
+    data: Optional[bytes]
+    record: Dict[str, Any]
+
+
+class TrainBackend(Protocol):
+    def train_profile(
+        self, compiler_id: str, source: str, user_arguments: str = "-O2",
+        lang: Optional[str] = None, timeout_s: Optional[float] = None,
+    ) -> Tuple[Any, Optional[bytes]]: ...
+
+
+def train_cell(
+    backend: TrainBackend,
+    compiler_id: str,
+    driver: str,
+    flags: str,
+    workload: Dict[str, Any],
+    lang: Optional[str] = None,
+    baseline: Optional[str] = None,
+    timeout_s: float = 300.0,
+    train_extra: str = "",
+) -> TrainedProfile:
+    """
+    Build *driver* (ce_bench.training_driver()) with *flags*, *train_extra*
+    (e.g. the ``bench-define`` size the driver is built for) and the
+    family's instrumentation, run it and collect the profile. *workload*
+    (functions, sizes, inputs) and *baseline*, the scenario with the same
+    flags and no profile, go into the record. Failures are recorded, not
+    raised.
+    """
+    family = compiler_family(compiler_id)
+    record: Dict[str, Any] = {
+        "compiler": compiler_id,
+        "flags": flags,
+        "training_flags": " ".join(f for f in (flags, train_extra, TRAIN_FLAGS.get(family, "")) if f),
+        "use_flags": f"{flags} {USE_FLAGS.get(family, '')}".strip(),
+        "workload": workload,
+        "ok": False,
+    }
+    if baseline:
+        record["baseline"] = baseline
+    if family not in TRAIN_FLAGS:
+        record["error"] = f"no profile-guided optimization support for {compiler_id}"
+        return TrainedProfile(None, record)
+    started = time.monotonic()
+    try:
+        res, data = backend.train_profile(
+            compiler_id, driver, user_arguments=f"{flags} {train_extra}".strip(), lang=lang, timeout_s=timeout_s,
+        )
+    except (KeyError, OSError) as e:
+        record["error"] = str(e)
+        return TrainedProfile(None, record)
+    record["seconds"] = round(time.monotonic() - started, 3)
+    if data is None:
+        detail = (res.stderr or res.stdout) if res is not None else ""
+        record["error"] = (detail or f"training run failed (exit code {getattr(res, 'code', '?')})")[-4000:]
+        return TrainedProfile(None, record)
+    record["ok"] = True
+    record["profile"] = {"bytes": len(data), "sha256": hashlib.sha256(data).hexdigest()}
+    return TrainedProfile(data, record)
+
+
+__all__ = [
+    "PGO_SUFFIX",
+    "TRAIN_FLAGS",
+    "TrainedProfile",
+    "USE_FLAGS",
+    "pgo_supported",
+    "train_cell",
+]
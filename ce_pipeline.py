@@ -0,0 +1,180 @@
+# Copyright (c) 2026 Larry H <l.gr [at] dartmouth [dot] edu>
+# SPDX-License-Identifier: AGPL-3.0-or-later
+#
+# Compiler Optimization Gallery
+# Developed for COSC-69.16: Basics of Reverse Engineering
+# Dartmouth College, Winter 2026
+
+"""
+ce_pipeline.py
+
+Two-stage worker pipeline used by ce_batch.py: a pool of compile workers feeds
+a queue that a separately sized pool of explain workers drains, so compiles
+for later cells overlap with the (much slower) explain calls for earlier ones.
+
+The first error raised by any worker stops both stages: queued items are
+dropped, in-flight ones finish, and the error is re-raised from run().
+stop() does the same without an error, e.g. when a run's time is up.
+"""
+
+from __future__ import annotations
+
+import itertools
+import queue
+import threading
+import time
+from typing import Any, Callable, Generic, Iterable, List, Optional, Tuple, TypeVar
+
+A = TypeVar("A")
+B = TypeVar("B")
+
+_DONE = object()  # queue sentinel: one per worker
+
+
+class TwoStagePipeline(Generic[A, B]):
+    """
+    Runs ``first`` on every item, then ``second`` on every non-None result.
+
+    ``on_item_done`` is called once per input item when it leaves the
+    pipeline (after ``second``, or after ``first`` if it returned None or
+    there is no second stage). Both stages and the callback run on worker
+    threads.
+
+    With ``fan_out``, an input item is a unit of work that ``first`` turns
+    into a list of results; each list entry then counts as one item above.
+
+    ``on_dequeue(enqueued_at, depth)`` is called on the second-stage worker
+    that takes a result off the queue, with the ``time.monotonic()`` it was
+    queued at and the number of results still waiting.
+
+    With ``priority``, the second stage takes the waiting result with the
+    lowest ``priority(result)`` first (ties in queueing order) instead of
+    the oldest. Input items are always started in the order given.
+    """
+
+    def __init__(
+        self,
+        first: Callable[[A], Any],  # Optional[B], or List[Optional[B]] with fan_out
+        second: Optional[Callable[[B], None]],
+        first_workers: int = 1,
+        second_workers: int = 1,
+        on_item_done: Optional[Callable[[], None]] = None,
+        fan_out: bool = False,
+        on_dequeue: Optional[Callable[[float, int], None]] = None,
+        priority: Optional[Callable[[B], Any]] = None,
+    ) -> None:
+        self.first = first
+        self.second = second
+        self.first_workers = max(1, first_workers)
+        self.second_workers = max(1, second_workers)
+        self.on_item_done = on_item_done or (lambda: None)
+        self.fan_out = fan_out
+        self.on_dequeue = on_dequeue
+        self.priority = priority
+
+        self._first_q: "queue.Queue[object]" = queue.Queue()
+        # Entries are (rank, seq, payload): results rank 0 by priority, the
+        # _DONE sentinels rank 1 so they come out after every result.
+        self._second_q: "queue.PriorityQueue[Tuple[Any, ...]]" = queue.PriorityQueue()
+        self._seq = itertools.count()
+        self._stop = threading.Event()
+        self._error: Optional[BaseException] = None
+        self._error_lock = threading.Lock()
+
+    def _put_second(self, payload: object) -> None:
+        if payload is _DONE:
+            self._second_q.put((1, 0, next(self._seq), payload))
+            return
+        result = payload[0]  # type: ignore[index]
+        rank = self.priority(result) if self.priority is not None else 0
+        self._second_q.put((0, rank, next(self._seq), payload))
+
+    def stop(self) -> None:
+        """Drop the queued items of both stages; in-flight ones finish and run() returns."""
+        self._stop.set()
+
+    @property
+    def stopped(self) -> bool:
+        return self._stop.is_set()
+
+    def _fail(self, exc: BaseException) -> None:
+        with self._error_lock:
+            if self._error is None:
+                self._error = exc
+        self._stop.set()
+
+    def _first_worker(self) -> None:
+        while True:
+            item = self._first_q.get()
+            if item is _DONE:
+                return
+            if self._stop.is_set():
+                continue
+            try:
+                produced = self.first(item)  # type: ignore[arg-type]
+                for result in (produced if self.fan_out else [produced]):
+                    if result is None or self.second is None:
+                        self.on_item_done()
+                    else:
+                        self._put_second((result, time.monotonic()))
+            except BaseException as e:  # noqa: BLE001 - propagated from run()
+                self._fail(e)
+
+    def _second_worker(self) -> None:
+        assert self.second is not None
+        while True:
+            item = self._second_q.get()[-1]
+            if item is _DONE:
+                return
+            if self._stop.is_set():
+                continue
+            result, enqueued_at = item  # type: ignore[misc]
+            try:
+                if self.on_dequeue is not None:
+                    self.on_dequeue(enqueued_at, self._second_q.qsize())
+                self.second(result)
+                self.on_item_done()
+            except BaseException as e:  # noqa: BLE001 - propagated from run()
+                self._fail(e)
+
+    @staticmethod
+    def _join(threads: List[threading.Thread]) -> None:
+        # Poll so Ctrl-C still reaches the main thread.
+        for t in threads:
+            while t.is_alive():
+                t.join(timeout=0.5)
+
+    def run(self, items: Iterable[A]) -> None:
+        for item in items:
+            self._first_q.put(item)
+        for _ in range(self.first_workers):
+            self._first_q.put(_DONE)
+
+        first_threads = [
+            threading.Thread(target=self._first_worker, name=f"compile-{i}", daemon=True)
+            for i in range(self.first_workers)
+        ]
+        second_threads: List[threading.Thread] = []
+        if self.second is not None:
+            second_threads = [
+                threading.Thread(target=self._second_worker, name=f"explain-{i}", daemon=True)
+                for i in range(self.second_workers)
+            ]
+        for t in first_threads + second_threads:
+            t.start()
+
+        try:
+            self._join(first_threads)
+            for _ in second_threads:
+                self._put_second(_DONE)
+            self._join(second_threads)
+        except KeyboardInterrupt:
+            # Drop queued work; in-flight requests finish before we return.
+            self._stop.set()
+            for _ in second_threads:
+                self._put_second(_DONE)
+            self._join(first_threads + second_threads)
+            raise
+
+        if self._error is not None:
+            raise self._error
@@ -0,0 +1,141 @@
+# Copyright (c) 2026 Larry H <l.gr [at] dartmouth [dot] edu>
+# SPDX-License-Identifier: AGPL-3.0-or-later
+#
+# Compiler Optimization Gallery
+# Developed for COSC-69.16: Basics of Reverse Engineering
+# Dartmouth College, Winter 2026
+
+"""
+ce_priority.py
+
+The order ce_batch.py works through the matrix in. Each source gets a score
+from its category and from how recently it changed:
+
+    score = weight(category) * (1 + recent_boost * 0.5 ** (age_days / half_life_days))
+
+Compile units (all scenarios of one compiler and source) start in
+descending score order, and the explain queue hands out its highest-scoring
+cell first, so explanations of important, freshly edited examples are
+written early in a long run. A run cut short by ``--time-limit`` then
+leaves the pages that matter most. The weights come from an optional
+``priorities`` mapping in config.yaml:
+
+    priorities:
+      categories:               # weight per top-level directory of src/ (default 1)
+        security: 3
+        simd: 3
+        string-literals: 0.5
+      recent_boost: 1           # extra weight of a source changed just now
+      half_life_days: 14        # age at which half of that boost is left
+
+A source's age is that of the last commit that touched it; uncommitted
+edits count as changed now. Outside a git checkout (or for files git does
+not know) the file's mtime is used. Only depends on the standard library.
+"""
+
+from __future__ import annotations
+
+import subprocess
+import time
+from dataclasses import dataclass, field
+from pathlib import Path
+from typing import Any, Dict, Iterable, Optional
+
+
+class PriorityError(ValueError):
+    pass
+
+
+@dataclass(frozen=True)
+class Priorities:
+    categories: Dict[str, float] = field(default_factory=dict)
+    recent_boost: float = 1.0
+    half_life_days: float = 14.0
+
+    def weight(self, category: str) -> float:
+        return self.categories.get(category, 1.0)
+
+    def score(self, category: str, age_days: Optional[float]) -> float:
+        """Priority of a source in *category* last changed *age_days* ago (None: unknown)."""
+        recency = 0.0 if age_days is None else 0.5 ** (max(0.0, age_days) / self.half_life_days)
+        return self.weight(category) * (1.0 + self.recent_boost * recency)
+
+
+def _number(value: Any, where: str, positive: bool) -> float:
+    if isinstance(value, bool) or not isinstance(value, (int, float)) or value < 0 or (positive and value == 0):
+        raise PriorityError(f"{where} must be a {'positive' if positive else 'non-negative'} number")
+    return float(value)
+
+
+def load_priorities(config: Dict[str, Any]) -> Priorities:
+    """Parse the config's ``priorities`` mapping (missing: every category weighs 1)."""
+    raw = config.get("priorities")
+    if raw is None:
+        return Priorities()
+    if not isinstance(raw, dict):
+        raise PriorityError("'priorities' must be a mapping")
+    unknown = set(raw) - {"categories", "recent_boost", "half_life_days"}
+    if unknown:
+        raise PriorityError(f"priorities: unknown key {sorted(unknown)[0]!r}")
+    categories_raw = raw.get("categories") or {}
+    if not isinstance(categories_raw, dict):
+        raise PriorityError("'priorities.categories' must be a mapping of category to weight")
+    defaults = Priorities()
+    return Priorities(
+        categories={
+            str(name): _number(w, f"priorities.categories[{name!r}]", positive=False)
+            for name, w in categories_raw.items()
+        },
+        recent_boost=_number(raw.get("recent_boost", defaults.recent_boost), "priorities.recent_boost", positive=False),
+        half_life_days=_number(raw.get("half_life_days", defaults.half_life_days), "priorities.half_life_days", positive=True),
+    )
+
+
+def _git_lines(args: Iterable[str], cwd: Path) -> Optional[str]:
+    try:
+        proc = subprocess.run(["git", *args], cwd=cwd, capture_output=True, text=True, check=True)
+    except (OSError, subprocess.CalledProcessError):
+        return None
+    return proc.stdout
+
+
+def source_ages(paths: Iterable[Path], src_root: Path, now: Optional[float] = None) -> Dict[Path, Optional[float]]:
+    """Days since each of *paths* (under *src_root*) last changed, from git history or mtime."""
+    now = time.time() if now is None else now
+    paths = [p.resolve() for p in paths]
+    changed: Dict[Path, float] = {}
+    top_out = _git_lines(["rev-parse", "--show-toplevel"], src_root)
+    if top_out:
+        top = Path(top_out.strip())
+        # One pass over the history: newest commits first, so the first time a
+        # path shows up is its last change.
+        log = _git_lines(["log", "--format=@%ct", "--name-only", "--no-renames", "--", str(src_root)], top) or ""
+        stamp = None
+        for line in log.splitlines():
+            if line.startswith("@"):
+                stamp = float(line[1:])
+            elif line and stamp is not None:
+                changed.setdefault(top / line, stamp)
+        status = _git_lines(["status", "--porcelain", "--untracked-files=all", "--", str(src_root)], top) or ""
+        for line in status.splitlines():
+            if len(line) > 3:
+                changed[top / line[3:].split(" -> ")[-1]] = now
+    ages: Dict[Path, Optional[float]] = {}
+    for p in paths:
+        stamp = changed.get(p)
+        if stamp is None:
+            try:
+                stamp = p.stat().st_mtime
+            except OSError:
+                ages[p] = None
+                continue
+        ages[p] = max(0.0, now - stamp) / 86400.0
+    return ages
+
+
+__all__ = [
+    "Priorities",
+    "PriorityError",
+    "load_priorities",
+    "source_ages",
+]
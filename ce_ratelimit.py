@@ -0,0 +1,129 @@
+# Copyright (c) 2026 Larry H <l.gr [at] dartmouth [dot] edu>
+# SPDX-License-Identifier: AGPL-3.0-or-later
+#
+# Compiler Optimization Gallery
+# Developed for COSC-69.16: Basics of Reverse Engineering
+# Dartmouth College, Winter 2026
+
+"""
+ce_ratelimit.py
+
+Request pacing for CompilerExplorerClient.
+
+- AdaptiveTokenBucket: a per-host token bucket whose refill rate follows
+  AIMD (additive increase, multiplicative decrease). Every success nudges the
+  rate up towards ``max_rate``; every 429/503 halves it. The pool therefore
+  settles just under the rate the host tolerates instead of a fixed guess.
+- RetryPolicy: which responses are retried and how long to wait, honouring
+  ``Retry-After`` and otherwise using exponential backoff with full jitter.
+"""
+
+from __future__ import annotations
+
+import email.utils
+import random
+import threading
+import time
+from dataclasses import dataclass
+from typing import Optional
+
+
+class AdaptiveTokenBucket:
+    """Thread-safe token bucket with an AIMD-controlled refill rate."""
+
+    def __init__(
+        self,
+        rate: float,
+        max_rate: float,
+        min_rate: float = 0.2,
+        burst: float = 2.0,
+        increase: Optional[float] = None,
+        decrease_interval_s: float = 1.0,
+    ) -> None:
+        self.min_rate = max(0.01, min_rate)
+        self.max_rate = max(self.min_rate, max_rate)
+        self.rate = min(max(rate, self.min_rate), self.max_rate)
+        self.burst = max(1.0, burst)
+        # Default: ~100 successes to climb from the floor to the ceiling.
+        self.increase = increase if increase is not None else self.max_rate / 100.0
+        # Concurrent workers often hit the same throttle window together;
+        # count those as one congestion signal, not N halvings.
+        self.decrease_interval_s = decrease_interval_s
+        self._last_decrease = float("-inf")
+        self._tokens = self.burst
+        self._last = time.monotonic()
+        self._blocked_until = 0.0
+        self._lock = threading.Lock()
+
+    def _refill(self, now: float) -> None:
+        self._tokens = min(self.burst, self._tokens + (now - self._last) * self.rate)
+        self._last = now
+
+    def acquire(self) -> float:
+        """Block until a token is available. Returns seconds spent waiting."""
+        waited = 0.0
+        while True:
+            with self._lock:
+                now = time.monotonic()
+                self._refill(now)
+                if now >= self._blocked_until and self._tokens >= 1.0:
+                    self._tokens -= 1.0
+                    return waited
+                delay = max(self._blocked_until - now, (1.0 - self._tokens) / self.rate)
+            time.sleep(delay)
+            waited += delay
+
+    def on_success(self) -> None:
+        with self._lock:
+            self.rate = min(self.max_rate, self.rate + self.increase)
+
+    def on_throttle(self, retry_after: Optional[float] = None) -> None:
+        """Halve the rate and, if the server said so, pause the whole host."""
+        with self._lock:
+            now = time.monotonic()
+            if now - self._last_decrease >= self.decrease_interval_s:
+                self.rate = max(self.min_rate, self.rate / 2.0)
+                self._last_decrease = now
+            self._tokens = min(self._tokens, 0.0)
+            if retry_after:
+                self._blocked_until = max(self._blocked_until, now + retry_after)
+
+
+def parse_retry_after(value: Optional[str]) -> Optional[float]:
+    """``Retry-After`` is either delta-seconds or an HTTP date."""
+    if not value:
+        return None
+    value = value.strip()
+    try:
+        return max(0.0, float(value))
+    except ValueError:
+        pass
+    try:
+        when = email.utils.parsedate_to_datetime(value)
+    except (TypeError, ValueError):
+        return None
+    return max(0.0, when.timestamp() - time.time())
+
+
+@dataclass(frozen=True)
+class RetryPolicy:
+    """Retry 429 and 5xx responses (and connection errors) with backoff."""
+    max_retries: int = 5
+    base_delay_s: float = 1.0
+    max_delay_s: float = 60.0
+
+    @staticmethod
+    def is_retryable(status_code: int) -> bool:
+        return status_code == 429 or 500 <= status_code <= 599
+
+    @staticmethod
+    def is_throttle(status_code: int) -> bool:
+        """Statuses that mean "slow down" rather than "something broke"."""
+        return status_code in (429, 503)
+
+    def delay(self, attempt: int, retry_after: Optional[float] = None) -> float:
+        """Seconds to wait before retry number *attempt* (0-based)."""
+        if retry_after is not None:
+            return min(self.max_delay_s, retry_after)
+        ceiling = min(self.max_delay_s, self.base_delay_s * (2 ** attempt))
+        return random.uniform(0.0, ceiling)  # full jitter
@@ -0,0 +1,191 @@
+# Copyright (c) 2026 Larry H <l.gr [at] dartmouth [dot] edu>
+# SPDX-License-Identifier: AGPL-3.0-or-later
+#
+# Compiler Optimization Gallery
+# Developed for COSC-69.16: Basics of Reverse Engineering
+# Dartmouth College, Winter 2026
+
+"""
+ce_remarks.py
+
+Vectorization and loop-optimization remarks: why a loop was or was not
+vectorized (or interchanged). A cell captures them when its source asks for
+it in its ``@gallery-hints`` block (``remarks: yes``) or when ce_batch.py runs
+with ``--remarks``. Each compiler family gets its own reporting flags:
+
+    gcc     -fopt-info-vec-all -fopt-info-loop-all
+    clang   -Rpass=vectorize -Rpass-missed=vectorize -Rpass-analysis=vectorize
+    msvc    /Qvec-report:2
+
+The remarks come from a second compile of the cell with those flags added
+(see compile_cell_group in ce_client.py), so the cell's own assembly,
+request and explanation are unchanged. parse_remarks() reads them from the
+response's stderr and stdout and keeps those about the cell's source file:
+
+    {"line": 16, "column": 23, "kind": "optimized" | "missed" | "analysis",
+     "pass": "loop-vectorize", "message": "loop vectorized using 16 byte vectors"}
+
+They are written as ``<stem>.remarks.json`` and listed on the source page
+next to the source lines they refer to. Families without such flags (none
+known for the ID) capture nothing. Only depends on the standard library.
+"""
+
+from __future__ import annotations
+
+import re
+from typing import Any, Dict, List, Optional
+
+REMARKS_SUFFIX = ".remarks.json"
+
+# More remarks than this per cell are dropped (gcc's -all notes can run to
+# thousands for large files); optimized and missed remarks are kept first.
+MAX_REMARKS = 400
+
+REMARK_FLAGS = {
+    "gcc": "-fopt-info-vec-all -fopt-info-loop-all",
+    # Clang's pass-name regex: matches loop-vectorize and slp-vectorizer.
+    "clang": "-Rpass=vectorize -Rpass-missed=vectorize -Rpass-analysis=vectorize",
+    "msvc": "/Qvec-report:2",
+}
+
+_KIND_ORDER = {"optimized": 0, "missed": 1, "analysis": 2}
+
+# <source>:16:23: optimized: loop vectorized using 16 byte vectors
+# <source>:16:5: remark: vectorized loop (vectorization width: 4, ...) [-Rpass=loop-vectorize]
+_GNU_RE = re.compile(
+    r"^(?P<file>.+?):(?P<line>\d+):(?:(?P<col>\d+):)?\s*"
+    r"(?P<kind>optimized|missed|note|remark|warning):\s*(?P<msg>.*?)\s*$"
+)
+_CLANG_PASS_RE = re.compile(r"\s*\[-R(?P<type>pass|pass-missed|pass-analysis)=(?P<pass>[\w.-]+)\]$")
+# example.c(16) : info C5001: loop vectorized
+# example.c(23) : info C5002: loop not vectorized due to reason '1105'
+_MSVC_RE = re.compile(
+    r"^(?P<file>.+?)\((?P<line>\d+)(?:,(?P<col>\d+))?\)\s*:\s*info\s+C(?P<code>500[12]):\s*(?P<msg>.*?)\s*$"
+)
+
+
+def compiler_family(compiler_id: str) -> Optional[str]:
+    """"gcc", "clang" or "msvc" for a CE compiler ID, or None if unknown."""
+    cid = compiler_id.lower()
+    if "clang" in cid or cid.startswith("icx"):
+        return "clang"
+    if cid.startswith("vc") or "msvc" in cid:
+        return "msvc"
+    if "gcc" in cid or re.search(r"g\d{2,}", cid):
+        return "gcc"
+    return None
+
+
+def remark_flags(compiler_id: str) -> Optional[str]:
+    family = compiler_family(compiler_id)
+    return REMARK_FLAGS.get(family) if family else None
+
+
+def _is_own_source(path: str, source_name: str) -> bool:
+    """Remarks about the cell's file, not about headers it includes."""
+    path = path.strip()
+    if path in ("<source>", "<stdin>", source_name):  # CE, a local compile, a named file
+        return True
+    name = re.split(r"[\\/]", path)[-1]
+    return name in (source_name, "example.c", "example.cpp") and "include" not in path.lower()
+
+
+def parse_remarks(lines: List[str], family: str, source_name: str = "<source>") -> List[Dict[str, Any]]:
+    """Optimization remarks of *family* in compiler output *lines*, by line number."""
+    remarks: List[Dict[str, Any]] = []
+    seen = set()
+    for raw in lines:
+        remark = None
+        if family == "msvc":
+            m = _MSVC_RE.match(raw.strip())
+            if m and _is_own_source(m.group("file"), source_name):
+                remark = {
+                    "line": int(m.group("line")),
+                    "column": int(m.group("col")) if m.group("col") else None,
+                    "kind": "optimized" if m.group("code") == "5001" else "missed",
+                    "pass": "vectorizer",
+                    "message": m.group("msg"),
+                }
+        else:
+            m = _GNU_RE.match(raw.strip())
+            if m and _is_own_source(m.group("file"), source_name):
+                kind, msg, pass_name = m.group("kind"), m.group("msg"), ""
+                if family == "clang":
+                    pm = _CLANG_PASS_RE.search(msg)
+                    if kind != "remark" or not pm:
+                        continue
+                    msg = msg[:pm.start()]
+                    pass_name = pm.group("pass")
+                    kind = {"pass": "optimized", "pass-missed": "missed"}.get(pm.group("type"), "analysis")
+                elif kind in ("optimized", "missed", "note"):
+                    if msg.startswith("*****"):
+                        continue  # gcc retrying the analysis with another vector mode
+                    # gcc names no pass; -fopt-info-loop remarks mention the transform.
+                    pass_name = "loop" if re.search(r"\b(interchang|unroll|peel|distribut|non-loop)", msg) else "vect"
+                    kind = "analysis" if kind == "note" else kind
+                else:
+                    continue
+                remark = {
+                    "line": int(m.group("line")),
+                    "column": int(m.group("col")) if m.group("col") else None,
+                    "kind": kind,
+                    "pass": pass_name,
+                    "message": msg,
+                }
+        if remark is None:
+            continue
+        key = (remark["line"], remark["kind"], remark["message"])
+        if key not in seen:
+            seen.add(key)
+            remarks.append(remark)
+    remarks.sort(key=lambda r: (_KIND_ORDER[r["kind"]], r["line"]))
+    remarks = remarks[:MAX_REMARKS]
+    remarks.sort(key=lambda r: (r["line"], r["column"] or 0, _KIND_ORDER[r["kind"]]))
+    return remarks
+
+
+def remarks_record(
+    compiler_id: str, flags: str, response: Dict[str, Any], source_name: str
+) -> Optional[Dict[str, Any]]:
+    """The ``.remarks.json`` record for a remark compile's response, or None for unknown families."""
+    family = compiler_family(compiler_id)
+    if family is None:
+        return None
+    lines = [
+        x.get("text", "") for stream in ("stderr", "stdout")
+        for x in (response.get(stream) or []) if isinstance(x, dict)
+    ]
+    remarks = parse_remarks(lines, family, source_name)
+    return {
+        "compiler": compiler_id,
+        "family": family,
+        "flags": flags,
+        "remarks": remarks,
+        "counts": {k: sum(1 for r in remarks if r["kind"] == k) for k in _KIND_ORDER},
+    }
+
+
+def group_by_line(remarks: List[Dict[str, Any]], source_code: str) -> List[Dict[str, Any]]:
+    """Remarks grouped per source line with that line's text, for the book page."""
+    source_lines = source_code.splitlines()
+    groups: Dict[int, Dict[str, Any]] = {}
+    for r in remarks:
+        line = r["line"]
+        group = groups.get(line)
+        if group is None:
+            text = source_lines[line - 1].strip() if 0 < line <= len(source_lines) else ""
+            group = groups[line] = {"line": line, "code": text, "remarks": []}
+        group["remarks"].append(r)
+    return [groups[k] for k in sorted(groups)]
+
+
+__all__ = [
+    "MAX_REMARKS",
+    "REMARKS_SUFFIX",
+    "REMARK_FLAGS",
+    "compiler_family",
+    "group_by_line",
+    "parse_remarks",
+    "remark_flags",
+    "remarks_record",
+]
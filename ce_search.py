@@ -0,0 +1,299 @@
+# Copyright (c) 2026 Larry H <l.gr [at] dartmouth [dot] edu>
+# SPDX-License-Identifier: AGPL-3.0-or-later
+#
+# Compiler Optimization Gallery
+# Developed for COSC-69.16: Basics of Reverse Engineering
+# Dartmouth College, Winter 2026
+
+"""
+ce_search.py
+
+An inverted index of the book's assembly: which pages define a function,
+and which functions of which pages use an instruction, and how often.
+build_book.py writes it to ``docs/search/asm-index.json``:
+
+    {"version": 2,
+     "pages": [["O2/cg152/loops/unrollme-1.md", "loops/unrollme-1", "cg152", "O2"], ...],
+     "functions": {"sum_array": [0, 7, ...], ...},
+     "mnemonics": {"vpaddd": [[7, 12, [["sum_array", 12]]], [0, 3, [...]], ...],
+                   "rep movsb": [...], ...}}
+
+Functions and mnemonics refer to pages by their position in ``pages``. A
+mnemonic posting is (page, uses, [(function, uses), ...]), pages with the
+most uses first. Instructions with an x86 prefix are indexed both ways:
+``rep movsb`` under ``movsb`` and under ``rep movsb``.
+
+The Assembly Search page of the book (gallery.js at the docs root) fetches
+the file once and matches in the browser. The MkDocs search index never
+has to hold the listings, which build_book.py moves out of large pages
+anyway (see its ASM_INLINE_LINES). From the command line:
+
+    python3 ce_search.py 'rep movs*'                  # the book's index
+    python3 ce_search.py --out output umulh --scenario O2
+    python3 ce_search.py --function 'divide_by_*'
+
+Patterns are shell-style globs over the lower-cased mnemonic (or function
+name). ``--out`` indexes an output tree directly, through its manifest, so
+no book is needed. find_instructions() and find_functions() are the same
+queries for other tools.
+
+The terms of each cell are cached with the cell's mtime in
+``<book>/.search-cache.json`` (``<out>/.search-cache.json`` for ``--out``),
+so a rebuild only reads the listings that changed. Only depends on the
+standard library.
+"""
+
+from __future__ import annotations
+
+import argparse
+import fnmatch
+import json
+import os
+from collections import Counter
+from pathlib import Path
+from typing import Any, Dict, List, Optional, Sequence, Tuple
+
+from ce_metrics import mnemonic, split_functions
+
+SEARCH_INDEX_NAME = "search/asm-index.json"
+SEARCH_INDEX_VERSION = 2
+
+DEFAULT_INDEX = Path("book/docs") / SEARCH_INDEX_NAME
+
+
+def instruction_terms(line: str) -> List[str]:
+    """The index terms of an instruction line: its mnemonic, and with its prefixes if it has any."""
+    plain = mnemonic(line)
+    prefixed = mnemonic(line, prefixes=True)
+    return [plain] if prefixed == plain else [plain, prefixed]
+
+
+def cell_terms(asm_text: str) -> Dict[str, Any]:
+    """A listing's function names, and per mnemonic its uses by function."""
+    functions = split_functions(asm_text.splitlines())
+    uses: Dict[str, Counter] = {}
+    for name, body in functions.items():
+        for line in body:
+            if line.endswith(":"):
+                continue
+            for term in instruction_terms(line):
+                uses.setdefault(term, Counter())[name] += 1
+    return {
+        "functions": [name for name in functions if name != "<toplevel>"],
+        "mnemonics": {m: dict(sorted(c.items())) for m, c in sorted(uses.items())},
+    }
+
+
+class TermCache:
+    """Cell terms by cell key, kept with the mtime they were read at."""
+
+    def __init__(self, path: Optional[Path]) -> None:
+        self.path = path
+        self._cells: Dict[str, Dict[str, Any]] = {}
+        self.hits = self.misses = 0
+        if path is not None:
+            try:
+                data = json.loads(path.read_text(encoding="utf-8"))
+                if isinstance(data, dict) and data.get("version") == SEARCH_INDEX_VERSION:
+                    self._cells = data.get("cells") or {}
+            except (OSError, ValueError):
+                pass
+
+    def get(self, cell_key: str, mtime: float, read_asm: Any) -> Dict[str, Any]:
+        """Terms of *cell_key*, from the cache if *mtime* matches, else from ``read_asm()``."""
+        cached = self._cells.get(cell_key)
+        if cached is not None and cached.get("mtime") == mtime:
+            self.hits += 1
+            return cached
+        self.misses += 1
+        terms = {"mtime": mtime, **cell_terms(read_asm() or "")}
+        self._cells[cell_key] = terms
+        return terms
+
+    def save(self, keep: Sequence[str]) -> None:
+        """Write the cache, dropping cells not in *keep*."""
+        if self.path is None:
+            return
+        wanted = set(keep)
+        cells = {k: v for k, v in sorted(self._cells.items()) if k in wanted}
+        self.path.parent.mkdir(parents=True, exist_ok=True)
+        tmp = self.path.with_name(self.path.name + ".tmp")
+        tmp.write_text(json.dumps({"version": SEARCH_INDEX_VERSION, "cells": cells}, separators=(",", ":")), encoding="utf-8")
+        os.replace(tmp, self.path)
+
+
+def build_index(pages: Sequence[Tuple[str, str, str, str, Dict[str, Any]]]) -> Dict[str, Any]:
+    """
+    The index of *pages*, given as (page path, source, compiler, scenario,
+    terms) with paths relative to docs/.
+    """
+    functions: Dict[str, List[int]] = {}
+    mnemonics: Dict[str, List[List[Any]]] = {}
+    rows: List[List[str]] = []
+    for i, (page, source, compiler_id, scenario, terms) in enumerate(pages):
+        rows.append([page, source, compiler_id, scenario])
+        for name in terms.get("functions", []):
+            functions.setdefault(name, []).append(i)
+        for mnem, by_function in terms.get("mnemonics", {}).items():
+            users = sorted(by_function.items(), key=lambda kv: (-kv[1], kv[0]))
+            mnemonics.setdefault(mnem, []).append([i, sum(by_function.values()), [list(u) for u in users]])
+    for postings in mnemonics.values():
+        postings.sort(key=lambda p: (-p[1], p[0]))
+    return {
+        "version": SEARCH_INDEX_VERSION,
+        "pages": rows,
+        "functions": dict(sorted(functions.items())),
+        "mnemonics": dict(sorted(mnemonics.items())),
+    }
+
+
+def page_path(cell_key: str) -> Tuple[str, str, str, str]:
+    """(book page, source, compiler, scenario) of a cell key such as ``cg152/O2/loops/unrollme-1``."""
+    compiler_id, scenario, source = cell_key.split("/", 2)
+    category, _, name = source.rpartition("/")
+    return f"{scenario}/{compiler_id}/{category or 'general'}/{name}.md", source, compiler_id, scenario
+
+
+def index_output_tree(root: Path, cache: Optional[Path] = None) -> Dict[str, Any]:
+    """The index of every compiled cell of an output tree, found through its manifest."""
+    from ce_manifest import read_manifest, scan_cells
+    from ce_store import open_outputs_for_reading
+
+    outputs = open_outputs_for_reading(root)
+    try:
+        cells = read_manifest(outputs)
+        if cells is None:
+            cells = scan_cells(outputs)
+        cell_keys = sorted(
+            (k for k, e in cells.items() if ".asm" in e.get("files", ()) and "@" not in k.rpartition("/")[2]),
+            key=lambda k: (page_path(k)[3], page_path(k)[2], page_path(k)[1]),
+        )
+        term_cache = TermCache(cache)
+        pages = []
+        for cell_key in cell_keys:
+            terms = term_cache.get(cell_key, cells[cell_key].get("mtime"), lambda: outputs.read_text(f"{cell_key}.asm"))
+            pages.append((*page_path(cell_key), terms))
+        term_cache.save(cell_keys)
+    finally:
+        outputs.close()
+    return build_index(pages)
+
+
+def load_index(path: Path) -> Dict[str, Any]:
+    """A written index; raises ValueError for one of another version."""
+    index = json.loads(Path(path).read_text(encoding="utf-8"))
+    if not isinstance(index, dict) or index.get("version") != SEARCH_INDEX_VERSION:
+        raise ValueError(f"{path}: not a version {SEARCH_INDEX_VERSION} assembly index, rebuild the book")
+    return index
+
+
+def _page_matches(row: List[str], compiler_id: Optional[str], scenario: Optional[str]) -> bool:
+    return (compiler_id is None or row[2] == compiler_id) and (scenario is None or row[3] == scenario)
+
+
+def find_instructions(
+    index: Dict[str, Any],
+    pattern: str,
+    compiler_id: Optional[str] = None,
+    scenario: Optional[str] = None,
+    function: Optional[str] = None,
+) -> List[Dict[str, Any]]:
+    """
+    Uses of the instructions matching glob *pattern*, one hit per page,
+    function and mnemonic: {"page", "source", "compiler", "scenario",
+    "function", "mnemonic", "count"}, most uses first. *function* is a glob
+    over function names.
+    """
+    pattern = pattern.strip().lower()
+    hits = []
+    for mnem, postings in index["mnemonics"].items():
+        if not fnmatch.fnmatchcase(mnem, pattern):
+            continue
+        for page, _, users in postings:
+            row = index["pages"][page]
+            if not _page_matches(row, compiler_id, scenario):
+                continue
+            for name, count in users:
+                if function is None or fnmatch.fnmatchcase(name, function):
+                    hits.append({
+                        "page": row[0], "source": row[1], "compiler": row[2], "scenario": row[3],
+                        "function": name, "mnemonic": mnem, "count": count,
+                    })
+    hits.sort(key=lambda h: (-h["count"], h["scenario"], h["compiler"], h["source"], h["function"], h["mnemonic"]))
+    return hits
+
+
+def find_functions(
+    index: Dict[str, Any],
+    pattern: str,
+    compiler_id: Optional[str] = None,
+    scenario: Optional[str] = None,
+) -> List[Dict[str, Any]]:
+    """Pages defining a function matching glob *pattern*: {"page", "source", "compiler", "scenario", "function"}."""
+    hits = []
+    for name, pages in index["functions"].items():
+        if not fnmatch.fnmatchcase(name, pattern):
+            continue
+        for page in pages:
+            row = index["pages"][page]
+            if _page_matches(row, compiler_id, scenario):
+                hits.append({"page": row[0], "source": row[1], "compiler": row[2], "scenario": row[3], "function": name})
+    hits.sort(key=lambda h: (h["function"], h["scenario"], h["compiler"], h["source"]))
+    return hits
+
+
+def main() -> int:
+    ap = argparse.ArgumentParser(description="Find where an instruction or function appears in the gallery's assembly")
+    ap.add_argument("pattern", help="Glob over mnemonics (e.g. 'cmov*', 'rep movsb'), or function names with --function")
+    src = ap.add_mutually_exclusive_group()
+    src.add_argument("--index", type=Path, default=None, help=f"Index written by build_book.py (default: {DEFAULT_INDEX})")
+    src.add_argument("--out", type=Path, default=None, help="Index an output tree (as passed to ce_batch.py --out) instead")
+    ap.add_argument("--compiler", default=None, help="Only this compiler id")
+    ap.add_argument("--scenario", default=None, help="Only this scenario")
+    ap.add_argument("--function", action="store_true", help="Match function names instead of instructions")
+    ap.add_argument("--limit", type=int, default=50, help="Hits to print (default: 50; 0 for all)")
+    ap.add_argument("--json", action="store_true", help="Print the hits as JSON")
+    args = ap.parse_args()
+
+    try:
+        if args.out is not None:
+            index = index_output_tree(args.out, cache=args.out / ".search-cache.json")
+        else:
+            index = load_index(args.index or DEFAULT_INDEX)
+    except (OSError, ValueError) as e:
+        raise SystemExit(f"ce_search: {e}") from e
+
+    if args.function:
+        hits = find_functions(index, args.pattern, args.compiler, args.scenario)
+    else:
+        hits = find_instructions(index, args.pattern, args.compiler, args.scenario)
+    shown = hits[:args.limit] if args.limit else hits
+    if args.json:
+        print(json.dumps(shown, indent=2))
+        return 0 if hits else 1
+    for h in shown:
+        uses = "" if args.function else f"{h['count']:>5}  {h['mnemonic']:<14} "
+        print(f"{uses}{h['compiler']:<12} {h['scenario']:<10} {h['source']:<40} {h['function']}")
+    pages = len({h["page"] for h in hits})
+    print(f"{len(hits)} hits on {pages} pages" + (f" (first {len(shown)} shown)" if len(shown) < len(hits) else ""))
+    return 0 if hits else 1
+
+
+__all__ = [
+    "DEFAULT_INDEX",
+    "SEARCH_INDEX_NAME",
+    "SEARCH_INDEX_VERSION",
+    "TermCache",
+    "build_index",
+    "cell_terms",
+    "find_functions",
+    "find_instructions",
+    "index_output_tree",
+    "instruction_terms",
+    "load_index",
+    "page_path",
+]
+
+
+if __name__ == "__main__":
+    raise SystemExit(main())
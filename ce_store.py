@@ -0,0 +1,361 @@
+# Copyright (c) 2026 Larry H <l.gr [at] dartmouth [dot] edu>
+# SPDX-License-Identifier: AGPL-3.0-or-later
+#
+# Compiler Optimization Gallery
+# Developed for COSC-69.16: Basics of Reverse Engineering
+# Dartmouth College, Winter 2026
+
+"""
+ce_store.py
+
+Output backends for per-cell results. ce_batch.py writes through one of these
+and build_book.py reads through the same interface, so neither needs to know
+which layout is on disk. Only depends on the standard library.
+
+- FileOutputs: the classic tree of 7 files per cell under <out>/.
+- PackedOutputs: a single SQLite file (<out>/gallery.sqlite). Contents are
+  zlib-compressed and stored once per distinct blob, so the source text that
+  is identical across all compiler/scenario cells is kept only once. JSON is
+  stored compact instead of pretty-printed.
+- TeeOutputs: writes to several backends (e.g. files + packed while
+  migrating); reads come from the first.
+
+All backends address entries by their path relative to the output root,
+e.g. ``"cg152/O2/loops/unrollme-1.asm"``. Path objects are taken as
+filesystem locations under the root and converted to that form.
+"""
+
+from __future__ import annotations
+
+import hashlib
+import json
+import sqlite3
+import threading
+import time
+import zlib
+from pathlib import Path
+from typing import Any, Iterator, List, Optional, Sequence, Union
+
+PACKED_NAME = "gallery.sqlite"
+
+PathLike = Union[str, Path]
+
+
+class OutputStore:
+    """Common interface of the output backends below."""
+
+    root: Path
+
+    def key(self, path: PathLike) -> str:
+        # A Path is a filesystem location under root; a str is already a key.
+        if isinstance(path, Path):
+            return path.resolve().relative_to(self.root).as_posix()
+        return path
+
+    def write_json(self, path: PathLike, obj: Any) -> None:
+        raise NotImplementedError
+
+    def write_text(self, path: PathLike, text: str) -> None:
+        raise NotImplementedError
+
+    def read_text(self, path: PathLike) -> Optional[str]:
+        raise NotImplementedError
+
+    def size(self, path: PathLike) -> Optional[int]:
+        raise NotImplementedError
+
+    def mtime(self, path: PathLike) -> float:
+        raise NotImplementedError
+
+    def iter_files(self, suffix: str = "", prefix: str = "") -> Iterator[str]:
+        """Relative paths of entries starting with *prefix* and ending in *suffix*, sorted."""
+        raise NotImplementedError
+
+    def delete(self, path: PathLike) -> bool:
+        """Remove one entry. Returns False if it did not exist."""
+        raise NotImplementedError
+
+    def close(self) -> None:
+        pass
+
+
+class FileOutputs(OutputStore):
+    """One file per output under *root* (the original layout)."""
+
+    def __init__(self, root: Path) -> None:
+        self.root = Path(root).resolve()
+
+    def _path(self, path: PathLike) -> Path:
+        return self.root / self.key(path)
+
+    def write_json(self, path: PathLike, obj: Any) -> None:
+        self.write_text(path, json.dumps(obj, indent=2, sort_keys=True) + "\n")
+
+    def write_text(self, path: PathLike, text: str) -> None:
+        p = self._path(path)
+        p.parent.mkdir(parents=True, exist_ok=True)
+        p.write_text(text, encoding="utf-8")
+
+    def read_text(self, path: PathLike) -> Optional[str]:
+        try:
+            return self._path(path).read_text(encoding="utf-8", errors="replace")
+        except FileNotFoundError:
+            return None
+
+    def size(self, path: PathLike) -> Optional[int]:
+        try:
+            return self._path(path).stat().st_size
+        except FileNotFoundError:
+            return None
+
+    def mtime(self, path: PathLike) -> float:
+        try:
+            return self._path(path).stat().st_mtime
+        except FileNotFoundError:
+            return 0.0
+
+    def iter_files(self, suffix: str = "", prefix: str = "") -> Iterator[str]:
+        # Glob from the deepest directory the prefix names; hidden dirs
+        # (.cache/, ...) are never part of the output set.
+        head, _, stem = prefix.rpartition("/")
+        base = self.root / head if head else self.root
+        if not base.is_dir():
+            return iter(())
+        found = []
+        for p in base.rglob(f"{stem}*{suffix}"):
+            rel = p.relative_to(self.root)
+            if p.is_file() and rel.as_posix().startswith(prefix) and not any(part.startswith(".") for part in rel.parts):
+                found.append(rel.as_posix())
+        return iter(sorted(found))
+
+    def delete(self, path: PathLike) -> bool:
+        try:
+            self._path(path).unlink()
+            return True
+        except FileNotFoundError:
+            return False
+
+
+class PackedOutputs(OutputStore):
+    """
+    Deduplicated, compressed single-file store backed by SQLite.
+
+    Schema:
+        blobs(hash PRIMARY KEY, size, data)      -- zlib(data), one row per distinct content
+        entries(path PRIMARY KEY, hash, mtime)   -- latest blob for each logical file
+
+    Rewriting an entry only moves its pointer; the file is a valid database
+    after every commit, so an interrupted run loses at most the entry being
+    written. One connection is shared by all worker threads behind a lock.
+    """
+
+    def __init__(self, root: Path, db_path: Optional[Path] = None, readonly: bool = False) -> None:
+        self.root = Path(root).resolve()
+        self.db_path = Path(db_path) if db_path else self.root / PACKED_NAME
+        self.readonly = readonly
+        self._lock = threading.Lock()
+        if readonly:
+            uri = f"file:{self.db_path}?mode=ro"
+            self._db = sqlite3.connect(uri, uri=True, check_same_thread=False)
+        else:
+            self.db_path.parent.mkdir(parents=True, exist_ok=True)
+            self._db = sqlite3.connect(str(self.db_path), check_same_thread=False)
+            self._db.execute("PRAGMA journal_mode=WAL")
+            self._db.execute("PRAGMA synchronous=NORMAL")
+            self._db.executescript(
+                """
+                CREATE TABLE IF NOT EXISTS blobs (
+                    hash TEXT PRIMARY KEY,
+                    size INTEGER NOT NULL,
+                    data BLOB NOT NULL
+                );
+                CREATE TABLE IF NOT EXISTS entries (
+                    path TEXT PRIMARY KEY,
+                    hash TEXT NOT NULL REFERENCES blobs(hash),
+                    mtime REAL NOT NULL
+                );
+                """
+            )
+            self._db.commit()
+
+    @staticmethod
+    def exists_in(root: Path) -> bool:
+        return (Path(root) / PACKED_NAME).is_file()
+
+    def write_json(self, path: PathLike, obj: Any) -> None:
+        self.write_text(path, json.dumps(obj, separators=(",", ":"), sort_keys=True))
+
+    def write_text(self, path: PathLike, text: str) -> None:
+        self.write_bytes(path, text.encode("utf-8"))
+
+    def write_bytes(self, path: PathLike, data: bytes) -> None:
+        digest = hashlib.sha256(data).hexdigest()
+        key = self.key(path)
+        with self._lock:
+            self._db.execute(
+                "INSERT OR IGNORE INTO blobs(hash, size, data) VALUES (?, ?, ?)",
+                (digest, len(data), zlib.compress(data, 6)),
+            )
+            self._db.execute(
+                "INSERT OR REPLACE INTO entries(path, hash, mtime) VALUES (?, ?, ?)",
+                (key, digest, time.time()),
+            )
+            self._db.commit()
+
+    def read_bytes(self, path: PathLike) -> Optional[bytes]:
+        with self._lock:
+            row = self._db.execute(
+                "SELECT b.data FROM entries e JOIN blobs b ON b.hash = e.hash WHERE e.path = ?",
+                (self.key(path),),
+            ).fetchone()
+        return zlib.decompress(row[0]) if row else None
+
+    def read_text(self, path: PathLike) -> Optional[str]:
+        data = self.read_bytes(path)
+        return data.decode("utf-8", errors="replace") if data is not None else None
+
+    def size(self, path: PathLike) -> Optional[int]:
+        with self._lock:
+            row = self._db.execute(
+                "SELECT b.size FROM entries e JOIN blobs b ON b.hash = e.hash WHERE e.path = ?",
+                (self.key(path),),
+            ).fetchone()
+        return row[0] if row else None
+
+    def mtime(self, path: PathLike) -> float:
+        with self._lock:
+            row = self._db.execute("SELECT mtime FROM entries WHERE path = ?", (self.key(path),)).fetchone()
+        return row[0] if row else 0.0
+
+    def iter_files(self, suffix: str = "", prefix: str = "") -> Iterator[str]:
+        with self._lock:
+            rows = self._db.execute(
+                "SELECT path FROM entries WHERE path LIKE ? ESCAPE '\\' ORDER BY path",
+                (_like_escape(prefix) + "%" + _like_escape(suffix),),
+            ).fetchall()
+        return iter([r[0] for r in rows])
+
+    def delete(self, path: PathLike) -> bool:
+        with self._lock:
+            cur = self._db.execute("DELETE FROM entries WHERE path = ?", (self.key(path),))
+            self._db.commit()
+        return cur.rowcount > 0
+
+    def vacuum(self) -> None:
+        """Drop blobs no entry points to any more and compact the file."""
+        with self._lock:
+            self._db.execute("DELETE FROM blobs WHERE hash NOT IN (SELECT hash FROM entries)")
+            self._db.commit()
+            self._db.execute("VACUUM")
+
+    def close(self) -> None:
+        with self._lock:
+            if not self.readonly:
+                # Leave a single self-contained file behind (no -wal/-shm).
+                self._db.execute("PRAGMA journal_mode=DELETE")
+            self._db.close()
+
+
+def _like_escape(s: str) -> str:
+    return s.replace("\\", "\\\\").replace("%", "\\%").replace("_", "\\_")
+
+
+class TeeOutputs(OutputStore):
+    """Write to every backend; read from the first."""
+
+    def __init__(self, backends: Sequence[OutputStore]) -> None:
+        if not backends:
+            raise ValueError("TeeOutputs needs at least one backend")
+        self.backends: List[OutputStore] = list(backends)
+        self.root = self.backends[0].root
+
+    def write_json(self, path: PathLike, obj: Any) -> None:
+        for b in self.backends:
+            b.write_json(path, obj)
+
+    def write_text(self, path: PathLike, text: str) -> None:
+        for b in self.backends:
+            b.write_text(path, text)
+
+    def read_text(self, path: PathLike) -> Optional[str]:
+        return self.backends[0].read_text(path)
+
+    def size(self, path: PathLike) -> Optional[int]:
+        return self.backends[0].size(path)
+
+    def mtime(self, path: PathLike) -> float:
+        return self.backends[0].mtime(path)
+
+    def iter_files(self, suffix: str = "", prefix: str = "") -> Iterator[str]:
+        return self.backends[0].iter_files(suffix, prefix)
+
+    def delete(self, path: PathLike) -> bool:
+        return any([b.delete(path) for b in self.backends])
+
+    def close(self) -> None:
+        for b in self.backends:
+            b.close()
+
+
+def open_outputs(root: Path, mode: str = "files") -> OutputStore:
+    """Backend for ``--store files|packed|both``."""
+    if mode == "files":
+        return FileOutputs(root)
+    if mode == "packed":
+        return PackedOutputs(root)
+    if mode == "both":
+        return TeeOutputs([FileOutputs(root), PackedOutputs(root)])
+    raise ValueError(f"Unknown output store mode: {mode}")
+
+
+def open_outputs_for_reading(root: Path) -> OutputStore:
+    """Prefer the packed store when one exists, else the file tree."""
+    if PackedOutputs.exists_in(root):
+        return PackedOutputs(root, readonly=True)
+    return FileOutputs(root)
+
+
+def pack_tree(root: Path) -> int:
+    """Copy an existing per-cell file tree under *root* into its packed store."""
+    files = FileOutputs(root)
+    packed = PackedOutputs(root)
+    count = 0
+    try:
+        for key in files.iter_files():
+            if "/" not in key or key == PACKED_NAME:
+                continue  # top-level README and the store itself
+            packed.write_bytes(key, (files.root / key).read_bytes())
+            count += 1
+    finally:
+        packed.close()
+    return count
+
+
+__all__ = [
+    "PACKED_NAME",
+    "OutputStore",
+    "FileOutputs",
+    "PackedOutputs",
+    "TeeOutputs",
+    "open_outputs",
+    "open_outputs_for_reading",
+    "pack_tree",
+]
+
+
+if __name__ == "__main__":
+    import argparse
+
+    ap = argparse.ArgumentParser(description="Maintain the packed output store")
+    ap.add_argument("command", choices=["pack", "vacuum"], help="pack: import an existing file tree; vacuum: drop unreferenced blobs")
+    ap.add_argument("out", help="Output directory root (as passed to ce_batch.py --out)")
+    args = ap.parse_args()
+
+    out = Path(args.out)
+    if args.command == "pack":
+        print(f"Packed {pack_tree(out)} files into {out / PACKED_NAME}")
+    else:
+        store = PackedOutputs(out)
+        store.vacuum()
+        store.close()
+        print(f"Vacuumed {out / PACKED_NAME}")
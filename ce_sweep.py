@@ -0,0 +1,184 @@
+# Copyright (c) 2026 Larry H <l.gr [at] dartmouth [dot] edu>
+# SPDX-License-Identifier: AGPL-3.0-or-later
+#
+# Compiler Optimization Gallery
+# Developed for COSC-69.16: Basics of Reverse Engineering
+# Dartmouth College, Winter 2026
+
+"""
+ce_sweep.py
+
+Flag-sweep scenarios. A ``sweeps`` mapping in config.yaml expands a flag
+matrix into ordinary scenarios, one per point:
+
+    sweeps:
+      vec:
+        title: "What unlocks vectorization"     # optional
+        base: "-O2"
+        axes:
+          - ["-march=x86-64", "-march=x86-64-v3", "-march=native"]
+          - ["-fno-tree-vectorize", ""]          # "" leaves the axis out
+        compilers: [cg152, clang1910]            # optional; default all
+        sources: ["simd/*"]                      # optional globs; default all
+
+gives six scenarios named ``vec_march-x86-64_fno-tree-vectorize``,
+``vec_march-x86-64_base``, ... with flags ``-O2 -march=x86-64
+-fno-tree-vectorize`` and so on.
+
+Two points are neighbours when they differ on exactly one axis. ce_batch.py
+prunes a point whose assembly matches an earlier neighbour's: it is not
+explained and keeps no outputs, and the sweep record
+``<compiler>/_sweeps/<sweep>/<rel path>.sweep.json`` sends it to the point it
+matches. build_book.py turns the records into one page per sweep, which
+shows at a glance which flag changed the code. Only depends on the standard
+library.
+"""
+
+from __future__ import annotations
+
+import fnmatch
+import hashlib
+import itertools
+import re
+from dataclasses import dataclass
+from typing import Any, Dict, List, Optional, Sequence, Tuple
+
+SWEEP_SUFFIX = ".sweep.json"
+SWEEP_DIR = "_sweeps"
+
+
+class SweepError(ValueError):
+    pass
+
+
+@dataclass(frozen=True)
+class SweepPoint:
+    sweep: str
+    name: str                   # scenario name
+    flags: str
+    coords: Tuple[int, ...]     # index into each axis
+    values: Tuple[str, ...]     # the chosen value of each axis
+
+
+@dataclass(frozen=True)
+class Sweep:
+    name: str
+    title: str
+    description: str
+    base: str
+    axes: Tuple[Tuple[str, ...], ...]
+    points: Tuple[SweepPoint, ...]
+    compilers: Optional[Tuple[str, ...]] = None   # None: every configured compiler
+    sources: Optional[Tuple[str, ...]] = None     # globs over source keys; None: all
+
+    def applies_to(self, compiler_id: str, source: str) -> bool:
+        """Whether the sweep runs for *compiler_id* and *source* (e.g. "simd/auto-vectorize")."""
+        if self.compilers is not None and compiler_id not in self.compilers:
+            return False
+        return self.sources is None or any(fnmatch.fnmatchcase(source, g) for g in self.sources)
+
+
+def _slug(value: str) -> str:
+    return re.sub(r"[^A-Za-z0-9.+]+", "-", value).strip("-") or "base"
+
+
+def expand_sweeps(raw: Any) -> List[Sweep]:
+    """Parse the config's ``sweeps`` mapping (None or empty: no sweeps)."""
+    if not raw:
+        return []
+    if not isinstance(raw, dict):
+        raise SweepError("'sweeps' must be a mapping of sweep name to spec")
+    sweeps = []
+    for name, spec in raw.items():
+        if not isinstance(name, str) or not re.fullmatch(r"[A-Za-z0-9][\w.+-]*", name):
+            raise SweepError(f"Sweep name {name!r} must be a plain identifier")
+        if not isinstance(spec, dict):
+            raise SweepError(f"Sweep '{name}' must be a mapping with 'axes'")
+        base = spec.get("base", "")
+        axes_raw = spec.get("axes")
+        if not isinstance(base, str):
+            raise SweepError(f"Sweep '{name}': 'base' must be a string")
+        if (
+            not isinstance(axes_raw, list) or not axes_raw
+            or not all(isinstance(a, list) and a and all(isinstance(v, str) for v in a) for a in axes_raw)
+        ):
+            raise SweepError(f"Sweep '{name}': 'axes' must be a non-empty list of non-empty lists of strings")
+        axes = tuple(tuple(v.strip() for v in axis) for axis in axes_raw)
+        filters: Dict[str, Optional[Tuple[str, ...]]] = {}
+        for key in ("compilers", "sources"):
+            value = spec.get(key)
+            if value is not None and (not isinstance(value, list) or not all(isinstance(v, str) for v in value)):
+                raise SweepError(f"Sweep '{name}': '{key}' must be a list of strings")
+            filters[key] = tuple(value) if value is not None else None
+
+        points = []
+        seen: Dict[str, Tuple[str, ...]] = {}
+        for coords in itertools.product(*(range(len(a)) for a in axes)):
+            values = tuple(axes[i][c] for i, c in enumerate(coords))
+            point_name = f"{name}_" + "_".join(_slug(v) for v in values)
+            if point_name in seen:
+                raise SweepError(f"Sweep '{name}': {values} and {seen[point_name]} both map to '{point_name}'")
+            seen[point_name] = values
+            flags = " ".join(f for f in (base, *values) if f)
+            points.append(SweepPoint(sweep=name, name=point_name, flags=flags, coords=coords, values=values))
+
+        sweeps.append(Sweep(
+            name=name,
+            title=str(spec.get("title", name)),
+            description=str(spec.get("description", "")).strip(),
+            base=base,
+            axes=axes,
+            points=tuple(points),
+            compilers=filters["compilers"],
+            sources=filters["sources"],
+        ))
+    return sweeps
+
+
+def are_neighbours(a: SweepPoint, b: SweepPoint) -> bool:
+    return sum(x != y for x, y in zip(a.coords, b.coords)) == 1
+
+
+def asm_fingerprint(asm_text: str) -> str:
+    """Hash of a listing with whitespace differences removed."""
+    normalized = "\n".join(" ".join(line.split()) for line in asm_text.splitlines() if line.strip())
+    return hashlib.sha256(normalized.encode("utf-8")).hexdigest()
+
+
+def prune_points(points: Sequence[SweepPoint], fingerprints: Dict[str, str]) -> Dict[str, Optional[str]]:
+    """
+    For each point with a fingerprint (points missing one were not
+    compiled): None if it is kept, else the kept point its assembly matches
+    through a chain of earlier neighbours.
+    """
+    same_as: Dict[str, Optional[str]] = {}
+    done: List[SweepPoint] = []
+    for p in points:
+        fp = fingerprints.get(p.name)
+        if fp is None:
+            continue
+        same_as[p.name] = None
+        for q in done:
+            if fingerprints[q.name] == fp and are_neighbours(p, q):
+                same_as[p.name] = same_as[q.name] or q.name
+                break
+        done.append(p)
+    return same_as
+
+
+def sweep_record_key(compiler_id: str, sweep: str, rel_path: str) -> str:
+    return f"{compiler_id}/{SWEEP_DIR}/{sweep}/{rel_path}{SWEEP_SUFFIX}"
+
+
+__all__ = [
+    "SWEEP_DIR",
+    "SWEEP_SUFFIX",
+    "Sweep",
+    "SweepError",
+    "SweepPoint",
+    "are_neighbours",
+    "asm_fingerprint",
+    "expand_sweeps",
+    "prune_points",
+    "sweep_record_key",
+]
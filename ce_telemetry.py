@@ -0,0 +1,290 @@
+#!/usr/bin/env python3
+# Copyright (c) 2026 Larry H <l.gr [at] dartmouth [dot] edu>
+# SPDX-License-Identifier: AGPL-3.0-or-later
+#
+# Compiler Optimization Gallery
+# Developed for COSC-69.16: Basics of Reverse Engineering
+# Dartmouth College, Winter 2026
+
+"""
+ce_telemetry.py
+
+Structured run telemetry for ce_batch.py. A Telemetry object collects:
+
+- events: spans (compile units, explain calls, HTTP requests), instants
+  (cache lookups, retries), async spans (time an explain job sat in the
+  queue) and counter samples (queue depth). With ``--trace PATH`` they are
+  streamed as JSONL, one event per line:
+
+      {"ph": "X", "name": "request", "cat": "http", "ts": 1.234, "dur": 0.087,
+       "thread": "compile-0", "args": {"endpoint": "POST explain /", "status": 200}}
+
+  ``ts`` and ``dur`` are seconds since the start of the run, which the first
+  line (``"ph": "M"``, ``"name": "run"``) gives as a Unix time. ``ph`` uses
+  the Chrome trace event phases, and ``--chrome-trace PATH`` writes the same
+  events in the Chrome trace format that chrome://tracing and
+  https://ui.perfetto.dev open: one track per worker thread, so compile and
+  explain stalls show up as gaps.
+
+- metrics: counters and latency summaries, written by ``--metrics-file PATH``
+  as an OpenMetrics text file (e.g. for node_exporter's textfile collector)
+  so successive runs can be graphed.
+
+An existing JSONL trace converts to a Chrome trace with:
+
+    python3 ce_telemetry.py trace.jsonl trace.json
+
+Only depends on the standard library.
+"""
+
+from __future__ import annotations
+
+import argparse
+import itertools
+import json
+import threading
+import time
+from contextlib import contextmanager
+from pathlib import Path
+from typing import Any, Dict, Iterable, Iterator, List, Optional, TextIO, Tuple
+
+# HELP lines of the OpenMetrics families; every metric must be listed here.
+METRIC_HELP = {
+    "ce_batch_stage_seconds": "Wall time per pipeline job, by stage (compile unit, explain call, explain queue wait)",
+    "ce_batch_request_seconds": "HTTP request latency, by endpoint",
+    "ce_batch_requests": "HTTP requests sent, retries included, by endpoint",
+    "ce_batch_request_bytes": "HTTP request body bytes sent (after gzip), by endpoint",
+    "ce_batch_retries": "Requests retried after 429/5xx or connection errors, by endpoint",
+    "ce_batch_cache_lookups": "Local response cache lookups, by kind and result",
+    "ce_batch_cells": "Cells that finished a stage",
+    "ce_batch_run_seconds": "Wall time of the run",
+    "ce_batch_run_timestamp_seconds": "Unix time the run started",
+}
+
+Labels = Tuple[Tuple[str, str], ...]
+
+_QUANTILES = (0.5, 0.95, 0.99)
+
+
+def _labels(labels: Dict[str, Any]) -> Labels:
+    return tuple(sorted((k, str(v)) for k, v in labels.items()))
+
+
+def _escape(value: str) -> str:
+    return value.replace("\\", "\\\\").replace('"', '\\"').replace("\n", "\\n")
+
+
+class Telemetry:
+    """
+    Thread-safe event and metric recorder. Events are only kept when a
+    trace is written (a ``jsonl_path`` streams them as they happen,
+    ``keep_events`` holds them for write_chrome_trace()); metrics are always
+    kept and cost a few dict updates per event.
+    """
+
+    def __init__(self, jsonl_path: Optional[Path] = None, keep_events: bool = False) -> None:
+        self.start_monotonic = time.monotonic()
+        self.start_unix = time.time()
+        self._lock = threading.Lock()
+        self._events: Optional[List[Dict[str, Any]]] = [] if keep_events else None
+        self._counters: Dict[Tuple[str, Labels], float] = {}
+        self._summaries: Dict[Tuple[str, Labels], List[float]] = {}
+        self._gauges: Dict[Tuple[str, Labels], float] = {}
+        self._async_ids = itertools.count(1)
+        self._jsonl: Optional[TextIO] = None
+        if jsonl_path is not None:
+            jsonl_path = Path(jsonl_path)
+            jsonl_path.parent.mkdir(parents=True, exist_ok=True)
+            self._jsonl = jsonl_path.open("w", encoding="utf-8")
+        self._emit({"ph": "M", "name": "run", "ts": 0.0, "args": {"start": self.start_unix}})
+
+    @property
+    def tracing(self) -> bool:
+        return self._jsonl is not None or self._events is not None
+
+    def now(self) -> float:
+        """Seconds since the start of the run."""
+        return time.monotonic() - self.start_monotonic
+
+    def _emit(self, event: Dict[str, Any]) -> None:
+        if not self.tracing:
+            return
+        event.setdefault("thread", threading.current_thread().name)
+        with self._lock:
+            if self._events is not None:
+                self._events.append(event)
+            if self._jsonl is not None:
+                self._jsonl.write(json.dumps(event, separators=(",", ":")) + "\n")
+
+    # ---- events ----
+
+    @contextmanager
+    def span(self, name: str, cat: str, **args: Any) -> Iterator[Dict[str, Any]]:
+        """Time the block as one complete event; the yielded dict takes more args."""
+        start = self.now()
+        try:
+            yield args
+        finally:
+            self._emit({"ph": "X", "name": name, "cat": cat, "ts": start, "dur": self.now() - start, "args": args})
+
+    def complete(self, name: str, cat: str, start: float, dur: float, **args: Any) -> None:
+        """A span measured by the caller (*start* as returned by now())."""
+        self._emit({"ph": "X", "name": name, "cat": cat, "ts": start, "dur": dur, "args": args})
+
+    def instant(self, name: str, cat: str, **args: Any) -> None:
+        self._emit({"ph": "i", "name": name, "cat": cat, "ts": self.now(), "args": args})
+
+    def async_span(self, name: str, cat: str, start: float, end: float, **args: Any) -> None:
+        """A span that may overlap others of its kind (Perfetto gives each its own row)."""
+        if not self.tracing:
+            return
+        span_id = next(self._async_ids)
+        self._emit({"ph": "b", "name": name, "cat": cat, "ts": start, "id": span_id, "args": args})
+        self._emit({"ph": "e", "name": name, "cat": cat, "ts": end, "id": span_id, "args": {}})
+
+    def sample(self, name: str, **values: float) -> None:
+        """Counter track sample, e.g. queue depth."""
+        self._emit({"ph": "C", "name": name, "cat": "counter", "ts": self.now(), "args": values})
+
+    # ---- metrics ----
+
+    def count(self, name: str, amount: float = 1, **labels: Any) -> None:
+        key = (name, _labels(labels))
+        with self._lock:
+            self._counters[key] = self._counters.get(key, 0) + amount
+
+    def observe(self, name: str, seconds: float, **labels: Any) -> None:
+        key = (name, _labels(labels))
+        with self._lock:
+            self._summaries.setdefault(key, []).append(seconds)
+
+    def gauge(self, name: str, value: float, **labels: Any) -> None:
+        with self._lock:
+            self._gauges[(name, _labels(labels))] = value
+
+    # ---- output ----
+
+    def close(self) -> None:
+        with self._lock:
+            if self._jsonl is not None:
+                self._jsonl.close()
+                self._jsonl = None
+
+    def write_chrome_trace(self, path: Path) -> None:
+        with self._lock:
+            events = list(self._events or [])
+        write_chrome_trace(events, path)
+
+    def openmetrics_text(self) -> str:
+        with self._lock:
+            counters = dict(self._counters)
+            summaries = {k: sorted(v) for k, v in self._summaries.items()}
+            gauges = dict(self._gauges)
+
+        def fmt_labels(labels: Labels, extra: Labels = ()) -> str:
+            items = labels + extra
+            if not items:
+                return ""
+            return "{" + ",".join(f'{k}="{_escape(v)}"' for k, v in items) + "}"
+
+        families: Dict[str, List[str]] = {}
+        types: Dict[str, str] = {}
+        for (name, labels), value in sorted(counters.items()):
+            types[name] = "counter"
+            families.setdefault(name, []).append(f"{name}_total{fmt_labels(labels)} {value:g}")
+        for (name, labels), xs in sorted(summaries.items()):
+            types[name] = "summary"
+            lines = families.setdefault(name, [])
+            for q in _QUANTILES:
+                value = xs[min(len(xs) - 1, int(q * len(xs)))]
+                lines.append(f"{name}{fmt_labels(labels, (('quantile', str(q)),))} {value:.6f}")
+            lines.append(f"{name}_sum{fmt_labels(labels)} {sum(xs):.6f}")
+            lines.append(f"{name}_count{fmt_labels(labels)} {len(xs)}")
+        for (name, labels), value in sorted(gauges.items()):
+            types[name] = "gauge"
+            families.setdefault(name, []).append(f"{name}{fmt_labels(labels)} {value:.6f}")
+
+        out = []
+        for name in sorted(families):
+            if name not in METRIC_HELP:
+                raise KeyError(f"metric {name} has no METRIC_HELP entry")
+            out.append(f"# TYPE {name} {types[name]}")
+            out.append(f"# HELP {name} {METRIC_HELP[name]}")
+            out.extend(families[name])
+        out.append("# EOF")
+        return "\n".join(out) + "\n"
+
+    def write_openmetrics(self, path: Path) -> None:
+        path = Path(path)
+        path.parent.mkdir(parents=True, exist_ok=True)
+        # Textfile collectors may read at any moment: write, then rename.
+        tmp = path.with_name(path.name + ".tmp")
+        tmp.write_text(self.openmetrics_text(), encoding="utf-8")
+        tmp.replace(path)
+
+
+def chrome_trace_events(events: Iterable[Dict[str, Any]]) -> List[Dict[str, Any]]:
+    """Convert telemetry events (seconds, thread names) to Chrome trace events."""
+    tids: Dict[str, int] = {}
+    out: List[Dict[str, Any]] = []
+    for ev in events:
+        if ev.get("ph") == "M":
+            continue
+        thread = str(ev.get("thread", "main"))
+        if thread not in tids:
+            tids[thread] = len(tids) + 1
+            out.append({"ph": "M", "name": "thread_name", "pid": 1, "tid": tids[thread], "args": {"name": thread}})
+        converted = {
+            "ph": ev["ph"], "name": ev["name"], "cat": ev.get("cat", ""),
+            "ts": round(float(ev["ts"]) * 1e6, 1), "pid": 1, "tid": tids[thread], "args": ev.get("args", {}),
+        }
+        if "dur" in ev:
+            converted["dur"] = round(float(ev["dur"]) * 1e6, 1)
+        if "id" in ev:
+            converted["id"] = ev["id"]
+        if ev["ph"] == "i":
+            converted["s"] = "t"
+        out.append(converted)
+    out.insert(0, {"ph": "M", "name": "process_name", "pid": 1, "args": {"name": "ce_batch.py"}})
+    return out
+
+
+def write_chrome_trace(events: Iterable[Dict[str, Any]], path: Path) -> None:
+    path = Path(path)
+    path.parent.mkdir(parents=True, exist_ok=True)
+    path.write_text(
+        json.dumps({"traceEvents": chrome_trace_events(events), "displayTimeUnit": "ms"}, separators=(",", ":")),
+        encoding="utf-8",
+    )
+
+
+def main() -> int:
+    ap = argparse.ArgumentParser(description="Convert a ce_batch.py JSONL trace to a Chrome/Perfetto trace")
+    ap.add_argument("trace", help="JSONL trace written by ce_batch.py --trace")
+    ap.add_argument("output", help="Chrome trace JSON to write")
+    args = ap.parse_args()
+
+    events = []
+    with open(args.trace, encoding="utf-8") as f:
+        for line in f:
+            line = line.strip()
+            if line:
+                try:
+                    events.append(json.loads(line))
+                except ValueError:
+                    pass  # a run killed mid-write leaves a partial last line
+    write_chrome_trace(events, Path(args.output))
+    print(f"Wrote {len(events)} events to {args.output}")
+    return 0
+
+
+__all__ = [
+    "METRIC_HELP",
+    "Telemetry",
+    "chrome_trace_events",
+    "write_chrome_trace",
+]
+
+
+if __name__ == "__main__":
+    raise SystemExit(main())
@@ -0,0 +1,199 @@
+# Copyright (c) 2026 Larry H <l.gr [at] dartmouth [dot] edu>
+# SPDX-License-Identifier: AGPL-3.0-or-later
+#
+# Compiler Optimization Gallery
+# Developed for COSC-69.16: Basics of Reverse Engineering
+# Dartmouth College, Winter 2026
+
+"""
+ce_transport.py
+
+HTTP transports for CompilerExplorerClient. Pacing, retries and caching all
+stay in the client; a transport only moves bytes.
+
+- RequestsTransport: one requests.Session (HTTP/1.1 keep-alive) shared by
+  every worker, with a connection pool per host sized to the concurrency cap.
+- HttpxTransport: httpx with HTTP/2, so all workers multiplex their requests
+  over a single connection per host. Needs ``pip install 'httpx[http2]'``.
+
+``make_transport("auto", ...)`` picks HTTP/2 when httpx and h2 are installed
+and falls back to requests otherwise.
+
+LatencyStats records wall time per endpoint for the end-of-run summary.
+"""
+
+from __future__ import annotations
+
+import json
+import threading
+from concurrent.futures import ThreadPoolExecutor
+from dataclasses import dataclass
+from typing import Any, Dict, List, Mapping, Optional
+
+
+class TransportError(RuntimeError):
+    """Connection-level failure (refused, reset, timed out); safe to retry."""
+
+
+@dataclass
+class TransportResponse:
+    status_code: int
+    headers: Mapping[str, str]  # case-insensitive mapping from the HTTP library
+    content: bytes
+
+    @property
+    def text(self) -> str:
+        return self.content.decode("utf-8", errors="replace")
+
+    def json(self) -> Any:
+        return json.loads(self.content)
+
+
+class Transport:
+    """Interface shared by the transports below."""
+
+    name = "base"
+
+    def request(
+        self,
+        method: str,
+        url: str,
+        *,
+        headers: Optional[Dict[str, str]] = None,
+        params: Optional[Dict[str, str]] = None,
+        content: Optional[bytes] = None,
+        timeout: float = 60.0,
+    ) -> TransportResponse:
+        raise NotImplementedError
+
+    def warm_up(self, url: str, connections: int = 1, timeout: float = 10.0) -> None:
+        """Open connections to *url*'s host ahead of the first real request."""
+        def ping(_: int) -> None:
+            try:
+                self.request("HEAD", url, timeout=timeout)
+            except TransportError:
+                pass  # warm-up is best effort; real requests retry on their own
+
+        connections = max(1, connections)
+        if connections == 1:
+            ping(0)
+            return
+        with ThreadPoolExecutor(max_workers=connections) as pool:
+            list(pool.map(ping, range(connections)))
+
+    def close(self) -> None:
+        pass
+
+
+class RequestsTransport(Transport):
+    name = "requests (HTTP/1.1)"
+
+    def __init__(self, pool_maxsize: int = 4, hosts: int = 2) -> None:
+        import requests
+        from requests.adapters import HTTPAdapter
+
+        self._requests = requests
+        self._session = requests.Session()
+        # Size the pools to the concurrency cap so workers reuse keep-alive
+        # connections instead of opening (and discarding) new ones.
+        adapter = HTTPAdapter(pool_connections=max(1, hosts), pool_maxsize=max(1, pool_maxsize))
+        self._session.mount("https://", adapter)
+        self._session.mount("http://", adapter)
+
+    def request(self, method, url, *, headers=None, params=None, content=None, timeout=60.0):
+        try:
+            r = self._session.request(method, url, headers=headers, params=params, data=content, timeout=timeout)
+        except (self._requests.ConnectionError, self._requests.Timeout) as e:
+            raise TransportError(str(e)) from e
+        return TransportResponse(status_code=r.status_code, headers=r.headers, content=r.content)
+
+
+class HttpxTransport(Transport):
+    name = "httpx (HTTP/2)"
+
+    def __init__(self, max_connections: int = 4) -> None:
+        import httpx
+
+        self._httpx = httpx
+        # With HTTP/2 every in-flight request to a host shares one
+        # connection; the limit only matters for HTTP/1.1 fallbacks.
+        self._client = httpx.Client(
+            http2=True,
+            limits=httpx.Limits(max_connections=max(1, max_connections) * 2, max_keepalive_connections=max(1, max_connections)),
+        )
+
+    def request(self, method, url, *, headers=None, params=None, content=None, timeout=60.0):
+        try:
+            r = self._client.request(method, url, headers=headers, params=params, content=content, timeout=timeout)
+        except self._httpx.TransportError as e:
+            raise TransportError(str(e)) from e
+        return TransportResponse(status_code=r.status_code, headers=r.headers, content=r.content)
+
+    def warm_up(self, url: str, connections: int = 1, timeout: float = 10.0) -> None:
+        super().warm_up(url, 1, timeout)  # one multiplexed connection per host
+
+    def close(self) -> None:
+        self._client.close()
+
+
+def http2_available() -> bool:
+    try:
+        import h2  # noqa: F401
+        import httpx  # noqa: F401
+    except ImportError:
+        return False
+    return True
+
+
+def make_transport(kind: str = "auto", max_per_host: int = 4) -> Transport:
+    """Transport for ``--transport auto|requests|httpx``."""
+    if kind == "auto":
+        kind = "httpx" if http2_available() else "requests"
+    if kind == "httpx":
+        if not http2_available():
+            raise SystemExit("--transport httpx needs httpx with HTTP/2 support: pip install 'httpx[http2]'")
+        return HttpxTransport(max_connections=max_per_host)
+    if kind == "requests":
+        return RequestsTransport(pool_maxsize=max_per_host)
+    raise ValueError(f"Unknown transport: {kind}")
+
+
+class LatencyStats:
+    """Thread-safe per-endpoint request latencies (seconds, wall clock)."""
+
+    def __init__(self) -> None:
+        self._samples: Dict[str, List[float]] = {}
+        self._lock = threading.Lock()
+
+    def record(self, endpoint: str, seconds: float) -> None:
+        with self._lock:
+            self._samples.setdefault(endpoint, []).append(seconds)
+
+    @staticmethod
+    def _pct(sorted_samples: List[float], q: float) -> float:
+        idx = min(len(sorted_samples) - 1, int(q * len(sorted_samples)))
+        return sorted_samples[idx]
+
+    def summary_lines(self) -> List[str]:
+        with self._lock:
+            items = {k: sorted(v) for k, v in self._samples.items()}
+        lines = []
+        for endpoint, xs in sorted(items.items()):
+            mean = sum(xs) / len(xs)
+            lines.append(
+                f"  {endpoint}: n={len(xs)} mean {mean * 1000:.0f}ms "
+                f"p50 {self._pct(xs, 0.5) * 1000:.0f}ms p95 {self._pct(xs, 0.95) * 1000:.0f}ms "
+                f"max {xs[-1] * 1000:.0f}ms"
+            )
+        return lines
+
+
+__all__ = [
+    "LatencyStats",
+    "HttpxTransport",
+    "RequestsTransport",
+    "Transport",
+    "TransportError",
+    "TransportResponse",
+    "make_transport",
+]
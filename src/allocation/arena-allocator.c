@@ -0,0 +1,113 @@
+/* @gallery-hints
+ *   bench: list_sum_malloc(n); list_sum_arena(n)
+ *   bench-sizes: 1024, 65536, 1048576
+ *   bench-counters: yes
+ */
+
+/*
+ * A bump (arena) allocator against one malloc per object.
+ *
+ * Building a linked list node by node calls malloc n times and free n
+ * times. None of those calls can be elided (see malloc-elision.c): the
+ * nodes point at each other, so the memory escapes into the list. Each
+ * call costs tens of instructions in the allocator, takes a lock or a
+ * thread cache lookup, and adds a header per node, which spreads the
+ * nodes out and costs cache misses when the list is walked.
+ *
+ * An arena grabs one block up front and hands out memory by bumping a
+ * pointer: allocation is an add and a compare, inlined at the call site,
+ * the nodes sit next to each other in allocation order, and everything is
+ * released by one free of the block. What it gives up is freeing
+ * individual objects, which suits data with one lifetime (a parse tree, a
+ * frame's temporaries, a request's state).
+ *
+ * Look for the call to malloc inside list_sum_malloc's first loop, and
+ * its absence from list_sum_arena's: arena_alloc is inlined into a few
+ * instructions.
+ */
+#include <stddef.h>
+#include <stdlib.h>
+
+struct node {
+    struct node *next;
+    long value;
+};
+
+struct arena {
+    char *base;
+    size_t used;
+    size_t size;
+};
+
+static int arena_init(struct arena *a, size_t size)
+{
+    a->base = malloc(size);
+    a->used = 0;
+    a->size = size;
+    return a->base != NULL;
+}
+
+/* Bump allocation: round up to the alignment (a power of two), then advance */
+static void *arena_alloc(struct arena *a, size_t size, size_t align)
+{
+    size_t offset = (a->used + (align - 1)) & ~(align - 1);
+    if (offset + size > a->size)
+        return NULL;
+    a->used = offset + size;
+    return a->base + offset;
+}
+
+static void arena_release(struct arena *a)
+{
+    free(a->base);
+    a->base = NULL;
+}
+
+static long list_sum(const struct node *head)
+{
+    long sum = 0;
+    for (const struct node *p = head; p; p = p->next)
+        sum += p->value;
+    return sum;
+}
+
+long list_sum_malloc(long n)
+{
+    struct node *head = NULL;
+    for (long i = 0; i < n; i++) {
+        struct node *node = malloc(sizeof *node);
+        if (!node)
+            break;
+        node->value = i;
+        node->next = head;
+        head = node;
+    }
+    long sum = list_sum(head);
+    while (head) {
+        struct node *next = head->next;
+        free(head);
+        head = next;
+    }
+    return sum;
+}
+
+long list_sum_arena(long n)
+{
+    struct arena arena;
+    struct node *head = NULL;
+    /* malloc's block is aligned for any type, and sizeof is a multiple of
+     * the alignment, so n nodes fit exactly. */
+    if (!arena_init(&arena, (size_t)n * sizeof(struct node)))
+        return -1;
+    for (long i = 0; i < n; i++) {
+        struct node *node = arena_alloc(&arena, sizeof *node, _Alignof(struct node));
+        if (!node)
+            break;
+        node->value = i;
+        node->next = head;
+        head = node;
+    }
+    long sum = list_sum(head);
+    arena_release(&arena);              /* every node at once */
+    return sum;
+}
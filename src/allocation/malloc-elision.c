@@ -0,0 +1,120 @@
+/* @gallery-hints
+ *   bench: scratch_sum_heap(i32[], n); scratch_sum_heap_checked(i32[], n); scratch_sum_stack(i32[], n); scratch_sum_escaped(i32[], n)
+ *   bench-sizes: 1024, 65536
+ *   bench-stubs: observe(i64)
+ */
+
+/*
+ * Eliding malloc/free pairs and promoting heap memory to registers.
+ *
+ * malloc and free are library functions, but the C standard pins down
+ * their behaviour, and GCC and Clang treat them as builtins. An allocation
+ * that never escapes the function and whose only "use" is being freed
+ * again can be removed entirely, and memory that is written and read back
+ * before its free can be kept in registers like a local variable.
+ *
+ *   unused_allocation     malloc + free and nothing else: both calls go
+ *                         (GCC and Clang at -O1 and up)
+ *   round_trip            store, load, free: folded to "return x"
+ *   round_trip_checked    the same with a null check. Clang folds the check
+ *                         away along with the allocation; GCC (12, at
+ *                         least) sees the pointer compared and keeps both
+ *                         calls
+ *   scratch_sum_heap      a small per-element scratch buffer: one
+ *                         malloc/free per iteration, unless it is elided
+ *   scratch_sum_heap_checked  the same with a null check
+ *   scratch_sum_stack     the same buffer as a local array, as the baseline
+ *   scratch_sum_escaped   the pointer reaches an extern function, so the
+ *                         allocation can never be removed
+ *
+ * The benchmarks show the difference when the optimizer makes it:
+ * scratch_sum_heap runs as fast as the stack version where the allocation
+ * is gone, and pays a malloc/free per element where it is not. At -O0, or
+ * with -fno-builtin-malloc (and in freestanding builds), every call stays.
+ */
+#include <stdlib.h>
+
+void observe(long long value);  /* defined elsewhere: the pointer escapes */
+
+int unused_allocation(void)
+{
+    int *p = malloc(64);
+    free(p);
+    return 0;
+}
+
+int round_trip(int x)
+{
+    int *p = malloc(sizeof *p);
+    *p = x;
+    int result = *p;
+    free(p);
+    return result;
+}
+
+int round_trip_checked(int x)
+{
+    int *p = malloc(sizeof *p);
+    if (!p)
+        return -1;
+    *p = x;
+    int result = *p;
+    free(p);
+    return result;
+}
+
+int scratch_sum_heap(const int *src, int n)
+{
+    int total = 0;
+    for (int i = 0; i < n; i++) {
+        int *tmp = malloc(4 * sizeof *tmp);
+        for (int k = 0; k < 4; k++)
+            tmp[k] = src[i] >> k;
+        total += tmp[0] + tmp[1] + tmp[2] + tmp[3];
+        free(tmp);
+    }
+    return total;
+}
+
+int scratch_sum_heap_checked(const int *src, int n)
+{
+    int total = 0;
+    for (int i = 0; i < n; i++) {
+        int *tmp = malloc(4 * sizeof *tmp);
+        if (!tmp)
+            return -1;
+        for (int k = 0; k < 4; k++)
+            tmp[k] = src[i] >> k;
+        total += tmp[0] + tmp[1] + tmp[2] + tmp[3];
+        free(tmp);
+    }
+    return total;
+}
+
+int scratch_sum_stack(const int *src, int n)
+{
+    int total = 0;
+    for (int i = 0; i < n; i++) {
+        int tmp[4];
+        for (int k = 0; k < 4; k++)
+            tmp[k] = src[i] >> k;
+        total += tmp[0] + tmp[1] + tmp[2] + tmp[3];
+    }
+    return total;
+}
+
+int scratch_sum_escaped(const int *src, int n)
+{
+    int total = 0;
+    for (int i = 0; i < n; i++) {
+        int *tmp = malloc(4 * sizeof *tmp);
+        if (!tmp)
+            return -1;
+        for (int k = 0; k < 4; k++)
+            tmp[k] = src[i] >> k;
+        observe((long long)(size_t)tmp);    /* the address leaves the function */
+        total += tmp[0] + tmp[1] + tmp[2] + tmp[3];
+        free(tmp);
+    }
+    return total;
+}
@@ -1,3 +1,7 @@
+/* @gallery-hints
+ *   throughput: multiply_by_8, multiply_by_15, divide_by_3, modulo_power_of_2
+ */
+
 /*
  * Strength reduction: expensive operations replaced with cheaper ones.
  *
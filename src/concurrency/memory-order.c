@@ -0,0 +1,101 @@
+/* @gallery-hints
+ *   compiler-exclude: vc_v19_44_VS17_14_x64, vc_v19_44_VS17_14_x86
+ */
+
+/*
+ * C11 atomics: what each memory order costs.
+ *
+ * The same message-passing pattern -- write the data, then set a flag;
+ * wait for the flag, then read the data -- with relaxed, release/acquire
+ * and seq_cst ordering on the flag, plus a read-modify-write and a fence.
+ *
+ * x86 is strongly ordered (TSO): ordinary loads and stores already have
+ * acquire and release semantics, so relaxed, acquire and release all
+ * compile to a plain mov. Only seq_cst stores pay, with an xchg (which is
+ * implicitly locked) or a mov followed by mfence. Every read-modify-write
+ * is a lock-prefixed instruction whatever its order.
+ *
+ * ARM is weakly ordered and every order shows up in the assembly:
+ *
+ *   ARMv8 (AArch64)  release store -> stlr, acquire load -> ldar,
+ *                    seq_cst uses the same two; fetch_add is an
+ *                    ldxr/stxr retry loop (ldadd with LSE, -march=armv8.1-a)
+ *   ARMv7            no ordered loads or stores: a dmb ish barrier before
+ *                    a release store and after an acquire load, both
+ *                    around seq_cst accesses; ldrex/strex loops for RMWs
+ *
+ * Relaxed is the same plain load or store on both, which is why the
+ * relaxed publish below is a bug: nothing stops the flag from becoming
+ * visible before the data. (MSVC needs /experimental:c11atomics for
+ * <stdatomic.h> and is left out.)
+ */
+#include <stdatomic.h>
+
+int payload;
+atomic_int ready;
+atomic_int counter;
+
+/* BROKEN: the payload store may be reordered after the flag (on ARM) */
+void publish_relaxed(int value)
+{
+    payload = value;
+    atomic_store_explicit(&ready, 1, memory_order_relaxed);
+}
+
+/* Correct and cheap: everything before the release store stays before it */
+void publish_release(int value)
+{
+    payload = value;
+    atomic_store_explicit(&ready, 1, memory_order_release);
+}
+
+/* The default order: also ordered against later seq_cst loads */
+void publish_seq_cst(int value)
+{
+    payload = value;
+    atomic_store(&ready, 1);
+}
+
+int consume_relaxed(void)
+{
+    while (!atomic_load_explicit(&ready, memory_order_relaxed))
+        ;
+    return payload;   /* may read a stale payload */
+}
+
+int consume_acquire(void)
+{
+    while (!atomic_load_explicit(&ready, memory_order_acquire))
+        ;
+    return payload;
+}
+
+int consume_seq_cst(void)
+{
+    while (!atomic_load(&ready))
+        ;
+    return payload;
+}
+
+/* Read-modify-writes: lock xadd on x86 for both, different on ARM */
+int increment_relaxed(void)
+{
+    return atomic_fetch_add_explicit(&counter, 1, memory_order_relaxed);
+}
+
+int increment_seq_cst(void)
+{
+    return atomic_fetch_add(&counter, 1);
+}
+
+/* A standalone fence: mfence (or a locked no-op) on x86, dmb ish on ARM */
+void full_fence(void)
+{
+    atomic_thread_fence(memory_order_seq_cst);
+}
+
+/* An acquire fence is free on x86: the compiler only stops reordering */
+void acquire_fence(void)
+{
+    atomic_thread_fence(memory_order_acquire);
+}
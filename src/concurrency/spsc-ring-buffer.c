@@ -0,0 +1,142 @@
+/* @gallery-hints
+ *   compiler-exclude: vc_v19_44_VS17_14_x64, vc_v19_44_VS17_14_x86
+ *   bench: transfer_one_thread(n); transfer_two_threads(n)
+ *   bench-sizes: 65536, 1048576
+ */
+
+/*
+ * A lock-free single-producer, single-consumer ring buffer.
+ *
+ * The producer owns the tail index and the consumer the head; each only
+ * reads the other's. A slot is published by storing the new tail with
+ * release order after writing the slot, and the consumer loads the tail
+ * with acquire order before reading it (and the same the other way for
+ * freeing slots). Loads of a thread's own index can be relaxed. No
+ * read-modify-write is needed at all, so on x86 the ring compiles to
+ * plain movs; on ARMv8 look for ldar/stlr, on ARMv7 for dmb ish.
+ *
+ * head and tail live on separate cache lines, or every push would take
+ * the line holding head away from the consumer (false sharing again).
+ * Each side also keeps a cached copy of the other's index and only
+ * reloads it when the ring looks full (or empty), which saves most of
+ * the cross-core traffic.
+ *
+ * transfer_two_threads() moves n values from a producer thread to the
+ * calling thread; transfer_one_thread() does the same work alternately
+ * from one thread, as the baseline. Without pthreads both run on one
+ * thread.
+ */
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#if defined(__linux__) || defined(__APPLE__)
+#include <pthread.h>
+#include <sched.h>
+#define HAVE_PTHREADS 1
+#endif
+
+#define RING_SIZE 1024          /* a power of two: indices wrap with a mask */
+#define RING_MASK (RING_SIZE - 1)
+
+struct ring {
+    _Alignas(64) atomic_size_t head;    /* next slot to read, written by the consumer */
+    size_t cached_tail;                 /* consumer's copy of tail */
+    _Alignas(64) atomic_size_t tail;    /* next slot to write, written by the producer */
+    size_t cached_head;                 /* producer's copy of head */
+    _Alignas(64) int slots[RING_SIZE];
+};
+
+bool ring_push(struct ring *r, int value)
+{
+    size_t tail = atomic_load_explicit(&r->tail, memory_order_relaxed);
+    if (tail - r->cached_head == RING_SIZE) {
+        r->cached_head = atomic_load_explicit(&r->head, memory_order_acquire);
+        if (tail - r->cached_head == RING_SIZE)
+            return false;               /* full */
+    }
+    r->slots[tail & RING_MASK] = value;
+    atomic_store_explicit(&r->tail, tail + 1, memory_order_release);
+    return true;
+}
+
+bool ring_pop(struct ring *r, int *value)
+{
+    size_t head = atomic_load_explicit(&r->head, memory_order_relaxed);
+    if (head == r->cached_tail) {
+        r->cached_tail = atomic_load_explicit(&r->tail, memory_order_acquire);
+        if (head == r->cached_tail)
+            return false;               /* empty */
+    }
+    *value = r->slots[head & RING_MASK];
+    atomic_store_explicit(&r->head, head + 1, memory_order_release);
+    return true;
+}
+
+static struct ring ring;
+
+static void ring_reset(struct ring *r)
+{
+    atomic_store(&r->head, 0);
+    atomic_store(&r->tail, 0);
+    r->cached_head = r->cached_tail = 0;
+}
+
+#ifdef HAVE_PTHREADS
+/* Waiting for the other thread: give up the core rather than spin on it,
+ * which matters when both threads share one (or more threads than cores) */
+static void spin_wait(void)
+{
+    sched_yield();
+}
+
+struct producer_job {
+    struct ring *ring;
+    long n;
+};
+
+static void *producer(void *arg)
+{
+    struct producer_job *job = arg;
+    for (long i = 0; i < job->n; i++) {
+        while (!ring_push(job->ring, (int)i))
+            spin_wait();                /* full */
+    }
+    return 0;
+}
+#endif
+
+long long transfer_one_thread(long n)
+{
+    long long sum = 0;
+    int value;
+    ring_reset(&ring);
+    for (long i = 0; i < n; ) {
+        while (i < n && ring_push(&ring, (int)i))
+            i++;                        /* fill the ring ... */
+        while (ring_pop(&ring, &value))
+            sum += value;               /* ... then drain it */
+    }
+    return sum;
+}
+
+long long transfer_two_threads(long n)
+{
+#ifdef HAVE_PTHREADS
+    struct producer_job job = { &ring, n };
+    pthread_t tid;
+    long long sum = 0;
+    int value;
+    ring_reset(&ring);
+    pthread_create(&tid, 0, producer, &job);
+    for (long i = 0; i < n; i++) {
+        while (!ring_pop(&ring, &value))
+            spin_wait();                /* empty */
+        sum += value;
+    }
+    pthread_join(tid, 0);
+    return sum;
+#else
+    return transfer_one_thread(n);
+#endif
+}
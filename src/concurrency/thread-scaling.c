@@ -0,0 +1,125 @@
+/* @gallery-hints
+ *   compiler-exclude: vc_v19_44_VS17_14_x64, vc_v19_44_VS17_14_x86
+ *   bench: count_one_atomic(n); count_unpadded(n); count_padded(n)
+ *   bench-sizes: 1000000
+ *   bench-counters: yes
+ *   sweep-defines: THREADS=1,2,4,8
+ */
+
+/*
+ * Counting with 1..N threads: contention and false sharing.
+ *
+ * Each function has THREADS threads add n to a total, one relaxed atomic
+ * increment at a time, in three ways:
+ *
+ *   count_one_atomic  every thread increments the same counter (true
+ *                     sharing: the cache line and the lock xadd serialize
+ *                     all threads)
+ *   count_unpadded    one counter per thread, all in one cache line
+ *                     (false sharing: no data is shared, the line still is)
+ *   count_padded      one counter per thread, each on its own cache line
+ *
+ * The code inside the loops is the same; only the addresses differ. The
+ * sweep-defines variants build THREADS=1, 2, 4 and 8, and the Scaling
+ * section plots ns/element against the thread count: the padded version
+ * should get faster with more cores, the other two slower. On a single
+ * core (or without pthreads) the threads run one after the other and
+ * the three curves coincide. memory/false-sharing.c shows the plain
+ * (non-atomic) layout version.
+ */
+#include <stdatomic.h>
+
+#if defined(__linux__) || defined(__APPLE__)
+#include <pthread.h>
+#define HAVE_PTHREADS 1
+#endif
+
+#ifndef THREADS
+#define THREADS 4
+#endif
+
+struct job {
+    atomic_long *counter;
+    long n;
+};
+
+struct padded_counter {
+    _Alignas(64) atomic_long count;
+};
+
+static void *worker(void *arg)
+{
+    struct job *job = arg;
+    for (long i = 0; i < job->n; i++) {
+        atomic_fetch_add_explicit(job->counter, 1, memory_order_relaxed);
+    }
+    return 0;
+}
+
+/* Runs THREADS workers, each adding n / THREADS to its counter */
+static void run_workers(atomic_long *counters[THREADS], long n)
+{
+    struct job jobs[THREADS];
+    for (int t = 0; t < THREADS; t++) {
+        jobs[t].counter = counters[t];
+        jobs[t].n = n / THREADS;
+    }
+#ifdef HAVE_PTHREADS
+    pthread_t tids[THREADS];
+    for (int t = 1; t < THREADS; t++) {
+        pthread_create(&tids[t], 0, worker, &jobs[t]);
+    }
+    worker(&jobs[0]);                   /* the calling thread is worker 0 */
+    for (int t = 1; t < THREADS; t++) {
+        pthread_join(tids[t], 0);
+    }
+#else
+    for (int t = 0; t < THREADS; t++) {
+        worker(&jobs[t]);
+    }
+#endif
+}
+
+long count_one_atomic(long n)
+{
+    static atomic_long total;
+    atomic_long *counters[THREADS];
+    atomic_store(&total, 0);
+    for (int t = 0; t < THREADS; t++) {
+        counters[t] = &total;           /* the same address for every thread */
+    }
+    run_workers(counters, n);
+    return atomic_load(&total);
+}
+
+long count_unpadded(long n)
+{
+    static _Alignas(64) atomic_long c[THREADS];
+    atomic_long *counters[THREADS];
+    for (int t = 0; t < THREADS; t++) {
+        atomic_store(&c[t], 0);
+        counters[t] = &c[t];            /* 8 bytes apart */
+    }
+    run_workers(counters, n);
+    long total = 0;
+    for (int t = 0; t < THREADS; t++) {
+        total += atomic_load(&c[t]);
+    }
+    return total;
+}
+
+long count_padded(long n)
+{
+    static struct padded_counter c[THREADS];
+    atomic_long *counters[THREADS];
+    for (int t = 0; t < THREADS; t++) {
+        atomic_store(&c[t].count, 0);
+        counters[t] = &c[t].count;      /* 64 bytes apart */
+    }
+    run_workers(counters, n);
+    long total = 0;
+    for (int t = 0; t < THREADS; t++) {
+        total += atomic_load(&c[t].count);
+    }
+    return total;
+}
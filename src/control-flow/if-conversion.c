@@ -1,3 +1,9 @@
+/* @gallery-hints
+ *   bench: clamp(i32{-100..100}, -50, 50); min(i32{-100..100}, 0); abs_val(i32{-100..100})
+ *   bench-sizes: 65536
+ *   bench-counters: yes
+ */
+
 /*
  * If-Conversion (branch to conditional move)
  *
@@ -8,6 +14,13 @@
  *
  * Look for: cmovl / cmovge / cmovne instead of jl / jge / jne
  * with a branch over a mov.
+ *
+ * Whether that pays off depends on the data. The benchmarks call each
+ * function on sorted, random and adversarial inputs: a branch is nearly
+ * free when the predictor gets it right (sorted) and costs a pipeline
+ * flush, 15-20 cycles, when it does not (random). cmov costs the same
+ * on every input, so a flat row across the three inputs means the
+ * compiler if-converted the function.
  */
 
 int min(int a, int b)
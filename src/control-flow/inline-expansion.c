@@ -1,3 +1,10 @@
+/* @gallery-hints
+ *   bench: compute(i32{-1000..1000}); fibonacci(i32{10..20}); large_function(i32{0..1000})
+ *   bench-sizes: 1024
+ *   bench-iterations: 20
+ *   bench-inputs: random
+ */
+
 /*
  * Function inlining: small functions are expanded at call site.
  *
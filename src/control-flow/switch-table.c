@@ -1,12 +1,24 @@
+/* @gallery-hints
+ *   bench: day_of_week(i32{0..7}); sparse_switch(i32{0,1,100,10000,999999})
+ *   bench-sizes: 65536
+ *   bench-counters: yes
+ */
+
 /*
  * Switch optimization: jump tables vs. binary search vs. if-else.
  *
  * Compiler chooses implementation based on case distribution:
  * - Dense cases: jump table (O(1))
  * - Sparse cases: binary search (O(log n)) or if-else chain
+ *
+ * A jump table is one indirect branch, whose target the predictor has
+ * to guess; a compare chain is several conditional branches. The
+ * benchmarks feed both with sorted, random and adversarial case values
+ * to show what each costs when the guess is wrong.
  */
 
-/* Dense cases - likely becomes a jump table */
+/* Dense cases returning constants - GCC turns this into a table of the
+ * return values (one load, no branch), not a jump table */
 int day_of_week(int day)
 {
     switch (day) {
@@ -21,6 +33,23 @@ int day_of_week(int day)
     }
 }
 
+/* Dense cases doing different work - becomes a jump table: one
+ * indirect jmp through a .rodata array of code addresses */
+int apply_op(int op, int a, int b)
+{
+    switch (op) {
+        case 0: return a + b;
+        case 1: return a - b;
+        case 2: return a * b;
+        case 3: return b ? a / b : 0;
+        case 4: return a << (b & 31);
+        case 5: return a >> (b & 31);
+        case 6: return a & b;
+        case 7: return a ^ b;
+        default: return 0;
+    }
+}
+
 /* Sparse cases - likely if-else or binary search */
 int sparse_switch(int x)
 {
@@ -1,5 +1,8 @@
 /* @gallery-hints
  *   extra-flags: -fcf-protection=full
+ *   overhead: -fcf-protection=none
+ *   bench: demo(); apply_n(n)
+ *   bench-sizes: 1024
  *   compiler-only: cg152, clang1910
  */
 
@@ -30,3 +33,14 @@ int demo(void)
 {
     return apply(add, 10, 3) + apply(sub, 10, 3);
 }
+
+/* n indirect calls through a table the compiler cannot see into:
+ * each one lands on an ENDBR64 with IBT on. */
+int apply_n(int n)
+{
+    static op_fn volatile ops[2] = {add, sub};
+    int acc = 0;
+    for (int i = 0; i < n; i++)
+        acc = apply(ops[i & 1], acc, i);
+    return acc;
+}
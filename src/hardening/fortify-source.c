@@ -1,5 +1,8 @@
 /* @gallery-hints
  *   extra-flags: -D_FORTIFY_SOURCE=2
+ *   overhead: -U_FORTIFY_SOURCE
+ *   bench: safe_copy(u8[], n, str[]); known_size_copy()
+ *   bench-sizes: 64
  *   compiler-only: cg152, clang1910
  *   scenario-exclude: O0
  */
@@ -16,6 +19,7 @@
  * memcpy / strcpy.  If the compiler can prove the copy is safe at
  * compile time, the check is elided entirely.
  */
+#include <stdio.h>
 #include <string.h>
 
 void safe_copy(char *dst, unsigned long dstsize, const char *src)
@@ -27,10 +31,20 @@ void safe_copy(char *dst, unsigned long dstsize, const char *src)
         memcpy(dst, src, srclen);
 }
 
+void greet(const char *name)
+{
+    char buf[16];
+    /* The source length is unknown but buf's size is not: this becomes
+     * __strcpy_chk(buf, name, 16). */
+    strcpy(buf, name);
+    puts(buf);
+}
+
 void known_size_copy(void)
 {
     char buf[32];
-    /* Compiler knows buf is 32 bytes, so it can check at compile time. */
+    /* Compiler knows buf is 32 bytes and "hello" fits, so the check is
+     * elided (and the dead copy with it). */
     strcpy(buf, "hello");
     (void)buf;
 }
@@ -1,5 +1,8 @@
 /* @gallery-hints
  *   extra-flags: -D_FORTIFY_SOURCE=2
+ *   overhead: -U_FORTIFY_SOURCE
+ *   bench: format_message(u8[], n, 42); bounded_format(u8[], n, str[])
+ *   bench-sizes: 64
  *   compiler-only: cg152, clang1910
  *   scenario-exclude: O0
  */
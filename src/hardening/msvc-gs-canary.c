@@ -1,5 +1,6 @@
 /* @gallery-hints
  *   replace-flags: /O2 /GS
+ *   overhead: /O2 /GS-
  *   compiler-only: vc_v19_44_VS17_14_x64, vc_v19_44_VS17_14_x86
  */
 
@@ -1,5 +1,6 @@
 /* @gallery-hints
  *   replace-flags: /O2 /guard:cf
+ *   overhead: /O2 /guard:cf-
  *   compiler-only: vc_v19_44_VS17_14_x64, vc_v19_44_VS17_14_x86
  */
 
@@ -38,3 +39,14 @@ int demo(void)
 {
     return apply(add, 10, 3) + apply(sub, 10, 3);
 }
+
+/* n indirect calls through a table the compiler cannot see into:
+ * each one goes through the CFG check. */
+int apply_n(int n)
+{
+    static op_fn volatile ops[2] = {add, sub};
+    int acc = 0;
+    for (int i = 0; i < n; i++)
+        acc = apply(ops[i & 1], acc, i);
+    return acc;
+}
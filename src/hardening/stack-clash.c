@@ -1,5 +1,8 @@
 /* @gallery-hints
  *   extra-flags: -fstack-clash-protection
+ *   overhead: -fno-stack-clash-protection
+ *   bench: large_frame(0)
+ *   bench-sizes: 1
  *   compiler-exclude: vc_v19_44_VS17_14_x64, vc_v19_44_VS17_14_x86, avrg1520
  */
 
@@ -1,5 +1,8 @@
 /* @gallery-hints
  *   extra-flags: -fstack-protector-all
+ *   overhead: -fno-stack-protector
+ *   bench: copy_input(str[])
+ *   bench-sizes: 16, 63
  *   compiler-exclude: vc_v19_44_VS17_14_x64, vc_v19_44_VS17_14_x86
  */
 
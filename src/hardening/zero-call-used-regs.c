@@ -1,5 +1,8 @@
 /* @gallery-hints
  *   extra-flags: -fzero-call-used-regs=used
+ *   overhead: -fzero-call-used-regs=skip
+ *   bench: compute(3, 5, 7); widen(12345)
+ *   bench-sizes: 1
  *   compiler-only: cg152, clang1910
  */
 
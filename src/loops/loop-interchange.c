@@ -1,3 +1,13 @@
+/* @gallery-hints
+ *   remarks: yes
+ *   bench: column_sum(i32[n*n], i32[]); column_sum_blocked(i32[n*n], i32[])
+ *   bench-define: N
+ *   bench-sizes: 128
+ *   bench-counters: yes
+ *   sweep-defines: N=64,512,1024,2048,4096
+ *   sweep-working-set: 4*N*N + 4*N
+ */
+
 /*
  * Loop Interchange
  *
@@ -11,7 +21,9 @@
  * Here the "bad" order (column-major traversal on a row-major array)
  * is presented; the compiler may interchange the loops at -O3.
  */
+#ifndef N
 #define N 128
+#endif
 
 void column_sum(int mat[N][N], int result[N])
 {
@@ -26,3 +38,29 @@ void column_sum(int mat[N][N], int result[N])
         }
     }
 }
+
+/* Hand-blocked reference: walk the matrix in strips of BLOCK columns
+ * (16 ints, one 64-byte cache line), row by row within a strip, so every
+ * line fetched is used in full before it is evicted. Same sums, same
+ * order per column, no help needed from the optimizer. */
+#ifndef BLOCK
+#define BLOCK 16
+#endif
+
+void column_sum_blocked(int mat[N][N], int result[N])
+{
+    for (int j = 0; j < N; j++)
+    {
+        result[j] = 0;
+    }
+    for (int jj = 0; jj < N; jj += BLOCK)
+    {
+        for (int i = 0; i < N; i++)
+        {
+            for (int j = jj; j < jj + BLOCK && j < N; j++)
+            {
+                result[j] += mat[i][j];
+            }
+        }
+    }
+}
@@ -1,3 +1,9 @@
+/* @gallery-hints
+ *   bench: fill_scaled(i32[], n, 3, 7)
+ *   bench-sizes: 4096, 65536, 1048576, 8388608
+ *   bench-counters: yes
+ */
+
 /*
  * Loop-Invariant Code Motion (LICM)
  *
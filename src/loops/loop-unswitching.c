@@ -1,3 +1,10 @@
+/* @gallery-hints
+ *   bench: process_array(i32[], n, 1); process_array(i32[], n, 0)
+ *   bench-stubs: process_a(i32); process_b(i32)
+ *   bench-sizes: 4096, 1048576
+ *   bench-counters: yes
+ */
+
 /*
  * Loop unswitching: moving a loop-invariant conditional outside
  * the loop by creating two copies of the loop body.
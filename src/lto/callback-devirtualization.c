@@ -0,0 +1,39 @@
+/* @gallery-hints
+ *   files: callback-devirtualization/ops.c
+ *   compiler-only: cg152, clang1910
+ */
+
+/*
+ * Devirtualizing callbacks across translation units.
+ *
+ * The op_fn callbacks and apply() of hardening/cf-protection.c, copied
+ * into a file of their own (callback-devirtualization/ops.c); the CET
+ * example keeps its copy as indirect-branch targets. Without LTO,
+ * main() passes function pointers to an apply() it cannot see into, so
+ * both calls go through apply() and an indirect CALL there. With -flto
+ * the link-time optimizer inlines apply() into main(): apply(add, ...)
+ * then calls a known function, which is inlined in turn and leaves a
+ * single ADD. The callback main() picks from argc stays an indirect call,
+ * since no compiler can know which one it is; add and sub keep their
+ * out-of-line copies only for that call.
+ *
+ * -fwhole-program tells the compiler no code outside this program calls
+ * its functions. When linking an executable through the linker plugin,
+ * LTO already has that from the linker, so its listing matches -flto's.
+ *
+ * Look for: two CALL apply at -O2; one CALL reg and an ADD of 10 in
+ * main() at -O2 -flto.
+ */
+
+typedef int (*op_fn)(int, int);
+
+int add(int a, int b);
+int sub(int a, int b);
+int apply(op_fn f, int x, int y);
+
+int main(int argc, char **argv)
+{
+    (void)argv;
+    op_fn f = argc > 1 ? sub : add;
+    return apply(f, argc, 3) + apply(add, argc, 10);
+}
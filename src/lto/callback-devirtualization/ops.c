@@ -0,0 +1,11 @@
+/* Part of callback-devirtualization.c: linked with it, not compiled on its own. */
+
+typedef int (*op_fn)(int, int);
+
+int add(int a, int b) { return a + b; }
+int sub(int a, int b) { return a - b; }
+
+int apply(op_fn f, int x, int y)
+{
+    return f(x, y);
+}
@@ -0,0 +1,30 @@
+/* @gallery-hints
+ *   files: cross-module-inline/helpers.c
+ *   compiler-only: cg152, clang1910
+ */
+
+/*
+ * Cross-module inlining with link-time optimization.
+ *
+ * clamp() and scale() are defined in another translation unit
+ * (cross-module-inline/helpers.c). Compiled one file at a time, the
+ * compiler only sees their declarations, so main() has to call them.
+ * With -flto the object files carry the compiler's IR and the link step
+ * optimizes the whole program: both helpers are inlined into main() and
+ * the loop folds into straight-line arithmetic.
+ *
+ * Look for: CALL clamp / CALL scale at -O2, and no calls (and often no
+ * separate helper functions left) at -O2 -flto.
+ */
+
+int clamp(int x, int lo, int hi);
+int scale(int x);
+
+int main(int argc, char **argv)
+{
+    (void)argv;
+    int acc = 0;
+    for (int i = 0; i < argc * 4; i++)
+        acc += scale(clamp(i - argc, 0, 10));
+    return acc;
+}
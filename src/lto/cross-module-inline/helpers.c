@@ -0,0 +1,11 @@
+/* Part of cross-module-inline.c: linked with it, not compiled on its own. */
+
+int clamp(int x, int lo, int hi)
+{
+    return x < lo ? lo : x > hi ? hi : x;
+}
+
+int scale(int x)
+{
+    return 3 * x + 1;
+}
@@ -0,0 +1,75 @@
+/* @gallery-hints
+ *   bench: update_aos(f32[n*8], n, 0.01); update_soa(f32[], f32[], f32[], f32[], f32[], f32[], n, 0.01); update_aosoa(f32[n*8], n, 0.01)
+ *   bench-sizes: 1024, 65536, 1048576
+ *   bench-counters: yes
+ */
+
+/*
+ * Array of structures vs structure of arrays.
+ *
+ * The same particle update -- position += velocity * dt -- over three
+ * layouts of the same data:
+ *
+ *   AoS    one struct per particle: x y z vx vy vz mass charge
+ *   SoA    one array per field: every x, then every y, ...
+ *   AoSoA  blocks of 8 particles, each block a small SoA
+ *
+ * With AoS a vector register loaded from memory holds x, y, z, vx, ...
+ * of one particle, so the compiler must shuffle (or gather) to put eight
+ * x values side by side, and mass and charge are loaded into cache for
+ * nothing. SoA and AoSoA put same-field values next to each other: plain
+ * vector loads and stores, and only the fields the loop touches are
+ * fetched. AoSoA also keeps one particle's fields within a few cache
+ * lines, which AoS code elsewhere may want.
+ */
+
+struct particle {
+    float x, y, z;
+    float vx, vy, vz;
+    float mass, charge;   /* not used by the update, but still fetched */
+};
+
+#define BLOCK 8
+
+struct particle_block {
+    float x[BLOCK], y[BLOCK], z[BLOCK];
+    float vx[BLOCK], vy[BLOCK], vz[BLOCK];
+    float mass[BLOCK], charge[BLOCK];
+};
+
+/* AoS: stride-8 accesses to every field */
+void update_aos(struct particle *p, int n, float dt)
+{
+    for (int i = 0; i < n; i++) {
+        p[i].x += p[i].vx * dt;
+        p[i].y += p[i].vy * dt;
+        p[i].z += p[i].vz * dt;
+    }
+}
+
+/* SoA: six unit-stride streams, vectorizes like a plain array loop.
+ * restrict matters: without it six pointers need more runtime overlap
+ * checks than GCC is willing to emit, and the loop stays scalar. */
+void update_soa(float *restrict x, float *restrict y, float *restrict z,
+                const float *restrict vx, const float *restrict vy, const float *restrict vz,
+                int n, float dt)
+{
+    for (int i = 0; i < n; i++) {
+        x[i] += vx[i] * dt;
+        y[i] += vy[i] * dt;
+        z[i] += vz[i] * dt;
+    }
+}
+
+/* AoSoA: the inner loop is a fixed 8-wide SoA update; n is a
+ * multiple of BLOCK */
+void update_aosoa(struct particle_block *b, int n, float dt)
+{
+    for (int blk = 0; blk < n / BLOCK; blk++) {
+        for (int k = 0; k < BLOCK; k++) {
+            b[blk].x[k] += b[blk].vx[k] * dt;
+            b[blk].y[k] += b[blk].vy[k] * dt;
+            b[blk].z[k] += b[blk].vz[k] * dt;
+        }
+    }
+}
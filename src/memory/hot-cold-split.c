@@ -0,0 +1,51 @@
+/* @gallery-hints
+ *   bench: total_balance_mixed(u8[n*64], n); total_balance_split(i32[], n)
+ *   bench-sizes: 1024, 65536, 1048576
+ *   bench-counters: yes
+ */
+
+/*
+ * Hot/cold field splitting.
+ *
+ * A loop that reads one field of a large record still pulls the whole
+ * cache line holding it into cache. Below, a 64-byte account record keeps
+ * its balance next to a name and address that the summing loop never
+ * reads: each balance costs a full cache line, so the loop is limited by
+ * memory bandwidth (and misses) once the records outgrow the caches.
+ *
+ * Splitting the hot field into its own array packs sixteen balances into
+ * every line, so sixteen times less data moves and the loop becomes a
+ * plain, vectorizable array sum. The record keeps its cold fields and an
+ * index into the hot array.
+ */
+
+struct account {
+    int balance;          /* hot: read by every pass */
+    int flags;
+    char name[24];        /* cold: read when printing a statement */
+    char address[32];
+};                        /* 64 bytes: one cache line per balance */
+
+struct account_cold {
+    int flags;
+    char name[24];
+    char address[32];
+};                        /* the balance lives in a separate int array */
+
+long long total_balance_mixed(const struct account *accounts, int n)
+{
+    long long total = 0;
+    for (int i = 0; i < n; i++) {
+        total += accounts[i].balance;   /* stride of 64 bytes */
+    }
+    return total;
+}
+
+long long total_balance_split(const int *balances, int n)
+{
+    long long total = 0;
+    for (int i = 0; i < n; i++) {
+        total += balances[i];           /* unit stride, 16 per line */
+    }
+    return total;
+}
@@ -1,3 +1,10 @@
+/* @gallery-hints
+ *   bench: copy_8_bytes(u8[], u8[]); copy_struct(u8[], u8[]); copy_varying(u8[], u8[], 1); copy_varying(u8[], u8[], 0)
+ *   bench-sizes: 4096
+ *   bench-iterations: 1000000
+ *   bench-counters: yes
+ */
+
 /*
  * memcpy inlining: small copies become inline loads/stores.
  *
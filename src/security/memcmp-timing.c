@@ -1,3 +1,7 @@
+/* @gallery-hints
+ *   constant-time: verify_token_safe(u8[], u8[], n); verify_token_bad(u8[], u8[], n)
+ */
+
 /*
  * Timing side channel: memcmp short-circuits on first mismatch.
  *
@@ -7,6 +11,10 @@
  *
  * Real-world: CVE-2014-0160 (Heartbleed context), countless
  * authentication bypass bugs from non-constant-time comparisons.
+ *
+ * Both functions are checked on every compiler and scenario: statically
+ * for secret-dependent branches and early-exit calls in the assembly,
+ * and (with --bench) by a fixed-vs-random timing test.
  */
 #include <string.h>
 #include <stdint.h>
@@ -1,3 +1,10 @@
+/* @gallery-hints
+ *   bench: add_arrays(f32[], f32[], f32[], n); sum_array(f32[], n); clamp_array(f32[], n, 0.25, 0.75)
+ *   bench-sizes: 1024, 16384, 262144, 4194304
+ *   remarks: yes
+ *   throughput: add_arrays, sum_array, clamp_array
+ */
+
 /*
  * Auto-vectorization: loops converted to SIMD operations.
  *
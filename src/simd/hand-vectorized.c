@@ -0,0 +1,133 @@
+/* @gallery-hints
+ *   bench: add_arrays_simd(f32[], f32[], f32[], n); sum_array_simd(f32[], n); sum_array_4acc(f32[], n); clamp_array_simd(f32[], n, 0.25, 0.75); clamp_array_branchless(f32[], n, 0.25, 0.75)
+ *   bench-sizes: 1024, 16384, 262144, 4194304
+ *   bench-baseline: simd/auto-vectorize
+ *   throughput: add_arrays_simd, sum_array_simd, sum_array_4acc, clamp_array_simd
+ */
+
+/*
+ * Hand-vectorized reference kernels for auto-vectorize.c.
+ *
+ * The same loops written the way they would be when tuned by hand:
+ * explicit SIMD intrinsics (AVX2, SSE2 or NEON, whichever the target
+ * flags enable; plain C elsewhere), several independent accumulators
+ * for the reduction, and min/max instead of branches for the clamp.
+ *
+ * The benchmarks are compared with auto-vectorize.c's on the same
+ * compiler and flags. The add loop should be close at -O3. The float
+ * reduction stays one serial chain of adds unless -ffast-math (Ofast)
+ * lets the compiler reassociate it, which the code below does by hand.
+ */
+#if defined(__AVX2__)
+#include <immintrin.h>
+typedef __m256 vfloat;
+#define VW 8
+#define vload(p) _mm256_loadu_ps(p)
+#define vstore(p, v) _mm256_storeu_ps(p, v)
+#define vadd(a, b) _mm256_add_ps(a, b)
+#define vmin(a, b) _mm256_min_ps(a, b)
+#define vmax(a, b) _mm256_max_ps(a, b)
+#define vset1(x) _mm256_set1_ps(x)
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+typedef __m128 vfloat;
+#define VW 4
+#define vload(p) _mm_loadu_ps(p)
+#define vstore(p, v) _mm_storeu_ps(p, v)
+#define vadd(a, b) _mm_add_ps(a, b)
+#define vmin(a, b) _mm_min_ps(a, b)
+#define vmax(a, b) _mm_max_ps(a, b)
+#define vset1(x) _mm_set1_ps(x)
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+typedef float32x4_t vfloat;
+#define VW 4
+#define vload(p) vld1q_f32(p)
+#define vstore(p, v) vst1q_f32(p, v)
+#define vadd(a, b) vaddq_f32(a, b)
+#define vmin(a, b) vminq_f32(a, b)
+#define vmax(a, b) vmaxq_f32(a, b)
+#define vset1(x) vdupq_n_f32(x)
+#endif
+
+/* add_arrays with one vector add per VW elements, then a scalar tail */
+void add_arrays_simd(float *dst, const float *a, const float *b, int n)
+{
+    int i = 0;
+#ifdef VW
+    for (; i + VW <= n; i += VW)
+        vstore(dst + i, vadd(vload(a + i), vload(b + i)));
+#endif
+    for (; i < n; i++)
+        dst[i] = a[i] + b[i];
+}
+
+/* sum_array with four vector accumulators: four independent add chains
+ * hide the add latency, which a single accumulator waits on every step. */
+float sum_array_simd(const float *arr, int n)
+{
+    float sum = 0.0f;
+    int i = 0;
+#ifdef VW
+    vfloat s0 = vset1(0.0f), s1 = s0, s2 = s0, s3 = s0;
+    for (; i + 4 * VW <= n; i += 4 * VW) {
+        s0 = vadd(s0, vload(arr + i));
+        s1 = vadd(s1, vload(arr + i + VW));
+        s2 = vadd(s2, vload(arr + i + 2 * VW));
+        s3 = vadd(s3, vload(arr + i + 3 * VW));
+    }
+    for (; i + VW <= n; i += VW)
+        s0 = vadd(s0, vload(arr + i));
+    float lanes[VW];
+    vstore(lanes, vadd(vadd(s0, s1), vadd(s2, s3)));
+    for (int k = 0; k < VW; k++)
+        sum += lanes[k];
+#endif
+    for (; i < n; i++)
+        sum += arr[i];
+    return sum;
+}
+
+/* The same reassociation in plain C: four scalar accumulators.
+ * The compiler may turn them into one vector accumulator (SLP). */
+float sum_array_4acc(const float *arr, int n)
+{
+    float s0 = 0.0f, s1 = 0.0f, s2 = 0.0f, s3 = 0.0f;
+    int i = 0;
+    for (; i + 4 <= n; i += 4) {
+        s0 += arr[i];
+        s1 += arr[i + 1];
+        s2 += arr[i + 2];
+        s3 += arr[i + 3];
+    }
+    for (; i < n; i++)
+        s0 += arr[i];
+    return (s0 + s1) + (s2 + s3);
+}
+
+/* clamp_array as a vector max then min: no branches, no masks */
+void clamp_array_simd(float *arr, int n, float min, float max)
+{
+    int i = 0;
+#ifdef VW
+    vfloat lo = vset1(min), hi = vset1(max);
+    for (; i + VW <= n; i += VW)
+        vstore(arr + i, vmin(vmax(vload(arr + i), lo), hi));
+#endif
+    for (; i < n; i++) {
+        float v = arr[i];
+        v = v < min ? min : v;
+        arr[i] = v > max ? max : v;
+    }
+}
+
+/* clamp_array with both tests as selects: every element is stored, so the
+ * loop has no control flow left and maps onto minss/maxss or vector min/max. */
+void clamp_array_branchless(float *arr, int n, float min, float max)
+{
+    for (int i = 0; i < n; i++) {
+        float v = arr[i];
+        v = v < min ? min : v;
+        arr[i] = v > max ? max : v;
+    }
+}
@@ -1,3 +1,9 @@
+/* @gallery-hints
+ *   bench: copy_no_restrict(i32[], i32[], n); copy_restrict(i32[], i32[], n); scale_no_restrict(f32[], f32[], f32[], n); scale_restrict(f32[], f32[], f32[], n)
+ *   bench-sizes: 1024, 16384, 262144, 4194304
+ *   remarks: yes
+ */
+
 /*
  * Restrict pointers enable better optimization.
  *